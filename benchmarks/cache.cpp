@@ -0,0 +1,256 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of cache structures: treap which orders cache elements by their event time
+ * and slru_cache_t itself. slru_cache_t needs dnet_node and dnet_backend, so single in-process
+ * server is started for the whole run. All writes are cache-only, so the backend is never touched
+ * and evicted elements are just dropped.
+ */
+
+#include <string.h>
+
+#include <iostream>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "cache/slru_cache.hpp"
+#include "library/backend.h"
+#include "tests/test_base.hpp"
+
+namespace {
+
+using ioremap::cache::data_t;
+using ioremap::cache::slru_cache_t;
+using ioremap::cache::treap_t;
+using ioremap::cache::write_request;
+using ioremap::elliptics::data_pointer;
+
+std::vector<dnet_raw_id> generate_ids(size_t count) {
+	std::mt19937_64 generator(count);
+	std::vector<dnet_raw_id> ids(count);
+	for (auto &id : ids) {
+		for (size_t i = 0; i < sizeof(id.id); i += sizeof(uint64_t)) {
+			const uint64_t value = generator();
+			memcpy(id.id + i, &value, sizeof(value));
+		}
+	}
+	return ids;
+}
+
+/* treap is guarded by cache lock, so it is measured by single thread */
+struct treap_fixture {
+	explicit treap_fixture(size_t count)
+	: ids(generate_ids(count)) {
+		for (size_t i = 0; i < ids.size(); ++i) {
+			auto node = new data_t(ids[i].id);
+			node->set_lifetime(i);
+			nodes.push_back(node);
+			treap.insert(node);
+		}
+	}
+
+	/* treap doesn't own its nodes, they are erased and deleted like slru_cache_t::erase_element() does */
+	~treap_fixture() {
+		for (auto node : nodes) {
+			treap.erase(node);
+			delete node;
+		}
+	}
+
+	std::vector<dnet_raw_id> ids;
+	std::vector<data_t *> nodes;
+	treap_t treap;
+};
+
+void BM_treap_find(benchmark::State &state) {
+	treap_fixture f(state.range(0));
+	size_t index = 0;
+
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(f.treap.find(f.ids[index].id));
+		if (++index == f.ids.size())
+			index = 0;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_treap_find)->RangeMultiplier(8)->Range(1 << 6, 1 << 21);
+
+/* slru_cache_t calls decrease_key (erase + insert) every time element's event time changes */
+void BM_treap_decrease_key(benchmark::State &state) {
+	treap_fixture f(state.range(0));
+	size_t index = 0;
+	size_t time = f.nodes.size();
+
+	while (state.KeepRunning()) {
+		auto node = f.nodes[index];
+		node->set_lifetime(++time);
+		f.treap.decrease_key(node);
+		if (++index == f.nodes.size())
+			index = 0;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_treap_decrease_key)->RangeMultiplier(8)->Range(1 << 6, 1 << 21);
+
+tests::nodes_data::ptr server;
+
+dnet_node *server_node() {
+	return server->nodes[0].get_native();
+}
+
+/*
+ * Shared by all benchmark threads, slru_cache_t has single lock, so threads show its contention.
+ * Cache is sized as @capacity objects of @object_size, every thread works with its own @keys keys,
+ * keys number above capacity makes every write evict an element.
+ */
+struct cache_fixture {
+	cache_fixture(size_t object_size, size_t capacity, size_t keys, size_t threads)
+	: backend(server_node()->io->backends_manager->get(0))
+	, need_exit(false)
+	, ids(generate_ids(keys * threads))
+	, data(data_pointer::allocate(object_size)) {
+		memset(data.data(), 0x5a, data.size());
+
+		/* cache has two pages like default one with caches_number=1 and cache_pages_proportions=1:1 */
+		const size_t page_size = capacity * object_size;
+		cache.reset(new slru_cache_t(server_node(), *backend, {page_size, page_size}, 1, need_exit));
+	}
+
+	~cache_fixture() {
+		need_exit = true;
+		cache.reset();
+	}
+
+	void write(const dnet_raw_id &id) {
+		dnet_cmd cmd;
+		memset(&cmd, 0, sizeof(cmd));
+		memcpy(cmd.id.id, id.id, sizeof(cmd.id.id));
+		cmd.cmd = DNET_CMD_WRITE;
+
+		dnet_io_attr io;
+		memset(&io, 0, sizeof(io));
+		memcpy(io.id, id.id, sizeof(io.id));
+		io.flags = DNET_IO_FLAGS_CACHE | DNET_IO_FLAGS_CACHE_ONLY;
+		io.size = data.size();
+		dnet_current_time(&io.timestamp);
+
+		data_pointer request_data = data;
+		write_request request(cmd.id.id, &io, request_data);
+		cache->write(nullptr, &cmd, request, nullptr);
+	}
+
+	std::shared_ptr<dnet_backend> backend;
+	bool need_exit;
+	std::unique_ptr<slru_cache_t> cache;
+	std::vector<dnet_raw_id> ids;
+	data_pointer data;
+};
+
+std::unique_ptr<cache_fixture> shared;
+
+enum {
+	/* all keys fit into cache */
+	fit = 0,
+	/* keys are 4 times more than cache can hold */
+	evict = 1,
+};
+
+void setup_cache(benchmark::State &state) {
+	const size_t object_size = state.range(0);
+	const size_t keys = 1024;
+	const size_t capacity = state.range(1) == evict ? keys * state.threads() / 4 : keys * state.threads();
+
+	shared.reset(new cache_fixture(object_size, capacity, keys, state.threads()));
+	for (const auto &id : shared->ids) {
+		shared->write(id);
+	}
+}
+
+void BM_slru_cache_write(benchmark::State &state) {
+	if (state.thread_index() == 0)
+		setup_cache(state);
+
+	const size_t keys = shared->ids.size() / state.threads();
+	const auto *ids = &shared->ids[keys * state.thread_index()];
+	size_t index = 0;
+
+	while (state.KeepRunning()) {
+		shared->write(ids[index]);
+		if (++index == keys)
+			index = 0;
+	}
+
+	if (state.thread_index() == 0)
+		shared.reset();
+
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_slru_cache_write)
+	->ArgNames({"size", "evict"})
+	->ArgsProduct({{128, 4096, 65536}, {fit, evict}})
+	->ThreadRange(1, 8)
+	->UseRealTime();
+
+void BM_slru_cache_read(benchmark::State &state) {
+	if (state.thread_index() == 0)
+		setup_cache(state);
+
+	const size_t keys = shared->ids.size() / state.threads();
+	const auto *ids = &shared->ids[keys * state.thread_index()];
+	size_t index = 0;
+
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(shared->cache->read(ids[index].id, DNET_IO_FLAGS_CACHE_ONLY));
+		if (++index == keys)
+			index = 0;
+	}
+
+	if (state.thread_index() == 0)
+		shared.reset();
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_slru_cache_read)
+	->ArgNames({"size", "evict"})
+	->ArgsProduct({{128, 4096, 65536}, {fit, evict}})
+	->ThreadRange(1, 8)
+	->UseRealTime();
+
+} /* namespace */
+
+int main(int argc, char **argv) {
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	{
+		auto config = tests::server_config::default_value();
+		config.log_level = "error";
+
+		tests::start_nodes_config start_config(std::cerr, {config}, "benchmark_cache");
+		start_config.monitor = false;
+		server = tests::start_nodes(start_config);
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+
+	server.reset();
+	return 0;
+}
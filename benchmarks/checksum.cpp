@@ -0,0 +1,62 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of data checksumming made by server for reads with DNET_IO_FLAGS_CHECKSUM
+ * and for lookups of objects stored in cache.
+ */
+
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "elliptics/session.hpp"
+
+namespace {
+
+/* checksum uses node's transform, so client node with default transform is enough */
+std::unique_ptr<ioremap::elliptics::node> node;
+
+void BM_checksum_data(benchmark::State &state) {
+	std::vector<char> data(state.range(0), 0x5a);
+	unsigned char csum[DNET_CSUM_SIZE];
+
+	while (state.KeepRunning()) {
+		dnet_checksum_data(node->get_native(), data.data(), data.size(), csum, sizeof(csum));
+		benchmark::DoNotOptimize(csum);
+	}
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_checksum_data)->RangeMultiplier(8)->Range(64, 64 << 20)->ThreadRange(1, 8)->UseRealTime();
+
+} /* namespace */
+
+int main(int argc, char **argv) {
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	node.reset(new ioremap::elliptics::node(ioremap::elliptics::make_file_logger("/dev/null", DNET_LOG_ERROR)));
+
+	benchmark::RunSpecifiedBenchmarks();
+
+	node.reset();
+	return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of sorting iterator results container made by recovery after merge iteration.
+ * Every key is presented by @copies items with different timestamps like after iterating several groups.
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "elliptics/newapi/result_entry.hpp"
+#include "library/elliptics.h"
+
+namespace {
+
+using ioremap::elliptics::newapi::iterator_container_item;
+using ioremap::elliptics::newapi::iterator_result_container;
+
+std::vector<iterator_container_item> generate_items(size_t count, size_t copies) {
+	std::mt19937_64 generator(count);
+	std::vector<iterator_container_item> items(count);
+
+	for (size_t i = 0; i < count; i += copies) {
+		dnet_raw_id key;
+		for (size_t j = 0; j < sizeof(key.id); j += sizeof(uint64_t)) {
+			const uint64_t value = generator();
+			memcpy(key.id + j, &value, sizeof(value));
+		}
+
+		for (size_t j = i; j < std::min(i + copies, count); ++j) {
+			auto &item = items[j];
+			memset(&item, 0, sizeof(item));
+			item.key = key;
+			item.data_timestamp.tsec = generator() % 1000;
+			item.json_timestamp = item.data_timestamp;
+			item.data_size = generator() % (1 << 20);
+		}
+	}
+
+	std::shuffle(items.begin(), items.end(), generator);
+	return items;
+}
+
+void BM_iterator_result_container_sort(benchmark::State &state) {
+	const auto items = generate_items(state.range(0), state.range(1));
+	const size_t size = items.size() * sizeof(iterator_container_item);
+
+	/* sort of large containers merges chunks through a file next to the container, so it must have a path */
+	char path[] = "/tmp/dnet_benchmark_iterator.XXXXXX";
+	const int fd = mkstemp(path);
+	if (fd < 0)
+		throw std::runtime_error("failed to create container file");
+
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		if (dnet_write_ll(fd, reinterpret_cast<const char *>(items.data()), size, 0))
+			throw std::runtime_error("failed to fill container file");
+		iterator_result_container container(fd, false, size);
+		state.ResumeTiming();
+
+		container.sort();
+	}
+
+	close(fd);
+	unlink(path);
+
+	state.SetItemsProcessed(state.iterations() * items.size());
+	state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_iterator_result_container_sort)
+	->ArgNames({"items", "copies"})
+	->ArgsProduct({{1 << 10, 1 << 14, 1 << 17, 1 << 20}, {1, 3}})
+	->Unit(benchmark::kMillisecond);
+
+} /* namespace */
+
+BENCHMARK_MAIN();
@@ -0,0 +1,139 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of log statements made by a single read request on the data path
+ * (send start, eblob read start and iterated key) when server runs with default INFO verbosity.
+ * "eager" variants evaluate arguments and let blackhole filter the message as it was before,
+ * "checked" variants use level-checking macros which skip disabled messages before arguments are evaluated.
+ */
+
+#include <string.h>
+
+#include <benchmark/benchmark.h>
+
+#include "elliptics/interface.h"
+#include "elliptics/packet.h"
+
+#include "library/logger.hpp"
+
+namespace {
+
+struct request {
+	request() {
+		memset(&cmd, 0, sizeof(cmd));
+		memset(&timestamp, 0, sizeof(timestamp));
+		for (size_t i = 0; i < sizeof(cmd.id.id); ++i) {
+			cmd.id.id[i] = i;
+		}
+		cmd.cmd = DNET_CMD_READ_NEW;
+		cmd.flags = DNET_FLAGS_NEED_ACK;
+		cmd.size = 4096;
+		dnet_current_time(&timestamp);
+	}
+
+	dnet_cmd cmd;
+	dnet_time timestamp;
+};
+
+struct backend {
+	explicit backend(dnet_log_level level)
+	: logger(ioremap::elliptics::make_file_logger("/dev/null", level))
+	, blog(logger.get())
+	, log_level(level) {}
+
+	std::unique_ptr<dnet_logger> logger;
+	dnet_logger *blog;
+	dnet_log_level log_level;
+};
+
+void log_eager(backend *c, const request &r) {
+	DNET_LOG_NOTICE(c->blog, "{}: {}: sending trans: {} -> {}/{}: size: {}, cflags: {}",
+	                dnet_dump_id(&r.cmd.id), dnet_cmd_string(r.cmd.cmd), r.cmd.trans, "127.0.0.1:1025",
+	                r.cmd.backend_id, r.cmd.size, dnet_flags_dump_cflags(r.cmd.flags));
+
+	DNET_LOG_NOTICE(c->blog, "{}: EBLOB: blob-read-new: {}: start: ioflags: {}, data_offset: {}, data_size: {}",
+	                dnet_dump_id(&r.cmd.id), dnet_cmd_string(r.cmd.cmd), dnet_flags_dump_ioflags(0), 0,
+	                r.cmd.size);
+
+	const std::string data_ts = dnet_print_time(&r.timestamp);
+	const std::string json_ts = dnet_print_time(&r.timestamp);
+
+	DNET_LOG_DEBUG(c->blog, "EBLOB: iterated: key: {}, json: {{ts: {}}}, data: {{size: {}, ts: {}}}",
+	               dnet_dump_id_str(r.cmd.id.id), json_ts, r.cmd.size, data_ts);
+}
+
+void log_checked(backend *c, const request &r) {
+	DNET_LOG_VERBOSITY(c->blog, c->log_level, DNET_LOG_NOTICE,
+	                   "{}: {}: sending trans: {} -> {}/{}: size: {}, cflags: {}",
+	                   dnet_dump_id(&r.cmd.id), dnet_cmd_string(r.cmd.cmd), r.cmd.trans, "127.0.0.1:1025",
+	                   r.cmd.backend_id, r.cmd.size, dnet_flags_dump_cflags(r.cmd.flags));
+
+	DNET_LOG_VERBOSITY(c->blog, c->log_level, DNET_LOG_NOTICE,
+	                   "{}: EBLOB: blob-read-new: {}: start: ioflags: {}, data_offset: {}, data_size: {}",
+	                   dnet_dump_id(&r.cmd.id), dnet_cmd_string(r.cmd.cmd), dnet_flags_dump_ioflags(0), 0,
+	                   r.cmd.size);
+
+	if (DNET_LOG_ENABLED(DNET_LOG_DEBUG, c->log_level)) {
+		const std::string data_ts = dnet_print_time(&r.timestamp);
+		const std::string json_ts = dnet_print_time(&r.timestamp);
+
+		DNET_LOG_DEBUG(c->blog, "EBLOB: iterated: key: {}, json: {{ts: {}}}, data: {{size: {}, ts: {}}}",
+		               dnet_dump_id_str(r.cmd.id.id), json_ts, r.cmd.size, data_ts);
+	}
+}
+
+void BM_log_eager(benchmark::State &state) {
+	backend c(static_cast<dnet_log_level>(state.range(0)));
+	request r;
+
+	while (state.KeepRunning()) {
+		log_eager(&c, r);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void BM_log_checked(benchmark::State &state) {
+	backend c(static_cast<dnet_log_level>(state.range(0)));
+	request r;
+
+	while (state.KeepRunning()) {
+		log_checked(&c, r);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+/* messages are filtered out by INFO verbosity, that is what data path pays by default */
+BENCHMARK(BM_log_eager)->Arg(DNET_LOG_INFO);
+BENCHMARK(BM_log_checked)->Arg(DNET_LOG_INFO);
+
+/* trace bit turns all messages on, checked variant must not be slower here */
+void BM_log_checked_traced(benchmark::State &state) {
+	backend c(static_cast<dnet_log_level>(state.range(0)));
+	request r;
+
+	ioremap::elliptics::trace_scope scope(1, true);
+	while (state.KeepRunning()) {
+		log_checked(&c, r);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_log_checked_traced)->Arg(DNET_LOG_INFO);
+
+} /* namespace */
+
+BENCHMARK_MAIN();
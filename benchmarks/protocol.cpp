@@ -0,0 +1,143 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of msgpack (de)serialization of new protocol headers made for every request and reply.
+ * Threads are independent, they show how much allocations made by (de)serialization scale.
+ */
+
+#include <string.h>
+
+#include <benchmark/benchmark.h>
+
+#include "library/protocol.hpp"
+
+namespace {
+
+using ioremap::elliptics::dnet_read_response;
+using ioremap::elliptics::dnet_write_request;
+using ioremap::elliptics::dnet_lookup_response;
+using ioremap::elliptics::dnet_iterator_response;
+using ioremap::elliptics::dnet_bulk_read_request;
+using ioremap::elliptics::serialize;
+using ioremap::elliptics::deserialize;
+
+void fill_time(dnet_time &time) {
+	dnet_current_time(&time);
+}
+
+dnet_read_response make_read_response(size_t) {
+	dnet_read_response response;
+	memset(&response, 0, sizeof(response));
+	response.json_size = response.read_json_size = 128;
+	response.data_size = response.read_data_size = 4096;
+	fill_time(response.json_timestamp);
+	fill_time(response.data_timestamp);
+	return response;
+}
+
+dnet_write_request make_write_request(size_t) {
+	dnet_write_request request;
+	memset(&request, 0, sizeof(request));
+	request.ioflags = DNET_IO_FLAGS_PREPARE | DNET_IO_FLAGS_COMMIT;
+	request.json_size = request.json_capacity = 128;
+	request.data_size = request.data_capacity = request.data_commit_size = 4096;
+	fill_time(request.timestamp);
+	fill_time(request.json_timestamp);
+	fill_time(request.deadline);
+	return request;
+}
+
+dnet_lookup_response make_lookup_response(size_t) {
+	dnet_lookup_response response;
+	response.record_flags = 0;
+	response.user_flags = 0;
+	response.path = "/srv/elliptics/1/data-0.0";
+	fill_time(response.json_timestamp);
+	response.json_offset = 1024;
+	response.json_size = response.json_capacity = 128;
+	response.json_checksum.assign(DNET_CSUM_SIZE, 0x5a);
+	fill_time(response.data_timestamp);
+	response.data_offset = 2048;
+	response.data_size = 4096;
+	response.data_checksum.assign(DNET_CSUM_SIZE, 0xa5);
+	return response;
+}
+
+dnet_iterator_response make_iterator_response(size_t) {
+	dnet_iterator_response response;
+	memset(&response, 0, sizeof(response));
+	response.iterator_id = 1;
+	response.iterated_keys = 100;
+	response.total_keys = 1000;
+	fill_time(response.json_timestamp);
+	fill_time(response.data_timestamp);
+	response.data_size = 4096;
+	return response;
+}
+
+/* @size is number of keys */
+dnet_bulk_read_request make_bulk_read_request(size_t size) {
+	dnet_bulk_read_request request;
+	request.keys.resize(size);
+	for (size_t i = 0; i < size; ++i) {
+		memset(&request.keys[i], 0, sizeof(request.keys[i]));
+		memcpy(request.keys[i].id, &i, sizeof(i));
+		request.keys[i].group_id = 1;
+	}
+	request.ioflags = 0;
+	request.read_flags = DNET_READ_FLAGS_JSON | DNET_READ_FLAGS_DATA;
+	fill_time(request.deadline);
+	return request;
+}
+
+template <typename T, T (*Make)(size_t)>
+void BM_serialize(benchmark::State &state) {
+	const T value = Make(state.range(0));
+
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(serialize(value));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template <typename T, T (*Make)(size_t)>
+void BM_deserialize(benchmark::State &state) {
+	const auto data = serialize(Make(state.range(0)));
+
+	while (state.KeepRunning()) {
+		T value;
+		deserialize(data, value);
+		benchmark::DoNotOptimize(value);
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+#define PROTOCOL_BENCHMARK(TYPE, ...) \
+	BENCHMARK_TEMPLATE(BM_serialize, dnet_##TYPE, make_##TYPE)->__VA_ARGS__->ThreadRange(1, 8); \
+	BENCHMARK_TEMPLATE(BM_deserialize, dnet_##TYPE, make_##TYPE)->__VA_ARGS__->ThreadRange(1, 8)
+
+PROTOCOL_BENCHMARK(read_response, Arg(1));
+PROTOCOL_BENCHMARK(write_request, Arg(1));
+PROTOCOL_BENCHMARK(lookup_response, Arg(1));
+PROTOCOL_BENCHMARK(iterator_response, Arg(1));
+PROTOCOL_BENCHMARK(bulk_read_request, RangeMultiplier(16)->Range(1, 1 << 12));
+
+} /* namespace */
+
+BENCHMARK_MAIN();
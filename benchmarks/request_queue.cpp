@@ -0,0 +1,156 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Push/pop cost of dnet_request_queue shared by io pool threads.
+ * Every thread keeps @depth own requests in the queue, each iteration pushes one request and pops one.
+ * Requests are marked by DNET_FLAGS_NO_QUEUE_TIMEOUT, so pop doesn't need a node to check queue timeout,
+ * and by DNET_FLAGS_NOLOCK in "nolock" variant which skips key locking.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "library/elliptics.h"
+#include "library/request_queue.h"
+
+namespace {
+
+enum {
+	with_lock = 0,
+	without_lock = 1,
+};
+
+struct request {
+	dnet_io_req req;
+	dnet_cmd cmd;
+};
+
+struct worker {
+	worker(size_t depth, bool nolock, int thread_index, dnet_net_state *st)
+	: requests(depth + 1) {
+		memset(&pool, 0, sizeof(pool));
+		memset(&wio, 0, sizeof(wio));
+		INIT_LIST_HEAD(&wio.reply_list);
+		INIT_LIST_HEAD(&wio.request_list);
+		wio.thread_index = thread_index;
+		wio.pool = &pool;
+
+		for (size_t i = 0; i < requests.size(); ++i) {
+			auto &r = requests[i];
+			memset(&r, 0, sizeof(r));
+			INIT_LIST_HEAD(&r.req.req_entry);
+			r.req.io_req_type = DNET_IO_REQ_OLD_PROTOCOL;
+			r.req.st = st;
+			r.req.header = &r.cmd;
+			r.req.hsize = sizeof(r.cmd);
+			r.req.fd = -1;
+
+			/* unique key per request, so threads never wait for each other's keys */
+			memcpy(r.cmd.id.id, &thread_index, sizeof(thread_index));
+			memcpy(r.cmd.id.id + sizeof(thread_index), &i, sizeof(i));
+			r.cmd.cmd = DNET_CMD_READ_NEW;
+			r.cmd.backend_id = -1;
+			r.cmd.flags = DNET_FLAGS_NO_QUEUE_TIMEOUT | (nolock ? DNET_FLAGS_NOLOCK : 0);
+
+			free_list.push_back(&r.req);
+		}
+	}
+
+	dnet_work_pool pool;
+	dnet_work_io wio;
+	std::vector<request> requests;
+	std::vector<dnet_io_req *> free_list;
+};
+
+/*
+ * Shared by all benchmark threads. It is set up by the first thread before the start barrier
+ * and torn down by it after the stop barrier, since requests of one thread may end up
+ * in free list of another one or be left in the queue.
+ */
+struct fixture {
+	fixture(size_t threads, size_t depth, bool nolock)
+	: queue(false)
+	, st(static_cast<dnet_net_state *>(calloc(1, sizeof(dnet_net_state)))) {
+		for (size_t i = 0; i < threads; ++i) {
+			workers.emplace_back(new worker(depth, nolock, i, st));
+
+			auto &w = *workers.back();
+			for (size_t j = 0; j < depth; ++j) {
+				queue.push_request(w.free_list.back(), "bench");
+				w.free_list.pop_back();
+			}
+		}
+	}
+
+	~fixture() {
+		worker drain(0, false, -1, st);
+		while (queue.size()) {
+			auto r = queue.pop_request(&drain.wio, "bench");
+			if (r)
+				queue.release_request(r);
+		}
+		free(st);
+	}
+
+	dnet_request_queue queue;
+	dnet_net_state *st;
+	std::vector<std::unique_ptr<worker>> workers;
+};
+
+std::unique_ptr<fixture> shared;
+
+void BM_request_queue_push_pop(benchmark::State &state) {
+	const bool nolock = state.range(0) == without_lock;
+	const size_t depth = state.range(1);
+
+	if (state.thread_index() == 0)
+		shared.reset(new fixture(state.threads(), depth, nolock));
+
+	while (state.KeepRunning()) {
+		auto &w = *shared->workers[state.thread_index()];
+
+		shared->queue.push_request(w.free_list.back(), "bench");
+		w.free_list.pop_back();
+
+		auto r = shared->queue.pop_request(&w.wio, "bench");
+		if (r) {
+			shared->queue.release_request(r);
+			w.free_list.push_back(r);
+		}
+	}
+
+	if (state.thread_index() == 0)
+		shared.reset();
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+} /* namespace */
+
+BENCHMARK(BM_request_queue_push_pop)
+	->ArgNames({"nolock", "depth"})
+	->ArgsProduct({{with_lock, without_lock}, {1, 64, 1024}})
+	->ThreadRange(1, 16)
+	->UseRealTime();
+
+BENCHMARK_MAIN();
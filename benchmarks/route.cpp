@@ -0,0 +1,114 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of route lookup made for every request sent by client or forwarded by server:
+ * binary search of responsible route entry within group's sorted ids.
+ * Lookups are made under node's state_lock like dnet_state_get_first() does.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "library/elliptics.h"
+
+namespace {
+
+void generate_id(std::mt19937_64 &generator, unsigned char *id) {
+	for (size_t i = 0; i < DNET_ID_SIZE; i += sizeof(uint64_t)) {
+		const uint64_t value = generator();
+		memcpy(id + i, &value, sizeof(value));
+	}
+}
+
+/* route table of single group with @count entries */
+struct route_table {
+	explicit route_table(size_t count)
+	: ids(count) {
+		std::mt19937_64 generator(count);
+		for (auto &id : ids) {
+			generate_id(generator, id.raw.id);
+			id.idc = NULL;
+		}
+
+		std::sort(ids.begin(), ids.end(), [] (const dnet_state_id &lhs, const dnet_state_id &rhs) {
+			return dnet_id_cmp_str(lhs.raw.id, rhs.raw.id) < 0;
+		});
+
+		memset(&group, 0, sizeof(group));
+		group.group_id = 1;
+		group.id_num = ids.size();
+		group.ids = ids.data();
+		atomic_init(&group.refcnt, 1);
+
+		pthread_mutex_init(&state_lock, NULL);
+	}
+
+	~route_table() {
+		pthread_mutex_destroy(&state_lock);
+	}
+
+	std::vector<dnet_state_id> ids;
+	dnet_group group;
+	pthread_mutex_t state_lock;
+};
+
+route_table *shared;
+
+void BM_route_lookup(benchmark::State &state) {
+	if (state.thread_index() == 0)
+		shared = new route_table(state.range(0));
+
+	/* keys are generated in advance, so generator isn't measured */
+	std::mt19937_64 generator(state.thread_index());
+	std::vector<dnet_id> keys(1024);
+	for (auto &key : keys) {
+		memset(&key, 0, sizeof(key));
+		generate_id(generator, key.id);
+		key.group_id = 1;
+	}
+	size_t index = 0;
+
+	while (state.KeepRunning()) {
+		pthread_mutex_lock(&shared->state_lock);
+		benchmark::DoNotOptimize(__dnet_idc_search(&shared->group, &keys[index]));
+		pthread_mutex_unlock(&shared->state_lock);
+
+		if (++index == keys.size())
+			index = 0;
+	}
+
+	if (state.thread_index() == 0) {
+		delete shared;
+		shared = nullptr;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+/* from single backend with few ids up to large cluster where every backend has hundreds of ids */
+BENCHMARK(BM_route_lookup)->RangeMultiplier(8)->Range(8, 1 << 20)->ThreadRange(1, 8)->UseRealTime();
+
+} /* namespace */
+
+BENCHMARK_MAIN();
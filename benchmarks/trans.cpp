@@ -0,0 +1,135 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of transaction tree of the network state: search made for every received reply
+ * and insert/remove made for every sent request. All threads share single state and its trans_lock
+ * like net and io threads do.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "library/elliptics.h"
+
+namespace {
+
+struct fixture {
+	fixture(size_t count, size_t threads)
+	: st(static_cast<dnet_net_state *>(calloc(1, sizeof(dnet_net_state))))
+	, next_trans(0)
+	, per_thread(count / threads) {
+		pthread_mutex_init(&st->trans_lock, NULL);
+		st->trans_root = RB_ROOT;
+		st->timer_root = RB_ROOT;
+
+		/* transactions are not bound to the state, so insert doesn't log and destroy doesn't touch it */
+		for (size_t i = 0; i < per_thread * threads; ++i) {
+			auto t = static_cast<dnet_trans *>(calloc(1, sizeof(dnet_trans)));
+			atomic_init(&t->refcnt, 1);
+			INIT_LIST_HEAD(&t->trans_list_entry);
+			t->trans = next_trans++;
+			t->cmd.trans = t->trans;
+
+			dnet_trans_insert_nolock(st, t);
+			trans.push_back(t);
+		}
+	}
+
+	~fixture() {
+		for (auto t : trans) {
+			dnet_trans_remove_nolock(st, t);
+			free(t);
+		}
+		pthread_mutex_destroy(&st->trans_lock);
+		free(st);
+	}
+
+	dnet_net_state *st;
+	std::atomic<uint64_t> next_trans;
+	const size_t per_thread;
+	std::vector<dnet_trans *> trans;
+};
+
+std::unique_ptr<fixture> shared;
+
+void BM_trans_search(benchmark::State &state) {
+	if (state.thread_index() == 0)
+		shared.reset(new fixture(state.range(0), state.threads()));
+
+	const size_t count = shared->trans.size();
+	uint64_t trans = state.thread_index();
+
+	while (state.KeepRunning()) {
+		pthread_mutex_lock(&shared->st->trans_lock);
+		auto t = dnet_trans_search(shared->st, trans);
+		pthread_mutex_unlock(&shared->st->trans_lock);
+
+		/* drops reference taken by search, transaction stays alive */
+		dnet_trans_put(t);
+
+		trans += 7919;
+		if (trans >= count)
+			trans %= count;
+	}
+
+	if (state.thread_index() == 0)
+		shared.reset();
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_trans_search)->RangeMultiplier(16)->Range(1 << 6, 1 << 18)->ThreadRange(1, 8)->UseRealTime();
+
+/* every thread replaces its oldest transaction by new one keeping tree size constant */
+void BM_trans_insert_remove(benchmark::State &state) {
+	if (state.thread_index() == 0)
+		shared.reset(new fixture(state.range(0), state.threads()));
+
+	const size_t per_thread = shared->per_thread;
+	auto trans = &shared->trans[per_thread * state.thread_index()];
+	size_t index = 0;
+
+	while (state.KeepRunning()) {
+		auto t = trans[index];
+
+		pthread_mutex_lock(&shared->st->trans_lock);
+		dnet_trans_remove_nolock(shared->st, t);
+		t->trans = shared->next_trans++;
+		t->cmd.trans = t->trans;
+		dnet_trans_insert_nolock(shared->st, t);
+		pthread_mutex_unlock(&shared->st->trans_lock);
+
+		if (++index == per_thread)
+			index = 0;
+	}
+
+	if (state.thread_index() == 0)
+		shared.reset();
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_trans_insert_remove)->RangeMultiplier(16)->Range(1 << 6, 1 << 18)->ThreadRange(1, 8)->UseRealTime();
+
+} /* namespace */
+
+BENCHMARK_MAIN();
@@ -21,22 +21,44 @@
 #include "elliptics/newapi/result_entry.hpp"
 #include "elliptics/session.hpp"
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+#include <thread>
 
 namespace ioremap { namespace elliptics {
 
+/*
+ * Completion of async_result doesn't take the lock: async_result_handler::complete() is called once,
+ * after all process() calls, so it only publishes the result by switching @state to state_finished.
+ * Final handler is handed over through @state too: whoever comes second (connect() or complete())
+ * calls it outside of any lock. Waiters use the lock and condition variable only if result isn't ready yet.
+ * @lock still guards @results and @result_handler, since entries can be processed by several io threads.
+ */
 template <typename T>
 class async_result<T>::data
 {
 	public:
-		data() : total(0), finished(false)
+		enum {
+			state_pending,
+			// final handler is being set by connect()
+			state_connecting,
+			state_connected,
+			state_finished,
+		};
+
+		data() : total(0), state(state_pending), waiters(0)
 		{
 			dnet_current_time(&start);
 			dnet_empty_time(&end);
 		}
 
+		bool finished() const
+		{
+			return state.load(std::memory_order_acquire) == state_finished;
+		}
+
 		std::mutex lock;
 		std::condition_variable condition;
 
@@ -54,7 +76,8 @@ class async_result<T>::data
 		std::vector<dnet_cmd> statuses;
 		size_t total;
 
-		bool finished;
+		std::atomic_int state;
+		std::atomic_size_t waiters;
 		dnet_time start;
 		dnet_time end;
 };
@@ -100,8 +123,8 @@ bool async_result<T>::is_valid() const
 template <typename T>
 void async_result<T>::connect(const result_function &result_handler, const final_function &final_handler)
 {
-	std::unique_lock<std::mutex> locker(m_data->lock);
 	if (result_handler) {
+		std::unique_lock<std::mutex> locker(m_data->lock);
 		m_data->result_handler = result_handler;
 		if (!m_data->results.empty()) {
 			for (auto it = m_data->results.begin(), end = m_data->results.end(); it != end; ++it) {
@@ -109,11 +132,34 @@ void async_result<T>::connect(const result_function &result_handler, const final
 			}
 		}
 	}
-	if (final_handler) {
-		m_data->final_handler = final_handler;
-		if (m_data->finished)
-			final_handler(m_data->error);
+
+	if (!final_handler)
+		return;
+
+	int state = m_data->state.load(std::memory_order_acquire);
+	while (state != data::state_finished) {
+		// state_connecting means concurrent connect(), wait until it sets its handler
+		if (state == data::state_connecting) {
+			std::this_thread::yield();
+			state = m_data->state.load(std::memory_order_acquire);
+			continue;
+		}
+
+		if (m_data->state.compare_exchange_weak(state, data::state_connecting, std::memory_order_acq_rel)) {
+			m_data->final_handler = final_handler;
+
+			state = data::state_connecting;
+			if (m_data->state.compare_exchange_strong(state, data::state_connected,
+			                                          std::memory_order_acq_rel)) {
+				// complete() will call the handler
+				return;
+			}
+			// complete() has been called while the handler was being set
+			break;
+		}
 	}
+
+	final_handler(m_data->error);
 }
 
 template <typename T>
@@ -127,8 +173,10 @@ void async_result<T>::connect(const result_array_function &handler)
 template <typename T>
 void async_result<T>::connect(const async_result_handler<T> &handler)
 {
-	connect(std::bind(handler_process, handler, std::placeholders::_1),
-		std::bind(handler_complete, handler, std::placeholders::_1));
+	// lambdas keep only handler's shared pointer, so they fit into std::function without allocation
+	async_result_handler<T> copy(handler);
+	connect([copy] (const T &result) mutable { copy.process(result); },
+		[copy] (const error_info &error) mutable { copy.complete(error); });
 }
 
 template <typename T>
@@ -146,7 +194,7 @@ error_info async_result<T>::error() const
 template <typename T>
 bool async_result<T>::ready() const
 {
-	return m_data->finished;
+	return m_data->finished();
 }
 
 template <typename T>
@@ -243,8 +291,10 @@ async_result<T>::iterator::iterator(async_result &result) : d(std::make_shared<d
 {
 	d->finished = false;
 	d->policy = result.m_data->policy;
-	result.connect(std::bind(process, d, std::placeholders::_1),
-	std::bind(complete, d, std::placeholders::_1));
+
+	std::weak_ptr<data> weak_data = d;
+	result.connect([weak_data] (const T &result) { process(weak_data, result); },
+		[weak_data] (const error_info &error) { complete(weak_data, error); });
 }
 
 template <typename T>
@@ -381,9 +431,17 @@ struct async_result<T>::data_keeper
 template <typename T>
 void async_result<T>::wait(uint32_t policy)
 {
-	std::unique_lock<std::mutex> locker(m_data->lock);
-	while (!m_data->finished)
-		m_data->condition.wait(locker);
+	if (!m_data->finished()) {
+		// @waiters tells complete() to notify condition, see it for pairing
+		++m_data->waiters;
+		{
+			std::unique_lock<std::mutex> locker(m_data->lock);
+			while (!m_data->finished())
+				m_data->condition.wait(locker);
+		}
+		--m_data->waiters;
+	}
+
 	if (m_data->policy & policy)
 		m_data->error.throw_error();
 }
@@ -396,18 +454,6 @@ void async_result<T>::aggregator_final_handler(const std::shared_ptr<data_keeper
 	handler(d->results, d->error);
 }
 
-template <typename T>
-void async_result<T>::handler_process(async_result_handler<T> handler, const T &result)
-{
-	handler.process(result);
-}
-
-template <typename T>
-void async_result<T>::handler_complete(async_result_handler<T> handler, const error_info &error)
-{
-	handler.complete(error);
-}
-
 template <typename T>
 async_result_handler<T>::async_result_handler(const async_result<T> &result)
 	: m_data(result.m_data)
@@ -463,18 +509,29 @@ void async_result_handler<T>::process(const T &result)
 template <typename T>
 void async_result_handler<T>::complete(const error_info &error)
 {
-	std::unique_lock<std::mutex> locker(m_data->lock);
-	m_data->finished = true;
 	dnet_current_time(&m_data->end);
 	m_data->error = error;
 	if (!error) {
 		if (!check(&m_data->error))
 			m_data->error_handler(m_data->error, m_data->statuses);
 	}
-	if (m_data->final_handler) {
+
+	const int state = m_data->state.exchange(data::state_finished);
+	if (state == data::state_connected) {
 		m_data->final_handler(m_data->error);
 	}
-	m_data->condition.notify_all();
+
+	/*
+	 * Both @state and @waiters are sequentially consistent: either waiter sees finished state
+	 * or it is counted here. Empty critical section guarantees that counted waiter is already
+	 * waiting for the condition or will see finished state under the lock.
+	 */
+	if (m_data->waiters.load()) {
+		{
+			std::lock_guard<std::mutex> locker(m_data->lock);
+		}
+		m_data->condition.notify_all();
+	}
 }
 
 template <typename T>
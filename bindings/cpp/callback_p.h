@@ -31,6 +31,8 @@
 
 #include "elliptics/async_result_cast.hpp"
 
+#include "library/elliptics.h"
+
 namespace ioremap { namespace elliptics {
 
 class session_scope
@@ -73,12 +75,19 @@ class callback_result_data
 		callback_result_data(const dnet_addr *addr, const dnet_cmd *cmd)
 		{
 			const size_t size = sizeof(dnet_addr) + sizeof(dnet_cmd) + cmd->size;
-			data = data_pointer::allocate(size);
+
+			// reply received from network is shared with the request, only sender's address is filled in
+			if (dnet_io_req *r = dnet_io_req_get_current_reply(cmd)) {
+				data = data_pointer::share(r, sizeof(dnet_io_req) + size).skip<dnet_io_req>();
+			} else {
+				data = data_pointer::allocate(size);
+				memcpy(data.data<char>() + sizeof(dnet_addr), cmd, sizeof(dnet_cmd) + cmd->size);
+			}
+
 			if (addr)
 				memcpy(data.data(), addr, sizeof(dnet_addr));
 			else
 				memset(data.data(), 0, sizeof(dnet_addr));
-			memcpy(data.data<char>() + sizeof(dnet_addr), cmd, sizeof(dnet_cmd) + cmd->size);
 		}
 
 		virtual ~callback_result_data()
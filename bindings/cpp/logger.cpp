@@ -18,6 +18,8 @@
 #include "example/config.hpp"
 #include "elliptics/session.hpp"
 
+__thread int dnet_logger_trace_bit = 0;
+
 namespace ioremap { namespace elliptics {
 
 namespace attributes {
@@ -34,10 +36,12 @@ public:
 	static void pop() {
 		if (!m_stack.empty())
 			m_stack.pop();
+		dnet_logger_trace_bit = bit();
 	}
 
 	static void push(uint64_t id, bool bit) {
 		m_stack.push({id, bit});
+		dnet_logger_trace_bit = bit;
 	}
 
 private:
@@ -69,7 +73,7 @@ static ssize_t &backend_id() {
 } /* namespace attributes */
 
 bool log_filter(const int severity, const int level) {
-	return attributes::trace::bit() || severity >= level;
+	return dnet_logger_trace_bit || severity >= level;
 }
 
 static std::unique_ptr<dnet_logger> make_logger(const std::string &path, dnet_log_level level, bool watched) {
@@ -195,6 +195,12 @@ void bulk_remove_handler::process(const remove_result_entry &entry) {
 }
 
 void bulk_remove_handler::complete(const error_info &error) {
+	for (const auto &key : keys_) {
+		dnet_raw_id id;
+		memcpy(id.id, key.first.id, DNET_ID_SIZE);
+		dnet_read_cache_invalidate(session_.get_native_node(), id);
+	}
+
 	handler_.complete(error);
 
 	if (context_) {
@@ -216,17 +222,26 @@ void bulk_remove_handler::complete(const error_info &error) {
 std::map<dnet_addr, keys_ts> split_keys_to_nodes(session &session, const keys_ts &keys,
                                                  err_callback callback) {
 	std::map<dnet_addr, std::vector<std::pair<dnet_id, dnet_time>>>  remote_ids;
-	dnet_addr address;
-	memset(&address, 0, sizeof(address));
 
+	std::vector<dnet_id> ids;
+	ids.reserve(keys.size());
 	for (const auto &id : keys) {
-		const int err = dnet_lookup_addr(session.get_native(), nullptr, 0, &id.first, id.first.group_id,
-		                                 &address, nullptr);
+		ids.emplace_back(id.first);
+	}
+
+	std::vector<dnet_addr> addresses(ids.size());
+	std::vector<int> errors(ids.size());
+	const int err = dnet_lookup_addr_batch(session.get_native(), ids.data(), ids.size(),
+	                                       addresses.data(), nullptr, errors.data());
+	if (err) {
+		errors.assign(ids.size(), err);
+	}
 
-		if (!err) {
-			remote_ids[address].emplace_back(id);
+	for (size_t i = 0; i < keys.size(); ++i) {
+		if (!errors[i]) {
+			remote_ids[addresses[i]].emplace_back(keys[i]);
 		} else {
-			callback(id.first, err);
+			callback(keys[i].first, errors[i]);
 		}
 	}
 	return remote_ids;
@@ -0,0 +1,278 @@
+#include "bulk_write_handler.h"
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include <blackhole/attribute.hpp>
+
+#include "bindings/cpp/callback_p.h"
+#include "bindings/cpp/node_p.hpp"
+
+#include "library/access_context.h"
+#include "library/elliptics.h"
+#include "library/common.hpp"
+
+#include "bindings/cpp/functional_p.h"
+
+
+namespace ioremap { namespace elliptics { namespace newapi {
+
+/* Builds DNET_CMD_BULK_WRITE_NEW packet of @entries pointed by @indexes: header followed by json and data of
+ * every record.
+ */
+static data_pointer make_bulk_write_packet(const std::vector<bulk_write_entry> &entries,
+                                           const std::vector<size_t> &indexes,
+                                           const dnet_time &deadline,
+                                           dnet_bulk_write_request &request) {
+	request.keys.reserve(indexes.size());
+	request.requests.reserve(indexes.size());
+	request.deadline = deadline;
+
+	size_t payload_size = 0;
+	for (const auto index : indexes) {
+		const auto &entry = entries[index];
+		request.keys.emplace_back(entry.key);
+		request.requests.emplace_back(entry.request);
+		request.requests.back().json_size = entry.json.size();
+		request.requests.back().data_size = entry.data.size();
+		payload_size += entry.json.size() + entry.data.size();
+	}
+
+	const auto header = serialize(request);
+
+	auto packet = data_pointer::allocate(header.size() + payload_size);
+	memcpy(packet.data(), header.data(), header.size());
+
+	size_t offset = header.size();
+	for (const auto index : indexes) {
+		const auto &entry = entries[index];
+		if (!entry.json.empty())
+			memcpy(packet.skip(offset).data(), entry.json.data(), entry.json.size());
+		offset += entry.json.size();
+		if (!entry.data.empty())
+			memcpy(packet.skip(offset).data(), entry.data.data(), entry.data.size());
+		offset += entry.data.size();
+	}
+	return packet;
+}
+
+void single_bulk_write_handler::start(const transport_control &control, const dnet_bulk_write_request &request) {
+	DNET_LOG_NOTICE(log_, "{}: started: address: {}, num_keys: {}",
+	                dnet_cmd_string(control.get_native().cmd), dnet_addr_string(&address_),
+	                request.keys.size());
+
+	keys_.assign(request.keys.begin(), request.keys.end());
+	std::sort(keys_.begin(), keys_.end());
+	key_responses_.resize(keys_.size(), false);
+
+	auto rr = async_result_cast<write_result_entry>(session_, send_to_single_state(session_, control));
+	handler_.set_total(rr.total());
+
+	rr.connect(
+		std::bind(&single_bulk_write_handler::process, shared_from_this(), std::placeholders::_1),
+		std::bind(&single_bulk_write_handler::complete, shared_from_this(), std::placeholders::_1)
+	);
+}
+
+void single_bulk_write_handler::process(const write_result_entry &entry) {
+	dnet_cmd *cmd = entry.command();
+	if (!entry.is_valid()) {
+		DNET_LOG_ERROR(log_, "{}: {}: process: invalid response, status: {}",
+		               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), cmd->status);
+		return;
+	}
+
+	// mark responded key, the same key may be written several times by the request
+	bool found = false;
+	for (auto it = std::lower_bound(keys_.begin(), keys_.end(), cmd->id); it != keys_.end(); ++it) {
+		if (dnet_id_cmp(&cmd->id, &*it) != 0)
+			break;
+
+		const auto index = std::distance(keys_.begin(), it);
+		if (key_responses_[index])
+			continue;
+
+		handler_.process(entry);
+		key_responses_[index] = true;
+		found = true;
+		break;
+	}
+
+	if (!found) {
+		DNET_LOG_ERROR(log_, "{}: {}: process: unknown key, status: {}",
+		               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), cmd->status);
+	}
+	last_error_ = cmd->status;
+}
+
+void single_bulk_write_handler::complete(const error_info &error) {
+	// process all non-responded keys, they are failed even if the rest of keys were written
+	dnet_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.status = error ? error.code() : (last_error_ ? last_error_ : -ETIMEDOUT);
+	cmd.cmd = DNET_CMD_BULK_WRITE_NEW;
+	cmd.trace_id = session_.get_trace_id();
+	cmd.flags = DNET_FLAGS_REPLY | DNET_FLAGS_MORE |
+		    (session_.get_trace_bit() ? DNET_FLAGS_TRACE_BIT : 0);
+
+	for (size_t i = 0; i < keys_.size(); ++i) {
+		if (key_responses_[i])
+			continue;
+		DNET_LOG_ERROR(log_, "{}: did not get response for key: {}",
+		               dnet_cmd_string(DNET_CMD_BULK_WRITE_NEW), dnet_dump_id(&keys_[i]));
+		cmd.id = keys_[i];
+		auto result_data = std::make_shared<ioremap::elliptics::callback_result_data>(&address_, &cmd);
+		result_data->error = error ? error :
+			create_error(cmd.status, "send_bulk_write: write failed for key: %s",
+			             dnet_dump_id(&keys_[i]));
+		ioremap::elliptics::callback_result_entry entry(result_data);
+		handler_.process(callback_cast<write_result_entry>(entry));
+	}
+
+	// finish
+	handler_.complete(error);
+	DNET_LOG_NOTICE(log_, "{}: finished: address: {}",
+	                dnet_cmd_string(DNET_CMD_BULK_WRITE_NEW), dnet_addr_string(&address_));
+}
+
+void bulk_write_handler::start(const std::vector<bulk_write_entry> &entries) {
+	DNET_LOG_INFO(log_, "{}: started: keys: {}",
+	              dnet_cmd_string(DNET_CMD_BULK_WRITE_NEW), entries.size());
+
+	keys_.reserve(entries.size());
+	for (const auto &entry : entries) {
+		keys_.emplace_back(entry.key);
+	}
+
+	context_.reset(new dnet_access_context(session_.get_native_node()));
+	if (context_) {
+		context_->add({{"cmd", std::string(dnet_cmd_string(DNET_CMD_BULK_WRITE_NEW))},
+		                {"access", "client"},
+		                {"cflags", std::string(dnet_flags_dump_cflags(session_.get_cflags()))},
+		                {"keys", keys_.size()},
+		                {"trace_id", to_hex_string(session_.get_trace_id())},
+		               });
+	}
+	if (keys_.empty()) {
+		handler_.complete(create_error(-ENXIO, "send_bulk_write: keys list is empty"));
+		return;
+	}
+
+	// group records
+	std::map<dnet_addr, std::vector<size_t>> remote_entries; // node_address -> [list of indexes of entries]
+	const bool has_direct_address = !!(session_.get_cflags() & (DNET_FLAGS_DIRECT | DNET_FLAGS_DIRECT_BACKEND));
+
+	if (!has_direct_address) {
+		const auto &ids = keys_;
+		std::vector<dnet_addr> addresses(ids.size());
+		std::vector<int> errors(ids.size());
+		const int err = dnet_lookup_addr_batch(session_.get_native(), ids.data(), ids.size(),
+		                                       addresses.data(), nullptr, errors.data());
+		if (err) {
+			errors.assign(ids.size(), err);
+		}
+
+		for (size_t i = 0; i < ids.size(); ++i) {
+			if (!errors[i]) {
+				remote_entries[addresses[i]].emplace_back(i);
+				continue;
+			}
+
+			dnet_addr address;
+			memset(&address, 0, sizeof(address));
+			dnet_cmd cmd;
+			memset(&cmd, 0, sizeof(cmd));
+			cmd.cmd = DNET_CMD_BULK_WRITE_NEW;
+			cmd.trace_id = session_.get_trace_id();
+			cmd.flags = DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+			if (session_.get_trace_bit())
+				cmd.flags |= DNET_FLAGS_TRACE_BIT;
+
+			cmd.id = ids[i];
+			cmd.status = errors[i];
+			auto result_data = std::make_shared<callback_result_data>(&address, &cmd);
+			result_data->error = create_error(errors[i],
+			                                  "bulk_write_handler: could not locate address & "
+			                                  "backend for requested key: %s",
+			                                  dnet_dump_id(&ids[i]));
+			ioremap::elliptics::callback_result_entry entry(result_data);
+			process(callback_cast<write_result_entry>(entry));
+		}
+	} else {
+		const auto address = session_.get_direct_address();
+		auto &indexes = remote_entries[address.to_raw()];
+		indexes.reserve(entries.size());
+		for (size_t i = 0; i < entries.size(); ++i) {
+			indexes.emplace_back(i);
+		}
+	}
+
+	dnet_time deadline;
+	dnet_current_time(&deadline);
+	deadline.tsec += session_.get_timeout();
+
+	std::vector<async_write_result> results;
+	results.reserve(remote_entries.size());
+
+	for (const auto &pair : remote_entries) {
+		const dnet_addr &address = pair.first;
+		dnet_bulk_write_request request;
+		const auto packet = make_bulk_write_packet(entries, pair.second, deadline, request);
+
+		transport_control control;
+		control.set_command(DNET_CMD_BULK_WRITE_NEW);
+		control.set_cflags(session_.get_cflags() | DNET_FLAGS_NEED_ACK);
+		control.set_data(packet.data(), packet.size());
+
+		auto session = session_.clean_clone();
+		if (!has_direct_address)
+			session.set_direct_id(address);
+
+		results.emplace_back(session);
+		auto handler = std::make_shared<single_bulk_write_handler>(results.back(), session, address);
+		handler->start(control, request);
+	}
+
+	auto rr = aggregated(session_, results);
+	handler_.set_total(rr.total());
+
+	rr.connect(
+		std::bind(&bulk_write_handler::process, shared_from_this(), std::placeholders::_1),
+		std::bind(&bulk_write_handler::complete, shared_from_this(), std::placeholders::_1)
+	);
+}
+
+void bulk_write_handler::process(const write_result_entry &entry) {
+	handler_.process(entry);
+
+	const auto *cmd = entry.command();
+	transes_.emplace(cmd->trans);
+	++statuses_[entry.status()];
+}
+
+void bulk_write_handler::complete(const error_info &error) {
+	for (const auto &key : keys_) {
+		dnet_raw_id id;
+		memcpy(id.id, key.id, DNET_ID_SIZE);
+		dnet_read_cache_invalidate(session_.get_native_node(), id);
+	}
+
+	handler_.complete(error);
+
+	if (context_) {
+		context_->add({{"transes", [&] {
+					std::ostringstream result;
+					result << transes_;
+					return std::move(result.str());
+				}()},
+				{"statuses", [&] {
+					std::ostringstream result;
+					result << statuses_;
+					return std::move(result.str());
+				}()},
+			       });
+		context_.reset(); // destroy context to print access log
+	}
+}
+
+} } } // namespace ioremap::elliptics::newapi
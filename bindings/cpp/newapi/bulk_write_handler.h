@@ -0,0 +1,68 @@
+#pragma once
+
+#include "elliptics/newapi/session.hpp"
+#include "elliptics/async_result_cast.hpp"
+
+#include "bindings/cpp/session_internals.hpp"
+#include "library/protocol.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ioremap { namespace elliptics { namespace newapi {
+
+class single_bulk_write_handler : public std::enable_shared_from_this<single_bulk_write_handler> {
+public:
+	single_bulk_write_handler(const async_write_result &result,
+	                          const session &session,
+	                          const dnet_addr &address)
+	: address_(address)
+	, session_(session.clean_clone())
+	, handler_(result)
+	, log_(session.get_logger())
+	{}
+
+	void start(const transport_control &control, const dnet_bulk_write_request &request);
+
+private:
+	void process(const write_result_entry &entry);
+	void complete(const error_info &error);
+
+private:
+	std::vector<dnet_id> keys_; // stores original keys from request
+	const dnet_addr address_;
+	session session_;
+	async_result_handler<write_result_entry> handler_;
+	std::unique_ptr<dnet_logger> log_;
+	std::vector<bool> key_responses_;
+	int last_error_{0};
+};
+
+class bulk_write_handler : public std::enable_shared_from_this<bulk_write_handler> {
+public:
+	bulk_write_handler(const async_write_result &result,
+	                   const session &session)
+	: session_(session.clean_clone())
+	, handler_(result)
+	, log_(session.get_logger())
+	{}
+
+	// json and data of @entries are copied into requests, so they may be released once start() returns
+	void start(const std::vector<bulk_write_entry> &entries);
+
+private:
+	void process(const write_result_entry &entry);
+	void complete(const error_info &error);
+
+private:
+	std::vector<dnet_id> keys_;
+	session session_;
+	async_result_handler<write_result_entry> handler_;
+	std::unique_ptr<dnet_logger> log_;
+
+	std::unordered_set<uint64_t> transes_;
+	std::unordered_map<int, size_t> statuses_;
+	std::unique_ptr<dnet_access_context> context_;
+};
+
+}}} // namespace ioremap::elliptics::newapi
@@ -0,0 +1,1218 @@
+#include "elliptics/newapi/dc_recovery.hpp"
+#include "elliptics/newapi/session.hpp"
+
+#include "library/elliptics.h"
+#include "library/logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fcntl.h>
+#include <mutex>
+
+#include <msgpack.hpp>
+
+/* size of buffer by which key data files are read and written */
+#define KEY_DATA_BUFFER_SIZE (1024 * 1024)
+/* keys of bucket are sorted by physical position within chunks of this number of keys */
+#define BUCKET_SORT_KEYS (256 * 1024)
+
+namespace ioremap { namespace elliptics { namespace newapi {
+
+namespace {
+
+/* replica of the key in format of recovery's KeyInfo */
+struct key_info {
+	std::string host;
+	int port;
+	int family;
+	int group_id;
+	dnet_time timestamp;
+	uint64_t size;
+	uint64_t user_flags;
+	uint64_t record_flags;
+	uint64_t data_offset;
+	uint64_t blob_id;
+};
+
+struct key_data {
+	dnet_raw_id id;
+	std::vector<key_info> infos;
+};
+
+/* counters of recovering one key, see recovery's RecoverStat */
+struct recover_stat {
+	uint64_t skipped = 0;
+	uint64_t read = 0;
+	uint64_t read_failed = 0;
+	uint64_t read_bytes = 0;
+	uint64_t write = 0;
+	uint64_t write_failed = 0;
+	uint64_t write_retries = 0;
+	uint64_t written_bytes = 0;
+	uint64_t remove = 0;
+	uint64_t remove_failed = 0;
+	uint64_t remove_retries = 0;
+	uint64_t skip_write_to_ro_group = 0;
+	uint64_t skip_remove_corrupted_key_from_ro_group = 0;
+};
+
+bool same_meta(const key_info &lhs, const key_info &rhs) {
+	return !dnet_time_cmp(&lhs.timestamp, &rhs.timestamp) &&
+	       lhs.size == rhs.size &&
+	       lhs.user_flags == rhs.user_flags;
+}
+
+std::string key_str(const dnet_raw_id &id) {
+	char buffer[2 * DNET_ID_SIZE + 1];
+	return dnet_dump_id_len_raw(id.id, DNET_ID_SIZE, buffer);
+}
+
+struct raw_id_less {
+	bool operator()(const dnet_raw_id &lhs, const dnet_raw_id &rhs) const {
+		return dnet_id_cmp_str(lhs.id, rhs.id) < 0;
+	}
+};
+
+void unpack_key_data(const msgpack::object &o, key_data &key) {
+	if (o.type != msgpack::type::ARRAY || o.via.array.size != 2)
+		throw msgpack::type_error();
+
+	const msgpack::object *p = o.via.array.ptr;
+	memset(&key.id, 0, sizeof(key.id));
+	if (p[0].type == msgpack::type::ARRAY) {
+		/* python's dump_key_data() packs list of id's bytes */
+		if (p[0].via.array.size != DNET_ID_SIZE)
+			throw msgpack::type_error();
+		for (size_t i = 0; i < DNET_ID_SIZE; ++i)
+			key.id.id[i] = p[0].via.array.ptr[i].as<unsigned int>();
+	} else {
+		const auto id = p[0].as<std::string>();
+		if (id.size() != DNET_ID_SIZE)
+			throw msgpack::type_error();
+		memcpy(key.id.id, id.data(), DNET_ID_SIZE);
+	}
+
+	if (p[1].type != msgpack::type::ARRAY)
+		throw msgpack::type_error();
+
+	key.infos.clear();
+	key.infos.reserve(p[1].via.array.size);
+	for (size_t i = 0; i < p[1].via.array.size; ++i) {
+		const msgpack::object &info = p[1].via.array.ptr[i];
+		if (info.type != msgpack::type::ARRAY || info.via.array.size != 8)
+			throw msgpack::type_error();
+
+		const msgpack::object *f = info.via.array.ptr;
+		if (f[0].type != msgpack::type::ARRAY || f[0].via.array.size != 3 ||
+		    f[2].type != msgpack::type::ARRAY || f[2].via.array.size != 2)
+			throw msgpack::type_error();
+
+		key_info item;
+		f[0].via.array.ptr[0].convert(&item.host);
+		f[0].via.array.ptr[1].convert(&item.port);
+		f[0].via.array.ptr[2].convert(&item.family);
+		f[1].convert(&item.group_id);
+		f[2].via.array.ptr[0].convert(&item.timestamp.tsec);
+		f[2].via.array.ptr[1].convert(&item.timestamp.tnsec);
+		f[3].convert(&item.size);
+		f[4].convert(&item.user_flags);
+		f[5].convert(&item.record_flags);
+		f[6].convert(&item.data_offset);
+		f[7].convert(&item.blob_id);
+		key.infos.emplace_back(std::move(item));
+	}
+}
+
+/* sequentially reads keys from file written by recovery's dump_key_data() */
+class key_data_reader {
+public:
+	explicit key_data_reader(const std::string &filename)
+	: m_filename(filename) {
+		m_fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (m_fd == -1)
+			throw_error(-errno, "failed to open key data file: %s", filename.c_str());
+	}
+
+	~key_data_reader() {
+		close(m_fd);
+	}
+
+	bool next(key_data &key) {
+		msgpack::unpacked msg;
+		while (!m_unpacker.next(&msg)) {
+			m_unpacker.reserve_buffer(KEY_DATA_BUFFER_SIZE);
+			const ssize_t size = read(m_fd, m_unpacker.buffer(), m_unpacker.buffer_capacity());
+			if (size < 0) {
+				if (errno == EINTR)
+					continue;
+				throw_error(-errno, "failed to read key data file: %s", m_filename.c_str());
+			}
+			if (size == 0) {
+				if (m_unpacker.nonparsed_size())
+					throw_error(-EINVAL, "key data file: %s is truncated", m_filename.c_str());
+				return false;
+			}
+			m_unpacker.buffer_consumed(size);
+		}
+
+		try {
+			unpack_key_data(msg.get(), key);
+		} catch (const msgpack::type_error &) {
+			throw_error(-EINVAL, "key data file: %s contains malformed key", m_filename.c_str());
+		}
+		return true;
+	}
+
+private:
+	std::string m_filename;
+	int m_fd;
+	msgpack::unpacker m_unpacker;
+};
+
+/* appends keys to file in format of recovery's dump_key_data() */
+class key_data_writer {
+public:
+	explicit key_data_writer(const std::string &filename)
+	: m_filename(filename)
+	, m_packer(m_buffer) {
+		m_fd = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+		if (m_fd == -1)
+			throw_error(-errno, "failed to open key data file: %s", filename.c_str());
+	}
+
+	~key_data_writer() {
+		try {
+			flush();
+		} catch (...) {
+		}
+		close(m_fd);
+	}
+
+	void write(const key_data &key) {
+		m_packer.pack_array(2);
+		m_packer.pack_array(DNET_ID_SIZE);
+		for (size_t i = 0; i < DNET_ID_SIZE; ++i)
+			m_packer.pack(static_cast<unsigned int>(key.id.id[i]));
+
+		m_packer.pack_array(key.infos.size());
+		for (const auto &info : key.infos) {
+			m_packer.pack_array(8);
+			m_packer.pack_array(3);
+			m_packer.pack(info.host);
+			m_packer.pack(info.port);
+			m_packer.pack(info.family);
+			m_packer.pack(info.group_id);
+			m_packer.pack_array(2);
+			m_packer.pack(info.timestamp.tsec);
+			m_packer.pack(info.timestamp.tnsec);
+			m_packer.pack(info.size);
+			m_packer.pack(info.user_flags);
+			m_packer.pack(info.record_flags);
+			m_packer.pack(info.data_offset);
+			m_packer.pack(info.blob_id);
+		}
+
+		if (m_buffer.size() >= KEY_DATA_BUFFER_SIZE)
+			flush();
+	}
+
+	void flush() {
+		const char *data = m_buffer.data();
+		size_t size = m_buffer.size();
+		while (size) {
+			const ssize_t written = ::write(m_fd, data, size);
+			if (written < 0) {
+				if (errno == EINTR)
+					continue;
+				throw_error(-errno, "failed to write key data file: %s", m_filename.c_str());
+			}
+			data += written;
+			size -= written;
+		}
+		m_buffer.clear();
+	}
+
+	void truncate() {
+		m_buffer.clear();
+		if (ftruncate(m_fd, 0))
+			throw_error(-errno, "failed to truncate key data file: %s", m_filename.c_str());
+	}
+
+private:
+	std::string m_filename;
+	int m_fd;
+	msgpack::sbuffer m_buffer;
+	msgpack::packer<msgpack::sbuffer> m_packer;
+};
+
+} /* unnamed namespace */
+
+class dc_recovery_data {
+public:
+	dc_recovery_data(const node &node, const dc_recovery_config &config)
+	: m_node(node)
+	, m_config(config)
+	, m_log(node.get_logger())
+	, m_result(true) {
+		std::sort(m_config.groups.begin(), m_config.groups.end());
+	}
+
+	bool recover();
+
+	/* adds @value to counter @name of @counters, see python's stat.counter() */
+	void counter(std::map<std::string, int64_t> &counters, const std::string &name, int64_t value) {
+		std::lock_guard<std::mutex> guard(m_lock);
+		counters[name] += value;
+	}
+
+	void failed() {
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_result = false;
+	}
+
+	void dump_corrupted_key(const dnet_raw_id &id, int group_id);
+
+	void on_key_complete(bool result, const recover_stat &stat);
+
+	std::string filename(const std::string &name) const {
+		return m_config.tmp_dir + "/" + name;
+	}
+
+	bool is_ro_group(int group_id) const {
+		return m_config.ro_groups.count(group_id) != 0;
+	}
+
+	session make_session() const {
+		session sess(m_node);
+		sess.set_trace_id(m_config.trace_id);
+		sess.set_exceptions_policy(session::no_exceptions);
+		return sess;
+	}
+
+	node m_node;
+	dc_recovery_config m_config;
+	std::unique_ptr<dnet_logger> m_log;
+
+	std::mutex m_lock;
+	std::condition_variable m_cond;
+	dc_recovery_stats m_stats;
+	bool m_result;
+
+	/* keys which can't be recovered by server_send, they are recovered by reading and writing them */
+	std::unique_ptr<key_data_writer> m_rest;
+
+private:
+	bool next_key(key_data_reader &reader, key_data &key, std::vector<int> &missed_groups);
+	void recover_rest_keys();
+};
+
+void dc_recovery_data::dump_corrupted_key(const dnet_raw_id &id, int group_id) {
+	const std::string line = key_str(id) + " " + std::to_string(group_id) + "\n";
+
+	std::lock_guard<std::mutex> guard(m_lock);
+	const std::string name = filename("corrupted_keys");
+	int fd = open(name.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		DNET_LOG_ERROR(m_log, "Failed to open {}: {}", name, strerror(errno));
+		return;
+	}
+	if (::write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size()))
+		DNET_LOG_ERROR(m_log, "Failed to write corrupted key: {} to {}", line, name);
+	close(fd);
+}
+
+void dc_recovery_data::on_key_complete(bool result, const recover_stat &stat) {
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	auto &stats = m_stats.recover;
+	auto apply = [&stats] (const char *name, int64_t value) {
+		if (value)
+			stats[name] += value;
+	};
+	apply("skipped_keys", stat.skipped);
+	apply("local_reads", stat.read);
+	apply("local_reads", -static_cast<int64_t>(stat.read_failed));
+	apply("local_read_bytes", stat.read_bytes);
+	apply("remote_writes", stat.write);
+	apply("remote_writes", -static_cast<int64_t>(stat.write_failed));
+	apply("remote_write_retries", stat.write_retries);
+	apply("remote_written_bytes", stat.written_bytes);
+	apply("local_removes", stat.remove);
+	apply("local_removes", -static_cast<int64_t>(stat.remove_failed));
+	apply("local_remove_retries", stat.remove_retries);
+	apply("skip_write_to_ro_group", stat.skip_write_to_ro_group);
+	apply("skip_remove_corrupted_key_from_ro_group", stat.skip_remove_corrupted_key_from_ro_group);
+
+	stats["recovered_keys"] += result ? 1 : -1;
+	m_stats.main["recovered_keys"] += result ? 1 : -1;
+
+	m_result &= result;
+	++m_stats.processed_keys;
+	--m_stats.recovers_in_progress;
+	m_cond.notify_all();
+}
+
+namespace {
+
+/*
+ * Recovers keys of bucket files by server_send, see recovery's ServerSendRecovery.
+ * Keys which can't be sent from one group are moved to the bucket of the next replica with the same meta
+ * or to rest_keys.
+ */
+class server_send_recovery {
+public:
+	explicit server_send_recovery(dc_recovery_data &data)
+	: m_data(data)
+	, m_session(data.make_session())
+	, m_remove_session(data.make_session())
+	, m_order(data.m_config.bucket_order)
+	, m_index(-1) {
+		m_remove_session.set_filter(filters::all_final);
+		m_remove_session.set_ioflags(m_remove_session.get_ioflags() | DNET_IO_FLAGS_CAS_TIMESTAMP);
+		m_remove_session.set_timestamp(data.m_config.prepare_timeout);
+
+		for (const int group_id : m_order)
+			get_bucket(group_id);
+	}
+
+	void recover() {
+		while (bucket *b = next_bucket()) {
+			b->writer->flush();
+
+			std::vector<key_data> keys;
+			key_data_reader reader(b->filename);
+			key_data key;
+			while (reader.next(key)) {
+				keys.emplace_back(std::move(key));
+				if (keys.size() >= BUCKET_SORT_KEYS)
+					process_chunk(keys, b->group_id);
+			}
+			if (!keys.empty())
+				process_chunk(keys, b->group_id);
+
+			b->writer->truncate();
+			b->empty = true;
+		}
+	}
+
+private:
+	struct bucket {
+		int group_id;
+		std::string filename;
+		std::unique_ptr<key_data_writer> writer;
+		bool empty;
+	};
+
+	bucket &get_bucket(int group_id) {
+		auto it = m_buckets.find(group_id);
+		if (it != m_buckets.end())
+			return it->second;
+
+		if (std::find(m_order.begin(), m_order.end(), group_id) == m_order.end())
+			m_order.push_back(group_id);
+
+		auto &b = m_buckets[group_id];
+		b.group_id = group_id;
+		b.filename = m_data.filename("bucket_" + std::to_string(group_id));
+		b.writer.reset(new key_data_writer(b.filename));
+		b.empty = false;
+		return b;
+	}
+
+	/* returns next nonempty bucket in round-robin manner */
+	bucket *next_bucket() {
+		for (size_t i = 0; i < m_order.size(); ++i) {
+			m_index = (m_index + 1) % m_order.size();
+			auto &b = get_bucket(m_order[m_index]);
+			if (!b.empty) {
+				DNET_LOG_INFO(m_data.m_log, "Get next bucket: index: {}, group_id: {}", m_index, b.group_id);
+				return &b;
+			}
+		}
+		return nullptr;
+	}
+
+	/* moves @key to the bucket of @next_group_id or to rest_keys if @next_group_id is negative */
+	void on_server_send_fail(const key_data &key, int next_group_id) {
+		if (next_group_id >= 0) {
+			auto &b = get_bucket(next_group_id);
+			b.writer->write(key);
+			b.empty = false;
+		} else {
+			DNET_LOG_INFO(m_data.m_log, "Moving key to rest keys bucket: {}", key_str(key.id));
+			m_data.m_rest->write(key);
+		}
+	}
+
+	/* replicas of @key starting from the replica of @group_id, previous ones were already tried */
+	static std::vector<key_info>::const_iterator unprocessed_infos(const key_data &key, int group_id) {
+		return std::find_if(key.infos.begin(), key.infos.end(), [group_id] (const key_info &info) {
+			return info.group_id == group_id;
+		});
+	}
+
+	static int next_group_id(const key_data &key, int group_id) {
+		auto it = unprocessed_infos(key, group_id);
+		if (it != key.infos.end() && std::next(it) != key.infos.end())
+			return std::next(it)->group_id;
+		return -1;
+	}
+
+	std::vector<int> dest_groups(const key_data &key) const {
+		std::set<int> groups(m_data.m_config.groups.begin(), m_data.m_config.groups.end());
+		for (const auto &info : key.infos)
+			groups.erase(info.group_id);
+
+		for (const auto &info : key.infos) {
+			if (!same_meta(info, key.infos.front()) || (info.record_flags & DNET_RECORD_FLAGS_CORRUPTED))
+				groups.insert(info.group_id);
+		}
+		return std::vector<int>(groups.begin(), groups.end());
+	}
+
+	void process_chunk(std::vector<key_data> &keys, int group_id) {
+		/* server_send reads keys in physical order of the source, so the blob is read sequentially */
+		auto position = [group_id] (const key_data &key) {
+			auto it = unprocessed_infos(key, group_id);
+			return it == key.infos.end() ? std::make_pair(uint64_t(0), uint64_t(0))
+			                             : std::make_pair(it->blob_id, it->data_offset);
+		};
+		std::stable_sort(keys.begin(), keys.end(), [&position] (const key_data &lhs, const key_data &rhs) {
+			return position(lhs) < position(rhs);
+		});
+
+		const size_t batch_size = std::max<size_t>(m_data.m_config.batch_size, 1);
+		for (size_t offset = 0; offset < keys.size(); offset += batch_size) {
+			const size_t end = std::min(keys.size(), offset + batch_size);
+			server_send(keys.begin() + offset, keys.begin() + end, group_id);
+		}
+		keys.clear();
+	}
+
+	typedef std::map<dnet_raw_id, const key_data *, raw_id_less> keys_map;
+
+	void server_send(std::vector<key_data>::const_iterator begin, std::vector<key_data>::const_iterator end,
+	                 int group_id) {
+		const auto &config = m_data.m_config;
+		DNET_LOG_INFO(m_data.m_log, "Server-send bucket: source group_id: {}, num keys: {}",
+		              group_id, std::distance(begin, end));
+
+		std::map<std::vector<int>, std::vector<const key_data *>> bunches;
+		for (auto it = begin; it != end; ++it)
+			bunches[dest_groups(*it)].push_back(&*it);
+
+		for (const auto &bunch : bunches) {
+			const auto &remote_groups = bunch.first;
+
+			std::vector<dnet_raw_id> keys;
+			keys_map infos;
+			uint64_t bunch_size = 0;
+			for (const auto key : bunch.second) {
+				keys.push_back(key->id);
+				infos.emplace(key->id, key);
+				auto it = unprocessed_infos(*key, group_id);
+				if (it != key->infos.end())
+					bunch_size += it->size;
+			}
+
+			m_session.set_timeout(std::max<uint64_t>(60, bunch_size / std::max<uint64_t>(config.data_flow_rate, 1)));
+
+			std::vector<dnet_raw_id> timeouted_keys;
+			for (int attempt = 0; attempt < config.attempts && !keys.empty(); ++attempt) {
+				m_data.counter(m_data.m_stats.recover, attempt == 0 ? "server_send" : "server_send_retry", 1);
+				if (attempt > 0)
+					m_data.counter(m_data.m_stats.main, "retry_recover_keys", timeouted_keys.size());
+
+				std::vector<int> dst_groups;
+				for (const int group : remote_groups) {
+					if (m_data.is_ro_group(group)) {
+						m_data.counter(m_data.m_stats.recover, "skip_server_send_to_ro_group", keys.size());
+						DNET_LOG_INFO(m_data.m_log, "Server-send: skip read-only group: {}", group);
+						continue;
+					}
+					dst_groups.push_back(group);
+				}
+				if (dst_groups.empty()) {
+					DNET_LOG_INFO(m_data.m_log, "Server-send: skip keys: {}, no writable groups left",
+					              keys.size());
+					break;
+				}
+
+				auto async = m_session.server_send(keys, 0, config.chunk_size, group_id, dst_groups,
+				                                   config.chunk_write_timeout, config.chunk_commit_timeout,
+				                                   std::max(config.attempts - 1, 0));
+				std::vector<dnet_raw_id> corrupted_keys;
+				timeouted_keys.clear();
+				check_results(async, infos, group_id, timeouted_keys, corrupted_keys);
+				keys = timeouted_keys;
+
+				if (!corrupted_keys.empty())
+					remove_corrupted_keys(corrupted_keys, group_id);
+			}
+
+			if (!timeouted_keys.empty())
+				on_server_send_timeout(timeouted_keys, infos, group_id);
+		}
+	}
+
+	void update_stats(int group_id, int status) {
+		if (status != -ETIMEDOUT) {
+			m_data.counter(m_data.m_stats.recover, "recovered_keys", status == 0 ? 1 : -1);
+			m_data.counter(m_data.m_stats.main, "recovered_keys", status == 0 ? 1 : -1);
+		}
+		if (status != 0) {
+			m_data.counter(m_data.m_stats.commands, "server_send." + std::to_string(status), 1);
+			m_data.counter(m_data.m_stats.commands_by_groups,
+			               "server_send." + std::to_string(group_id) + "." + std::to_string(status), 1);
+		}
+	}
+
+	void check_results(async_iterator_result &async, const keys_map &infos, int group_id,
+	                   std::vector<dnet_raw_id> &timeouted_keys, std::vector<dnet_raw_id> &corrupted_keys) {
+		std::set<dnet_raw_id, raw_id_less> succeeded_keys;
+		size_t processed = 0;
+
+		for (const auto &result : async) {
+			if (result.empty())
+				continue;
+
+			++processed;
+			const int status = result.status();
+			update_stats(group_id, status);
+
+			const auto id = result.key();
+			auto it = infos.find(id);
+			if (it == infos.end())
+				continue;
+
+			if (status < 0) {
+				on_key_fail(status, *it->second, group_id, timeouted_keys, corrupted_keys);
+			} else if (status == 0) {
+				succeeded_keys.insert(id);
+				DNET_LOG_INFO(m_data.m_log, "Success recovered key: {} from group: {}", key_str(id), group_id);
+			}
+		}
+
+		if (processed < infos.size()) {
+			DNET_LOG_ERROR(m_data.m_log, "Server-send operation failed: group_id: {}, received results: {}, "
+			               "expected: {}, error: {}", group_id, processed, infos.size(), async.error().message());
+			update_stats(group_id, async.error().code());
+
+			timeouted_keys.clear();
+			for (const auto &info : infos) {
+				if (!succeeded_keys.count(info.first))
+					timeouted_keys.push_back(info.first);
+			}
+		}
+	}
+
+	void on_key_fail(int status, const key_data &key, int group_id,
+	                 std::vector<dnet_raw_id> &timeouted_keys, std::vector<dnet_raw_id> &corrupted_keys) {
+		DNET_LOG_ERROR(m_data.m_log, "Failed to server-send key: {}, group_id: {}, error: {}",
+		               key_str(key.id), group_id, status);
+
+		if (status == -ENXIO) {
+			on_server_send_fail(key, -1);
+		} else if (status == -ETIMEDOUT) {
+			timeouted_keys.push_back(key.id);
+		} else {
+			const int next_group = next_group_id(key, group_id);
+			key_data next_key = key;
+			if (status == -EILSEQ || status == -ERANGE) {
+				corrupted_keys.push_back(key.id);
+				m_data.dump_corrupted_key(key.id, group_id);
+				/* corrupted replica's group becomes destination of next server_send */
+				next_key.infos.erase(std::remove_if(next_key.infos.begin(), next_key.infos.end(),
+				                                    [group_id] (const key_info &info) {
+					return info.group_id == group_id;
+				}), next_key.infos.end());
+			}
+			if (next_group >= 0) {
+				on_server_send_fail(next_key, next_group);
+			} else {
+				DNET_LOG_ERROR(m_data.m_log, "Key: {} is not recovered", key_str(key.id));
+				m_data.failed();
+			}
+		}
+	}
+
+	/*
+	 * Timeouted keys are moved to the next bucket only if its replica has the same meta, because older replica
+	 * should not be used for recovery due to temporary unavailability of the newest one.
+	 */
+	void on_server_send_timeout(const std::vector<dnet_raw_id> &keys, const keys_map &infos, int group_id) {
+		int64_t failed_keys = 0;
+		for (const auto &id : keys) {
+			const auto &key = *infos.at(id);
+			auto it = unprocessed_infos(key, group_id);
+			if (it != key.infos.end() && std::next(it) != key.infos.end() && same_meta(*it, *std::next(it))) {
+				on_server_send_fail(key, std::next(it)->group_id);
+				continue;
+			}
+			++failed_keys;
+			DNET_LOG_ERROR(m_data.m_log, "Key: {} is not recovered", key_str(id));
+		}
+
+		if (failed_keys > 0) {
+			m_data.failed();
+			m_data.counter(m_data.m_stats.recover, "recovered_keys", -failed_keys);
+			m_data.counter(m_data.m_stats.main, "recovered_keys", -failed_keys);
+		}
+	}
+
+	void remove_corrupted_keys(std::vector<dnet_raw_id> keys, int group_id) {
+		const auto &config = m_data.m_config;
+		if (config.safe)
+			return;
+
+		if (m_data.is_ro_group(group_id)) {
+			m_data.counter(m_data.m_stats.recover, "skip_remove_corrupted_key_from_ro_group", 1);
+			return;
+		}
+
+		m_remove_session.set_groups({group_id});
+
+		for (int attempt = 0; attempt < config.attempts && !keys.empty(); ++attempt) {
+			std::vector<async_remove_result> results;
+			for (const auto &id : keys)
+				results.emplace_back(m_remove_session.remove(id));
+
+			std::vector<dnet_raw_id> timeouted_keys;
+			for (size_t i = 0; i < results.size(); ++i) {
+				const auto entries = results[i].get();
+				const int status = entries.empty() ? results[i].error().code() : entries.front().status();
+				DNET_LOG_INFO(m_data.m_log, "Removed corrupted key: {}, status: {}, attempts: {}/{}",
+				              key_str(keys[i]), status, attempt, config.attempts);
+				if (status == 0)
+					m_data.counter(m_data.m_stats.recover, "removed_corrupted_keys", 1);
+				else if (status == -ETIMEDOUT || status == -ENXIO)
+					timeouted_keys.push_back(keys[i]);
+			}
+			keys.swap(timeouted_keys);
+		}
+	}
+
+	dc_recovery_data &m_data;
+	session m_session;
+	session m_remove_session;
+
+	std::map<int, bucket> m_buckets;
+	std::vector<int> m_order;
+	size_t m_index;
+};
+
+/*
+ * Recovers one key by reading it from the newest replica and writing it to missed and stale groups chunk by chunk,
+ * see recovery's KeyRecover. Each step is started from the completion callback of the previous one, the key
+ * reports its result to dc_recovery_data when all its operations including removal of corrupted replicas finish.
+ */
+class key_recover : public std::enable_shared_from_this<key_recover> {
+public:
+	key_recover(dc_recovery_data &data, key_data &&key, std::vector<int> &&missed_groups)
+	: m_data(data)
+	, m_key(std::move(key))
+	, m_missed_groups(std::move(missed_groups))
+	, m_read_session(data.make_session())
+	, m_write_session(data.make_session())
+	, m_remove_session(data.make_session())
+	, m_key_flags(0)
+	, m_total_size(0)
+	, m_recovered_size(0)
+	, m_chunked(false)
+	, m_json_capacity(0)
+	, m_attempt(0)
+	, m_pending(1)
+	, m_result(false) {
+		m_read_session.set_filter(filters::all);
+
+		m_write_session.set_checker(checkers::all);
+		m_write_session.set_ioflags(m_write_session.get_ioflags() | DNET_IO_FLAGS_CAS_TIMESTAMP);
+
+		m_remove_session.set_filter(filters::all_final);
+		m_remove_session.set_ioflags(m_remove_session.get_ioflags() | DNET_IO_FLAGS_CAS_TIMESTAMP);
+		m_remove_session.set_timestamp(data.m_config.prepare_timeout);
+	}
+
+	void start() {
+		guarded([this] () { run(); });
+	}
+
+private:
+	/* any exception stops recovery of the key instead of leaking into i/o thread */
+	template <typename Func>
+	void guarded(Func func) {
+		try {
+			func();
+		} catch (const std::exception &e) {
+			DNET_LOG_ERROR(m_data.m_log, "Failed to recover key: {}: {}", key_str(m_key.id), e.what());
+			stop(false);
+		}
+	}
+
+	void run() {
+		m_total_size = m_key.infos.front().size;
+		m_chunked = m_total_size > m_data.m_config.chunk_size;
+		m_recovered_size = 0;
+
+		const key_info newest = m_key.infos.front();
+		m_key_flags = newest.record_flags;
+
+		m_same_groups.clear();
+		std::vector<key_info> other_infos;
+		for (const auto &info : m_key.infos) {
+			if (same_meta(info, newest))
+				m_same_groups.push_back(info.group_id);
+			else
+				other_infos.push_back(info);
+		}
+		m_key.infos.swap(other_infos);
+
+		for (const auto &info : m_key.infos)
+			m_diff_groups.push_back(info.group_id);
+		std::set<int> diff_groups(m_diff_groups.begin(), m_diff_groups.end());
+		for (const int group : m_same_groups)
+			diff_groups.erase(group);
+		m_diff_groups.assign(diff_groups.begin(), diff_groups.end());
+
+		if (m_diff_groups.empty() && m_missed_groups.empty()) {
+			DNET_LOG_DEBUG(m_data.m_log, "Key: {} already up-to-date in all groups", key_str(m_key.id));
+			stop(false);
+			return;
+		}
+
+		m_read_session.set_groups(m_same_groups);
+
+		std::vector<int> groups_for_write;
+		for (const int group : dest_groups()) {
+			if (m_data.is_ro_group(group)) {
+				++m_stats.skip_write_to_ro_group;
+				continue;
+			}
+			groups_for_write.push_back(group);
+		}
+		m_write_session.set_groups(groups_for_write);
+
+		read();
+	}
+
+	std::vector<int> dest_groups() const {
+		std::vector<int> groups(m_diff_groups);
+		groups.insert(groups.end(), m_missed_groups.begin(), m_missed_groups.end());
+		return groups;
+	}
+
+	void read() {
+		uint64_t size = m_total_size;
+		if (m_chunked)
+			size = std::min(m_total_size - m_recovered_size, m_data.m_config.chunk_size);
+
+		/* checksum is verified only by the first chunk unless the record is checksummed by chunks */
+		if (m_recovered_size != 0) {
+			if (m_key_flags & DNET_RECORD_FLAGS_CHUNKED_CSUM)
+				m_read_session.set_ioflags(m_read_session.get_ioflags() & ~DNET_IO_FLAGS_NOCSUM);
+			else
+				m_read_session.set_ioflags(m_read_session.get_ioflags() | DNET_IO_FLAGS_NOCSUM);
+		} else {
+			m_read_session.set_ioflags(0);
+		}
+
+		DNET_LOG_DEBUG(m_data.m_log, "Reading key: {}, chunked: {}, offset: {}, size: {}, total_size: {}",
+		               key_str(m_key.id), m_chunked, m_recovered_size, size, m_total_size);
+
+		auto self = shared_from_this();
+		auto handler = [self] (const std::vector<read_result_entry> &results, const error_info &error) {
+			self->guarded([&] () { self->on_read(results, error); });
+		};
+		if (m_recovered_size == 0)
+			m_read_session.read(m_key.id, 0, size).connect(handler);
+		else
+			m_read_session.read_data(m_key.id, m_recovered_size, size).connect(handler);
+	}
+
+	void on_read(const std::vector<read_result_entry> &results, const error_info &error) {
+		const auto &config = m_data.m_config;
+
+		std::vector<int> corrupted_groups;
+		for (const auto &result : results) {
+			const int group_id = result.command()->id.group_id;
+			if (result.status())
+				m_data.counter(m_data.m_stats.commands_by_groups,
+				               "read." + std::to_string(group_id) + "." + std::to_string(result.status()), 1);
+
+			if (result.status() != -EILSEQ)
+				continue;
+
+			if (m_data.is_ro_group(group_id)) {
+				++m_stats.skip_remove_corrupted_key_from_ro_group;
+				continue;
+			}
+			corrupted_groups.push_back(group_id);
+		}
+
+		if (!corrupted_groups.empty()) {
+			++m_pending;
+			std::make_shared<key_remover>(shared_from_this(), corrupted_groups)->remove();
+		}
+
+		if (error) {
+			DNET_LOG_ERROR(m_data.m_log, "Failed to read key: {}: {}", key_str(m_key.id), error.message());
+			m_data.counter(m_data.m_stats.commands, "read." + std::to_string(error.code()), 1);
+			m_stats.read_failed += results.size();
+
+			if (error.code() == -ETIMEDOUT) {
+				if (m_attempt < config.attempts) {
+					++m_attempt;
+					m_read_session.set_timeout(m_read_session.get_timeout() * 2);
+					read();
+				} else {
+					DNET_LOG_ERROR(m_data.m_log, "Read of key: {} has been timed out {} times, skip it",
+					               key_str(m_key.id), m_attempt);
+					++m_stats.skipped;
+					stop(false);
+				}
+			} else if (m_key.infos.size() > 1) {
+				DNET_LOG_ERROR(m_data.m_log, "Try to recover key: {} from replicas in other groups",
+				               key_str(m_key.id));
+				const auto groups = m_read_session.get_groups();
+				m_diff_groups.insert(m_diff_groups.end(), groups.begin(), groups.end());
+				run();
+			} else {
+				DNET_LOG_ERROR(m_data.m_log, "Failed to read key: {} from any available group, skip it",
+				               key_str(m_key.id));
+				++m_stats.skipped;
+				stop(false);
+			}
+			return;
+		}
+
+		const auto &result = results.back();
+		m_stats.read_failed += results.size() - 1;
+		++m_stats.read;
+		m_stats.read_bytes += result.size();
+
+		if (m_recovered_size == 0) {
+			const auto info = result.record_info();
+			m_write_session.set_user_flags(info.user_flags);
+			m_write_session.set_timestamp(info.data_timestamp);
+			m_write_session.set_json_timestamp(info.json_timestamp);
+			m_read_session.set_ioflags(m_read_session.get_ioflags() | DNET_IO_FLAGS_NOCSUM);
+			m_read_session.set_groups({static_cast<int>(result.command()->id.group_id)});
+			m_key_flags = info.record_flags;
+			m_json_capacity = info.json_capacity;
+			if (m_total_size != info.data_size) {
+				m_total_size = info.data_size;
+				m_chunked = m_total_size > config.chunk_size;
+			}
+		}
+		m_attempt = 0;
+
+		if (m_chunked && results.size() > 1) {
+			for (const auto &r : results) {
+				if (r.error())
+					m_missed_groups.push_back(r.command()->id.group_id);
+			}
+		}
+
+		m_json = result.json();
+		m_data_chunk = result.data();
+		write();
+	}
+
+	void write() {
+		auto self = shared_from_this();
+		auto handler = [self] (const std::vector<write_result_entry> &results, const error_info &error) {
+			self->guarded([&] () { self->on_write(results, error); });
+		};
+
+		if (!m_chunked) {
+			m_write_session.write(m_key.id, m_json, m_json_capacity, m_data_chunk, m_total_size)
+				.connect(handler);
+		} else if (m_recovered_size == 0) {
+			m_write_session.write_prepare(m_key.id, m_json, m_json_capacity, m_data_chunk, 0, m_total_size)
+				.connect(handler);
+		} else if (m_recovered_size + m_data_chunk.size() < m_total_size) {
+			m_write_session.write_plain(m_key.id, m_json, m_data_chunk, m_recovered_size)
+				.connect(handler);
+		} else {
+			m_write_session.write_commit(m_key.id, m_json, m_data_chunk, m_recovered_size, m_total_size)
+				.connect(handler);
+		}
+	}
+
+	void on_write(const std::vector<write_result_entry> &results, const error_info &error) {
+		for (const auto &result : results) {
+			if (result.status())
+				m_data.counter(m_data.m_stats.commands_by_groups,
+				               "write." + std::to_string(result.command()->id.group_id) + "." +
+				               std::to_string(result.status()), 1);
+		}
+
+		if (error) {
+			DNET_LOG_ERROR(m_data.m_log, "Failed to write key: {}: {}", key_str(m_key.id), error.message());
+			m_data.counter(m_data.m_stats.commands, "write." + std::to_string(error.code()), 1);
+			++m_stats.write_failed;
+			if (m_attempt < m_data.m_config.attempts &&
+			    (error.code() == -ETIMEDOUT || error.code() == -ENXIO)) {
+				++m_attempt;
+				++m_stats.write_retries;
+				m_write_session.set_timeout(m_write_session.get_timeout() * 2);
+				write();
+				return;
+			}
+			stop(false);
+			return;
+		}
+
+		m_stats.write += results.size();
+		m_recovered_size += m_data_chunk.size();
+		m_stats.written_bytes += m_data_chunk.size() * results.size();
+		m_attempt = 0;
+
+		if (m_recovered_size < m_total_size) {
+			read();
+		} else {
+			DNET_LOG_DEBUG(m_data.m_log, "Key: {} has been successfully copied", key_str(m_key.id));
+			stop(true);
+		}
+	}
+
+	/* removes corrupted replicas of the key in parallel with its recovery, see recovery's KeyRemover */
+	class key_remover : public std::enable_shared_from_this<key_remover> {
+	public:
+		key_remover(const std::shared_ptr<key_recover> &parent, const std::vector<int> &groups)
+		: m_parent(parent)
+		, m_session(parent->m_remove_session.clone())
+		, m_attempt(0) {
+			const auto &config = parent->m_data.m_config;
+			m_session.set_groups(groups);
+			m_session.set_timeout(std::max<uint64_t>(60,
+				parent->m_total_size / std::max<uint64_t>(config.data_flow_rate, 1)));
+		}
+
+		void remove() {
+			const auto &data = m_parent->m_data;
+			const auto &config = data.m_config;
+			if (config.safe || config.dry_run) {
+				DNET_LOG_INFO(data.m_log, "{} mode is turned on. Skip removing key: {}",
+				              config.safe ? "Safe" : "Dry-run", key_str(m_parent->m_key.id));
+				complete();
+				return;
+			}
+
+			auto self = shared_from_this();
+			m_session.remove(m_parent->m_key.id).connect(
+				[self] (const std::vector<remove_result_entry> &results, const error_info &error) {
+					try {
+						self->on_remove(results, error);
+					} catch (const std::exception &e) {
+						DNET_LOG_ERROR(self->m_parent->m_data.m_log, "Failed to handle remove of key: {}: {}",
+						               key_str(self->m_parent->m_key.id), e.what());
+						self->complete();
+					}
+				});
+		}
+
+	private:
+		void on_remove(const std::vector<remove_result_entry> &results, const error_info &error) {
+			auto &data = m_parent->m_data;
+			for (const auto &result : results) {
+				if (result.status()) {
+					data.counter(data.m_stats.commands, "remove." + std::to_string(result.status()), 1);
+					data.counter(data.m_stats.commands_by_groups,
+					             "remove." + std::to_string(result.command()->id.group_id) + "." +
+					             std::to_string(result.status()), 1);
+				}
+			}
+
+			if (error) {
+				++m_stats.remove_failed;
+
+				std::vector<int> failed_groups;
+				for (const auto &result : results) {
+					const int status = result.status();
+					if (status != 0 && status != -ENOENT && status != -EBADFD)
+						failed_groups.push_back(result.command()->id.group_id);
+				}
+				DNET_LOG_ERROR(data.m_log, "Failed to remove key: {}: {}",
+				               key_str(m_parent->m_key.id), error.message());
+
+				if (!failed_groups.empty() && m_attempt < data.m_config.attempts) {
+					++m_attempt;
+					++m_stats.remove_retries;
+					m_session.set_groups(failed_groups);
+					m_session.set_timeout(m_session.get_timeout() * 2);
+					remove();
+					return;
+				}
+			} else {
+				m_stats.remove += results.size();
+			}
+
+			complete();
+		}
+
+		void complete() {
+			m_parent->on_remove_complete(m_stats);
+		}
+
+		std::shared_ptr<key_recover> m_parent;
+		session m_session;
+		int m_attempt;
+		recover_stat m_stats;
+	};
+
+	void on_remove_complete(const recover_stat &stat) {
+		{
+			std::lock_guard<std::mutex> guard(m_remove_lock);
+			m_stats.remove += stat.remove;
+			m_stats.remove_failed += stat.remove_failed;
+			m_stats.remove_retries += stat.remove_retries;
+		}
+		complete();
+	}
+
+	void stop(bool result) {
+		m_result = result;
+		DNET_LOG_DEBUG(m_data.m_log, "Finished recovering key: {} with result: {}", key_str(m_key.id), result);
+		complete();
+	}
+
+	void complete() {
+		if (--m_pending)
+			return;
+		m_data.on_key_complete(m_result, m_stats);
+	}
+
+	dc_recovery_data &m_data;
+	key_data m_key;
+
+	std::vector<int> m_missed_groups;
+	std::vector<int> m_diff_groups;
+	std::vector<int> m_same_groups;
+
+	session m_read_session;
+	session m_write_session;
+	session m_remove_session;
+
+	uint64_t m_key_flags;
+	uint64_t m_total_size;
+	uint64_t m_recovered_size;
+	bool m_chunked;
+
+	data_pointer m_json;
+	uint64_t m_json_capacity;
+	data_pointer m_data_chunk;
+
+	int m_attempt;
+
+	recover_stat m_stats;
+	/* removers of corrupted replicas report their counters concurrently */
+	std::mutex m_remove_lock;
+	std::atomic<int> m_pending;
+	bool m_result;
+};
+
+} /* unnamed namespace */
+
+/*
+ * Reads next key which needs recovery, replicas are sorted from the newest to the oldest,
+ * see recovery's iterate_key().
+ */
+bool dc_recovery_data::next_key(key_data_reader &reader, key_data &key, std::vector<int> &missed_groups) {
+	const auto &groups = m_config.groups;
+
+	while (reader.next(key)) {
+		if (key.infos.empty() || key.infos.size() + groups.size() <= 1) {
+			DNET_LOG_ERROR(m_log, "Invalid number of replicas for key: {}: infos_count: {}, groups_count: {}",
+			               key_str(key.id), key.infos.size(), groups.size());
+			continue;
+		}
+
+		std::stable_sort(key.infos.begin(), key.infos.end(), [] (const key_info &lhs, const key_info &rhs) {
+			const int cmp = dnet_time_cmp(&lhs.timestamp, &rhs.timestamp);
+			return cmp != 0 ? cmp > 0 : lhs.size > rhs.size;
+		});
+
+		std::set<int> dest_groups(groups.begin(), groups.end());
+		for (const auto &info : key.infos)
+			dest_groups.erase(info.group_id);
+		missed_groups.assign(dest_groups.begin(), dest_groups.end());
+
+		for (const auto &info : key.infos) {
+			if (info.record_flags & DNET_RECORD_FLAGS_CORRUPTED)
+				dest_groups.insert(info.group_id);
+		}
+
+		if (same_meta(key.infos.front(), key.infos.back()) && dest_groups.empty())
+			continue;
+
+		return true;
+	}
+	return false;
+}
+
+void dc_recovery_data::recover_rest_keys() {
+	key_data_reader reader(filename("rest_keys"));
+	key_data key;
+	std::vector<int> missed_groups;
+	const size_t window = std::max<size_t>(m_config.batch_size, 1);
+
+	std::unique_lock<std::mutex> guard(m_lock);
+	try {
+		for (;;) {
+			m_cond.wait(guard, [&] () { return m_stats.recovers_in_progress < window; });
+
+			guard.unlock();
+			const bool found = next_key(reader, key, missed_groups);
+			guard.lock();
+			if (!found)
+				break;
+
+			++m_stats.recovers_in_progress;
+			auto recover = std::make_shared<key_recover>(*this, std::move(key), std::move(missed_groups));
+
+			/* the key may complete synchronously, so its callbacks must not meet the lock */
+			guard.unlock();
+			recover->start();
+			guard.lock();
+		}
+	} catch (...) {
+		m_result = false;
+		m_cond.wait(guard, [&] () { return m_stats.recovers_in_progress == 0; });
+		throw;
+	}
+
+	m_cond.wait(guard, [&] () { return m_stats.recovers_in_progress == 0; });
+}
+
+bool dc_recovery_data::recover() {
+	m_rest.reset(new key_data_writer(filename("rest_keys")));
+
+	if (!m_config.bucket_order.empty())
+		server_send_recovery(*this).recover();
+
+	m_rest.reset();
+
+	recover_rest_keys();
+
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_result;
+}
+
+dc_recovery::dc_recovery(const node &node, const dc_recovery_config &config)
+: m_data(new dc_recovery_data(node, config)) {
+}
+
+dc_recovery::~dc_recovery() = default;
+
+bool dc_recovery::recover() {
+	return m_data->recover();
+}
+
+dc_recovery_stats dc_recovery::stats() const {
+	std::lock_guard<std::mutex> guard(m_data->m_lock);
+	return m_data->m_stats;
+}
+
+}}} /* namespace ioremap::elliptics::newapi */
@@ -0,0 +1,182 @@
+#include "read_cache.hpp"
+
+#include "library/elliptics.h"
+
+#include <cstring>
+#include <tuple>
+
+/* share of cache's bytes given to entries which were hit at least twice */
+static const uint64_t dnet_read_cache_protected_ratio = 80;
+
+bool dnet_read_cache::key_type::operator<(const key_type &other) const {
+	/* id goes first, so all replies of the key are neighbours and can be dropped by invalidate() */
+	const int cmp = memcmp(id.id, other.id.id, DNET_ID_SIZE);
+	if (cmp != 0)
+		return cmp < 0;
+
+	return std::tie(ns, ioflags, read_flags, offset, size) <
+		std::tie(other.ns, other.ioflags, other.read_flags, other.offset, other.size);
+}
+
+dnet_read_cache::dnet_read_cache(uint64_t max_size, uint64_t ttl_ms)
+: m_max_size(max_size)
+, m_ttl(std::chrono::milliseconds(ttl_ms))
+, m_probation_size(0)
+, m_protected_size(0) {
+	m_generations.fill(0);
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void dnet_read_cache::configure(uint64_t max_size, uint64_t ttl_ms) {
+	std::lock_guard<std::mutex> guard(m_lock);
+	m_max_size = max_size;
+	m_ttl = std::chrono::milliseconds(ttl_ms);
+	shrink();
+}
+
+bool dnet_read_cache::enabled() const {
+	return m_max_size != 0;
+}
+
+bool dnet_read_cache::find(const key_type &key, read_result_entry &result, bool &fresh) {
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	auto it = m_entries.find(key);
+	if (it == m_entries.end()) {
+		++m_stats.misses;
+		return false;
+	}
+
+	result = it->second->result;
+	fresh = clock::now() - it->second->validated < m_ttl;
+
+	/* stale entry is promoted only if lookup confirms it, see revalidated() */
+	if (fresh) {
+		++m_stats.hits;
+		touch(it->second);
+	} else {
+		++m_stats.misses;
+	}
+	return true;
+}
+
+void dnet_read_cache::revalidated(const key_type &key) {
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	auto it = m_entries.find(key);
+	if (it == m_entries.end())
+		return;
+
+	it->second->validated = clock::now();
+	++m_stats.revalidations;
+	touch(it->second);
+}
+
+void dnet_read_cache::touch(lru_list::iterator item) {
+	if (item->is_protected) {
+		m_protected.splice(m_protected.begin(), m_protected, item);
+	} else {
+		/* second hit promotes entry to protected segment */
+		item->is_protected = true;
+		m_probation_size -= item->size;
+		m_protected_size += item->size;
+		m_protected.splice(m_protected.begin(), m_probation, item);
+		shrink();
+	}
+}
+
+size_t dnet_read_cache::slot(const dnet_raw_id &id) const {
+	uint64_t hash;
+	memcpy(&hash, id.id, sizeof(hash));
+	return hash % m_generations.size();
+}
+
+uint64_t dnet_read_cache::generation(const dnet_raw_id &id) {
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_generations[slot(id)];
+}
+
+void dnet_read_cache::insert(const key_type &key, const read_result_entry &result, uint64_t generation) {
+	/* the whole reply buffer is kept alive by the entry, so it is accounted entirely */
+	const uint64_t size = result.raw_data().size() + sizeof(dnet_addr) + sizeof(dnet_cmd) + sizeof(entry);
+
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	if (size > m_max_size || m_generations[slot(key.id)] != generation)
+		return;
+
+	auto it = m_entries.find(key);
+	if (it != m_entries.end())
+		erase(it);
+
+	m_probation.push_front(entry{key, result, size, clock::now(), false});
+	m_probation_size += size;
+	m_entries.emplace(key, m_probation.begin());
+	shrink();
+}
+
+void dnet_read_cache::invalidate(const dnet_raw_id &id) {
+	key_type first;
+	first.id = id;
+	first.ioflags = 0;
+	first.read_flags = 0;
+	first.offset = 0;
+	first.size = 0;
+
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	++m_generations[slot(id)];
+
+	auto it = m_entries.lower_bound(first);
+	while (it != m_entries.end() && !memcmp(it->first.id.id, id.id, DNET_ID_SIZE)) {
+		erase(it++);
+		++m_stats.invalidations;
+	}
+}
+
+ioremap::elliptics::read_cache_stats dnet_read_cache::stats() const {
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	auto stats = m_stats;
+	stats.entries = m_entries.size();
+	stats.size = m_probation_size + m_protected_size;
+	stats.max_size = m_max_size;
+	return stats;
+}
+
+void dnet_read_cache::erase(std::map<key_type, lru_list::iterator>::iterator it) {
+	auto item = it->second;
+	if (item->is_protected) {
+		m_protected_size -= item->size;
+		m_protected.erase(item);
+	} else {
+		m_probation_size -= item->size;
+		m_probation.erase(item);
+	}
+	m_entries.erase(it);
+}
+
+void dnet_read_cache::shrink() {
+	const uint64_t max_size = m_max_size;
+	const uint64_t max_protected_size = max_size / 100 * dnet_read_cache_protected_ratio;
+
+	/* entries pushed out of protected segment get one more chance in probationary one */
+	while (m_protected_size > max_protected_size && !m_protected.empty()) {
+		auto item = std::prev(m_protected.end());
+		item->is_protected = false;
+		m_protected_size -= item->size;
+		m_probation_size += item->size;
+		m_probation.splice(m_probation.begin(), m_protected, item);
+	}
+
+	while (m_probation_size + m_protected_size > max_size) {
+		auto &list = m_probation.empty() ? m_protected : m_probation;
+		erase(m_entries.find(std::prev(list.end())->key));
+		++m_stats.evictions;
+	}
+}
+
+void dnet_read_cache_invalidate(struct dnet_node *n, const struct dnet_raw_id &id) {
+	if (n->read_cache)
+		n->read_cache->invalidate(id);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "elliptics/newapi/result_entry.hpp"
+#include "elliptics/session.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+/*
+ * Client-side cache of newapi read replies shared by all sessions of the node, see node::set_read_cache().
+ * It is referred by dnet_node, so it lives in global namespace like other C-visible structures.
+ *
+ * Replies are kept in two LRU segments: new entries come to probationary one and are moved
+ * to protected one on the second hit, so single scan of many keys can't wash out hot objects.
+ */
+struct dnet_read_cache {
+public:
+	typedef ioremap::elliptics::newapi::read_result_entry read_result_entry;
+	typedef std::chrono::steady_clock clock;
+
+	/* reply is cached per request, so different ranges of the same key are different entries */
+	struct key_type {
+		dnet_raw_id id;
+		std::string ns;
+		uint64_t ioflags;
+		uint64_t read_flags;
+		uint64_t offset;
+		uint64_t size;
+
+		bool operator<(const key_type &other) const;
+	};
+
+	dnet_read_cache(uint64_t max_size, uint64_t ttl_ms);
+
+	void configure(uint64_t max_size, uint64_t ttl_ms);
+	bool enabled() const;
+
+	/*
+	 * Returns true and cached reply if @key is in the cache,
+	 * @fresh is set if reply can be returned without revalidation. Stale reply is counted as a miss.
+	 */
+	bool find(const key_type &key, read_result_entry &result, bool &fresh);
+	/* restarts ttl of @key whose timestamps are confirmed by lookup */
+	void revalidated(const key_type &key);
+
+	/*
+	 * Reply read from storage is inserted only if nobody has invalidated its key since the read was started,
+	 * @generation is taken by generation() before sending the read.
+	 */
+	uint64_t generation(const dnet_raw_id &id);
+	void insert(const key_type &key, const read_result_entry &result, uint64_t generation);
+
+	/* drops all cached replies of @id in all namespaces */
+	void invalidate(const dnet_raw_id &id);
+
+	ioremap::elliptics::read_cache_stats stats() const;
+
+private:
+	struct entry {
+		key_type key;
+		read_result_entry result;
+		uint64_t size;
+		clock::time_point validated;
+		bool is_protected;
+	};
+	typedef std::list<entry> lru_list;
+
+	size_t slot(const dnet_raw_id &id) const;
+	void erase(std::map<key_type, lru_list::iterator>::iterator it);
+	/* moves entry hit by fresh or revalidated read to the head of its segment or promotes it */
+	void touch(lru_list::iterator item);
+	/* must be called under the lock */
+	void shrink();
+
+	mutable std::mutex m_lock;
+	std::atomic<uint64_t> m_max_size;
+	clock::duration m_ttl;
+
+	lru_list m_probation;
+	lru_list m_protected;
+	std::map<key_type, lru_list::iterator> m_entries;
+	uint64_t m_probation_size;
+	uint64_t m_protected_size;
+
+	/* invalidation counters of hashed keys, collisions only make some replies not to be cached */
+	std::array<uint64_t, 1024> m_generations;
+
+	ioremap::elliptics::read_cache_stats m_stats;
+};
+
+/*
+ * Drops cached replies of @id if read cache is enabled for node @n. Writes and removes call it
+ * both before sending the request and after its completion, so reads racing with them don't refill the cache
+ * with old data.
+ */
+void dnet_read_cache_invalidate(struct dnet_node *n, const struct dnet_raw_id &id);
@@ -6,6 +6,8 @@
 #include <fcntl.h>
 #include <queue>
 
+#include <msgpack.hpp>
+
 namespace ioremap { namespace elliptics { namespace newapi {
 
 data_pointer callback_result_entry::raw() const {
@@ -155,6 +157,13 @@ uint64_t iterator_result_entry::total_keys() const {
 	return response.total_keys;
 }
 
+uint64_t iterator_result_entry::filtered_keys() const {
+	dnet_iterator_response response;
+	deserialize(raw_data(), response);
+
+	return response.filtered_keys;
+}
+
 int iterator_result_entry::status() const {
 	dnet_iterator_response response;
 	deserialize(raw_data(), response);
@@ -352,6 +361,23 @@ void iterator_result_container::append_old(const ioremap::elliptics::iterator_re
 	append_item(item);
 }
 
+void iterator_result_container::append_sorted_chunk(const iterator_result_entry &result)
+{
+	if (m_count && !m_sorted)
+		throw_error(-EINVAL, "can't append sorted chunk to unsorted container");
+
+	const auto chunk = result.data();
+	if (chunk.size() % sizeof(iterator_container_item) != 0)
+		throw_error(-EINVAL, "invalid chunk size: %zu", chunk.size());
+
+	int err = dnet_write_ll(m_fd, chunk.data<char>(), chunk.size(), m_write_position);
+	if (err != 0)
+		throw_error(err, "dnet_write_ll failed");
+	m_write_position += chunk.size();
+	m_count += chunk.size() / sizeof(iterator_container_item);
+	m_sorted = true;
+}
+
 void iterator_result_container::append_item(const iterator_container_item &item)
 {
 	int err = dnet_write_ll(m_fd, reinterpret_cast<const char *>(&item), sizeof(item), m_write_position);
@@ -454,4 +480,281 @@ iterator_container_item iterator_result_container::operator [](size_t n) const
 	return item;
 }
 
+//
+// Iterator results merger
+//
+
+static const size_t MERGE_SOURCE_BUFFER_ITEMS = 64 * 1024;
+static const size_t MERGE_OUTPUT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// Sequential reader of the sorted container, which skips older duplicates of the key
+class iterator_merge_cursor
+{
+public:
+	iterator_merge_cursor(const iterator_merge_source &source, size_t index)
+	: m_source(source)
+	, m_index(index)
+	, m_position(0)
+	, m_buffer_index(0)
+	{}
+
+	// Reads the first item, returns false if the container is empty
+	bool start()
+	{
+		if (!read_next(m_item))
+			return false;
+		m_has_next = read_next(m_next);
+		skip_duplicates();
+		return true;
+	}
+
+	// Moves to the next key, returns false if the container is over
+	bool next()
+	{
+		if (!m_has_next)
+			return false;
+		m_item = m_next;
+		m_has_next = read_next(m_next);
+		skip_duplicates();
+		return true;
+	}
+
+	const iterator_container_item &item() const
+	{
+		return m_item;
+	}
+
+	const iterator_merge_source &source() const
+	{
+		return m_source;
+	}
+
+	size_t index() const
+	{
+		return m_index;
+	}
+
+private:
+	// container could keep several records of the key, the newest one is used like in recovery's MergeData
+	void skip_duplicates()
+	{
+		while (m_has_next && !dnet_id_cmp_str(m_item.key.id, m_next.key.id)) {
+			if (dnet_time_cmp(&m_item.data_timestamp, &m_next.data_timestamp) < 0)
+				m_item = m_next;
+			m_has_next = read_next(m_next);
+		}
+	}
+
+	bool read_next(iterator_container_item &item)
+	{
+		if (m_buffer_index >= m_buffer.size()) {
+			const auto &container = m_source.container;
+			if (m_position >= container.m_count)
+				return false;
+
+			const size_t num_items = std::min<uint64_t>(MERGE_SOURCE_BUFFER_ITEMS,
+			                                            container.m_count - m_position);
+			m_buffer.resize(num_items);
+			int err = dnet_read_ll(container.m_fd, reinterpret_cast<char *>(m_buffer.data()),
+			                       num_items * sizeof(iterator_container_item),
+			                       m_position * sizeof(iterator_container_item));
+			if (err)
+				throw_error(err, "read of merge source failed");
+
+			m_position += num_items;
+			m_buffer_index = 0;
+		}
+
+		item = m_buffer[m_buffer_index++];
+		return true;
+	}
+
+	const iterator_merge_source &m_source;
+	const size_t m_index;
+
+	uint64_t m_position;
+	std::vector<iterator_container_item> m_buffer;
+	size_t m_buffer_index;
+
+	iterator_container_item m_item;
+	iterator_container_item m_next;
+	bool m_has_next;
+};
+
+struct CursorsComparator
+{
+	bool operator () (const iterator_merge_cursor *lhs, const iterator_merge_cursor *rhs) const
+	{
+		const int diff = dnet_id_cmp_str(lhs->item().key.id, rhs->item().key.id);
+		if (diff)
+			return diff > 0;
+		return lhs->index() > rhs->index();
+	}
+};
+
+// Replicas go from the newest: by (data_timestamp desc, data_size asc, user_flags desc) like recovery's MergeData
+static bool compare_merged_replicas(const iterator_merge_cursor *lhs, const iterator_merge_cursor *rhs)
+{
+	const auto &l = lhs->item();
+	const auto &r = rhs->item();
+
+	int diff = dnet_time_cmp(&r.data_timestamp, &l.data_timestamp);
+	if (diff)
+		return diff < 0;
+	if (l.data_size != r.data_size)
+		return l.data_size < r.data_size;
+	return l.user_flags > r.user_flags;
+}
+
+static bool same_replica_meta(const iterator_container_item &lhs, const iterator_container_item &rhs)
+{
+	return !dnet_time_cmp(&lhs.data_timestamp, &rhs.data_timestamp) &&
+	       lhs.data_size == rhs.data_size &&
+	       lhs.user_flags == rhs.user_flags;
+}
+
+static bool skip_merged_key(const std::vector<const iterator_merge_cursor *> &replicas,
+                            const std::vector<int> &groups, const std::set<uint64_t> &user_flags_set)
+{
+	for (const auto replica : replicas) {
+		if (replica->item().record_flags & DNET_RECORD_FLAGS_CORRUPTED)
+			return false;
+	}
+
+	if (!user_flags_set.empty()) {
+		bool has_user_flags = false;
+		for (const auto replica : replicas)
+			has_user_flags |= user_flags_set.count(replica->item().user_flags) != 0;
+		if (!has_user_flags)
+			return true;
+	}
+
+	size_t committed = 0;
+	for (const auto replica : replicas) {
+		if (!(replica->item().record_flags & DNET_RECORD_FLAGS_UNCOMMITTED))
+			++committed;
+	}
+	if (committed < groups.size())
+		return false;
+
+	const auto &newest = replicas.front()->item();
+	for (const auto replica : replicas) {
+		if (!same_replica_meta(replica->item(), newest))
+			return false;
+	}
+	return true;
+}
+
+static void write_merge_output(int fd, msgpack::sbuffer &buffer, uint64_t &offset)
+{
+	int err = dnet_write_ll(fd, buffer.data(), buffer.size(), offset);
+	if (err)
+		throw_error(err, "write of merge result failed");
+	offset += buffer.size();
+	buffer.clear();
+}
+
+void iterator_result_merger::add_source(const iterator_merge_source &source)
+{
+	if (!source.container.m_sorted)
+		throw_error(-EINVAL, "merge source of group %d isn't sorted", source.group_id);
+	m_sources.emplace_back(source);
+}
+
+iterator_merge_stats iterator_result_merger::merge(const std::string &filename, const std::vector<int> &groups,
+                                                   const std::set<uint64_t> &user_flags_set) const
+{
+	iterator_merge_stats stats;
+
+	std::vector<std::unique_ptr<iterator_merge_cursor>> cursors;
+	std::priority_queue<iterator_merge_cursor *, std::vector<iterator_merge_cursor *>, CursorsComparator> pq;
+	for (const auto &source : m_sources) {
+		cursors.emplace_back(new iterator_merge_cursor(source, cursors.size()));
+		if (cursors.back()->start())
+			pq.push(cursors.back().get());
+	}
+
+	int fd = open(filename.c_str(), O_WRONLY | O_CLOEXEC | O_TRUNC | O_CREAT, 0644);
+	if (fd == -1)
+		throw_error(-errno, "create merge result file failed");
+	std::unique_ptr<int, void (*)(int *)> fd_guard(&fd, [] (int *fd) { close(*fd); });
+
+	msgpack::sbuffer buffer;
+	msgpack::packer<msgpack::sbuffer> packer(buffer);
+	uint64_t offset = 0;
+
+	std::vector<const iterator_merge_cursor *> replicas;
+	std::vector<iterator_merge_cursor *> processed;
+	while (!pq.empty()) {
+		replicas.clear();
+		processed.clear();
+
+		const dnet_raw_id key = pq.top()->item().key;
+		while (!pq.empty() && !dnet_id_cmp_str(pq.top()->item().key.id, key.id)) {
+			replicas.push_back(pq.top());
+			processed.push_back(pq.top());
+			pq.pop();
+		}
+
+		++stats.total_keys;
+		std::stable_sort(replicas.begin(), replicas.end(), compare_merged_replicas);
+
+		if (!skip_merged_key(replicas, groups, user_flags_set)) {
+			++stats.written_keys;
+
+			const auto &newest = replicas.front()->item();
+			for (const int group : groups) {
+				auto it = std::find_if(replicas.begin(), replicas.end(),
+				                       [&] (const iterator_merge_cursor *replica) {
+					return replica->source().group_id == group;
+				});
+				if (it == replicas.end())
+					++stats.missing_keys[group];
+			}
+
+			packer.pack_array(2);
+			packer.pack_array(DNET_ID_SIZE);
+			for (size_t i = 0; i < DNET_ID_SIZE; ++i)
+				packer.pack(static_cast<unsigned int>(key.id[i]));
+
+			packer.pack_array(replicas.size());
+			for (const auto replica : replicas) {
+				const auto &source = replica->source();
+				const auto &item = replica->item();
+
+				if (!same_replica_meta(item, newest))
+					++stats.stale_keys[source.group_id];
+
+				packer.pack_array(8);
+				packer.pack_array(3);
+				packer.pack(source.host);
+				packer.pack(source.port);
+				packer.pack(source.family);
+				packer.pack(source.group_id);
+				packer.pack_array(2);
+				packer.pack(item.data_timestamp.tsec);
+				packer.pack(item.data_timestamp.tnsec);
+				packer.pack(item.data_size);
+				packer.pack(item.user_flags);
+				packer.pack(item.record_flags);
+				packer.pack(item.data_offset);
+				packer.pack(item.blob_id);
+			}
+
+			if (buffer.size() >= MERGE_OUTPUT_BUFFER_SIZE)
+				write_merge_output(fd, buffer, offset);
+		}
+
+		for (const auto cursor : processed) {
+			if (cursor->next())
+				pq.push(cursor);
+		}
+	}
+
+	if (buffer.size())
+		write_merge_output(fd, buffer, offset);
+
+	return stats;
+}
+
 }}} // namespace ioremap::elliptics::newapi
@@ -19,6 +19,7 @@
 #include "bindings/cpp/functional_p.h"
 
 #include "bulk_remove_handler.h"
+#include "bulk_write_handler.h"
 
 namespace ioremap { namespace elliptics { namespace newapi {
 
@@ -235,6 +236,8 @@ public:
 			               });
 		}
 
+		dnet_read_cache_invalidate(m_session.get_native_node(), m_key.raw_id());
+
 		auto rr = send_to_groups(m_session, control);
 		m_handler.set_total(rr.total());
 
@@ -253,6 +256,7 @@ private:
 	}
 
 	void complete(const error_info &error) {
+		dnet_read_cache_invalidate(m_session.get_native_node(), m_key.raw_id());
 		m_handler.complete(error);
 
 		if (m_context) {
@@ -376,6 +380,13 @@ public:
 		);
 	}
 
+	/* first successful reply will be put into @cache if @key isn't invalidated since @generation */
+	void set_cache(dnet_read_cache *cache, const dnet_read_cache::key_type &key, uint64_t generation) {
+		m_cache = cache;
+		m_cache_key = key;
+		m_cache_generation = generation;
+	}
+
 private:
 	void process(const read_result_entry &entry) {
 		m_handler.process(entry);
@@ -383,6 +394,11 @@ private:
 		const auto *cmd = entry.command();
 		m_transes.emplace_back(cmd->trans);
 
+		if (m_cache && !entry.error() && !entry.is_ack()) {
+			m_cache->insert(m_cache_key, entry, m_cache_generation);
+			m_cache = nullptr;
+		}
+
 		if (!entry.error()) {
 			m_read_json_size += entry.io_info().json_size;
 			m_read_data_size += entry.io_info().data_size;
@@ -438,18 +454,145 @@ private:
 	} m_responses;
 
 	std::unique_ptr<dnet_access_context> m_context;
+
+	dnet_read_cache *m_cache{nullptr};
+	dnet_read_cache::key_type m_cache_key;
+	uint64_t m_cache_generation{0};
 };
 
-async_read_result send_read(const session &orig_sess, const key &id, const dnet_read_request &request,
-                            std::vector<int> &&groups) {
+static void send_uncached_read(const session &orig_sess, const async_read_result &result, const key &id,
+                               const dnet_read_request &request, std::vector<int> &&groups,
+                               dnet_read_cache *cache = nullptr,
+                               const dnet_read_cache::key_type *cache_key = nullptr) {
 	transport_control control;
 	control.set_key(id.id());
 	control.set_command(DNET_CMD_READ_NEW);
 	control.set_cflags(orig_sess.get_cflags() | DNET_FLAGS_NEED_ACK);
 
-	async_read_result result(orig_sess);
 	auto handler = std::make_shared<read_handler>(orig_sess, result, id);
+	if (cache)
+		handler->set_cache(cache, *cache_key, cache->generation(id.raw_id()));
 	handler->start(std::move(groups), control.get_native(), request);
+}
+
+/*
+ * Checks by lookup whether stale reply from the client cache still matches the object in the storage.
+ * Cached reply is returned if json and data timestamps are the same, otherwise the object is read again.
+ */
+class revalidate_read_handler : public std::enable_shared_from_this<revalidate_read_handler> {
+public:
+	explicit revalidate_read_handler(const session &session,
+	                                 const async_read_result &result,
+	                                 const key &key,
+	                                 const dnet_read_request &request,
+	                                 dnet_read_cache *cache,
+	                                 const dnet_read_cache::key_type &cache_key,
+	                                 const read_result_entry &cached)
+	: m_key(key)
+	, m_session(session)
+	, m_handler(result)
+	, m_request(request)
+	, m_cache(cache)
+	, m_cache_key(cache_key)
+	, m_cached(cached)
+	, m_valid(false) {
+		m_handler.set_total(1);
+	}
+
+	void start(std::vector<int> &&groups) {
+		m_groups = std::move(groups);
+
+		auto sess = m_session.clean_clone();
+		sess.set_groups(m_groups);
+		sess.set_filter(filters::positive);
+		sess.lookup(m_key).connect(
+			std::bind(&revalidate_read_handler::process, shared_from_this(), std::placeholders::_1),
+			std::bind(&revalidate_read_handler::complete, shared_from_this(), std::placeholders::_1)
+		);
+	}
+
+private:
+	void process(const lookup_result_entry &entry) {
+		if (m_valid)
+			return;
+
+		const auto actual = entry.record_info();
+		const auto cached = m_cached.record_info();
+		m_valid = !dnet_time_cmp(&actual.json_timestamp, &cached.json_timestamp) &&
+		          !dnet_time_cmp(&actual.data_timestamp, &cached.data_timestamp);
+	}
+
+	void complete(const error_info &) {
+		if (!m_valid) {
+			async_read_result result(m_session);
+			send_uncached_read(m_session, result, m_key, m_request, std::move(m_groups),
+			                   m_cache, &m_cache_key);
+			result.connect(
+				std::bind(&revalidate_read_handler::forward, shared_from_this(), std::placeholders::_1),
+				std::bind(&revalidate_read_handler::finish, shared_from_this(), std::placeholders::_1)
+			);
+			return;
+		}
+
+		m_cache->revalidated(m_cache_key);
+
+		m_handler.process(m_cached);
+		m_handler.complete(error_info());
+	}
+
+	void forward(const read_result_entry &entry) {
+		m_handler.process(entry);
+	}
+
+	void finish(const error_info &error) {
+		m_handler.complete(error);
+	}
+
+	const key m_key;
+	session m_session;
+	async_result_handler<read_result_entry> m_handler;
+	dnet_read_request m_request;
+	std::vector<int> m_groups;
+
+	dnet_read_cache *m_cache;
+	dnet_read_cache::key_type m_cache_key;
+	read_result_entry m_cached;
+	bool m_valid;
+};
+
+async_read_result send_read(const session &orig_sess, const key &id, const dnet_read_request &request,
+                            std::vector<int> &&groups) {
+	async_read_result result(orig_sess);
+
+	auto cache = orig_sess.get_native_node()->read_cache;
+	const auto *native = orig_sess.get_native();
+	if (!cache || !cache->enabled() || (native->cflags & (DNET_FLAGS_DIRECT | DNET_FLAGS_DIRECT_BACKEND))) {
+		send_uncached_read(orig_sess, result, id, request, std::move(groups));
+		return result;
+	}
+
+	dnet_read_cache::key_type cache_key;
+	cache_key.id = id.raw_id();
+	cache_key.ns.assign(native->ns ? native->ns : "", native->ns ? native->nsize : 0);
+	cache_key.ioflags = request.ioflags;
+	cache_key.read_flags = request.read_flags;
+	cache_key.offset = request.data_offset;
+	cache_key.size = request.data_size;
+
+	read_result_entry cached;
+	bool fresh = false;
+	if (!cache->find(cache_key, cached, fresh)) {
+		send_uncached_read(orig_sess, result, id, request, std::move(groups), cache, &cache_key);
+	} else if (fresh) {
+		async_result_handler<read_result_entry> handler(result);
+		handler.set_total(1);
+		handler.process(cached);
+		handler.complete(error_info());
+	} else {
+		auto handler = std::make_shared<revalidate_read_handler>(orig_sess, result, id, request,
+		                                                         cache, cache_key, cached);
+		handler->start(std::move(groups));
+	}
 	return result;
 }
 
@@ -561,6 +704,8 @@ public:
 		m_responses.data_sizes.reserve(groups_number);
 		m_transes.reserve(groups_number);
 
+		dnet_read_cache_invalidate(m_session.get_native_node(), m_key.raw_id());
+
 		auto rr = async_result_cast<write_result_entry>(m_session, send_to_groups(m_session, control));
 		m_handler.set_total(rr.total());
 
@@ -587,6 +732,7 @@ private:
 	}
 
 	void complete(const error_info &error) {
+		dnet_read_cache_invalidate(m_session.get_native_node(), m_key.raw_id());
 		m_handler.complete(error);
 
 		DNET_LOG_INFO(m_log, "{}: {}: finished: groups: {}, trans: {}, status: {}, json-size: {}, data-size: "
@@ -886,6 +1032,8 @@ public:
 	}
 
 	void start(const transport_control &control, const dnet_iterator_request &request) {
+		m_batched = request.flags & DNET_IFLAGS_BATCH;
+
 		DNET_LOG_INFO(m_log, "{}: started: st: {}/{}, id: {}, action: {}, type: {}, iflags: {}, "
 		                     "key_ranges: {}, ts_range: '{}' - '{}', groups: {}",
 		              dnet_cmd_string(control.get_native().cmd), m_address.to_string_with_family(),
@@ -928,7 +1076,10 @@ public:
 
 private:
 	void process(const iterator_result_entry &entry) {
-		m_handler.process(entry);
+		if (m_batched && !entry.empty() && !entry.status())
+			split(entry);
+		else
+			m_handler.process(entry);
 
 		const auto *cmd = entry.command();
 		m_trans = cmd->trans;
@@ -937,6 +1088,37 @@ private:
 			++it.first->second;
 	}
 
+	/* splits the packet of batched replies into per-record entries, each reply is preceded by its response */
+	void split(const iterator_result_entry &entry) {
+		const auto packet = entry.raw_data();
+
+		size_t offset = 0;
+		while (offset < packet.size()) {
+			dnet_iterator_response response;
+			size_t end = offset;
+			deserialize(packet, response, end);
+			end += response.read_json_size + response.read_data_size;
+			if (end > packet.size()) {
+				DNET_LOG_ERROR(m_log, "{}: batched reply is truncated: st: {}/{}, size: {}, offset: {}, "
+				                      "reply end: {}", dnet_cmd_string(entry.command()->cmd),
+				               m_address.to_string_with_family(), m_backend_id, packet.size(), offset, end);
+				break;
+			}
+
+			auto data = std::make_shared<callback_result_data>();
+			data->data = data_pointer::allocate(sizeof(dnet_addr) + sizeof(dnet_cmd) + end - offset);
+			memcpy(data->data.data(), entry.address(), sizeof(dnet_addr));
+
+			auto cmd = data->data.skip<dnet_addr>().data<dnet_cmd>();
+			memcpy(cmd, entry.command(), sizeof(dnet_cmd));
+			cmd->size = end - offset;
+			memcpy(cmd + 1, packet.slice(offset, end - offset).data(), end - offset);
+
+			m_handler.process(callback_cast<iterator_result_entry>(ioremap::elliptics::callback_result_entry(data)));
+			offset = end;
+		}
+	}
+
 	void complete(const error_info &error) {
 		m_handler.complete(error);
 
@@ -960,11 +1142,27 @@ private:
 	const uint32_t m_backend_id;
 
 	uint64_t m_trans{0};
+	bool m_batched{false};
 
 	std::unordered_map<int, size_t> m_statuses;
 	std::unique_ptr<dnet_access_context> m_context;
 };
 
+static async_iterator_result send_iterator_request(session &sess, const address &addr, uint32_t backend_id,
+                                                   const dnet_iterator_request &request) {
+	auto packet = serialize(request);
+
+	transport_control control;
+	control.set_command(DNET_CMD_ITERATOR_NEW);
+	control.set_cflags(sess.get_cflags() | DNET_FLAGS_NEED_ACK | DNET_FLAGS_NOLOCK);
+	control.set_data(packet.data(), packet.size());
+
+	async_iterator_result result(sess);
+	auto handler = std::make_shared<iterator_handler>(result, sess, addr, backend_id);
+	handler->start(control, request);
+	return result;
+}
+
 async_iterator_result session::start_iterator(const address &addr, uint32_t backend_id,
                                               uint64_t flags,
                                               const std::vector<dnet_iterator_range> &key_ranges,
@@ -983,17 +1181,83 @@ async_iterator_result session::start_iterator(const address &addr, uint32_t back
 		time_range,
 	};
 
-	auto packet = serialize(request);
+	return send_iterator_request(*this, addr, backend_id, request);
+}
 
-	transport_control control;
-	control.set_command(DNET_CMD_ITERATOR_NEW);
-	control.set_cflags(get_cflags() | DNET_FLAGS_NEED_ACK | DNET_FLAGS_NOLOCK);
-	control.set_data(packet.data(), packet.size());
+async_iterator_result session::start_iterator(const address &addr, uint32_t backend_id,
+                                              uint64_t flags,
+                                              const std::vector<dnet_iterator_range> &key_ranges,
+                                              const std::tuple<dnet_time, dnet_time> &time_range,
+                                              const iterator_filter &filter) {
+	trace_scope scope{*this};
+	if (key_ranges.empty()) {
+		flags &= ~DNET_IFLAGS_KEY_RANGE;
+	} else {
+		flags |= DNET_IFLAGS_KEY_RANGE;
+	}
 
-	async_iterator_result result(*this);
-	auto handler = std::make_shared<iterator_handler>(result, *this, addr, backend_id);
-	handler->start(control, request);
-	return result;
+	dnet_iterator_request request{
+		DNET_ITYPE_NETWORK,
+		flags | DNET_IFLAGS_FILTER,
+		key_ranges,
+		time_range,
+	};
+
+	request.filter.user_flags_mask = filter.user_flags_mask;
+	request.filter.user_flags_value = filter.user_flags_value;
+	request.filter.record_flags_mask = filter.record_flags_mask;
+	request.filter.record_flags_value = filter.record_flags_value;
+	request.filter.min_data_size = filter.min_data_size;
+	request.filter.max_data_size = filter.max_data_size;
+	request.filter.json_key = filter.json_key;
+	request.filter.json_value = filter.json_value;
+
+	return send_iterator_request(*this, addr, backend_id, request);
+}
+
+async_iterator_result session::start_disk_iterator(const address &addr, uint32_t backend_id,
+                                                   uint64_t flags,
+                                                   const std::vector<dnet_iterator_range> &key_ranges,
+                                                   const std::tuple<dnet_time, dnet_time> &time_range) {
+	trace_scope scope{*this};
+	if (key_ranges.empty()) {
+		flags &= ~DNET_IFLAGS_KEY_RANGE;
+	} else {
+		flags |= DNET_IFLAGS_KEY_RANGE;
+	}
+
+	dnet_iterator_request request{
+		DNET_ITYPE_DISK,
+		flags,
+		key_ranges,
+		time_range,
+	};
+
+	return send_iterator_request(*this, addr, backend_id, request);
+}
+
+static async_iterator_result send_iterator_action(session &sess, const address &addr, uint32_t backend_id,
+                                                  uint64_t iterator_id, dnet_iterator_action action) {
+	dnet_iterator_request request;
+	request.iterator_id = iterator_id;
+	request.action = action;
+
+	return send_iterator_request(sess, addr, backend_id, request);
+}
+
+async_iterator_result session::pause_iterator(const address &addr, uint32_t backend_id, uint64_t iterator_id) {
+	trace_scope scope{*this};
+	return send_iterator_action(*this, addr, backend_id, iterator_id, DNET_ITERATOR_ACTION_PAUSE);
+}
+
+async_iterator_result session::continue_iterator(const address &addr, uint32_t backend_id, uint64_t iterator_id) {
+	trace_scope scope{*this};
+	return send_iterator_action(*this, addr, backend_id, iterator_id, DNET_ITERATOR_ACTION_CONTINUE);
+}
+
+async_iterator_result session::cancel_iterator(const address &addr, uint32_t backend_id, uint64_t iterator_id) {
+	trace_scope scope{*this};
+	return send_iterator_action(*this, addr, backend_id, iterator_id, DNET_ITERATOR_ACTION_CANCEL);
 }
 
 async_iterator_result session::server_send(const std::vector<dnet_raw_id> &keys, uint64_t flags, uint64_t chunk_size,
@@ -1082,22 +1346,31 @@ public:
 			}
 		};
 
-		std::map<remote, std::vector<dnet_raw_id>> remotes_ids;
-		dnet_addr address;
-		int backend_id;
+		std::vector<dnet_id> ids;
+		ids.reserve(keys.size());
 		for (const auto &key: keys) {
 			m_session.transform(key);
-			const int err = dnet_lookup_addr(m_session.get_native(), nullptr, 0, &key.id(), src_group,
-			                                 &address, &backend_id);
-			if (err) {
+			ids.emplace_back(key.id());
+			ids.back().group_id = src_group;
+		}
+
+		std::vector<dnet_addr> addresses(ids.size());
+		std::vector<int> backend_ids(ids.size());
+		std::vector<int> errors(ids.size());
+		const int err = dnet_lookup_addr_batch(m_session.get_native(), ids.data(), ids.size(),
+		                                       addresses.data(), backend_ids.data(), errors.data());
+
+		std::map<remote, std::vector<dnet_raw_id>> remotes_ids;
+		for (size_t i = 0; i < ids.size(); ++i) {
+			if (err || errors[i]) {
 				m_handler.complete(create_error(-ENXIO,
 				                               "server_send: could not locate address & backend for "
 				                               "requested key: %d:%s",
-				                               src_group, dnet_dump_id(&key.id())));
+				                               src_group, dnet_dump_id(&ids[i])));
 				return;
 			}
 
-			remotes_ids[remote{address, backend_id}].emplace_back(key.raw_id());
+			remotes_ids[remote{addresses[i], backend_ids[i]}].emplace_back(keys[i].raw_id());
 		}
 
 		std::vector<async_iterator_result> results;
@@ -1426,11 +1699,19 @@ public:
 			if (m_session.get_trace_bit())
 				cmd.flags |= DNET_FLAGS_TRACE_BIT;
 
-			for (const auto &id : m_keys) {
-				const int err = dnet_lookup_addr(m_session.get_native(), nullptr, 0, &id, id.group_id,
-				                                 &address, nullptr);
+			std::vector<dnet_addr> addresses(m_keys.size());
+			std::vector<int> errors(m_keys.size());
+			const int batch_err = dnet_lookup_addr_batch(m_session.get_native(), m_keys.data(), m_keys.size(),
+			                                             addresses.data(), nullptr, errors.data());
+			if (batch_err) {
+				errors.assign(m_keys.size(), batch_err);
+			}
+
+			for (size_t i = 0; i < m_keys.size(); ++i) {
+				const auto &id = m_keys[i];
+				const int err = errors[i];
 				if (!err) {
-					remotes_ids[address].emplace_back(id);
+					remotes_ids[addresses[i]].emplace_back(id);
 				} else {
 					memset(&address, 0, sizeof(address));
 					cmd.id = id;
@@ -1556,6 +1837,12 @@ async_remove_result send_bulk_remove(session &session, const std::vector<std::pa
 
 	trace_scope scope{session}; 
 
+	for (const auto &key : keys) {
+		dnet_raw_id id;
+		memcpy(id.id, key.first.id, DNET_ID_SIZE);
+		dnet_read_cache_invalidate(session.get_native_node(), id);
+	}
+
 	async_remove_result result(session);
 	auto handler = std::make_shared<bulk_remove_handler>(result, session, keys);
 	handler->start();
@@ -1566,4 +1853,92 @@ async_remove_result session::bulk_remove(const std::vector<std::pair<dnet_id, dn
 	return send_bulk_remove(*this, keys);
 }
 
+async_write_result send_bulk_write(session &session, const std::vector<bulk_write_entry> &entries) {
+	trace_scope scope{session};
+
+	for (const auto &entry : entries) {
+		dnet_raw_id id;
+		memcpy(id.id, entry.key.id, DNET_ID_SIZE);
+		dnet_read_cache_invalidate(session.get_native_node(), id);
+	}
+
+	async_write_result result(session);
+	auto handler = std::make_shared<bulk_write_handler>(result, session);
+	handler->start(entries);
+	return result;
+}
+
+async_write_result session::bulk_write(const std::vector<bulk_write_record> &records) {
+	auto on_fail = [this](const error_info &error) {
+		async_write_result result(*this);
+		async_result_handler<write_result_entry> handler(result);
+		handler.complete(error);
+		return result;
+	};
+
+	const dnet_write_request base_request = [this] () {
+		auto request = create_write_request(*this);
+		request.ioflags |= DNET_IO_FLAGS_PREPARE |
+		                   DNET_IO_FLAGS_COMMIT |
+		                   DNET_IO_FLAGS_PLAIN_WRITE;
+		request.ioflags &= ~DNET_IO_FLAGS_UPDATE_JSON;
+		return request;
+	} ();
+
+	auto session_json_timestamp = get_json_timestamp();
+	const bool has_json_timestamp = !dnet_time_is_empty(&session_json_timestamp);
+
+	std::vector<bulk_write_entry> entries;
+	entries.reserve(records.size());
+
+	for (const auto &record : records) {
+		try {
+			validate_json(record.json.to_string());
+		} catch (const std::exception &e) {
+			return on_fail(create_error(-EINVAL, "invalid json of key: %s: %s",
+			                            dnet_dump_id(&record.key), e.what()));
+		}
+
+		const uint64_t json_capacity = record.json_capacity ? record.json_capacity : record.json.size();
+		const uint64_t data_capacity = record.data_capacity ? record.data_capacity : record.data.size();
+
+		if (json_capacity < record.json.size()) {
+			return on_fail(create_error(-EINVAL,
+			                            "%s: json_capacity (%llu) is less than json.size() (%llu)",
+			                            dnet_dump_id(&record.key),
+			                            (unsigned long long)json_capacity,
+			                            (unsigned long long)record.json.size()));
+		}
+
+		if (data_capacity < record.data.size()) {
+			return on_fail(create_error(-EINVAL,
+			                            "%s: data_capacity (%llu) is less than data.size() (%llu)",
+			                            dnet_dump_id(&record.key),
+			                            (unsigned long long)data_capacity,
+			                            (unsigned long long)record.data.size()));
+		}
+
+		auto request = base_request;
+		request.json_capacity = json_capacity;
+		request.data_offset = 0;
+		request.data_commit_size = record.data.size();
+		request.data_capacity = data_capacity;
+
+		auto timestamp = record.timestamp;
+		if (!dnet_time_is_empty(&timestamp)) {
+			request.timestamp = timestamp;
+			/* like session::write(), json timestamp follows data timestamp unless it is specified */
+			if (!has_json_timestamp)
+				request.json_timestamp = timestamp;
+		}
+		auto json_timestamp = record.json_timestamp;
+		if (!dnet_time_is_empty(&json_timestamp))
+			request.json_timestamp = json_timestamp;
+
+		entries.emplace_back(bulk_write_entry{record.key, request, record.json, record.data});
+	}
+
+	return send_bulk_write(*this, entries);
+}
+
 }}} // ioremap::elliptics::newapi
@@ -124,4 +124,26 @@ dnet_node *node::get_native() const
 	return m_data ? m_data->node_ptr : NULL;
 }
 
+void node::set_read_cache(uint64_t max_size, uint64_t ttl_ms)
+{
+	if (m_data->read_cache) {
+		m_data->read_cache->configure(max_size, ttl_ms);
+		return;
+	}
+
+	m_data->read_cache.reset(new dnet_read_cache(max_size, ttl_ms));
+	m_data->node_ptr->read_cache = m_data->read_cache.get();
+}
+
+read_cache_stats node::get_read_cache_stats() const
+{
+	if (!m_data->read_cache) {
+		read_cache_stats stats;
+		memset(&stats, 0, sizeof(stats));
+		return stats;
+	}
+
+	return m_data->read_cache->stats();
+}
+
 } } // namespace ioremap::elliptics
@@ -20,6 +20,8 @@
 
 #include "library/logger.hpp"
 
+#include "bindings/cpp/newapi/read_cache.hpp"
+
 namespace ioremap { namespace elliptics {
 
 class node_data {
@@ -41,6 +43,8 @@ public:
 	struct dnet_node *node_ptr;
 	std::unique_ptr<trace_wrapper_t> logger;
 	std::unique_ptr<trace_wrapper_t> access_logger;
+	/* it is destroyed after dnet_node_destroy(), so io threads never see freed cache */
+	std::unique_ptr<dnet_read_cache> read_cache;
 	bool destroy_node;
 };
 
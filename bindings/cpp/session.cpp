@@ -764,6 +764,194 @@ async_read_result session::read_data(const key &id, uint64_t offset, uint64_t si
 	return read_data(id, std::move(groups), offset, size);
 }
 
+/* number of times single chunk of parallel upload/download is sent again after failure */
+static const int parallel_chunk_retry_count = 3;
+
+struct parallel_read_handler : public std::enable_shared_from_this<parallel_read_handler> {
+	parallel_read_handler(const async_read_result::handler &handler, const session &sess, const key &id,
+			std::vector<int> &&groups, uint64_t offset, uint64_t size, uint64_t chunk_size, size_t window)
+		: handler(handler)
+		, sess(sess.clone())
+		, id(id)
+		, groups(std::move(groups))
+		, offset(offset)
+		, size(size)
+		, chunk_size(chunk_size)
+		, window(std::max<size_t>(window, 1))
+		, chunks_count(0)
+		, next_chunk(1)
+		, in_flight(0)
+		, failed(false)
+	{
+	}
+
+	void start() {
+		auto arr = sess.read_data(id, groups, offset, size ? std::min(size, chunk_size) : chunk_size);
+		arr.connect(std::bind(&parallel_read_handler::first_read, shared_from_this(),
+					std::placeholders::_1, std::placeholders::_2));
+	}
+
+	void first_read(const std::vector<read_result_entry> &entries, const error_info &error) {
+		if (error || entries.empty()) {
+			handler.complete(error ? error : create_error(-ENOENT, id, "read_data: no data received"));
+			return;
+		}
+
+		const auto &entry = entries.front();
+		const dnet_io_attr *io = entry.io_attribute();
+		const uint64_t available = io->total_size > offset ? io->total_size - offset : 0;
+		if (size == 0 || size > available)
+			size = available;
+
+		const data_pointer file = entry.file();
+		if (file.size() >= size) {
+			handler.process(entry);
+			handler.complete(error_info());
+			return;
+		}
+
+		/* the rest is read from the group which has answered, other groups are used if it fails */
+		const int group_id = entry.command()->id.group_id;
+		groups.erase(std::remove(groups.begin(), groups.end(), group_id), groups.end());
+		groups.insert(groups.begin(), group_id);
+
+		/* result entry is made up the same way as reply to the single read of the whole range */
+		result = data_pointer::allocate(sizeof(dnet_addr) + sizeof(dnet_cmd) + sizeof(dnet_io_attr) + size);
+		memcpy(result.data(), entry.address(), sizeof(dnet_addr));
+
+		dnet_cmd *cmd = result.skip<dnet_addr>().data<dnet_cmd>();
+		memcpy(cmd, entry.command(), sizeof(dnet_cmd));
+		cmd->size = sizeof(dnet_io_attr) + size;
+		cmd->flags &= ~DNET_FLAGS_MORE;
+
+		dnet_io_attr *result_io = result.skip<dnet_addr>().skip<dnet_cmd>().data<dnet_io_attr>();
+		memcpy(result_io, io, sizeof(dnet_io_attr));
+		result_io->offset = offset;
+		result_io->size = size;
+
+		memcpy(data(0), file.data(), file.size());
+
+		std::vector<std::pair<size_t, int>> requests;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			chunks_count = (size + chunk_size - 1) / chunk_size;
+			requests = schedule();
+		}
+		send(requests);
+	}
+
+	void chunk_read(size_t index, int attempt, const std::vector<read_result_entry> &entries,
+			const error_info &error) {
+		const uint64_t chunk_offset = index * chunk_size;
+		const uint64_t expected = std::min(chunk_size, size - chunk_offset);
+
+		std::vector<std::pair<size_t, int>> requests;
+		bool done = false;
+		error_info fatal;
+
+		if (!error && !entries.empty() && entries.front().file().size() == expected) {
+			const data_pointer file = entries.front().file();
+			memcpy(data(chunk_offset), file.data(), file.size());
+
+			std::lock_guard<std::mutex> guard(lock);
+			if (failed)
+				return;
+			--in_flight;
+			requests = schedule();
+			done = in_flight == 0 && next_chunk == chunks_count;
+		} else {
+			std::lock_guard<std::mutex> guard(lock);
+			if (failed)
+				return;
+
+			if (attempt < parallel_chunk_retry_count) {
+				requests.emplace_back(index, attempt + 1);
+			} else {
+				failed = true;
+				fatal = error ? error : create_error(-EIO, id,
+						"read_data: chunk %zu could not be read from any group", index);
+			}
+		}
+
+		if (fatal) {
+			handler.complete(fatal);
+			return;
+		}
+
+		if (done) {
+			auto data = std::make_shared<callback_result_data>();
+			data->data = result;
+			callback_result_entry entry(data);
+			handler.process(*static_cast<const read_result_entry *>(&entry));
+			handler.complete(error_info());
+			return;
+		}
+
+		send(requests);
+	}
+
+	/* must be called under the lock */
+	std::vector<std::pair<size_t, int>> schedule() {
+		std::vector<std::pair<size_t, int>> requests;
+		while (in_flight < window && next_chunk < chunks_count) {
+			requests.emplace_back(next_chunk++, 0);
+			++in_flight;
+		}
+		return requests;
+	}
+
+	void send(const std::vector<std::pair<size_t, int>> &requests) {
+		for (auto it = requests.begin(); it != requests.end(); ++it) {
+			const uint64_t chunk_offset = it->first * chunk_size;
+			auto arr = sess.clone().read_data(id, groups, offset + chunk_offset,
+					std::min(chunk_size, size - chunk_offset));
+			arr.connect(std::bind(&parallel_read_handler::chunk_read, shared_from_this(),
+						it->first, it->second, std::placeholders::_1, std::placeholders::_2));
+		}
+	}
+
+	char *data(uint64_t chunk_offset) {
+		return result.skip<dnet_addr>().skip<dnet_cmd>().skip<dnet_io_attr>().data<char>() + chunk_offset;
+	}
+
+	async_read_result::handler handler;
+	session sess;
+
+	key id;
+	std::vector<int> groups;
+	const uint64_t offset;
+	uint64_t size;
+	const uint64_t chunk_size;
+	const size_t window;
+	data_pointer result;
+
+	std::mutex lock;
+	size_t chunks_count;
+	size_t next_chunk;
+	size_t in_flight;
+	bool failed;
+};
+
+async_read_result session::read_data(const key &id, uint64_t offset, uint64_t size, uint64_t chunk_size,
+		size_t window)
+{
+	trace_scope scope{*this};
+	if (chunk_size == 0 || (size != 0 && size <= chunk_size))
+		return read_data(id, offset, size);
+
+	DNET_SESSION_GET_GROUPS(async_read_result);
+	transform(id);
+
+	async_read_result res(*this);
+	async_read_result::handler handler(res);
+
+	auto rh = std::make_shared<parallel_read_handler>(handler, *this, id, std::move(groups),
+			offset, size, chunk_size, window);
+	rh->start();
+
+	return res;
+}
+
 // It could be a lambda functor! :`(
 struct read_latest_callback
 {
@@ -812,6 +1000,53 @@ async_read_result session::read_latest(const key &id, uint64_t offset, uint64_t
 	return result;
 }
 
+/*
+ * Classic writes and removes drop newapi read cache of the key like newapi ones do: before sending the request
+ * and after its completion, so reads racing with them don't refill the cache with old data.
+ */
+template <typename T>
+struct read_cache_invalidator : public std::enable_shared_from_this<read_cache_invalidator<T>> {
+	dnet_node *node;
+	dnet_raw_id id;
+	async_result_handler<T> handler;
+
+	read_cache_invalidator(dnet_node *node, const dnet_id &id, const async_result<T> &result)
+	: node(node)
+	, handler(result) {
+		memcpy(this->id.id, id.id, DNET_ID_SIZE);
+	}
+
+	void process(const T &entry) {
+		handler.process(entry);
+	}
+
+	void complete(const error_info &error) {
+		dnet_read_cache_invalidate(node, id);
+		handler.complete(error);
+	}
+};
+
+template <typename T>
+static async_result<T> send_invalidating_read_cache(session &sess, const dnet_id &id,
+                                                    const std::function<async_result<T> ()> &send)
+{
+	dnet_node *node = sess.get_native_node();
+	if (!node->read_cache)
+		return send();
+
+	async_result<T> result(sess);
+	auto invalidator = std::make_shared<read_cache_invalidator<T>>(node, id, result);
+	dnet_read_cache_invalidate(node, invalidator->id);
+
+	auto sent = send();
+	invalidator->handler.set_total(sent.total());
+	sent.connect(
+		std::bind(&read_cache_invalidator<T>::process, invalidator, std::placeholders::_1),
+		std::bind(&read_cache_invalidator<T>::complete, invalidator, std::placeholders::_1)
+	);
+	return result;
+}
+
 async_write_result session::write_data(const dnet_io_control &ctl)
 {
 	trace_scope scope{*this};
@@ -831,7 +1066,9 @@ async_write_result session::write_data(const dnet_io_control &ctl)
 	}
 
 	session sess = clean_clone();
-	return async_result_cast<write_result_entry>(*this, send_to_groups(sess, ctl_copy));
+	return send_invalidating_read_cache<write_result_entry>(*this, ctl_copy.id, [&] () {
+		return async_result_cast<write_result_entry>(*this, send_to_groups(sess, ctl_copy));
+	});
 }
 
 async_write_result session::write_data(const dnet_io_attr &io, const argument_data &file)
@@ -963,6 +1200,175 @@ async_write_result session::write_data(const key &id, const data_pointer &file,
 	return res;
 }
 
+static std::vector<int> entries_groups(const std::vector<write_result_entry> &entries)
+{
+	std::vector<int> groups;
+	for (auto it = entries.begin(); it != entries.end(); ++it) {
+		groups.push_back(it->command()->id.group_id);
+	}
+	return groups;
+}
+
+struct parallel_chunk_handler : public std::enable_shared_from_this<parallel_chunk_handler> {
+	struct chunk_request {
+		size_t index;
+		std::vector<int> groups;
+		int attempt;
+	};
+
+	parallel_chunk_handler(const async_write_result::handler &handler, const session &sess,
+			const key &id, const data_pointer &content,
+			uint64_t remote_offset, uint64_t chunk_size, size_t window)
+		: handler(handler)
+		, sess(sess.clone())
+		, id(id)
+		, content(content)
+		, remote_offset(remote_offset)
+		, chunk_size(chunk_size)
+		, window(std::max<size_t>(window, 1))
+		, chunks_count((content.size() + chunk_size - 1) / chunk_size)
+		, next_chunk(1)
+		, in_flight(0)
+		, failed(false)
+	{
+	}
+
+	void prepared(const std::vector<write_result_entry> &entries, const error_info &error) {
+		if (error) {
+			handler.complete(error);
+			return;
+		}
+
+		std::vector<chunk_request> requests;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			groups = entries_groups(entries);
+			requests = schedule();
+		}
+		send(requests);
+	}
+
+	void written(const chunk_request &request, const std::vector<write_result_entry> &entries,
+			const error_info &error) {
+		std::vector<chunk_request> requests;
+		error_info fatal;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (failed)
+				return;
+
+			const auto succeeded = entries_groups(entries);
+			std::vector<int> failed_groups;
+			for (auto it = request.groups.begin(); it != request.groups.end(); ++it) {
+				if (std::find(succeeded.begin(), succeeded.end(), *it) == succeeded.end())
+					failed_groups.push_back(*it);
+			}
+
+			if (!failed_groups.empty() && request.attempt < parallel_chunk_retry_count) {
+				requests.push_back(chunk_request{request.index, failed_groups, request.attempt + 1});
+			} else {
+				--in_flight;
+				for (auto it = failed_groups.begin(); it != failed_groups.end(); ++it) {
+					groups.erase(std::remove(groups.begin(), groups.end(), *it), groups.end());
+				}
+
+				if (groups.empty()) {
+					failed = true;
+					fatal = error ? error : create_error(-ENXIO, id,
+							"write_data: chunk %zu could not be written to any group", request.index);
+				} else {
+					requests = schedule();
+				}
+			}
+		}
+
+		if (fatal) {
+			handler.complete(fatal);
+			return;
+		}
+		send(requests);
+	}
+
+	void finish(const std::vector<write_result_entry> &entries, const error_info &error) {
+		for (auto it = entries.begin(); it != entries.end(); ++it)
+			handler.process(*it);
+		handler.complete(error);
+	}
+
+	/*
+	 * Fills the window by following plain chunks, the last chunk is written by write_commit()
+	 * only when all previous chunks are acknowledged. Must be called under the lock.
+	 */
+	std::vector<chunk_request> schedule() {
+		std::vector<chunk_request> requests;
+		while (in_flight < window && next_chunk + 1 < chunks_count) {
+			requests.push_back(chunk_request{next_chunk++, groups, 0});
+			++in_flight;
+		}
+
+		if (in_flight == 0 && next_chunk + 1 == chunks_count) {
+			requests.push_back(chunk_request{next_chunk++, groups, 0});
+		}
+		return requests;
+	}
+
+	/* requests are sent without the lock, since their handlers can be called right inside connect() */
+	void send(const std::vector<chunk_request> &requests) {
+		for (auto it = requests.begin(); it != requests.end(); ++it) {
+			const uint64_t offset = it->index * chunk_size;
+
+			session chunk_sess = sess.clone();
+			chunk_sess.set_groups(it->groups);
+
+			if (it->index + 1 == chunks_count) {
+				auto awr = chunk_sess.write_commit(id, content.slice(offset, content.size() - offset),
+						remote_offset + offset, remote_offset + content.size());
+				awr.connect(std::bind(&parallel_chunk_handler::finish, shared_from_this(),
+							std::placeholders::_1, std::placeholders::_2));
+			} else {
+				chunk_sess.set_filter(filters::positive);
+				auto awr = chunk_sess.write_plain(id, content.slice(offset, chunk_size), remote_offset + offset);
+				awr.connect(std::bind(&parallel_chunk_handler::written, shared_from_this(), *it,
+							std::placeholders::_1, std::placeholders::_2));
+			}
+		}
+	}
+
+	async_write_result::handler handler;
+	session sess;
+
+	key id;
+	data_pointer content;
+	const uint64_t remote_offset;
+	const uint64_t chunk_size;
+	const size_t window;
+	const size_t chunks_count;
+
+	std::mutex lock;
+	std::vector<int> groups;
+	size_t next_chunk;
+	size_t in_flight;
+	bool failed;
+};
+
+async_write_result session::write_data(const key &id, const data_pointer &file, uint64_t remote_offset,
+		uint64_t chunk_size, size_t window)
+{
+	trace_scope scope{*this};
+	if (window <= 1 || file.size() <= chunk_size || chunk_size == 0)
+		return write_data(id, file, remote_offset, chunk_size);
+
+	auto awr = write_prepare(id, file.slice(0, chunk_size), remote_offset, remote_offset + file.size());
+
+	async_write_result res(*this);
+	async_write_result::handler handler(res);
+
+	auto ch = std::make_shared<parallel_chunk_handler>(handler, *this, id, file, remote_offset, chunk_size, window);
+	awr.connect(std::bind(&parallel_chunk_handler::prepared, ch, std::placeholders::_1, std::placeholders::_2));
+
+	return res;
+}
+
 // At every iteration ask items to find the latest one
 // Read it, process and write result to all groups
 struct cas_functor : std::enable_shared_from_this<cas_functor>
@@ -1642,7 +2048,9 @@ async_remove_result session::remove(const key &id)
 	ctl.cmd = DNET_CMD_DEL;
 	ctl.cflags = DNET_FLAGS_NEED_ACK;
 
-	return send_to_groups(*this, ctl);
+	return send_invalidating_read_cache<remove_result_entry>(*this, ctl.id, [&] () {
+		return send_to_groups(*this, ctl);
+	});
 }
 
 async_monitor_stat_result session::monitor_stat(uint64_t categories)
@@ -2367,12 +2775,28 @@ async_iterator_result session::server_send(const std::vector<key> &keys, uint64_
 		}
 	};
 
+	std::vector<dnet_id> local_ids;
+	local_ids.reserve(keys.size());
+	for (auto key_it = keys.begin(), id_end = keys.end(); key_it != id_end; ++key_it) {
+		local_ids.push_back(key_it->id());
+		local_ids.back().group_id = local_group;
+	}
+
+	std::vector<dnet_addr> addrs(local_ids.size());
+	std::vector<int> backend_ids(local_ids.size());
+	std::vector<int> errors(local_ids.size());
+	err = dnet_lookup_addr_batch(get_native(), local_ids.data(), local_ids.size(),
+			addrs.data(), backend_ids.data(), errors.data());
+
 	std::map<la, std::vector<dnet_raw_id>> raw_ids;
 	for (auto key_it = keys.begin(), id_end = keys.end(); key_it != id_end; ++key_it) {
+		const size_t index = key_it - keys.begin();
 		la l;
 
-		err = dnet_lookup_addr(get_native(), NULL, 0, &key_it->id(), local_group, &l.addr, &l.backend_id);
-		if (err != 0) {
+		l.addr = addrs[index];
+		l.backend_id = backend_ids[index];
+
+		if (err != 0 || errors[index] != 0) {
 			l.id = key_it->id();
 			l.id.group_id = local_group;
 
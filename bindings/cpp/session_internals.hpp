@@ -22,10 +22,22 @@
 
 #include "elliptics/newapi/result_entry.hpp"
 
+#include "library/protocol.hpp"
+
 namespace ioremap { namespace elliptics { namespace newapi {
 
+/* Record of send_bulk_write(): @json and @data written to @key as described by @request */
+struct bulk_write_entry {
+	dnet_id key;
+	dnet_write_request request;
+	data_pointer json;
+	data_pointer data;
+};
+
 async_read_result send_bulk_read(session &sess, const std::vector<dnet_id> &keys, uint64_t read_flags);
 async_remove_result send_bulk_remove(session &session, const std::vector<std::pair<dnet_id, dnet_time>> &keys);
+/* Sends @entries by DNET_CMD_BULK_WRITE_NEW, one request per node, result contains one entry per record */
+async_write_result send_bulk_write(session &session, const std::vector<bulk_write_entry> &entries);
 
 }}} // namespace ioremap::elliptics::newapi
 
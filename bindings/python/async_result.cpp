@@ -152,6 +152,20 @@ struct def_async_result<T> {
 			     "            print 'The operation failed: {0}'\n"
 			     "                  .format(error)\n"
 			     "    async_result.connect(rhandler, fhandler)")
+			.def("connect_batch", &python_async_result<T>::connect_batch,
+			     (bp::arg("batch_handler"), bp::arg("final_handler"), bp::arg("batch_size") = 1024),
+			     "connect_batch(batch_handler, final_handler, batch_size=1024)\n"
+			     "    Sets callbacks:\n"
+			     "        batch_handler will be called with list of up to batch_size results\n"
+			     "        final_handler will be called once after all results\n"
+			     "    Results are accumulated without GIL and GIL is taken once per batch,\n"
+			     "    so it is preferable to connect() for operations with many results\n\n"
+			     "    def bhandler(results):\n"
+			     "        for result in results:\n"
+			     "            print 'The operation result:', result\n"
+			     "    def fhandler(error):\n"
+			     "        print 'The operation completed: {0}'.format(error)\n"
+			     "    async_result.connect_batch(bhandler, fhandler, 100)")
 			.def("connect", &python_async_result<T>::connect_all,
 			     (bp::arg("handler")),
 			     "connect(result_handler)\n"
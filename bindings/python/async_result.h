@@ -22,6 +22,10 @@
 #include <boost/python/str.hpp>
 #include <boost/python/errors.hpp>
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 #include <elliptics/result_entry.hpp>
 #include <elliptics/newapi/result_entry.hpp>
 
@@ -89,6 +93,69 @@ struct callback_one_handlers {
 	std::unique_ptr<bp::api::object> final_handler;
 };
 
+/*
+ * Accumulates results without GIL and hands them to python by lists of @batch_size results,
+ * so GIL is acquired once per batch instead of once per result.
+ */
+template <typename T>
+struct callback_batch_handlers {
+	ELLIPTICS_DISABLE_COPY(callback_batch_handlers)
+
+	callback_batch_handlers(bp::api::object &result, bp::api::object &final, size_t size)
+	: batch_size(std::max<size_t>(size, 1)) {
+		result_handler.reset(new bp::api::object(result));
+		final_handler.reset(new bp::api::object(final));
+		results.reserve(batch_size);
+	}
+
+	~callback_batch_handlers() {
+		gil_guard gstate;
+		result_handler.reset();
+		final_handler.reset();
+	}
+
+	void on_result(const T &result) {
+		std::vector<T> batch;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			results.push_back(result);
+			if (results.size() < batch_size)
+				return;
+			batch.swap(results);
+			results.reserve(batch_size);
+		}
+
+		gil_guard gstate;
+		try {
+			(*result_handler)(convert_to_list(batch));
+		} catch (const bp::error_already_set& e) {}
+	}
+
+	void on_final(const error_info &err) {
+		std::vector<T> batch;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			batch.swap(results);
+		}
+
+		gil_guard gstate;
+		if (!batch.empty()) {
+			try {
+				(*result_handler)(convert_to_list(batch));
+			} catch (const bp::error_already_set& e) {}
+		}
+		try {
+			(*final_handler)(error(err.code(), err.message()));
+		} catch (const bp::error_already_set& e) {}
+	}
+
+	const size_t batch_size;
+	std::mutex lock;
+	std::vector<T> results;
+	std::unique_ptr<bp::api::object> result_handler;
+	std::unique_ptr<bp::api::object> final_handler;
+};
+
 template <typename T>
 struct python_async_result {
 	class iterator : public std::iterator<std::input_iterator_tag, T, std::ptrdiff_t, T *, T> {
@@ -168,6 +235,12 @@ struct python_async_result {
 		               boost::bind(&callback_one_handlers<T>::on_final, callback, _1));
 	}
 
+	void connect_batch(bp::api::object &batch_handler, bp::api::object &final_handler, size_t batch_size) {
+		auto callback = boost::make_shared<callback_batch_handlers<T>>(batch_handler, final_handler, batch_size);
+		scope->connect(boost::bind(&callback_batch_handlers<T>::on_result, callback, _1),
+		               boost::bind(&callback_batch_handlers<T>::on_final, callback, _1));
+	}
+
 	void connect_all(bp::api::object &handler) {
 		auto callback = boost::make_shared<callback_all_handler<T>>(handler);
 		scope->connect(boost::bind(&callback_all_handler<T>::on_results, callback, _1, _2));
@@ -0,0 +1,79 @@
+/*
+* 2018+ Copyright (c) Elliptics contributors
+* All rights reserved.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*/
+
+#include "data_buffer.h"
+
+namespace ioremap { namespace elliptics { namespace python {
+
+namespace {
+
+struct data_buffer_object {
+	PyObject_HEAD
+	data_pointer *data;
+};
+
+void data_buffer_dealloc(PyObject *self) {
+	delete reinterpret_cast<data_buffer_object *>(self)->data;
+	Py_TYPE(self)->tp_free(self);
+}
+
+int data_buffer_getbuffer(PyObject *self, Py_buffer *view, int flags) {
+	data_pointer *data = reinterpret_cast<data_buffer_object *>(self)->data;
+	return PyBuffer_FillInfo(view, self, data->data(), data->size(), 1, flags);
+}
+
+PyBufferProcs data_buffer_procs;
+
+// zero-initialized, it is filled by init_data_buffer() and its type is set by PyType_Ready()
+PyTypeObject data_buffer_type;
+
+} /* unnamed namespace */
+
+bp::object data_pointer_view(const data_pointer &data) {
+	data_buffer_object *obj = PyObject_New(data_buffer_object, &data_buffer_type);
+	if (!obj)
+		bp::throw_error_already_set();
+	obj->data = nullptr;
+
+	bp::object buffer{bp::handle<>(reinterpret_cast<PyObject *>(obj))};
+	obj->data = new data_pointer(data);
+
+	return bp::object(bp::handle<>(PyMemoryView_FromObject(buffer.ptr())));
+}
+
+void init_data_buffer() {
+	data_buffer_procs.bf_getbuffer = data_buffer_getbuffer;
+
+	// static type is never deallocated, so it holds a reference to itself like PyVarObject_HEAD_INIT does
+	reinterpret_cast<PyObject *>(&data_buffer_type)->ob_refcnt = 1;
+	data_buffer_type.tp_name = "elliptics.core.DataBuffer";
+	data_buffer_type.tp_basicsize = sizeof(data_buffer_object);
+	data_buffer_type.tp_dealloc = data_buffer_dealloc;
+	data_buffer_type.tp_as_buffer = &data_buffer_procs;
+#if PY_MAJOR_VERSION < 3
+	data_buffer_type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER;
+#else
+	data_buffer_type.tp_flags = Py_TPFLAGS_DEFAULT;
+#endif
+	data_buffer_type.tp_doc = "Read-only buffer which shares memory of elliptics result without copying it";
+
+	if (PyType_Ready(&data_buffer_type) < 0)
+		bp::throw_error_already_set();
+
+	bp::scope().attr("DataBuffer") = bp::object(bp::handle<>(bp::borrowed(
+		reinterpret_cast<PyObject *>(&data_buffer_type))));
+}
+
+} } } // namespace ioremap::elliptics::python
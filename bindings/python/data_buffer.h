@@ -0,0 +1,38 @@
+/*
+* 2018+ Copyright (c) Elliptics contributors
+* All rights reserved.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*/
+
+#ifndef ELLIPTICS_PYTHON_DATA_BUFFER_HPP
+#define ELLIPTICS_PYTHON_DATA_BUFFER_HPP
+
+#include <boost/python.hpp>
+
+#include <elliptics/utils.hpp>
+
+namespace bp = boost::python;
+
+namespace ioremap { namespace elliptics { namespace python {
+
+/*
+ * Returns read-only memoryview of @data without copying it.
+ * The memoryview exports elliptics.core.DataBuffer which holds a reference to @data,
+ * so underlying memory stays alive while the memoryview or any its slice is alive.
+ */
+bp::object data_pointer_view(const data_pointer &data);
+
+void init_data_buffer();
+
+} } } // namespace ioremap::elliptics::python
+
+#endif // ELLIPTICS_PYTHON_DATA_BUFFER_HPP
@@ -38,6 +38,7 @@
 #include "elliptics_time.h"
 #include "elliptics_io_attr.h"
 #include "elliptics_session.h"
+#include "data_buffer.h"
 
 namespace bp = boost::python;
 
@@ -56,7 +57,9 @@ enum elliptics_iterator_flags {
 	iflag_no_meta		= DNET_IFLAGS_NO_META,
 	iflags_move		= DNET_IFLAGS_MOVE,
 	iflags_overwrite	= DNET_IFLAGS_OVERWRITE,
-	iflags_json		= DNET_IFLAGS_JSON
+	iflags_json		= DNET_IFLAGS_JSON,
+	iflags_filter		= DNET_IFLAGS_FILTER,
+	iflags_batch		= DNET_IFLAGS_BATCH
 };
 
 enum elliptics_cflags {
@@ -409,7 +412,9 @@ BOOST_PYTHON_MODULE(core) {
 	    "overwrite\n    Overwrite data. If this flag is NOT set, we only write data if remote timestamp is less\n"
 	    "               than in data being written. When NOT set, data will still be transferred over the network,\n"
 	    "               even if remote timestamp doesn't allow us to overwrite data.\n"
-	    "json\n    Iteration results should also includes objects json")
+	    "json\n    Iteration results should also includes objects json\n"
+	    "filter\n    Only records matching elliptics.IteratorFilter are sent, it is set by start_iterator with filter\n"
+	    "batch\n    Replies of many records are packed into a single packet, results are still yielded one per record")
 		.value("default", iflag_default)
 		.value("data", iflag_data)
 		.value("key_range", iflag_key_range)
@@ -418,6 +423,8 @@ BOOST_PYTHON_MODULE(core) {
 		.value("move", iflags_move)
 		.value("overwrite", iflags_overwrite)
 		.value("json", iflags_json)
+		.value("filter", iflags_filter)
+		.value("batch", iflags_batch)
 	;
 
 	bp::enum_<elliptics_iterator_types>("iterator_types",
@@ -573,6 +580,7 @@ BOOST_PYTHON_MODULE(core) {
 	;
 
 	init_elliptics_id();
+	init_data_buffer();
 	init_async_results();
 	init_result_entry();
 	init_elliptics_time();
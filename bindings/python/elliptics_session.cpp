@@ -30,6 +30,7 @@
 #include <boost/make_shared.hpp>
 
 #include <elliptics/cppdef.h>
+#include <elliptics/newapi/dc_recovery.hpp>
 
 #include "elliptics_id.h"
 #include "async_result.h"
@@ -803,7 +804,8 @@ public:
 	python_iterator_result start_iterator(const std::string &host, int port, int family, uint32_t backend_id,
 	                                      uint64_t flags,
 	                                      const bp::api::object &key_ranges,
-	                                      const bp::api::object &time_range) {
+	                                      const bp::api::object &time_range,
+	                                      const bp::api::object &filter) {
 		auto std_key_ranges = convert_to_vector<dnet_iterator_range>(key_ranges);
 		auto std_time_range = [&] () {
 			if (time_range.ptr() == Py_None) {
@@ -816,12 +818,58 @@ public:
 
 		} ();
 
+		if (filter.ptr() != Py_None) {
+			const auto &std_filter = bp::extract<const ioremap::elliptics::newapi::iterator_filter &>(filter)();
+			return create_result(
+				newapi::session{*this}.start_iterator(address(host, port, family), backend_id, flags,
+				                                      std_key_ranges, std_time_range, std_filter)
+			);
+		}
+
 		return create_result(
 			newapi::session{*this}.start_iterator(address(host, port, family), backend_id, flags,
 			                                      std_key_ranges, std_time_range)
 		);
 	}
 
+	python_iterator_result start_disk_iterator(const std::string &host, int port, int family, uint32_t backend_id,
+	                                           uint64_t flags,
+	                                           const bp::api::object &key_ranges,
+	                                           const bp::api::object &time_range) {
+		auto std_key_ranges = convert_to_vector<dnet_iterator_range>(key_ranges);
+		auto std_time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+		if (time_range.ptr() != Py_None) {
+			std_time_range = std::make_tuple(bp::extract<const elliptics_time&>(time_range[0])().m_time,
+			                                 bp::extract<const elliptics_time&>(time_range[1])().m_time);
+		}
+
+		return create_result(
+			newapi::session{*this}.start_disk_iterator(address(host, port, family), backend_id, flags,
+			                                           std_key_ranges, std_time_range)
+		);
+	}
+
+	python_iterator_result pause_iterator(const std::string &host, int port, int family, uint32_t backend_id,
+	                                      uint64_t iterator_id) {
+		return create_result(
+			newapi::session{*this}.pause_iterator(address(host, port, family), backend_id, iterator_id)
+		);
+	}
+
+	python_iterator_result continue_iterator(const std::string &host, int port, int family, uint32_t backend_id,
+	                                         uint64_t iterator_id) {
+		return create_result(
+			newapi::session{*this}.continue_iterator(address(host, port, family), backend_id, iterator_id)
+		);
+	}
+
+	python_iterator_result cancel_iterator(const std::string &host, int port, int family, uint32_t backend_id,
+	                                       uint64_t iterator_id) {
+		return create_result(
+			newapi::session{*this}.cancel_iterator(address(host, port, family), backend_id, iterator_id)
+		);
+	}
+
 	python_iterator_result server_send(const bp::api::object &keys, uint64_t flags, uint64_t chunk_size,
 	                                   int src_group, const bp::api::object &dst_groups,
 	                                   uint64_t chunk_write_timeout,
@@ -892,7 +940,71 @@ public:
 			newapi::session{ *this }.bulk_remove(keys)
 		);
 	}
+
+	python_write_result bulk_write(const bp::api::object &list_of_tuples) {
+		std::vector<newapi::bulk_write_record> records;
+		for (bp::stl_input_iterator<bp::tuple> it(list_of_tuples), end; it != end; ++it) {
+			newapi::bulk_write_record record;
+			record.key = bp::extract<elliptics_id>((*it)[0])().id();
+			record.json = data_pointer::copy(bp::extract<std::string>((*it)[1])());
+			record.data = data_pointer::copy(bp::extract<std::string>((*it)[2])());
+			if (bp::len(*it) > 3)
+				record.timestamp = bp::extract<elliptics_time>((*it)[3])().m_time;
+			records.emplace_back(std::move(record));
+		}
+
+		return create_result(
+			newapi::session{*this}.bulk_write(records)
+		);
+	}
 };
+
+bp::tuple dc_recover(const node &n, const bp::api::object &groups, const bp::api::object &ro_groups,
+                     const std::string &tmp_dir, const bp::api::object &bucket_order,
+                     size_t batch_size, uint64_t chunk_size, uint64_t data_flow_rate, int attempts,
+                     uint64_t chunk_write_timeout, uint64_t chunk_commit_timeout,
+                     const elliptics_time &prepare_timeout, trace_id_t trace_id, bool safe, bool dry_run) {
+	dc_recovery_config config;
+	config.groups = convert_to_vector<int>(groups);
+	const auto std_ro_groups = convert_to_vector<int>(ro_groups);
+	config.ro_groups.insert(std_ro_groups.begin(), std_ro_groups.end());
+	config.tmp_dir = tmp_dir;
+	config.bucket_order = convert_to_vector<int>(bucket_order);
+	config.batch_size = batch_size;
+	config.chunk_size = chunk_size;
+	config.data_flow_rate = data_flow_rate;
+	config.attempts = attempts;
+	config.chunk_write_timeout = chunk_write_timeout;
+	config.chunk_commit_timeout = chunk_commit_timeout;
+	config.prepare_timeout = prepare_timeout.m_time;
+	config.trace_id = trace_id;
+	config.safe = safe;
+	config.dry_run = dry_run;
+
+	bool result;
+	dc_recovery_stats stats;
+	{
+		py_allow_threads_scoped pythr;
+		dc_recovery recovery(n, config);
+		result = recovery.recover();
+		stats = recovery.stats();
+	}
+
+	auto convert_counters = [] (const std::map<std::string, int64_t> &counters) {
+		bp::dict ret;
+		for (const auto &counter : counters)
+			ret[counter.first] = counter.second;
+		return ret;
+	};
+
+	bp::dict ret;
+	ret["main"] = convert_counters(stats.main);
+	ret["recover"] = convert_counters(stats.recover);
+	ret["commands"] = convert_counters(stats.commands);
+	ret["commands_by_groups"] = convert_counters(stats.commands_by_groups);
+	ret["processed_keys"] = stats.processed_keys;
+	return bp::make_tuple(result, ret);
+}
 } /* namespace newapi */
 
 void init_elliptics_session() {
@@ -975,6 +1087,24 @@ void init_elliptics_session() {
 		              "range.key_end = elliptics.Id([255] * 64, 1)")
 	;
 
+	bp::class_<ioremap::elliptics::newapi::iterator_filter>("IteratorFilter",
+	    "Used in iteration for skipping records by their metadata on the server side,\n"
+	    "record is sent only if all conditions are true")
+		.def_readwrite("user_flags_mask", &ioremap::elliptics::newapi::iterator_filter::user_flags_mask,
+		               "Record matches if (user_flags & user_flags_mask) == user_flags_value")
+		.def_readwrite("user_flags_value", &ioremap::elliptics::newapi::iterator_filter::user_flags_value)
+		.def_readwrite("record_flags_mask", &ioremap::elliptics::newapi::iterator_filter::record_flags_mask,
+		               "Record matches if (record_flags & record_flags_mask) == record_flags_value")
+		.def_readwrite("record_flags_value", &ioremap::elliptics::newapi::iterator_filter::record_flags_value)
+		.def_readwrite("min_data_size", &ioremap::elliptics::newapi::iterator_filter::min_data_size)
+		.def_readwrite("max_data_size", &ioremap::elliptics::newapi::iterator_filter::max_data_size,
+		               "0 means no upper bound of data size")
+		.def_readwrite("json_key", &ioremap::elliptics::newapi::iterator_filter::json_key,
+		               "If it isn't empty, top-level member json_key of record's json should be equal to json_value")
+		.def_readwrite("json_value", &ioremap::elliptics::newapi::iterator_filter::json_value,
+		               "Json representation of expected value, e.g. '\"value\"' or '42'")
+	;
+
 	bp::class_<elliptics_session, boost::noncopyable>(
 	        "Session",
 	        "The main class which is used for executing operations with elliptics",
@@ -1875,6 +2005,17 @@ void init_elliptics_session() {
 		    "    async = session.bulk_remove(keys)\n"
 		    "    for result in result:\n"
 		    "         assert res.status == 0 \n")
+		.def("bulk_write", &newapi::elliptics_session::bulk_write,
+		    bp::arg("records"),
+		    "bulk_write(records)\n"
+		    "    Write @records by one request per node, records are written with group commit\n"
+		    "    by backends configured with bulk_write_sync.\n"
+		    "    Return elliptics.AsyncResult with a result per record.\n"
+		    "    -- records - list of tuples: elliptics.Id, json, data and optional elliptics.Time\n\n"
+		    "    records = [(elliptics.Id('key', 1), '{}', 'data', elliptics.Time(1, 1))]\n"
+		    "    async = session.bulk_write(records)\n"
+		    "    for result in async:\n"
+		    "        assert result.status == 0\n")
 
 		.def("read_json", &newapi::elliptics_session::read_json,
 		     bp::args("key"),
@@ -1974,15 +2115,16 @@ void init_elliptics_session() {
 
 		.def("start_iterator", &newapi::elliptics_session::start_iterator,
 		     bp::args("host", "port", "family", "backend_id",
-		              "flags", "key_ranges", "time_range"),
-		     "start_iterator(host, port, family, backend_id, flags, key_ranges, time_range)\n"
+		              "flags", "key_ranges", "time_range", "filter"),
+		     "start_iterator(host, port, family, backend_id, flags, key_ranges, time_range, filter)\n"
 		     "    Start iterator on the Elliptics node specified by @host, @port, @family and @backend_id."
 		     "    Return elliptics.AsyncResult.\n"
 		     "    -- host, port, family - the node where iteration should be executed\n"
 		     "    -- backend_id - id of backend where iteration should be executed\n"
 		     "    -- flags - bits set of elliptics.iterator_flags\n"
 		     "    -- key_ranges - list of elliptics.IteratorRange by which keys on the node should be filtered\n"
-		     "    -- time_range - time range by which keys on the node should be filtered\n\n"
+		     "    -- time_range - time range by which keys on the node should be filtered\n"
+		     "    -- filter - elliptics.IteratorFilter applied to records' metadata on the node or None\n\n"
 		     "    flags = elliptics.iterator_flags.key_range\n"
 		     "    range = elliptics.IteratorRange()\n"
 		     "    range.key_begin = elliptics.Id([0] * 64, 1)\n"
@@ -2007,6 +2149,37 @@ void init_elliptics_session() {
 		     "                       result.record_info.data_timestamp,\n"
 		     "                       result.json))\n")
 
+		.def("start_disk_iterator", &newapi::elliptics_session::start_disk_iterator,
+		     bp::args("host", "port", "family", "backend_id", "flags", "key_ranges", "time_range"),
+		     "start_disk_iterator(host, port, family, backend_id, flags, key_ranges, time_range)\n"
+		     "    Start iterator which collects and sorts records' metadata on the node specified by\n"
+		     "    @host, @port, @family and @backend_id. Return elliptics.AsyncResult, whose results carry\n"
+		     "    chunks of the sorted container, they are appended by\n"
+		     "    elliptics.core.newapi.IteratorResultContainer.append_sorted_chunk().\n\n"
+		     "    container = elliptics.core.newapi.IteratorResultContainer(fd)\n"
+		     "    for result in session.start_disk_iterator(\n"
+		     "            host='host.com', port=1025, family=10, backend_id=1,\n"
+		     "            flags=0, key_ranges=[], time_range=None):\n"
+		     "        container.append_sorted_chunk(result)\n")
+
+		.def("pause_iterator", &newapi::elliptics_session::pause_iterator,
+		     bp::args("host", "port", "family", "backend_id", "iterator_id"),
+		     "pause_iterator(host, port, family, backend_id, iterator_id)\n"
+		     "    Pause iterator @iterator_id started by start_iterator() on the node specified by\n"
+		     "    @host, @port, @family and @backend_id. Return elliptics.AsyncResult.\n")
+
+		.def("continue_iterator", &newapi::elliptics_session::continue_iterator,
+		     bp::args("host", "port", "family", "backend_id", "iterator_id"),
+		     "continue_iterator(host, port, family, backend_id, iterator_id)\n"
+		     "    Continue paused iterator @iterator_id on the node specified by\n"
+		     "    @host, @port, @family and @backend_id. Return elliptics.AsyncResult.\n")
+
+		.def("cancel_iterator", &newapi::elliptics_session::cancel_iterator,
+		     bp::args("host", "port", "family", "backend_id", "iterator_id"),
+		     "cancel_iterator(host, port, family, backend_id, iterator_id)\n"
+		     "    Cancel iterator @iterator_id on the node specified by\n"
+		     "    @host, @port, @family and @backend_id. Return elliptics.AsyncResult.\n")
+
 		.def("server_send", &newapi::elliptics_session::server_send,
 		     (bp::arg("keys"), bp::arg("flags"), bp::arg("chunk_size"), bp::arg("src_group"),
 		      bp::arg("dst_groups"),
@@ -2066,6 +2239,22 @@ void init_elliptics_session() {
 		    "                       read_result.data,\n"
 		    "                       read_result.status))\n")
 	;
+
+	bp::def("dc_recover", newapi::dc_recover,
+	        (bp::arg("node"), bp::arg("groups"), bp::arg("ro_groups"), bp::arg("tmp_dir"),
+	         bp::arg("bucket_order"), bp::arg("batch_size"), bp::arg("chunk_size"),
+	         bp::arg("data_flow_rate"), bp::arg("attempts"), bp::arg("chunk_write_timeout"),
+	         bp::arg("chunk_commit_timeout"), bp::arg("prepare_timeout"), bp::arg("trace_id"),
+	         bp::arg("safe"), bp::arg("dry_run")),
+	        "dc_recover(node, groups, ro_groups, tmp_dir, bucket_order, batch_size, chunk_size,\n"
+	        "           data_flow_rate, attempts, chunk_write_timeout, chunk_commit_timeout,\n"
+	        "           prepare_timeout, trace_id, safe, dry_run)\n"
+	        "    Recovers keys of bucket_<group> files of @tmp_dir (in @bucket_order) by server_send and\n"
+	        "    keys of rest_keys file by reading and writing them, see ioremap::elliptics::newapi::dc_recovery.\n"
+	        "    Parameters have the same meaning as dnet_recovery's options, GIL is released while recovery\n"
+	        "    is running. Returns tuple of result and dict with main, recover, commands and\n"
+	        "    commands_by_groups counters of dnet_recovery's stats and processed_keys")
+	;
 }
 
 } } } // namespace ioremap::elliptics::python
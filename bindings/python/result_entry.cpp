@@ -27,6 +27,8 @@
 #include "elliptics_time.h"
 #include "elliptics_io_attr.h"
 #include "py_converters.h"
+#include "gil_guard.h"
+#include "data_buffer.h"
 
 namespace bp = boost::python;
 
@@ -55,6 +57,11 @@ std::string read_result_get_data(read_result_entry &result)
 	return result.file().to_string();
 }
 
+bp::object read_result_get_data_view(read_result_entry &result)
+{
+	return data_pointer_view(result.file());
+}
+
 elliptics_id read_result_get_id(read_result_entry &result)
 {
 	dnet_raw_id id;
@@ -327,6 +334,22 @@ bp::object read_result_get_data(const newapi::read_result_entry &result) {
 	return bp::object(result.data().to_string());
 }
 
+bp::object read_result_get_json_view(const newapi::read_result_entry &result) {
+	if (result.status()) {
+		return bp::object();
+	}
+
+	return data_pointer_view(result.json());
+}
+
+bp::object read_result_get_data_view(const newapi::read_result_entry &result) {
+	if (result.status()) {
+		return bp::object();
+	}
+
+	return data_pointer_view(result.data());
+}
+
 uint64_t iterator_result_get_iterator_id(const newapi::iterator_result_entry &result) {
 	return result.iterator_id();
 }
@@ -343,6 +366,10 @@ uint64_t iterator_result_get_total_keys(const newapi::iterator_result_entry &res
 	return result.total_keys();
 }
 
+uint64_t iterator_result_get_filtered_keys(const newapi::iterator_result_entry &result) {
+	return result.filtered_keys();
+}
+
 elliptics_id iterator_result_get_key(const newapi::iterator_result_entry &result) {
 	auto key = result.key();
 	return elliptics_id(key);
@@ -364,6 +391,10 @@ std::string iterator_result_get_data(const newapi::iterator_result_entry &result
 	return result.data().to_string();
 }
 
+bp::object iterator_result_get_data_view(const newapi::iterator_result_entry &result) {
+	return data_pointer_view(result.data());
+}
+
 void iterator_container_append(newapi::iterator_result_container &container, newapi::iterator_result_entry &result) {
 	container.append(result);
 }
@@ -372,6 +403,11 @@ void iterator_container_append_old(newapi::iterator_result_container &container,
 	container.append_old(result);
 }
 
+void iterator_container_append_sorted_chunk(newapi::iterator_result_container &container,
+                                            newapi::iterator_result_entry &result) {
+	container.append_sorted_chunk(result);
+}
+
 void iterator_container_sort(newapi::iterator_result_container &container) {
 	container.sort();
 }
@@ -388,6 +424,40 @@ iterator_container_item iterator_container_getitem(const newapi::iterator_result
 	return container[n];
 }
 
+void iterator_merger_add_source(newapi::iterator_result_merger &merger,
+                                const newapi::iterator_result_container &container,
+                                const std::string &host, int port, int family,
+                                uint32_t backend_id, int group_id) {
+	merger.add_source(newapi::iterator_merge_source{container, host, port, family, backend_id, group_id});
+}
+
+bp::dict iterator_merger_merge(const newapi::iterator_result_merger &merger, const std::string &filename,
+                               const bp::api::object &groups, const bp::api::object &user_flags_set) {
+	const auto std_groups = convert_to_vector<int>(groups);
+	const auto std_user_flags = convert_to_vector<uint64_t>(user_flags_set);
+
+	newapi::iterator_merge_stats stats;
+	{
+		py_allow_threads_scoped pythr;
+		stats = merger.merge(filename, std_groups,
+		                     std::set<uint64_t>(std_user_flags.begin(), std_user_flags.end()));
+	}
+
+	auto convert_counters = [] (const std::map<int, uint64_t> &counters) {
+		bp::dict ret;
+		for (const auto &counter : counters)
+			ret[counter.first] = counter.second;
+		return ret;
+	};
+
+	bp::dict ret;
+	ret["total_keys"] = stats.total_keys;
+	ret["written_keys"] = stats.written_keys;
+	ret["missing_keys"] = convert_counters(stats.missing_keys);
+	ret["stale_keys"] = convert_counters(stats.stale_keys);
+	return ret;
+}
+
 elliptics_id iterator_container_item_key(const newapi::iterator_container_item &item) {
 	return elliptics_id(item.key);
 }
@@ -456,6 +526,8 @@ void init_result_entry() {
 	bp::class_<read_result_entry, bp::bases<callback_result_entry> >("ReadResultEntry")
 		.add_property("data", read_result_get_data,
 		              "Read data")
+		.add_property("data_view", read_result_get_data_view,
+		              "Read data as read-only memoryview which shares memory of the result without copying")
 		.add_property("id", read_result_get_id,
 		              "elliptics.Id of read object")
 		.add_property("timestamp", read_result_get_timestamp,
@@ -587,6 +659,10 @@ void init_result_entry() {
 		              "Read json if it was requested otherwise it is empty string.")
 		.add_property("data", newapi::read_result_get_data,
 		              "Read data if it was requested otherwise it is empty string.")
+		.add_property("json_view", newapi::read_result_get_json_view,
+		              "Read json as read-only memoryview which shares memory of the result without copying.")
+		.add_property("data_view", newapi::read_result_get_data_view,
+		              "Read data as read-only memoryview which shares memory of the result without copying.")
 	;
 
 	bp::class_<newapi::iterator_result_entry, bp::bases<newapi::callback_result_entry>>("IteratorResultEntry",
@@ -604,6 +680,9 @@ void init_result_entry() {
 		.add_property("total_keys", newapi::iterator_result_get_total_keys,
 		              "Total number of keys which expected to be iterated. "
 		              "It isn't true when some filtering is on, for example, filtering by key-range.")
+		.add_property("filtered_keys", newapi::iterator_result_get_filtered_keys,
+		              "Number of keys skipped by elliptics.IteratorFilter at the moment of this key iteration, "
+		              "the last result of filtered iteration reports it for the whole iteration.")
 		.add_property("key", newapi::iterator_result_get_key,
 		              "elliptics.Id of iterated key.")
 		.add_property("record_info", newapi::iterator_result_get_record_info,
@@ -614,6 +693,9 @@ void init_result_entry() {
 		              "Json of iterated key if appropriate flag was set otherwise it is empty string.")
 		.add_property("data", newapi::iterator_result_get_data,
 		              "Data of iterated key if appropriate flag was set otherwise it is empty string.")
+		.add_property("data_view", newapi::iterator_result_get_data_view,
+		              "Data of iterated key as read-only memoryview which shares memory of the result "
+		              "without copying.")
 	;
 
 	bp::class_<newapi::iterator_container_item>("IteratorContainerItem",
@@ -658,6 +740,11 @@ void init_result_entry() {
 		     (bp::arg("iterator_result_entry")),
 		     "append_old(iterator_result_entry)\n"
 		     "    Appends iterator_result_entry of type elliptics.core.IteratorResultEntry to the end of the container file")
+		.def("append_sorted_chunk", newapi::iterator_container_append_sorted_chunk,
+		     (bp::arg("iterator_result_entry")),
+		     "append_sorted_chunk(iterator_result_entry)\n"
+		     "    Appends chunk of sorted items sent by elliptics.newapi.Session.start_disk_iterator()\n"
+		     "    to the end of the container file, the container stays sorted")
 		.def("sort", newapi::iterator_container_sort,
 		     "sort()\n"
 		     "    Sorts items of the container file by (key, data_timestamp, json_timestamp, data_size) tuple")
@@ -669,6 +756,24 @@ void init_result_entry() {
 		     "x.__getitem__(n) <==> x[n]\n"
 		     "    Returns n-th item of the container file of type elliptics.core.newapi.IteratorContainerItem")
 	;
+
+	bp::class_<newapi::iterator_result_merger>("IteratorResultMerger",
+			bp::init<>())
+		.def("add_source", newapi::iterator_merger_add_source,
+		     (bp::arg("container"), bp::arg("host"), bp::arg("port"), bp::arg("family"),
+		      bp::arg("backend_id"), bp::arg("group_id")),
+		     "add_source(container, host, port, family, backend_id, group_id)\n"
+		     "    Adds sorted elliptics.core.newapi.IteratorResultContainer of the backend @backend_id\n"
+		     "    of the node @host, @port, @family from the group @group_id")
+		.def("merge", newapi::iterator_merger_merge,
+		     (bp::arg("filename"), bp::arg("groups"), bp::arg("user_flags_set")),
+		     "merge(filename, groups, user_flags_set)\n"
+		     "    Merges containers by keys and writes keys which need recovery to @filename in format of\n"
+		     "    recovery's dump_key_data(). Key is skipped if it is committed in all @groups with the same\n"
+		     "    timestamp, size and user_flags or none of its replicas has user_flags from non-empty\n"
+		     "    @user_flags_set. Returns dict with total_keys, written_keys and per group counters\n"
+		     "    of written keys missing_keys and stale_keys")
+	;
 }
 
 } } } // namespace ioremap::elliptics::python
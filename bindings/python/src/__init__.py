@@ -18,7 +18,7 @@ from __future__ import absolute_import
 from elliptics.core import ErrorInfo, iterator_flags, monitor_stat_categories
 from elliptics.core import iterator_types, command_flags, io_flags, log_level, record_flags
 from elliptics.core import exceptions_policy, config_flags
-from elliptics.core import Time, IoAttr, status_flags, Range, IteratorRange
+from elliptics.core import Time, IoAttr, status_flags, Range, IteratorRange, IteratorFilter
 from elliptics.core import Error, NotFoundError, TimeoutError, filters, checkers
 from elliptics.route import Address, Route, RouteList
 from elliptics.session import Session
@@ -261,12 +261,50 @@ class Session(elliptics.core.newapi.Session):
             backends = list(backends)
         return super(Session, self).monitor_stat(address, categories, backends)
 
-    def start_iterator(self, address, backend_id, flags, key_ranges=None, time_range=None):
-        """Start iterator on node @address and backend @backend_id."""
+    def start_iterator(self, address, backend_id, flags, key_ranges=None, time_range=None, filter=None):
+        """Start iterator on node @address and backend @backend_id.
+        Only records matching elliptics.IteratorFilter @filter are sent if it is set,
+        then the last result has no key and reports filtered_keys of the whole iteration."""
         return super(Session, self).start_iterator(host=address.host,
                                                    port=address.port,
                                                    family=address.family,
                                                    backend_id=backend_id,
                                                    flags=flags,
                                                    key_ranges=key_ranges,
-                                                   time_range=time_range)
+                                                   time_range=time_range,
+                                                   filter=filter)
+
+    def start_disk_iterator(self, address, backend_id, flags, key_ranges=None, time_range=None):
+        """Start iterator on node @address and backend @backend_id which sorts records' metadata on the node.
+        Its results are appended by elliptics.core.newapi.IteratorResultContainer.append_sorted_chunk()."""
+        return super(Session, self).start_disk_iterator(host=address.host,
+                                                        port=address.port,
+                                                        family=address.family,
+                                                        backend_id=backend_id,
+                                                        flags=flags,
+                                                        key_ranges=key_ranges,
+                                                        time_range=time_range)
+
+    def pause_iterator(self, address, backend_id, iterator_id):
+        """Pause iterator @iterator_id on node @address and backend @backend_id."""
+        return super(Session, self).pause_iterator(host=address.host,
+                                                   port=address.port,
+                                                   family=address.family,
+                                                   backend_id=backend_id,
+                                                   iterator_id=iterator_id)
+
+    def continue_iterator(self, address, backend_id, iterator_id):
+        """Continue paused iterator @iterator_id on node @address and backend @backend_id."""
+        return super(Session, self).continue_iterator(host=address.host,
+                                                      port=address.port,
+                                                      family=address.family,
+                                                      backend_id=backend_id,
+                                                      iterator_id=iterator_id)
+
+    def cancel_iterator(self, address, backend_id, iterator_id):
+        """Cancel iterator @iterator_id on node @address and backend @backend_id."""
+        return super(Session, self).cancel_iterator(host=address.host,
+                                                    port=address.port,
+                                                    family=address.family,
+                                                    backend_id=backend_id,
+                                                    iterator_id=iterator_id)
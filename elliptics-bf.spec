@@ -99,6 +99,7 @@ rm -rf %{buildroot}
 %files devel
 %defattr(-,root,root,-)
 %{_bindir}/dnet_run_servers
+%{_bindir}/dnet_bench
 %{_libdir}/libelliptics.so
 
 %defattr(-,root,root,-)
@@ -111,8 +112,10 @@ rm -rf %{buildroot}
 %{_bindir}/dnet_ioclient
 %{_bindir}/dnet_notify
 %{_bindir}/dnet_ids
+%{_bindir}/dnet_access_log_decode
 %{_bindir}/dnet_balancer
 %{_bindir}/dnet_recovery
+%{_bindir}/dnet_dc_recovery
 %{_bindir}/dnet_client
 %{_libdir}/libelliptics_client.so.*
 %{_libdir}/libelliptics_cpp.so.*
@@ -0,0 +1,130 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Converts binary access log written by server with "binary_access_log" option
+ * into text access log in tskv format with the same attributes as text access log has.
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "elliptics/interface.h"
+#include "elliptics/packet.h"
+
+#include "library/access_log.hpp"
+
+static const char *access_type_string(uint32_t access) {
+	switch (access) {
+	case DNET_ACCESS_SERVER:
+		return "server";
+	case DNET_ACCESS_SERVER_CONTROL:
+		return "server/control";
+	case DNET_ACCESS_SERVER_FORWARD:
+		return "server/forward";
+	case DNET_ACCESS_CLIENT:
+		return "client";
+	default:
+		return "unknown";
+	}
+}
+
+static void print_record(std::ostream &out, const dnet_access_record &record) {
+	out << "tskv"
+	    << "\ttimestamp=" << dnet_print_time(&record.start)
+	    << "\taccess=" << access_type_string(record.access)
+	    << "\tcmd=" << dnet_cmd_string(record.cmd)
+	    << "\tid=" << dnet_dump_id_str(record.id.id)
+	    << "\tgroup=" << record.id.group_id
+	    << "\tbackend_id=" << record.backend_id
+	    << "\ttrans=" << record.trans
+	    << "\tst=" << dnet_addr_string(&record.st)
+	    << "\ttrace_id=" << std::hex << std::setw(16) << std::setfill('0') << record.trace_id
+	    << std::dec << std::setfill(' ')
+	    << "\trequest_cflags=" << dnet_flags_dump_cflags(record.cflags)
+	    << "\trequest_size=" << record.request_size
+	    << "\treceive_time=" << record.receive_time
+	    << "\treceive_queue_time=" << record.receive_queue_time
+	    << "\tstatus=" << record.status
+	    << "\tresponse_size=" << record.response_size
+	    << "\tsend_time=" << record.send_time
+	    << "\tsend_queue_time=" << record.send_queue_time
+	    << "\ttotal_time=" << record.total_time
+	    << '\n';
+}
+
+static int decode(std::istream &in, std::ostream &out, const std::string &name) {
+	try {
+		dnet_access_log_decode(in, [&] (const dnet_access_record &record) {
+			print_record(out, record);
+		});
+	} catch (const std::exception &e) {
+		std::cerr << name << ": " << e.what() << std::endl;
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	std::vector<std::string> files;
+
+	bpo::options_description description("Usage: dnet_access_log_decode [options] [file...]\n"
+	                                      "Converts binary access log into text one, reads stdin if no file is given");
+	description.add_options()
+		("help,h", "this help message")
+		("file", bpo::value<std::vector<std::string>>(&files), "binary access log file");
+
+	bpo::positional_options_description positional;
+	positional.add("file", -1);
+
+	bpo::variables_map vm;
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(description).positional(positional).run(), vm);
+		bpo::notify(vm);
+	} catch (const std::exception &e) {
+		std::cerr << "Invalid options: " << e.what() << "\n" << description << std::endl;
+		return -1;
+	}
+
+	if (vm.count("help")) {
+		std::cout << description << std::endl;
+		return 0;
+	}
+
+	if (files.empty())
+		return decode(std::cin, std::cout, "stdin");
+
+	for (const auto &file : files) {
+		std::ifstream in(file, std::ios::binary);
+		if (!in) {
+			std::cerr << file << ": failed to open" << std::endl;
+			return -ENOENT;
+		}
+
+		const int err = decode(in, std::cout, file);
+		if (err)
+			return err;
+	}
+
+	return 0;
+}
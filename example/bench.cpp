@@ -0,0 +1,755 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Load generator: runs mixed workload against remote cluster (or the local one started by itself)
+ * and reports throughput and latency percentiles of every operation.
+ *
+ * Every worker thread issues requests one by one. If target rate is set, requests are issued
+ * by schedule and latency is measured since scheduled time, so stalls of the cluster are not hidden
+ * by the fact that worker couldn't send the next request in time.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include "elliptics/newapi/session.hpp"
+
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "tests/test_base.hpp"
+
+using namespace ioremap::elliptics;
+
+namespace {
+
+typedef std::chrono::steady_clock clock_type;
+
+enum operation_type {
+	OPERATION_READ = 0,
+	OPERATION_WRITE,
+	OPERATION_LOOKUP,
+	OPERATION_REMOVE,
+	OPERATION_BULK_READ,
+	OPERATION_MAX,
+};
+
+const char *operation_names[OPERATION_MAX] = {"read", "write", "lookup", "remove", "bulk_read"};
+
+operation_type parse_operation(const std::string &name) {
+	for (size_t i = 0; i < OPERATION_MAX; ++i) {
+		if (name == operation_names[i])
+			return static_cast<operation_type>(i);
+	}
+	throw std::invalid_argument("unknown operation: " + name);
+}
+
+// parses sizes like "4096", "4k", "16M"
+uint64_t parse_size(const std::string &value) {
+	if (value.empty())
+		throw std::invalid_argument("empty size");
+
+	uint64_t multiplier = 1;
+	switch (value.back()) {
+	case 'k': case 'K':
+		multiplier = 1 << 10;
+		break;
+	case 'm': case 'M':
+		multiplier = 1 << 20;
+		break;
+	case 'g': case 'G':
+		multiplier = 1 << 30;
+		break;
+	}
+
+	const std::string number = multiplier == 1 ? value : value.substr(0, value.size() - 1);
+	return boost::lexical_cast<uint64_t>(number) * multiplier;
+}
+
+/*
+ * Size of written objects:
+ * "fixed:SIZE", "uniform:MIN-MAX" or "exponential:MEAN" (bounded by 64 * MEAN).
+ */
+class size_distribution {
+public:
+	explicit size_distribution(const std::string &description)
+	: m_description(description) {
+		std::vector<std::string> parts;
+		boost::split(parts, description, boost::is_any_of(":"));
+		if (parts.size() == 1)
+			parts.insert(parts.begin(), "fixed");
+		if (parts.size() != 2)
+			throw std::invalid_argument("invalid size distribution: " + description);
+
+		if (parts[0] == "fixed") {
+			m_type = FIXED;
+			m_min = m_max = parse_size(parts[1]);
+		} else if (parts[0] == "uniform") {
+			std::vector<std::string> bounds;
+			boost::split(bounds, parts[1], boost::is_any_of("-"));
+			if (bounds.size() != 2)
+				throw std::invalid_argument("invalid uniform size distribution: " + description);
+			m_type = UNIFORM;
+			m_min = parse_size(bounds[0]);
+			m_max = parse_size(bounds[1]);
+			if (m_min > m_max)
+				throw std::invalid_argument("invalid uniform size distribution: " + description);
+		} else if (parts[0] == "exponential") {
+			m_type = EXPONENTIAL;
+			m_min = parse_size(parts[1]);
+			m_max = m_min * 64;
+		} else {
+			throw std::invalid_argument("unknown size distribution: " + description);
+		}
+	}
+
+	template <typename Generator>
+	uint64_t next(Generator &generator) const {
+		switch (m_type) {
+		case UNIFORM:
+			return std::uniform_int_distribution<uint64_t>(m_min, m_max)(generator);
+		case EXPONENTIAL:
+			return std::min<uint64_t>(m_max,
+			                          std::exponential_distribution<double>(1. / m_min)(generator) + 1);
+		case FIXED:
+		default:
+			return m_min;
+		}
+	}
+
+	uint64_t max() const {
+		return m_max;
+	}
+
+	const std::string &description() const {
+		return m_description;
+	}
+
+private:
+	enum { FIXED, UNIFORM, EXPONENTIAL } m_type;
+	uint64_t m_min;
+	uint64_t m_max;
+	std::string m_description;
+};
+
+/*
+ * Index of the next accessed key: "uniform" or "zipf" with @theta skew,
+ * zipf uses the generator described in "Quickly Generating Billion-Record Synthetic Databases" by Gray et al.
+ */
+class key_distribution {
+public:
+	key_distribution(const std::string &type, uint64_t keys, double theta)
+	: m_keys(keys)
+	, m_zipf(false)
+	, m_theta(theta) {
+		if (!keys)
+			throw std::invalid_argument("number of keys must be positive");
+
+		if (type == "zipf") {
+			if (theta <= 0 || theta >= 1)
+				throw std::invalid_argument("zipf theta must be in (0, 1)");
+
+			m_zipf = true;
+			m_zetan = zeta(keys, theta);
+			const double zeta2 = zeta(2, theta);
+			m_alpha = 1. / (1. - theta);
+			m_eta = (1. - std::pow(2. / keys, 1. - theta)) / (1. - zeta2 / m_zetan);
+		} else if (type != "uniform") {
+			throw std::invalid_argument("unknown key distribution: " + type);
+		}
+	}
+
+	template <typename Generator>
+	uint64_t next(Generator &generator) const {
+		if (!m_zipf)
+			return std::uniform_int_distribution<uint64_t>(0, m_keys - 1)(generator);
+
+		const double u = std::uniform_real_distribution<double>(0, 1)(generator);
+		const double uz = u * m_zetan;
+		if (uz < 1.)
+			return 0;
+		if (uz < 1. + std::pow(0.5, m_theta))
+			return 1;
+		return std::min<uint64_t>(m_keys - 1, m_keys * std::pow(m_eta * u - m_eta + 1., m_alpha));
+	}
+
+private:
+	static double zeta(uint64_t n, double theta) {
+		double result = 0;
+		for (uint64_t i = 1; i <= n; ++i) {
+			result += 1. / std::pow(i, theta);
+		}
+		return result;
+	}
+
+	uint64_t m_keys;
+	bool m_zipf;
+	double m_theta;
+	double m_zetan;
+	double m_alpha;
+	double m_eta;
+};
+
+struct bench_config {
+	std::vector<std::string> remotes;
+	std::vector<int> groups;
+
+	size_t local_servers = 0;
+	size_t local_groups = 1;
+	std::string local_path;
+	std::string local_log_level;
+
+	double duration = 10;
+	uint64_t requests = 0;
+	size_t concurrency = 16;
+	double rate = 0;
+
+	std::vector<double> weights = std::vector<double>(OPERATION_MAX, 0);
+	std::string mix;
+	std::string sizes;
+	std::string key_type;
+	uint64_t keys = 10000;
+	double zipf_theta = 0.99;
+	size_t bulk_size = 16;
+	bool prefill = false;
+
+	uint32_t ioflags = 0;
+	long wait_timeout = 60;
+
+	std::string log_file;
+	std::string log_level;
+	std::string json_file;
+};
+
+// "read=70,write=30" -> weights of operations
+std::vector<double> parse_mix(const std::string &mix) {
+	std::vector<double> weights(OPERATION_MAX, 0);
+
+	std::vector<std::string> parts;
+	boost::split(parts, mix, boost::is_any_of(","));
+	for (const auto &part : parts) {
+		std::vector<std::string> pair;
+		boost::split(pair, part, boost::is_any_of("="));
+		if (pair.size() != 2)
+			throw std::invalid_argument("invalid mix entry: " + part);
+
+		weights[parse_operation(pair[0])] = boost::lexical_cast<double>(pair[1]);
+	}
+
+	if (std::all_of(weights.begin(), weights.end(), [] (double weight) { return weight <= 0; }))
+		throw std::invalid_argument("mix has no operations: " + mix);
+
+	return weights;
+}
+
+struct operation_stats {
+	std::vector<uint64_t> latencies; // usecs
+	uint64_t errors = 0;
+	uint64_t bytes = 0;
+
+	void merge(const operation_stats &other) {
+		latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+		errors += other.errors;
+		bytes += other.bytes;
+	}
+};
+
+typedef std::array<operation_stats, OPERATION_MAX> worker_stats;
+
+class bench {
+public:
+	bench(const bench_config &config, const newapi::session &s)
+	: m_config(config)
+	, m_session(s.clone())
+	, m_sizes(config.sizes)
+	, m_keys(config.key_type, config.keys, config.zipf_theta)
+	, m_requests(0) {
+		std::mt19937_64 generator(0);
+		m_payload.resize(m_sizes.max());
+		std::generate(m_payload.begin(), m_payload.end(), [&generator] () { return char(generator()); });
+
+		m_session.set_exceptions_policy(session::no_exceptions);
+		m_session.set_ioflags(m_session.get_ioflags() | config.ioflags);
+	}
+
+	// writes all keys once, so reads and lookups do not miss
+	void prefill() {
+		std::vector<newapi::async_write_result> results;
+		for (uint64_t i = 0; i < m_config.keys; ++i) {
+			results.emplace_back(write(key_name(i), m_sizes.max()));
+
+			if (results.size() >= m_config.concurrency * 16) {
+				for (auto &result : results) {
+					result.wait();
+				}
+				results.clear();
+			}
+		}
+
+		for (auto &result : results) {
+			result.wait();
+		}
+	}
+
+	double run() {
+		std::vector<std::thread> threads;
+		m_stats.resize(m_config.concurrency);
+
+		const auto start = clock_type::now();
+		m_deadline = start + std::chrono::duration_cast<clock_type::duration>(
+			std::chrono::duration<double>(m_config.duration));
+
+		for (size_t i = 0; i < m_config.concurrency; ++i) {
+			threads.emplace_back(&bench::worker, this, i, start);
+		}
+
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		return std::chrono::duration<double>(clock_type::now() - start).count();
+	}
+
+	worker_stats stats() const {
+		worker_stats result;
+		for (const auto &stats : m_stats) {
+			for (size_t i = 0; i < OPERATION_MAX; ++i) {
+				result[i].merge(stats[i]);
+			}
+		}
+		return result;
+	}
+
+private:
+	static std::string key_name(uint64_t index) {
+		return "dnet_bench." + std::to_string(index);
+	}
+
+	newapi::async_write_result write(const std::string &id, uint64_t size) {
+		return m_session.write(id, "", 0,
+		                       argument_data(data_pointer::from_raw(const_cast<char *>(m_payload.data()), size)),
+		                       0);
+	}
+
+	bool continue_running() {
+		if (clock_type::now() >= m_deadline)
+			return false;
+		if (m_config.requests && m_requests.fetch_add(1) >= m_config.requests)
+			return false;
+		return true;
+	}
+
+	void worker(size_t index, clock_type::time_point start) {
+		std::mt19937_64 generator(index + 1);
+		std::discrete_distribution<size_t> operations(m_config.weights.begin(), m_config.weights.end());
+		auto &stats = m_stats[index];
+
+		// every worker issues its share of the target rate
+		const auto interval = m_config.rate > 0
+			? std::chrono::duration_cast<clock_type::duration>(
+				std::chrono::duration<double>(m_config.concurrency / m_config.rate))
+			: clock_type::duration::zero();
+		auto scheduled = start + interval * index / m_config.concurrency;
+
+		while (continue_running()) {
+			if (interval != clock_type::duration::zero()) {
+				std::this_thread::sleep_until(scheduled);
+			} else {
+				scheduled = clock_type::now();
+			}
+
+			const auto operation = static_cast<operation_type>(operations(generator));
+			auto &current = stats[operation];
+
+			uint64_t bytes = 0;
+			const int err = execute(operation, generator, bytes);
+
+			const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+				clock_type::now() - scheduled).count();
+			current.latencies.push_back(latency);
+			current.bytes += bytes;
+			if (err)
+				++current.errors;
+
+			scheduled += interval;
+		}
+	}
+
+	template <typename Result>
+	static int wait(Result &result, uint64_t &bytes) {
+		result.wait();
+		for (const auto &entry : result.get()) {
+			if (!entry.status())
+				bytes += entry.data().size();
+		}
+		return result.error().code();
+	}
+
+	int execute(operation_type operation, std::mt19937_64 &generator, uint64_t &bytes) {
+		const std::string id = key_name(m_keys.next(generator));
+
+		switch (operation) {
+		case OPERATION_READ: {
+			auto result = m_session.read(id, 0, 0);
+			return wait(result, bytes);
+		}
+		case OPERATION_WRITE: {
+			const uint64_t size = m_sizes.next(generator);
+			auto result = write(id, size);
+			result.wait();
+			if (!result.error())
+				bytes = size;
+			return result.error().code();
+		}
+		case OPERATION_LOOKUP: {
+			auto result = m_session.lookup(id);
+			result.wait();
+			return result.error().code();
+		}
+		case OPERATION_REMOVE: {
+			auto result = m_session.remove(id);
+			result.wait();
+			return result.error().code();
+		}
+		case OPERATION_BULK_READ: {
+			const auto &groups = m_session.get_groups();
+			std::vector<dnet_id> ids;
+			ids.reserve(m_config.bulk_size);
+			for (size_t i = 0; i < m_config.bulk_size; ++i) {
+				key k(key_name(m_keys.next(generator)));
+				k.transform(m_session);
+				dnet_id raw_id = k.id();
+				raw_id.group_id = groups[i % groups.size()];
+				ids.emplace_back(raw_id);
+			}
+
+			auto result = m_session.bulk_read(ids);
+			return wait(result, bytes);
+		}
+		default:
+			return -EINVAL;
+		}
+	}
+
+	const bench_config &m_config;
+	newapi::session m_session;
+	size_distribution m_sizes;
+	key_distribution m_keys;
+	std::string m_payload;
+
+	clock_type::time_point m_deadline;
+	std::atomic<uint64_t> m_requests;
+	std::vector<worker_stats> m_stats;
+};
+
+struct operation_report {
+	uint64_t count;
+	uint64_t errors;
+	double ops_per_second;
+	double bytes_per_second;
+	double avg;
+	// min, p50, p90, p99, p99.9, max
+	std::vector<std::pair<std::string, uint64_t>> percentiles;
+};
+
+operation_report make_report(operation_stats &stats, double duration) {
+	operation_report report;
+	report.count = stats.latencies.size();
+	report.errors = stats.errors;
+	report.ops_per_second = report.count / duration;
+	report.bytes_per_second = stats.bytes / duration;
+	report.avg = 0;
+
+	auto &latencies = stats.latencies;
+	std::sort(latencies.begin(), latencies.end());
+
+	static const std::vector<std::pair<std::string, double>> points = {
+		{"min", 0}, {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p99.9", 0.999}, {"max", 1}
+	};
+	for (const auto &point : points) {
+		uint64_t value = 0;
+		if (!latencies.empty()) {
+			const size_t index = std::min<size_t>(latencies.size() - 1, point.second * latencies.size());
+			value = latencies[index];
+		}
+		report.percentiles.emplace_back(point.first, value);
+	}
+
+	if (!latencies.empty()) {
+		report.avg = std::accumulate(latencies.begin(), latencies.end(), 0.) / latencies.size();
+	}
+
+	return report;
+}
+
+void print_text(std::ostream &out, const std::vector<std::pair<std::string, operation_report>> &reports,
+                double duration) {
+	out << "duration: " << std::fixed << std::setprecision(2) << duration << " secs, latencies are in usecs\n";
+	out << std::left << std::setw(12) << "operation"
+	    << std::right << std::setw(10) << "count"
+	    << std::setw(8) << "errors"
+	    << std::setw(12) << "ops/s"
+	    << std::setw(10) << "MB/s"
+	    << std::setw(10) << "avg";
+	for (const auto &point : reports.front().second.percentiles) {
+		out << std::setw(10) << point.first;
+	}
+	out << '\n';
+
+	for (const auto &pair : reports) {
+		const auto &report = pair.second;
+		out << std::left << std::setw(12) << pair.first
+		    << std::right << std::setw(10) << report.count
+		    << std::setw(8) << report.errors
+		    << std::setw(12) << std::setprecision(1) << report.ops_per_second
+		    << std::setw(10) << std::setprecision(2) << report.bytes_per_second / (1 << 20)
+		    << std::setw(10) << std::setprecision(0) << report.avg;
+		for (const auto &point : report.percentiles) {
+			out << std::setw(10) << point.second;
+		}
+		out << '\n';
+	}
+}
+
+void write_json(const std::string &path, const bench_config &config,
+                const std::vector<std::pair<std::string, operation_report>> &reports, double duration) {
+	rapidjson::Document doc;
+	doc.SetObject();
+	auto &allocator = doc.GetAllocator();
+
+	auto add_string = [&allocator] (rapidjson::Value &object, const char *name, const std::string &value) {
+		rapidjson::Value json_value(value.c_str(), value.size(), allocator);
+		object.AddMember(name, json_value, allocator);
+	};
+
+	rapidjson::Value workload(rapidjson::kObjectType);
+	add_string(workload, "mix", config.mix);
+	add_string(workload, "sizes", config.sizes);
+	add_string(workload, "key_distribution", config.key_type);
+	workload.AddMember("keys", config.keys, allocator);
+	workload.AddMember("concurrency", static_cast<uint64_t>(config.concurrency), allocator);
+	workload.AddMember("rate", config.rate, allocator);
+	add_string(workload, "ioflags", dnet_flags_dump_ioflags(config.ioflags));
+	doc.AddMember("workload", workload, allocator);
+	doc.AddMember("duration", duration, allocator);
+
+	rapidjson::Value operations(rapidjson::kObjectType);
+	for (const auto &pair : reports) {
+		const auto &report = pair.second;
+
+		rapidjson::Value latency(rapidjson::kObjectType);
+		latency.AddMember("avg", report.avg, allocator);
+		for (const auto &point : report.percentiles) {
+			rapidjson::Value value(point.second);
+			latency.AddMember(point.first.c_str(), allocator, value, allocator);
+		}
+
+		rapidjson::Value operation(rapidjson::kObjectType);
+		operation.AddMember("count", report.count, allocator);
+		operation.AddMember("errors", report.errors, allocator);
+		operation.AddMember("ops_per_second", report.ops_per_second, allocator);
+		operation.AddMember("bytes_per_second", report.bytes_per_second, allocator);
+		operation.AddMember("latency_usecs", latency, allocator);
+
+		operations.AddMember(pair.first.c_str(), allocator, operation, allocator);
+	}
+	doc.AddMember("operations", operations, allocator);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+	doc.Accept(writer);
+
+	if (path == "-") {
+		std::cout << buffer.GetString() << std::endl;
+		return;
+	}
+
+	std::ofstream out(path.c_str());
+	if (!out)
+		throw std::runtime_error("failed to open json output: " + path);
+	out << buffer.GetString() << std::endl;
+}
+
+// starts @config.local_servers in-process servers spread over @config.local_groups groups
+tests::nodes_data::ptr start_local_cluster(bench_config &config) {
+	std::vector<tests::server_config> configs(config.local_servers, tests::server_config::default_value());
+	for (size_t i = 0; i < configs.size(); ++i) {
+		configs[i].log_level = config.local_log_level;
+		configs[i].backends[0]("group", static_cast<int>(i % config.local_groups + 1));
+	}
+
+	tests::start_nodes_config start_config(std::cerr, std::move(configs), config.local_path);
+	start_config.monitor = false;
+	auto setup = tests::start_nodes(start_config);
+
+	for (const auto &server : setup->nodes) {
+		config.remotes.emplace_back(server.remote().to_string_with_family());
+	}
+
+	if (config.groups.empty()) {
+		for (size_t i = 0; i < config.local_groups; ++i) {
+			config.groups.push_back(i + 1);
+		}
+	}
+
+	return setup;
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	bench_config config;
+	std::string flags;
+
+	bpo::options_description description("Usage: dnet_bench [options]\n"
+	                                     "Runs mixed workload and reports throughput and latency percentiles");
+	description.add_options()
+		("help,h", "this help message")
+		("remote,r", bpo::value<std::vector<std::string>>(&config.remotes)->composing(),
+		 "remote node address, can be specified several times")
+		("groups,g", bpo::value<std::vector<int>>(&config.groups)->multitoken(), "groups to work with")
+		("local-servers", bpo::value<size_t>(&config.local_servers)->default_value(0),
+		 "start this number of in-process servers and run workload against them")
+		("local-groups", bpo::value<size_t>(&config.local_groups)->default_value(1),
+		 "number of groups local servers are spread over")
+		("local-path", bpo::value<std::string>(&config.local_path)->default_value(""),
+		 "directory for local servers' data, temporary one is created if it is empty")
+		("local-log-level", bpo::value<std::string>(&config.local_log_level)->default_value("error"),
+		 "log level of local servers")
+		("duration,d", bpo::value<double>(&config.duration)->default_value(10), "duration of the run in seconds")
+		("requests,n", bpo::value<uint64_t>(&config.requests)->default_value(0),
+		 "stop after this number of requests, 0 means no limit")
+		("concurrency,c", bpo::value<size_t>(&config.concurrency)->default_value(16),
+		 "number of concurrent requests")
+		("rate", bpo::value<double>(&config.rate)->default_value(0),
+		 "target rate of requests per second, 0 means as fast as possible")
+		("mix,m", bpo::value<std::string>(&config.mix)->default_value("read=80,write=20"),
+		 "weights of operations: read, write, lookup, remove, bulk_read")
+		("sizes,s", bpo::value<std::string>(&config.sizes)->default_value("fixed:4k"),
+		 "size distribution of written objects: fixed:SIZE, uniform:MIN-MAX or exponential:MEAN")
+		("keys,k", bpo::value<uint64_t>(&config.keys)->default_value(10000), "number of distinct keys")
+		("key-distribution", bpo::value<std::string>(&config.key_type)->default_value("uniform"),
+		 "key popularity distribution: uniform or zipf")
+		("zipf-theta", bpo::value<double>(&config.zipf_theta)->default_value(0.99), "skew of zipf distribution")
+		("bulk-size", bpo::value<size_t>(&config.bulk_size)->default_value(16), "number of keys per bulk_read")
+		("prefill", "write all keys before the run")
+		("cache", "set cache ioflag: operations go through the cache and then to the disk")
+		("cache-only", "set cache_only ioflag: operations do not touch the disk")
+		("wait-timeout,w", bpo::value<long>(&config.wait_timeout)->default_value(60),
+		 "request timeout in seconds")
+		("log-file,l", bpo::value<std::string>(&config.log_file)->default_value("/dev/stderr"), "client log file")
+		("log-level,L", bpo::value<std::string>(&config.log_level)->default_value("error"), "client log level")
+		("json,j", bpo::value<std::string>(&config.json_file),
+		 "write report in json format into the file, - means stdout");
+
+	bpo::variables_map vm;
+	try {
+		bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+		bpo::notify(vm);
+
+		if (vm.count("help")) {
+			std::cout << description << std::endl;
+			return 0;
+		}
+
+		config.weights = parse_mix(config.mix);
+		config.prefill = vm.count("prefill");
+		if (vm.count("cache"))
+			config.ioflags |= DNET_IO_FLAGS_CACHE;
+		if (vm.count("cache-only"))
+			config.ioflags |= DNET_IO_FLAGS_CACHE | DNET_IO_FLAGS_CACHE_ONLY;
+		if (!config.concurrency)
+			throw std::invalid_argument("concurrency must be positive");
+		if (!config.local_groups)
+			throw std::invalid_argument("number of local groups must be positive");
+	} catch (const std::exception &e) {
+		std::cerr << "Invalid options: " << e.what() << "\n" << description << std::endl;
+		return -1;
+	}
+
+	try {
+		srand(time(nullptr));
+
+		tests::nodes_data::ptr local_cluster;
+		if (config.local_servers)
+			local_cluster = start_local_cluster(config);
+
+		if (config.remotes.empty()) {
+			std::cerr << "You must specify remote address or number of local servers\n"
+			          << description << std::endl;
+			return -1;
+		}
+		if (config.groups.empty()) {
+			std::cerr << "You must specify groups\n" << description << std::endl;
+			return -1;
+		}
+
+		dnet_config cfg;
+		memset(&cfg, 0, sizeof(cfg));
+		cfg.wait_timeout = cfg.check_timeout = config.wait_timeout;
+
+		node n(make_file_logger(config.log_file, dnet_log_parse_level(config.log_level.c_str())), cfg);
+		std::vector<address> remotes(config.remotes.begin(), config.remotes.end());
+		n.add_remote(remotes);
+
+		newapi::session s(n);
+		s.set_groups(config.groups);
+
+		bench runner(config, s);
+		if (config.prefill)
+			runner.prefill();
+
+		const double duration = runner.run();
+		auto stats = runner.stats();
+
+		std::vector<std::pair<std::string, operation_report>> reports;
+		operation_stats total;
+		for (size_t i = 0; i < OPERATION_MAX; ++i) {
+			if (config.weights[i] <= 0)
+				continue;
+			total.merge(stats[i]);
+			reports.emplace_back(operation_names[i], make_report(stats[i], duration));
+		}
+		reports.emplace_back("total", make_report(total, duration));
+
+		print_text(std::cout, reports, duration);
+		if (!config.json_file.empty())
+			write_json(config.json_file, config, reports, duration);
+	} catch (const std::exception &e) {
+		std::cerr << "Failed: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return 0;
+}
@@ -263,6 +263,25 @@ uint64_t parse_queue_timeout(const kora::config_t &options) {
 	return queue_timeout * scale;
 }
 
+static void parse_binary_access_log(config_data *data, const kora::config_t &log) {
+	binary_access_log_config config;
+	config.path = log.at<std::string>("path");
+	config.sample_every = log.at<uint64_t>("sample_every", 1);
+	config.slow_threshold_ms = log.at<uint64_t>("slow_threshold_ms", 0);
+	config.ring_size = log.at<size_t>("ring_size", 4096);
+	config.flush_interval_ms = log.at<uint64_t>("flush_interval_ms", 100);
+
+	if (!config.ring_size || !config.flush_interval_ms)
+		throw config_error() << "binary_access_log: ring_size and flush_interval_ms must be positive";
+
+	try {
+		data->binary_access_holder.reset(new dnet_binary_access_log(config));
+	} catch (std::exception &e) {
+		throw config_error() << "failed to initialize binary access log: " << e.what();
+	}
+	data->binary_access_log = data->binary_access_holder.get();
+}
+
 static void parse_options(config_data *data, const kora::config_t &options) {
 	if (options.has("mallopt_mmap_threshold"))
 		dnet_set_malloc_options(data, options.at<int>("mallopt_mmap_threshold"));
@@ -274,6 +293,8 @@ static void parse_options(config_data *data, const kora::config_t &options) {
 	data->cfg_state.flags |= (options.at("flags", 0) & ~DNET_CFG_JOIN_NETWORK);
 	data->cfg_state.io_thread_num = options.at<unsigned>("io_thread_num");
 	data->cfg_state.send_limit = options.at<unsigned>("send_limit", DNET_DEFAULT_SEND_LIMIT);
+	data->cfg_state.output_memory_limit = options.at<uint64_t>("output_memory_limit",
+	                                                           DNET_DEFAULT_OUTPUT_MEMORY_LIMIT);
 	data->cfg_state.nonblocking_io_thread_num = options.at<unsigned>("nonblocking_io_thread_num");
 	data->cfg_state.net_thread_num = options.at<unsigned>("net_thread_num");
 	data->cfg_state.bg_ionice_class = options.at("bg_ionice_class", 0);
@@ -308,6 +329,9 @@ static void parse_options(config_data *data, const kora::config_t &options) {
 	if (options.has("cache"))
 		data->cache_config = ioremap::cache::cache_config::parse(options["cache"]);
 
+	if (options.has("binary_access_log"))
+		parse_binary_access_log(data, options["binary_access_log"]);
+
 	data->queue_timeout = parse_queue_timeout(options);
 }
 
@@ -498,6 +522,8 @@ void config_data::reset_logger() {
 	*root_holder = make_logger(this, "core");
 	if (access_holder)
 		*access_holder = make_logger(this, "access", /*filter*/ false);
+	if (binary_access_holder)
+		binary_access_holder->reopen();
 	DNET_LOG_INFO(logger, "logger has been reset");
 }
 
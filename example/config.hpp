@@ -12,6 +12,7 @@
 
 #include "elliptics/backends.h"
 #include "library/elliptics.h"
+#include "library/access_log.hpp"
 
 // forward declaration
 namespace kora {
@@ -160,6 +161,8 @@ public:
 	// common logger is used by default for all logs
 	std::unique_ptr<wrapper_t>			logger;
 	std::unique_ptr<wrapper_t>			access_logger;
+	// binary access log is used instead of access_logger by server if it is configured
+	std::unique_ptr<dnet_binary_access_log>		binary_access_holder;
 	// addresses of remote nodes
 	std::vector<address>				remotes;
 	boost::optional<cache::cache_config>		cache_config;
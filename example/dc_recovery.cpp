@@ -0,0 +1,292 @@
+/*
+ * 2018+ Copyright (c) Elliptics contributors
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * This application runs recover stage of `dnet_recovery dc` by native dc recovery engine.
+ * It recovers keys prepared in recovery's directory by `dnet_recovery -N dc` (rest_keys and bucket_* files)
+ * and accepts the same options as dnet_recovery.
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <elliptics/cppdef.h>
+#include <elliptics/newapi/dc_recovery.hpp>
+
+using namespace ioremap;
+namespace bpo = boost::program_options;
+
+static std::vector<int> parse_groups(const std::string &str) {
+	std::vector<int> groups;
+	std::istringstream stream(str);
+	std::string group;
+	while (std::getline(stream, group, ','))
+		groups.push_back(std::stoi(group));
+	return groups;
+}
+
+/* accepts timestamp or time difference like dnet_recovery, e.g. `1368940603`, `12h`, `1d` or `1w 2d` */
+static dnet_time parse_time(const std::string &str) {
+	dnet_time ts;
+	ts.tnsec = 0;
+
+	if (str.find_first_not_of("0123456789") == std::string::npos) {
+		ts.tsec = std::stoull(str);
+		return ts;
+	}
+
+	uint64_t diff = 0;
+	std::istringstream stream(str);
+	uint64_t value;
+	char unit;
+	while (stream >> value >> unit) {
+		switch (unit) {
+		case 'w':
+			diff += value * 7 * 24 * 3600;
+			break;
+		case 'd':
+			diff += value * 24 * 3600;
+			break;
+		case 'h':
+			diff += value * 3600;
+			break;
+		case 'm':
+			diff += value * 60;
+			break;
+		default:
+			throw std::invalid_argument("unknown time unit: " + str);
+		}
+	}
+
+	dnet_current_time(&ts);
+	ts.tsec -= std::min<uint64_t>(ts.tsec, diff);
+	ts.tnsec = 0;
+	return ts;
+}
+
+static uint64_t file_size(const std::string &path) {
+	struct stat st;
+	if (stat(path.c_str(), &st))
+		return 0;
+	return st.st_size;
+}
+
+/* groups of bucket_* files sorted from the biggest bucket to the smallest one */
+static std::vector<int> find_buckets(const std::string &dir) {
+	std::vector<std::pair<uint64_t, int>> buckets;
+
+	DIR *d = opendir(dir.c_str());
+	if (!d)
+		throw std::runtime_error("could not open directory: " + dir);
+
+	static const std::string prefix = "bucket_";
+	while (struct dirent *entry = readdir(d)) {
+		const std::string name = entry->d_name;
+		if (name.compare(0, prefix.size(), prefix) ||
+		    name.find_first_not_of("0123456789", prefix.size()) != std::string::npos ||
+		    name.size() == prefix.size())
+			continue;
+		buckets.emplace_back(file_size(dir + "/" + name), std::stoi(name.substr(prefix.size())));
+	}
+	closedir(d);
+
+	std::sort(buckets.begin(), buckets.end(), std::greater<std::pair<uint64_t, int>>());
+
+	std::vector<int> groups;
+	for (const auto &bucket : buckets)
+		groups.push_back(bucket.second);
+	return groups;
+}
+
+/* moves keys of bucket files to rest_keys if server_send is disabled */
+static void merge_buckets_into_rest(const std::string &dir, const std::vector<int> &groups) {
+	const std::string rest = dir + "/rest_keys";
+	int out = open(rest.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+	if (out == -1)
+		throw std::runtime_error("could not open: " + rest);
+
+	std::vector<char> buffer(1024 * 1024);
+	for (const int group : groups) {
+		const std::string bucket = dir + "/bucket_" + std::to_string(group);
+		int in = open(bucket.c_str(), O_RDONLY | O_CLOEXEC);
+		if (in == -1)
+			continue;
+
+		ssize_t size;
+		while ((size = read(in, buffer.data(), buffer.size())) > 0) {
+			if (write(out, buffer.data(), size) != size) {
+				close(in);
+				close(out);
+				throw std::runtime_error("could not write: " + rest);
+			}
+		}
+		close(in);
+		unlink(bucket.c_str());
+	}
+	close(out);
+}
+
+static void print_stats(const elliptics::newapi::dc_recovery_stats &stats, const std::string &format) {
+	const std::vector<std::pair<const char *, const std::map<std::string, int64_t> *>> groups = {
+		{"main", &stats.main},
+		{"recover", &stats.recover},
+		{"commands", &stats.commands},
+		{"commands_by_groups", &stats.commands_by_groups},
+	};
+
+	if (format == "json") {
+		std::cout << "{";
+		for (size_t i = 0; i < groups.size(); ++i) {
+			std::cout << (i ? ", " : "") << "\"" << groups[i].first << "\": {";
+			bool first = true;
+			for (const auto &counter : *groups[i].second) {
+				std::cout << (first ? "" : ", ") << "\"" << counter.first << "\": " << counter.second;
+				first = false;
+			}
+			std::cout << "}";
+		}
+		std::cout << ", \"processed_keys\": " << stats.processed_keys << "}" << std::endl;
+	} else if (format == "text") {
+		for (const auto &group : groups) {
+			for (const auto &counter : *group.second)
+				std::cout << group.first << "." << counter.first << ": " << counter.second << std::endl;
+		}
+		std::cout << "processed_keys: " << stats.processed_keys << std::endl;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<std::string> remotes;
+	std::string groups, ro_groups, tmp_dir, log_file, log_level, stat_format, prepare_timeout, trace_id;
+	long wait_timeout;
+	size_t batch_size;
+	uint64_t chunk_size, data_flow_rate, chunk_write_timeout, chunk_commit_timeout;
+	int attempts;
+
+	bpo::options_description desc("Usage: dnet_dc_recovery [options], options are the same as dnet_recovery's");
+	desc.add_options()
+		("help,h", "this help message")
+		("remote,r", bpo::value<std::vector<std::string>>(&remotes)->required()->composing(),
+			"elliptics node address, can be specified multiple times")
+		("groups,g", bpo::value<std::string>(&groups)->required(), "comma separated list of groups")
+		("ro-groups", bpo::value<std::string>(&ro_groups)->default_value(""),
+			"comma separated list of read-only groups")
+		("dir,D", bpo::value<std::string>(&tmp_dir)->required(),
+			"recovery's directory with rest_keys and bucket_* files prepared by `dnet_recovery -N dc`")
+		("log,l", bpo::value<std::string>(&log_file)->default_value("dnet_recovery.log"),
+			"output log messages from library to file")
+		("log-level,L", bpo::value<std::string>(&log_level)->default_value("notice"), "elliptics client verbosity")
+		("stat,s", bpo::value<std::string>(&stat_format)->default_value("text"),
+			"statistics output format: none/text/json")
+		("safe,S", "do not remove corrupted keys")
+		("dry-run,N", "do not remove corrupted keys, only recover them")
+		("wait-timeout,w", bpo::value<long>(&wait_timeout)->default_value(3600), "wait timeout in seconds")
+		("batch-size,b", bpo::value<size_t>(&batch_size)->default_value(1024),
+			"number of keys in one server-send and number of keys recovered simultaneously")
+		("attempts,a", bpo::value<int>(&attempts)->default_value(1), "number of attempts to recover one key")
+		("chunk-size,c", bpo::value<uint64_t>(&chunk_size)->default_value(1024 * 1024),
+			"size of chunk by which all object will be read and recovered")
+		("prepare-timeout,p", bpo::value<std::string>(&prepare_timeout)->default_value("1d"),
+			"timeout for uncommitted records, used as timestamp of removal of corrupted keys")
+		("trace-id,T", bpo::value<std::string>(&trace_id)->default_value("0"),
+			"marks all recovery commands by trace_id, accepts hex strings")
+		("no-server-send,U", "do not use server-send for recovery")
+		("data-flow-rate", bpo::value<uint64_t>(&data_flow_rate)->default_value(10),
+			"expected execution speed for an I/O operation in Mb")
+		("chunk-write-timeout", bpo::value<uint64_t>(&chunk_write_timeout)->default_value(1000),
+			"timeout in ms for writing a chunk by server-send")
+		("chunk-commit-timeout", bpo::value<uint64_t>(&chunk_commit_timeout)->default_value(1000),
+			"timeout in ms for committing a chunk by server-send")
+		;
+
+	bpo::variables_map vm;
+	elliptics::newapi::dc_recovery_config config;
+
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+
+		if (vm.count("help")) {
+			std::cout << desc << std::endl;
+			return 0;
+		}
+
+		bpo::notify(vm);
+
+		config.groups = parse_groups(groups);
+		for (const int group : parse_groups(ro_groups))
+			config.ro_groups.insert(group);
+		config.tmp_dir = tmp_dir;
+		config.batch_size = batch_size;
+		config.chunk_size = chunk_size;
+		config.data_flow_rate = data_flow_rate * 1024 * 1024;
+		config.attempts = attempts;
+		config.chunk_write_timeout = chunk_write_timeout;
+		config.chunk_commit_timeout = chunk_commit_timeout;
+		config.prepare_timeout = parse_time(prepare_timeout);
+		config.trace_id = std::stoull(trace_id, nullptr, 16);
+		config.safe = vm.count("safe");
+		config.dry_run = vm.count("dry-run");
+	} catch (const std::exception &e) {
+		std::cerr << "Invalid options: " << e.what() << "\n" << desc << std::endl;
+		return -1;
+	}
+
+	try {
+		const auto buckets = find_buckets(tmp_dir);
+		if (vm.count("no-server-send"))
+			merge_buckets_into_rest(tmp_dir, buckets);
+		else
+			config.bucket_order = buckets;
+
+		dnet_config cfg;
+		memset(&cfg, 0, sizeof(cfg));
+		cfg.wait_timeout = wait_timeout;
+		cfg.check_timeout = 60;
+		cfg.flags = DNET_CFG_NO_ROUTE_LIST;
+		cfg.io_thread_num = 24;
+		cfg.nonblocking_io_thread_num = 1;
+		cfg.net_thread_num = 4;
+
+		const std::string log_path = log_file[0] == '/' ? log_file : tmp_dir + "/" + log_file;
+		elliptics::node node(elliptics::make_file_logger(log_path.c_str(),
+		                                                 dnet_log_parse_level(log_level.c_str())), cfg);
+		for (const auto &remote : remotes) {
+			try {
+				node.add_remote(remote);
+			} catch (const std::exception &e) {
+				std::cerr << "Could not connect to " << remote << ": " << e.what() << std::endl;
+			}
+		}
+
+		elliptics::newapi::dc_recovery recovery(node, config);
+		const bool result = recovery.recover();
+
+		print_stats(recovery.stats(), stat_format);
+		return result ? 0 : 1;
+	} catch (const std::exception &e) {
+		std::cerr << "Caught exception: " << e.what() << std::endl;
+		return -1;
+	}
+}
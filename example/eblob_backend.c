@@ -207,7 +207,7 @@ static int blob_write(struct eblob_backend_config *c, void *state,
 	static const size_t ehdr_size = sizeof(struct dnet_ext_list_hdr);
 	int err;
 
-	DNET_LOG_NOTICE(c->blog, "%s: EBLOB: blob-write: WRITE: start: %s", dnet_dump_id_str(io->id),
+	BLOB_LOG_NOTICE(c, "%s: EBLOB: blob-write: WRITE: start: %s", dnet_dump_id_str(io->id),
 	                dnet_print_io(io));
 
 	dnet_convert_io_attr(io);
@@ -226,6 +226,34 @@ static int blob_write(struct eblob_backend_config *c, void *state,
 
 	memcpy(key.id, io->id, EBLOB_ID_SIZE);
 
+	/*
+	 * Header written below is always uncompressed and data is written as is, so writes which don't
+	 * recreate the record (offset, append and plain rewrites) can be applied only to uncompressed records.
+	 * Compressed record can be rewritten entirely by a write with prepare or by the new api.
+	 */
+	if (!(io->flags & DNET_IO_FLAGS_PREPARE)) {
+		struct eblob_write_control disk_wc;
+		struct dnet_ext_list_hdr disk_ehdr;
+
+		memset(&disk_wc, 0, sizeof(disk_wc));
+		if (eblob_read_return(b, &key, EBLOB_READ_NOCSUM, &disk_wc) == 0 &&
+		    (disk_wc.flags & BLOB_DISK_CTL_EXTHDR) &&
+		    disk_wc.total_data_size >= ehdr_size) {
+			err = dnet_ext_hdr_read(&disk_ehdr, disk_wc.data_fd, disk_wc.data_offset);
+			if (err)
+				goto err_out_exit;
+
+			if (disk_ehdr.compression) {
+				err = -ENOTSUP;
+				DNET_LOG_ERROR(c->blog, "%s: EBLOB: blob-write: WRITE: record is compressed, "
+				                        "only entire rewrite is supported: ioflags: %s: %s %d",
+				               dnet_dump_id_str(io->id), dnet_flags_dump_ioflags(io->flags),
+				               strerror(-err), err);
+				goto err_out_exit;
+			}
+		}
+	}
+
 	if (io->flags & DNET_IO_FLAGS_PREPARE) {
 		/*
 		 * We have to put ext header flag into prepare command, since otherwise
@@ -260,7 +288,7 @@ static int blob_write(struct eblob_backend_config *c, void *state,
 			goto err_out_exit;
 		}
 
-		DNET_LOG_NOTICE(c->blog, "%s: EBLOB: blob-write: eblob_write_prepare: size: %" PRIu64 ": Ok",
+		BLOB_LOG_NOTICE(c, "%s: EBLOB: blob-write: eblob_write_prepare: size: %" PRIu64 ": Ok",
 		                dnet_dump_id_str(io->id), io->num + ehdr_size);
 	}
 
@@ -286,7 +314,7 @@ static int blob_write(struct eblob_backend_config *c, void *state,
 			goto err_out_exit;
 		}
 
-		DNET_LOG_NOTICE(c->blog, "%s: EBLOB: blob-write: WRITE: Ok: offset: %" PRIu64 ", size: %" PRIu64,
+		BLOB_LOG_NOTICE(c, "%s: EBLOB: blob-write: WRITE: Ok: offset: %" PRIu64 ", size: %" PRIu64,
 		                dnet_dump_id_str(io->id), io->offset, io->size);
 	}
 
@@ -327,11 +355,13 @@ static int blob_write(struct eblob_backend_config *c, void *state,
 				goto err_out_exit;
 			}
 
-			DNET_LOG_NOTICE(c->blog, "%s: EBLOB: blob-write: eblob_write_commit: size: %" PRIu64 ": Ok",
+			BLOB_LOG_NOTICE(c, "%s: EBLOB: blob-write: eblob_write_commit: size: %" PRIu64 ": Ok",
 			                dnet_dump_id_str(io->id), csize);
 		}
 	}
 
+	blob_header_cache_forget(c->header_cache, &key);
+
 	if (!err && wc.data_fd == -1) {
 		err = eblob_read_return(b, &key, EBLOB_READ_NOCSUM, &wc);
 		if (err) {
@@ -364,8 +394,8 @@ static int blob_write(struct eblob_backend_config *c, void *state,
 		goto err_out_exit;
 	}
 
-	DNET_LOG_INFO(c->blog, "%s: EBLOB: blob-write: fd: %d, offset: %" PRIu64 ", offset-within-fd: %" PRIu64
-	                       ", size: %" PRIu64,
+	BLOB_LOG_INFO(c, "%s: EBLOB: blob-write: fd: %d, offset: %" PRIu64 ", offset-within-fd: %" PRIu64
+	                ", size: %" PRIu64,
 	              dnet_dump_id_str(io->id), wc.data_fd, wc.offset, fd_offset, wc.size);
 
 err_out_exit:
@@ -419,6 +449,12 @@ static int blob_read(struct eblob_backend_config *c, void *state, struct dnet_cm
 		dnet_ext_hdr_to_list(&ehdr, &elist);
 		dnet_ext_list_to_io(&elist, io);
 
+		/* compressed data can be decoded only by new api, see blob_read_new() */
+		if (ehdr.compression) {
+			err = -ENOTSUP;
+			goto err_out_exit;
+		}
+
 		if (size < sizeof(ehdr) + ehdr.size) {
 			err = -ERANGE;
 			goto err_out_exit;
@@ -581,6 +617,12 @@ static int blob_read_range_callback(struct eblob_range_request *req)
 			if (err != 0)
 				goto err_out_exit;
 
+			/* compressed data can be decoded only by new api, see blob_read_new() */
+			if (ehdr.compression) {
+				err = -ENOTSUP;
+				goto err_out_exit;
+			}
+
 			dnet_ext_hdr_to_list(&ehdr, &elist);
 			dnet_ext_list_to_io(&elist, &io);
 
@@ -613,12 +655,13 @@ static int blob_del_range_callback(struct eblob_backend_config *c, struct eblob_
 	struct eblob_key key;
 	int err;
 
-	DNET_LOG_DEBUG(c->blog, "%s: EBLOB: blob-read-range: DEL", dnet_dump_id_str(req->record_key));
+	BLOB_LOG_DEBUG(c, "%s: EBLOB: blob-read-range: DEL", dnet_dump_id_str(req->record_key));
 
 	memcpy(key.id, req->record_key, EBLOB_ID_SIZE);
 	err = eblob_remove(req->back, &key);
+	blob_header_cache_forget(c->header_cache, &key);
 	if (err) {
-		DNET_LOG_DEBUG(c->blog, "%s: EBLOB: blob-read-range: DEL: err: %d", dnet_dump_id_str(req->record_key),
+		BLOB_LOG_DEBUG(c, "%s: EBLOB: blob-read-range: DEL: err: %d", dnet_dump_id_str(req->record_key),
 		               err);
 	}
 
@@ -714,7 +757,7 @@ static int blob_read_range(struct eblob_backend_config *c, void *state, struct d
 	}
 
 	if ((cmd->cmd == DNET_CMD_READ_RANGE) && (cmd->flags & DNET_ATTR_SORT)) {
-		DNET_LOG_DEBUG(c->blog, "Sorting keys before sending");
+		BLOB_LOG_DEBUG(c, "Sorting keys before sending");
 		qsort(p.keys, p.keys_cnt, sizeof(struct eblob_range_request), &blob_cmp_range_request);
 	}
 
@@ -727,19 +770,19 @@ static int blob_read_range(struct eblob_backend_config *c, void *state, struct d
 			case DNET_CMD_READ_RANGE:
 				if ((io->num > 0) && (i >= (io->num + start_from)))
 					break;
-				DNET_LOG_DEBUG(c->blog, "%s: EBLOB: blob-read-range: READ",
+				BLOB_LOG_DEBUG(c, "%s: EBLOB: blob-read-range: READ",
 				               dnet_dump_id_str(p.keys[i].record_key));
 				err = blob_read_range_callback(&p.keys[i]);
 				break;
 			case DNET_CMD_DEL_RANGE:
-				DNET_LOG_DEBUG(c->blog, "%s: EBLOB: blob-read-range: DEL",
+				BLOB_LOG_DEBUG(c, "%s: EBLOB: blob-read-range: DEL",
 				               dnet_dump_id_str(p.keys[i].record_key));
 				err = blob_del_range_callback(c, &p.keys[i]);
 				break;
 		}
 
 		if (err) {
-			DNET_LOG_DEBUG(c->blog, "%s: EBLOB: blob-read-range: err: %d",
+			BLOB_LOG_DEBUG(c, "%s: EBLOB: blob-read-range: err: %d",
 			               dnet_dump_id_str(p.keys[i].record_key), err);
 			goto err_out_exit;
 		}
@@ -770,6 +813,7 @@ static int blob_del(struct eblob_backend_config *c, struct dnet_cmd *cmd)
 	memcpy(key.id, cmd->id.id, EBLOB_ID_SIZE);
 
 	err = eblob_remove(c->eblob, &key);
+	blob_header_cache_forget(c->header_cache, &key);
 	if (err) {
 		DNET_LOG_ERROR(c->blog, "%s: EBLOB: blob-del: REMOVE: %d: %s", dnet_dump_id_str(cmd->id.id), err,
 		               strerror(-err));
@@ -916,9 +960,11 @@ static int blob_defrag_start(void *priv, enum dnet_backend_defrag_level level, c
 			return -ENOTSUP;
 	}
 
+	blob_header_cache_clear(c->header_cache);
+
 	int err = eblob_start_defrag_in_dir(c->eblob, defrag_level, chunks_dir);
 
-	DNET_LOG_INFO(c->blog, "DEFRAG: defragmentation request: status: %d", err);
+	BLOB_LOG_INFO(c, "DEFRAG: defragmentation request: status: %d", err);
 
 	return err;
 }
@@ -1059,6 +1105,12 @@ static int blob_send(struct eblob_backend_config *cfg, void *state, struct dnet_
 			if (err != 0)
 				goto err_out_send_fail_reply;
 
+			/* compressed data can be decoded only by new api, see blob_read_new() */
+			if (ehdr.compression) {
+				err = -ENOTSUP;
+				goto err_out_send_fail_reply;
+			}
+
 			dnet_ext_hdr_to_list(&ehdr, &elist);
 
 			re.timestamp = elist.timestamp;
@@ -1165,6 +1217,9 @@ static int eblob_backend_command_handler(void *state,
 		case DNET_CMD_BULK_REMOVE_NEW:
 			err = blob_bulk_remove_new(c, state, cmd, data, context);
 			break;
+		case DNET_CMD_BULK_WRITE_NEW:
+			err = blob_bulk_write_new(c, state, cmd, data, cmd_stats, context);
+			break;
 		case DNET_CMD_LOOKUP:
 		case DNET_CMD_LOOKUP_NEW:
 		case DNET_CMD_DEL_NEW:
@@ -1363,6 +1418,110 @@ static int dnet_blob_set_bg_ioprio_data(struct dnet_config_backend *b, const cha
 	return 0;
 }
 
+static int dnet_blob_set_compression(struct dnet_config_backend *b, const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	if (!strcmp(value, "none"))
+		c->compression = DNET_EXT_COMPRESSION_NONE;
+	else if (!strcmp(value, "zlib"))
+		c->compression = DNET_EXT_COMPRESSION_ZLIB;
+	else
+		return -ENOTSUP;
+	return 0;
+}
+
+static int dnet_blob_set_compression_min_gain(struct dnet_config_backend *b, const char *key __unused,
+                                              const char *value) {
+	struct eblob_backend_config *c = b->data;
+	int val = atoi(value);
+
+	if (val < 0 || val >= 100)
+		return -ERANGE;
+
+	c->compression_min_gain = val;
+	return 0;
+}
+
+static int dnet_blob_set_verified_checksum_ttl(struct dnet_config_backend *b, const char *key __unused,
+                                               const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->verified_checksum_ttl = strtoul(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_batch_records(struct dnet_config_backend *b, const char *key __unused,
+                                                const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_batch_records = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_batch_size(struct dnet_config_backend *b, const char *key __unused,
+                                             const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_batch_size = parse_size(value);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_batch_delay(struct dnet_config_backend *b, const char *key __unused,
+                                              const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_batch_delay = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_threads(struct dnet_config_backend *b, const char *key __unused,
+                                          const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_threads = strtoul(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_ioprio_class(struct dnet_config_backend *b, const char *key __unused,
+                                               const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_ioprio_class = atoi(value);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_ioprio_data(struct dnet_config_backend *b, const char *key __unused,
+                                              const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_ioprio_data = atoi(value);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_rate_bytes(struct dnet_config_backend *b, const char *key __unused,
+                                             const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_rate_bytes = parse_size(value);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_rate_keys(struct dnet_config_backend *b, const char *key __unused,
+                                            const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_rate_keys = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_parallelism(struct dnet_config_backend *b, const char *key __unused,
+                                              const char *value) {
+	struct eblob_backend_config *c = b->data;
+
+	c->iterator_parallelism = strtoul(value, NULL, 0);
+	return 0;
+}
+
 static int dnet_blob_set_single_pass_file_size_threshold(struct dnet_config_backend *b, const char *key __unused,
                                                          const char *value) {
 	struct eblob_backend_config *c = b->data;
@@ -1370,6 +1529,13 @@ static int dnet_blob_set_single_pass_file_size_threshold(struct dnet_config_back
 	return 0;
 }
 
+static int dnet_blob_set_bulk_write_sync(struct dnet_config_backend *b, const char *key __unused,
+                                         const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->bulk_write_sync = !!atoi(value);
+	return 0;
+}
+
 
 uint64_t eblob_backend_total_elements(void *priv) {
 	struct eblob_backend_config *r = priv;
@@ -1386,15 +1552,21 @@ int eblob_backend_storage_stat_json(void *priv, char **json_stat, size_t *size)
 		return err;
 	}
 
-	return 0;
+	return blob_backend_stat_json(r, json_stat, size);
 }
 
 static void eblob_backend_cleanup(void *priv)
 {
 	struct eblob_backend_config *c = priv;
 
+	blob_iterator_pool_destroy(c->iterator_pool);
+	c->iterator_pool = NULL;
+
 	eblob_cleanup(c->eblob);
 
+	blob_header_cache_destroy(c->header_cache);
+	c->header_cache = NULL;
+
 	pthread_mutex_destroy(&c->last_read_lock);
 }
 
@@ -1502,6 +1674,7 @@ static int dnet_blob_config_init(struct dnet_config_backend *b, enum dnet_log_le
 	c->log.log_private = b->log;
 	c->log.log_level = convert_to_eblob_log(level);
 	c->log.log = dnet_eblob_log_implementation;
+	c->log_level = level;
 
 	c->data.log = &c->log;
 
@@ -1512,23 +1685,44 @@ static int dnet_blob_config_init(struct dnet_config_backend *b, enum dnet_log_le
 		goto err_out_exit;
 	}
 
+	c->header_cache = blob_header_cache_create();
+	if (!c->header_cache) {
+		err = -ENOMEM;
+		goto err_out_last_read_lock_destroy;
+	}
+
 	c->eblob = eblob_init(&c->data);
 	if (!c->eblob) {
 		err = errno;
 		if (err == 0)
 			err = -EINVAL;
-		goto err_out_last_read_lock_destroy;
+		goto err_out_header_cache_destroy;
 	}
 
 	memset(&st, 0, sizeof(struct dnet_vm_stat));
 	err = dnet_get_vm_stat(c->blog, &st);
 	if (err)
-		goto err_out_last_read_lock_destroy;
+		goto err_out_eblob_cleanup;
+
+	c->iterator_pool = blob_iterator_pool_create(c);
+	if (!c->iterator_pool) {
+		err = -ENOMEM;
+		goto err_out_eblob_cleanup;
+	}
 
 	eblob_set_trace_id_function(&dnet_logger_get_trace_bit);
 
 	c->vm_total = st.vm_total * st.vm_total * 1024 * 1024;
 
+	atomic_init(&c->compression_stats.compressed_records, 0);
+	atomic_init(&c->compression_stats.skipped_records, 0);
+	atomic_init(&c->compression_stats.raw_bytes, 0);
+	atomic_init(&c->compression_stats.compressed_bytes, 0);
+	atomic_init(&c->compression_stats.compress_time, 0);
+	atomic_init(&c->compression_stats.decompressed_bytes, 0);
+	atomic_init(&c->compression_stats.decompress_time, 0);
+	atomic_init(&c->verified_checksum_hits, 0);
+
 	b->cb.storage_stat_json = eblob_backend_storage_stat_json;
 	b->cb.total_elements = eblob_backend_total_elements;
 
@@ -1551,6 +1745,12 @@ static int dnet_blob_config_init(struct dnet_config_backend *b, enum dnet_log_le
 
 	return 0;
 
+err_out_eblob_cleanup:
+	eblob_cleanup(c->eblob);
+	c->eblob = NULL;
+err_out_header_cache_destroy:
+	blob_header_cache_destroy(c->header_cache);
+	c->header_cache = NULL;
 err_out_last_read_lock_destroy:
 	pthread_mutex_destroy(&c->last_read_lock);
 err_out_exit:
@@ -1589,6 +1789,7 @@ static void dnet_blob_config_cleanup(struct dnet_config_backend *b)
 static void dnet_blob_set_verbosity(struct dnet_config_backend *b, enum dnet_log_level level) {
 	struct eblob_backend_config *c = b->data;
 	c->log.log_level = convert_to_eblob_log(level);
+	c->log_level = level;
 }
 
 static struct dnet_config_entry dnet_cfg_entries_blobsystem[] = {
@@ -1609,7 +1810,20 @@ static struct dnet_config_entry dnet_cfg_entries_blobsystem[] = {
 	{"backend_id", dnet_blob_set_backend_id},
 	{"bg_ioprio_class", dnet_blob_set_bg_ioprio_class},
 	{"bg_ioprio_data", dnet_blob_set_bg_ioprio_data},
-	{"single_pass_file_size_threshold", dnet_blob_set_single_pass_file_size_threshold}
+	{"single_pass_file_size_threshold", dnet_blob_set_single_pass_file_size_threshold},
+	{"compression", dnet_blob_set_compression},
+	{"compression_min_gain", dnet_blob_set_compression_min_gain},
+	{"verified_checksum_ttl", dnet_blob_set_verified_checksum_ttl},
+	{"iterator_batch_records", dnet_blob_set_iterator_batch_records},
+	{"iterator_batch_size", dnet_blob_set_iterator_batch_size},
+	{"iterator_batch_delay", dnet_blob_set_iterator_batch_delay},
+	{"iterator_threads", dnet_blob_set_iterator_threads},
+	{"iterator_ioprio_class", dnet_blob_set_iterator_ioprio_class},
+	{"iterator_ioprio_data", dnet_blob_set_iterator_ioprio_data},
+	{"iterator_rate_bytes", dnet_blob_set_iterator_rate_bytes},
+	{"iterator_rate_keys", dnet_blob_set_iterator_rate_keys},
+	{"iterator_parallelism", dnet_blob_set_iterator_parallelism},
+	{"bulk_write_sync", dnet_blob_set_bulk_write_sync}
 };
 
 static struct dnet_config_backend dnet_eblob_backend = {
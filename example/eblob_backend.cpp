@@ -19,9 +19,26 @@
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include <boost/scope_exit.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
 
 #include <blackhole/wrapper.hpp>
 
@@ -41,6 +58,7 @@
 
 #include "monitor/measure_points.h"
 
+#include "bindings/cpp/session_internals.hpp"
 #include "bindings/cpp/timer.hpp"
 
 #include "rapidjson/document.h"
@@ -85,8 +103,8 @@ int blob_check_corrupted_stamp(void *buffer, size_t buffer_size) {
 	const auto check_ext_header = [] (const dnet_ext_list_hdr &ehdr) {
 		return (ehdr.version == DNET_EXT_VERSION_FIRST || ehdr.version == DNET_EXT_VERSION_V1) &&
 		       ehdr.timestamp.tsec && ehdr.timestamp.tsec <= DNET_SERVER_SEND_BUGFIX_TIMESTAMP &&
-		       !(ehdr.__pad1[0] || ehdr.__pad1[1] || ehdr.__pad1[2]) &&
-		       !(ehdr.__pad2[0] || ehdr.__pad2[1]);
+		       !(ehdr.compression || ehdr.__pad1[0] || ehdr.__pad1[1]) &&
+		       !(ehdr.data_size || ehdr.__pad2[0]);
 	};
 
 	if (check_ext_header(*ehdr)) {
@@ -136,6 +154,280 @@ static int dnet_get_filename(int fd, std::string &filename) {
 	return 0;
 }
 
+/*
+ * Data of compressed record is split into chunks of blob_compression_chunk_size bytes compressed independently,
+ * so reading a part of the data decompresses only chunks covering it. Stored data starts with the chunk index:
+ *   [blob_compression_header][uint64_t end of each chunk relative to the end of the index][compressed chunks]
+ */
+static const uint32_t blob_compression_chunk_size = 64 * 1024;
+
+struct blob_compression_header {
+	uint32_t chunk_size;
+	uint32_t chunks;
+} __attribute__ ((packed));
+
+static const char *blob_compression_name(int compression) {
+	switch (compression) {
+	case DNET_EXT_COMPRESSION_NONE:
+		return "none";
+	case DNET_EXT_COMPRESSION_ZLIB:
+		return "zlib";
+	default:
+		return "unknown";
+	}
+}
+
+static void blob_zlib_compress(const char *data, size_t size, std::string &compressed) {
+	boost::iostreams::filtering_streambuf<boost::iostreams::output> out;
+	out.push(boost::iostreams::zlib_compressor(boost::iostreams::zlib::best_speed));
+	out.push(std::back_inserter(compressed));
+	boost::iostreams::copy(boost::make_iterator_range(data, data + size), out);
+}
+
+static void blob_zlib_decompress(const char *data, size_t size, std::string &decompressed) {
+	boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+	in.push(boost::iostreams::zlib_decompressor());
+	in.push(boost::make_iterator_range(data, data + size));
+	boost::iostreams::copy(in, std::back_inserter(decompressed));
+}
+
+/*
+ * Compresses @size bytes of @data by backend's codec into @compressed. Returns false if compression doesn't save
+ * compression_min_gain percents of the size, such data should be written as is.
+ */
+static bool blob_compress_data(eblob_backend_config *c, const char *data, uint64_t size, std::string &compressed) {
+	using namespace ioremap::elliptics;
+
+	const uint64_t chunks = (size + blob_compression_chunk_size - 1) / blob_compression_chunk_size;
+	const uint64_t index_size = sizeof(blob_compression_header) + chunks * sizeof(uint64_t);
+	if (!size || chunks > std::numeric_limits<uint32_t>::max())
+		return false;
+
+	util::steady_timer timer;
+
+	compressed.reserve(size);
+	compressed.resize(index_size);
+
+	std::vector<uint64_t> ends;
+	ends.reserve(chunks);
+
+	try {
+		for (uint64_t offset = 0; offset < size; offset += blob_compression_chunk_size) {
+			const uint64_t chunk_size = std::min<uint64_t>(blob_compression_chunk_size, size - offset);
+			blob_zlib_compress(data + offset, chunk_size, compressed);
+			ends.push_back(compressed.size() - index_size);
+		}
+	} catch (const std::exception &e) {
+		DNET_LOG_ERROR(c->blog, "EBLOB: compression of {} bytes failed: {}", size, e.what());
+		return false;
+	}
+
+	atomic_add(&c->compression_stats.compress_time, timer.get_us());
+
+	if (compressed.size() * 100 > size * (100 - c->compression_min_gain)) {
+		atomic_inc(&c->compression_stats.skipped_records);
+		return false;
+	}
+
+	const blob_compression_header header{blob_compression_chunk_size, static_cast<uint32_t>(chunks)};
+	memcpy(&compressed[0], &header, sizeof(header));
+	memcpy(&compressed[sizeof(header)], ends.data(), ends.size() * sizeof(uint64_t));
+
+	atomic_inc(&c->compression_stats.compressed_records);
+	atomic_add(&c->compression_stats.raw_bytes, size);
+	atomic_add(&c->compression_stats.compressed_bytes, compressed.size());
+	return true;
+}
+
+/* compressed chunks covering requested part of uncompressed data, found by blob_locate_compressed() */
+struct blob_compressed_range {
+	uint64_t offset;
+	uint64_t size;
+
+	uint64_t chunk_size;
+	uint64_t first_chunk;
+	/* position of compressed chunks relative to the beginning of stored data */
+	uint64_t chunks_offset;
+	/* beginning of the first chunk followed by ends of all chunks, relative to chunks_offset */
+	std::vector<uint64_t> bounds;
+
+	uint64_t stored_offset() const {
+		return chunks_offset + bounds.front();
+	}
+
+	uint64_t stored_size() const {
+		return bounds.back() - bounds.front();
+	}
+};
+
+/*
+ * Finds chunks of compressed data stored at @data_offset of @fd which cover @size bytes at @offset
+ * of uncompressed data described by @ehdr. Only the part of the index describing these chunks is read.
+ */
+static int blob_locate_compressed(int fd, uint64_t data_offset, const dnet_ext_list_hdr &ehdr,
+                                  uint64_t offset, uint64_t size, blob_compressed_range &range) {
+	if (ehdr.compression != DNET_EXT_COMPRESSION_ZLIB)
+		return -ENOTSUP;
+
+	range.offset = offset;
+	range.size = size;
+	range.bounds.clear();
+
+	if (!size)
+		return 0;
+
+	if (offset + size > ehdr.data_size)
+		return -ERANGE;
+
+	blob_compression_header header;
+	int err = dnet_read_ll(fd, (char *)&header, sizeof(header), data_offset);
+	if (err)
+		return err;
+
+	if (!header.chunk_size ||
+	    header.chunks != (ehdr.data_size + header.chunk_size - 1) / header.chunk_size)
+		return -EILSEQ;
+
+	range.chunk_size = header.chunk_size;
+	range.first_chunk = offset / header.chunk_size;
+	range.chunks_offset = sizeof(header) + header.chunks * sizeof(uint64_t);
+
+	const uint64_t last_chunk = (offset + size - 1) / header.chunk_size;
+
+	range.bounds.resize(last_chunk - range.first_chunk + 2, 0);
+	if (range.first_chunk) {
+		err = dnet_read_ll(fd, (char *)range.bounds.data(), range.bounds.size() * sizeof(uint64_t),
+		                   data_offset + sizeof(header) + (range.first_chunk - 1) * sizeof(uint64_t));
+	} else {
+		err = dnet_read_ll(fd, (char *)(range.bounds.data() + 1), (range.bounds.size() - 1) * sizeof(uint64_t),
+		                   data_offset + sizeof(header));
+	}
+	if (err)
+		return err;
+
+	if (!std::is_sorted(range.bounds.begin(), range.bounds.end()))
+		return -EILSEQ;
+
+	return 0;
+}
+
+/* Reads and decompresses chunks of @range from compressed data stored at @data_offset of @fd */
+static int blob_decompress_range(eblob_backend_config *c, int fd, uint64_t data_offset, const dnet_ext_list_hdr &ehdr,
+                                 const blob_compressed_range &range, ioremap::elliptics::data_pointer &data) {
+	using namespace ioremap::elliptics;
+
+	data = data_pointer();
+	if (!range.size)
+		return 0;
+
+	std::string compressed(range.stored_size(), '\0');
+	int err = dnet_read_ll(fd, &compressed[0], compressed.size(), data_offset + range.stored_offset());
+	if (err)
+		return err;
+
+	util::steady_timer timer;
+
+	std::string decompressed;
+	decompressed.reserve((range.bounds.size() - 1) * range.chunk_size);
+
+	for (size_t i = 0; i + 1 < range.bounds.size(); ++i) {
+		const uint64_t chunk_offset = (range.first_chunk + i) * range.chunk_size;
+		const uint64_t chunk_size = std::min(range.chunk_size, ehdr.data_size - chunk_offset);
+		const size_t size_before = decompressed.size();
+
+		try {
+			blob_zlib_decompress(compressed.data() + range.bounds[i] - range.bounds.front(),
+			                     range.bounds[i + 1] - range.bounds[i], decompressed);
+		} catch (const std::exception &e) {
+			DNET_LOG_ERROR(c->blog, "EBLOB: decompression of chunk {} failed: {}", range.first_chunk + i,
+			               e.what());
+			return -EILSEQ;
+		}
+
+		if (decompressed.size() - size_before != chunk_size)
+			return -EILSEQ;
+	}
+
+	atomic_add(&c->compression_stats.decompress_time, timer.get_us());
+	atomic_add(&c->compression_stats.decompressed_bytes, decompressed.size());
+
+	const uint64_t skip = range.offset - range.first_chunk * range.chunk_size;
+	data = data_pointer::copy(decompressed.data() + skip, range.size);
+	return 0;
+}
+
+/* Reads @size bytes at @offset of uncompressed data of the record compressed by blob_compress_data() */
+static int blob_read_compressed(eblob_backend_config *c, int fd, uint64_t data_offset, const dnet_ext_list_hdr &ehdr,
+                                uint64_t offset, uint64_t size, ioremap::elliptics::data_pointer &data) {
+	blob_compressed_range range;
+	int err = blob_locate_compressed(fd, data_offset, ehdr, offset, size, range);
+	if (err)
+		return err;
+
+	return blob_decompress_range(c, fd, data_offset, ehdr, range, data);
+}
+
+static void blob_iterator_pool_stat(const blob_iterator_pool *pool, rapidjson::Value &value,
+                                    rapidjson::Document::AllocatorType &allocator);
+
+int blob_backend_stat_json(struct eblob_backend_config *c, char **json_stat, size_t *size) {
+	rapidjson::Document doc;
+	doc.Parse<0>(*json_stat);
+	if (doc.HasParseError() || !doc.IsObject())
+		return 0;
+
+	rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
+
+	if (doc.HasMember("config") && doc["config"].IsObject()) {
+		doc["config"].AddMember("compression", blob_compression_name(c->compression), allocator);
+		doc["config"].AddMember("compression_min_gain", c->compression_min_gain, allocator);
+		doc["config"].AddMember("verified_checksum_ttl", c->verified_checksum_ttl, allocator);
+	}
+
+	auto &stats = c->compression_stats;
+	const uint64_t raw_bytes = atomic_read(&stats.raw_bytes);
+	const uint64_t compressed_bytes = atomic_read(&stats.compressed_bytes);
+
+	rapidjson::Value compression(rapidjson::kObjectType);
+	compression.AddMember("compressed_records", static_cast<uint64_t>(atomic_read(&stats.compressed_records)),
+	                      allocator);
+	compression.AddMember("skipped_records", static_cast<uint64_t>(atomic_read(&stats.skipped_records)), allocator);
+	compression.AddMember("raw_bytes", raw_bytes, allocator);
+	compression.AddMember("compressed_bytes", compressed_bytes, allocator);
+	compression.AddMember("ratio", raw_bytes ? double(compressed_bytes) / raw_bytes : 1., allocator);
+	compression.AddMember("compress_time", static_cast<uint64_t>(atomic_read(&stats.compress_time)), allocator);
+	compression.AddMember("decompressed_bytes", static_cast<uint64_t>(atomic_read(&stats.decompressed_bytes)),
+	                      allocator);
+	compression.AddMember("decompress_time", static_cast<uint64_t>(atomic_read(&stats.decompress_time)),
+	                      allocator);
+	doc.AddMember("compression", compression, allocator);
+
+	doc.AddMember("verified_checksum_hits", static_cast<uint64_t>(atomic_read(&c->verified_checksum_hits)),
+	              allocator);
+
+	rapidjson::Value iterators(rapidjson::kArrayType);
+	if (c->iterator_pool)
+		blob_iterator_pool_stat(c->iterator_pool, iterators, allocator);
+	doc.AddMember("iterators", iterators, allocator);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	doc.Accept(writer);
+
+	std::string json = buffer.GetString();
+
+	char *result = (char *)malloc(json.length() + 1);
+	if (!result)
+		return -ENOMEM;
+
+	memcpy(result, json.c_str(), json.length() + 1);
+
+	free(*json_stat);
+	*json_stat = result;
+	*size = json.length();
+	return 0;
+}
+
 int dnet_blob_config_to_json(struct dnet_config_backend *b, char **json_stat, size_t *size) {
 	struct eblob_backend_config *c = static_cast<struct eblob_backend_config *>(b->data);
 	int err = 0;
@@ -160,6 +452,19 @@ int dnet_blob_config_to_json(struct dnet_config_backend *b, char **json_stat, si
 	doc.AddMember("defrag_time", c->data.defrag_time, allocator);
 	doc.AddMember("defrag_splay", c->data.defrag_splay, allocator);
 	doc.AddMember("single_pass_file_size_threshold", c->data.single_pass_file_size_threshold, allocator);
+	doc.AddMember("compression", blob_compression_name(c->compression), allocator);
+	doc.AddMember("compression_min_gain", c->compression_min_gain, allocator);
+	doc.AddMember("verified_checksum_ttl", c->verified_checksum_ttl, allocator);
+	doc.AddMember("iterator_batch_records", c->iterator_batch_records, allocator);
+	doc.AddMember("iterator_batch_size", c->iterator_batch_size, allocator);
+	doc.AddMember("iterator_batch_delay", c->iterator_batch_delay, allocator);
+	doc.AddMember("iterator_threads", c->iterator_threads, allocator);
+	doc.AddMember("iterator_ioprio_class", c->iterator_ioprio_class, allocator);
+	doc.AddMember("iterator_ioprio_data", c->iterator_ioprio_data, allocator);
+	doc.AddMember("iterator_rate_bytes", c->iterator_rate_bytes, allocator);
+	doc.AddMember("iterator_rate_keys", c->iterator_rate_keys, allocator);
+	doc.AddMember("iterator_parallelism", c->iterator_parallelism, allocator);
+	doc.AddMember("bulk_write_sync", c->bulk_write_sync, allocator);
 
 	rapidjson::StringBuffer buffer;
 	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
@@ -204,6 +509,281 @@ int dnet_read_json_header(int fd, uint64_t offset, uint64_t size, dnet_json_head
 	return 0;
 }
 
+/*
+ * Headers of recently accessed records. The slot is chosen by record's key, and the entry is valid only
+ * for the record's current position in the blob, so a record moved by write or defragmentation just misses.
+ * Writes update the entry (records can be rewritten in place), other changes drop it.
+ *
+ * The entry also remembers ranges of the record whose checksums were verified since it was last written,
+ * so repeated reads of immutable records don't hash the same bytes again.
+ */
+struct blob_header_cache {
+	typedef std::chrono::steady_clock clock;
+
+	/* [begin, end) of the record relative to its start */
+	struct range {
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	struct entry {
+		bool valid;
+		eblob_key key;
+		int fd;
+		uint64_t offset;
+		dnet_ext_list_hdr ehdr;
+		dnet_json_header jhdr;
+
+		/* headers with json and data are usually verified separately, so two ranges are kept */
+		std::array<range, 2> verified;
+		clock::time_point verified_at;
+	};
+
+	blob_header_cache() {
+		clear();
+	}
+
+	bool find(const eblob_key &key, int fd, uint64_t offset, dnet_ext_list_hdr &ehdr, dnet_json_header &jhdr) {
+		const size_t index = slot(key);
+		std::lock_guard<std::mutex> guard(locks[index % locks.size()]);
+
+		const auto &e = entries[index];
+		if (!e.valid || e.fd != fd || e.offset != offset || memcmp(e.key.id, key.id, EBLOB_ID_SIZE))
+			return false;
+
+		ehdr = e.ehdr;
+		jhdr = e.jhdr;
+		return true;
+	}
+
+	/*
+	 * Writes must pass @reset_verified: data can be rewritten in place under the very same headers.
+	 * Headers re-read from the disk keep verification state of the unchanged record.
+	 */
+	void store(const eblob_key &key, int fd, uint64_t offset, const dnet_ext_list_hdr &ehdr,
+	           const dnet_json_header &jhdr, bool reset_verified) {
+		const size_t index = slot(key);
+		std::lock_guard<std::mutex> guard(locks[index % locks.size()]);
+
+		auto &e = entries[index];
+		const bool same = e.valid && e.fd == fd && e.offset == offset && !memcmp(e.key.id, key.id, EBLOB_ID_SIZE) &&
+		                  !memcmp(&e.ehdr, &ehdr, sizeof(ehdr)) && !memcmp(&e.jhdr, &jhdr, sizeof(jhdr));
+		e.valid = true;
+		e.key = key;
+		e.fd = fd;
+		e.offset = offset;
+		e.ehdr = ehdr;
+		e.jhdr = jhdr;
+
+		if (reset_verified || !same)
+			e.verified.fill(range{0, 0});
+	}
+
+	/* checks whether [begin, end) of the record was verified less than @ttl ago */
+	bool verified(const eblob_key &key, int fd, uint64_t offset, uint64_t begin, uint64_t end,
+	              clock::duration ttl) {
+		const size_t index = slot(key);
+		std::lock_guard<std::mutex> guard(locks[index % locks.size()]);
+
+		const auto &e = entries[index];
+		if (!e.valid || e.fd != fd || e.offset != offset || memcmp(e.key.id, key.id, EBLOB_ID_SIZE))
+			return false;
+
+		if (clock::now() - e.verified_at >= ttl)
+			return false;
+
+		for (const auto &r : e.verified) {
+			if (r.begin <= begin && end <= r.end)
+				return true;
+		}
+		return false;
+	}
+
+	/* remembers that checksum of [begin, end) of the record is correct, ranges verified @ttl ago are dropped */
+	void set_verified(const eblob_key &key, int fd, uint64_t offset, uint64_t begin, uint64_t end,
+	                  clock::duration ttl) {
+		const size_t index = slot(key);
+		std::lock_guard<std::mutex> guard(locks[index % locks.size()]);
+
+		auto &e = entries[index];
+		if (!e.valid || e.fd != fd || e.offset != offset || memcmp(e.key.id, key.id, EBLOB_ID_SIZE))
+			return;
+
+		/* ttl counts from the oldest verification, so all ranges are re-verified periodically */
+		const auto now = clock::now();
+		if ((e.verified[0].begin == e.verified[0].end && e.verified[1].begin == e.verified[1].end) ||
+		    now - e.verified_at >= ttl) {
+			e.verified.fill(range{0, 0});
+			e.verified_at = now;
+		}
+
+		for (auto &r : e.verified) {
+			if (r.begin != r.end && begin <= r.end && r.begin <= end) {
+				r.begin = std::min(r.begin, begin);
+				r.end = std::max(r.end, end);
+				return;
+			}
+		}
+
+		e.verified[1] = e.verified[0];
+		e.verified[0] = range{begin, end};
+	}
+
+	void forget(const eblob_key &key) {
+		const size_t index = slot(key);
+		std::lock_guard<std::mutex> guard(locks[index % locks.size()]);
+
+		auto &e = entries[index];
+		if (e.valid && !memcmp(e.key.id, key.id, EBLOB_ID_SIZE))
+			e.valid = false;
+	}
+
+	void clear() {
+		for (size_t i = 0; i < entries.size(); ++i) {
+			std::lock_guard<std::mutex> guard(locks[i % locks.size()]);
+			entries[i].valid = false;
+		}
+	}
+
+	/*
+	 * Defragmentation moves records and swaps blobs, so descriptors of the cached records can be reused
+	 * by other files. The cache isn't used while defragmentation is @running and it is cleared once
+	 * defragmentation has finished. Returns whether the cache can be used.
+	 */
+	bool check_defrag(bool running) {
+		if (running) {
+			defragmented = true;
+			return false;
+		}
+
+		if (defragmented) {
+			clear();
+			defragmented = false;
+		}
+		return true;
+	}
+
+private:
+	size_t slot(const eblob_key &key) const {
+		uint64_t hash;
+		memcpy(&hash, key.id, sizeof(hash));
+		return hash % entries.size();
+	}
+
+	std::array<entry, 4096> entries;
+	std::array<std::mutex, 64> locks;
+	std::atomic_bool defragmented{false};
+};
+
+/* checks defragmentation state of the backend, including the one started by eblob itself, see check_defrag() */
+static bool blob_header_cache_usable(eblob_backend_config *c) {
+	return c->header_cache->check_defrag(eblob_defrag_status(c->eblob) != 0);
+}
+
+struct blob_header_cache *blob_header_cache_create(void) {
+	try {
+		return new blob_header_cache;
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void blob_header_cache_destroy(struct blob_header_cache *cache) {
+	delete cache;
+}
+
+void blob_header_cache_forget(struct blob_header_cache *cache, const struct eblob_key *key) {
+	if (cache)
+		cache->forget(*key);
+}
+
+void blob_header_cache_clear(struct blob_header_cache *cache) {
+	if (cache)
+		cache->clear();
+}
+
+/*
+ * Size of record's beginning read at once by blob_read_record_head(),
+ * it holds headers, and json and data of small records.
+ */
+static const uint64_t blob_record_head_size = 4096;
+
+/* headers of the record with BLOB_DISK_CTL_EXTHDR and its beginning read along with them */
+struct blob_record_head {
+	dnet_ext_list_hdr ehdr;
+	dnet_json_header jhdr;
+	/* beginning of the record starting with ext header, it is empty if headers were taken from the cache */
+	ioremap::elliptics::data_pointer data;
+
+	bool covers(uint64_t offset, uint64_t size) const {
+		return size && offset + size <= data.size();
+	}
+};
+
+/*
+ * Reads ext and json headers of the record of @size bytes (0 if it is unknown) at @offset of @fd
+ * by the single read. Json header is left empty if it doesn't fit into the record, the caller should check it.
+ */
+static int blob_read_record_head(int fd, uint64_t offset, uint64_t size, blob_record_head &head) {
+	using namespace ioremap::elliptics;
+
+	memset(&head.ehdr, 0, sizeof(head.ehdr));
+	memset(&head.jhdr, 0, sizeof(head.jhdr));
+	head.data = data_pointer();
+
+	if (!size) {
+		int err = dnet_ext_hdr_read(&head.ehdr, fd, offset);
+		if (err)
+			return err;
+
+		return dnet_read_json_header(fd, offset + sizeof(head.ehdr), head.ehdr.size, &head.jhdr);
+	}
+
+	if (size < sizeof(head.ehdr))
+		return -ERANGE;
+
+	head.data = data_pointer::allocate(std::min(size, blob_record_head_size));
+	int err = dnet_read_ll(fd, head.data.data<char>(), head.data.size(), offset);
+	if (err) {
+		head.data = data_pointer();
+		return err;
+	}
+
+	memcpy(&head.ehdr, head.data.data(), sizeof(head.ehdr));
+
+	const uint64_t headers_size = sizeof(head.ehdr) + head.ehdr.size;
+	if (!head.ehdr.size || headers_size > size)
+		return 0;
+
+	if (headers_size > head.data.size())
+		return dnet_read_json_header(fd, offset + sizeof(head.ehdr), head.ehdr.size, &head.jhdr);
+
+	try {
+		deserialize(head.data.slice(sizeof(head.ehdr), head.ehdr.size), head.jhdr);
+	} catch (const std::exception &) {
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/* blob_read_record_head() for the record found in the index, its headers are looked up in the cache first */
+static int blob_read_record_head(eblob_backend_config *c, const eblob_key &key, const eblob_write_control &wc,
+                                 blob_record_head &head) {
+	const bool use_cache = blob_header_cache_usable(c);
+	if (use_cache && c->header_cache->find(key, wc.data_fd, wc.data_offset, head.ehdr, head.jhdr)) {
+		head.data = ioremap::elliptics::data_pointer();
+		return 0;
+	}
+
+	int err = blob_read_record_head(wc.data_fd, wc.data_offset, wc.total_data_size, head);
+	if (err)
+		return err;
+
+	if (use_cache && sizeof(head.ehdr) + head.ehdr.size <= wc.total_data_size)
+		c->header_cache->store(key, wc.data_fd, wc.data_offset, head.ehdr, head.jhdr, false);
+	return 0;
+}
+
 static int blob_read_and_check_flags_new(const eblob_backend_config *c,
                                          eblob_key *key,
                                          eblob_write_control *wc) {
@@ -263,13 +843,17 @@ int blob_file_info(eblob_backend_config *c, void *state, struct n2_request_info
 			return err;
 		}
 
-		err = dnet_ext_hdr_read(&ehdr, wc.data_fd, wc.data_offset);
+		blob_record_head head;
+		err = blob_read_record_head(c, key, wc, head);
 		if (err) {
-			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: failed to read ext header: {} [{}]",
+			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: failed to read headers: {} [{}]",
 			               dnet_dump_id(&cmd->id), strerror(-err), err);
 			return err;
 		}
 
+		ehdr = head.ehdr;
+		jhdr = head.jhdr;
+
 		if (wc.total_data_size < sizeof(ehdr) + ehdr.size) {
 			err = -ERANGE;
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: invalid record: total_data_size({}) < "
@@ -279,13 +863,6 @@ int blob_file_info(eblob_backend_config *c, void *state, struct n2_request_info
 			return err;
 		}
 
-		err = dnet_read_json_header(wc.data_fd, wc.data_offset + sizeof(ehdr), ehdr.size, &jhdr);
-		if(err) {
-			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: failed to read json header: {} [{}]",
-			               dnet_dump_id(&cmd->id), strerror(-err), err);
-			return err;
-		}
-
 		if (wc.total_data_size < sizeof(ehdr) + ehdr.size + jhdr.capacity) {
 			err = -ERANGE;
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: invalid record: total_data_size({}) < "
@@ -300,7 +877,8 @@ int blob_file_info(eblob_backend_config *c, void *state, struct n2_request_info
 
 	const uint64_t json_size = jhdr.size;
 	const uint64_t data_offset = json_offset + jhdr.capacity;
-	const uint64_t data_size = (wc.size >= data_offset) ? (wc.size - data_offset) : 0;
+	const uint64_t stored_data_size = (wc.size >= data_offset) ? (wc.size - data_offset) : 0;
+	const uint64_t data_size = ehdr.compression ? ehdr.data_size : stored_data_size;
 
 	std::vector<unsigned char> json_checksum;
 	std::vector<unsigned char> data_checksum;
@@ -350,11 +928,11 @@ int blob_file_info(eblob_backend_config *c, void *state, struct n2_request_info
 		};
 
 		err = blob_read_and_check_stamp(c, &ehdr.timestamp, wc.data_fd,
-			                        wc.data_offset + data_offset, data_size);
+			                        wc.data_offset + data_offset, stored_data_size);
 		if (err) {
 			DNET_LOG_ERROR(c->blog, "%s: EBLOB: blob-file-info: corrupted signature: "
 			                        "data offset %" PRIu64 ", data size %" PRIu64,
-			               dnet_dump_id(&cmd->id), wc.data_offset + data_offset, data_size);
+			               dnet_dump_id(&cmd->id), wc.data_offset + data_offset, stored_data_size);
 			return err;
 		}
 
@@ -363,10 +941,27 @@ int blob_file_info(eblob_backend_config *c, void *state, struct n2_request_info
 			return err;
 		}
 
-		err = verify_and_get_checksum(wc, data_offset, data_size, data_checksum, "data", "data_csum_time");
+		err = verify_and_get_checksum(wc, data_offset, stored_data_size, data_checksum, "data",
+		                              "data_csum_time");
 		if (err) {
 			return err;
 		}
+
+		/* checksum of compressed record is calculated over its uncompressed data */
+		if (ehdr.compression && data_size) {
+			data_pointer data;
+			err = blob_read_compressed(c, wc.data_fd, wc.data_offset + data_offset, ehdr, 0, data_size, data);
+			if (!err) {
+				err = dnet_checksum_data(st->n, data.data(), data.size(), data_checksum.data(),
+				                         data_checksum.size());
+			}
+			if (err) {
+				DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: failed to calculate checksum of "
+				                        "compressed data: {} [{}]",
+				               dnet_dump_id(&cmd->id), strerror(-err), err);
+				return err;
+			}
+		}
 	}
 
 	err = req_info->repliers.on_last_reply(
@@ -388,7 +983,7 @@ int blob_file_info(eblob_backend_config *c, void *state, struct n2_request_info
 		return err;
 	}
 
-	DNET_LOG_INFO(c->blog, "{}: EBLOB: blob-file-info-new: fd: {}, json_size: {}, data_size: {}",
+	BLOB_LOG_INFO(c, "{}: EBLOB: blob-file-info-new: fd: {}, json_size: {}, data_size: {}",
 	              dnet_dump_id(&cmd->id), wc.data_fd, json_size, data_size);
 
 	return 0;
@@ -405,7 +1000,7 @@ static int blob_del_new_cas(eblob_backend_config *c, eblob_backend *b, const dne
 	}
 
 	if (!(wc.flags & BLOB_DISK_CTL_EXTHDR)) {
-		DNET_LOG_INFO(c->blog, "{}: EBLOB: {}: REMOVE_NEW: key doesn't have exthdr",
+		BLOB_LOG_INFO(c, "{}: EBLOB: {}: REMOVE_NEW: key doesn't have exthdr",
 			      dnet_dump_id(&cmd->id), __func__);
 		return 0;
 	}
@@ -462,7 +1057,7 @@ int blob_del_new(eblob_backend_config *c, struct n2_request_info *req_info, stru
 		}
 	}
 
-	DNET_LOG_INFO(c->blog, "{}: EBLOB: {}: REMOVE_NEW: start: ioflags: {}",
+	BLOB_LOG_INFO(c, "{}: EBLOB: {}: REMOVE_NEW: start: ioflags: {}",
 		      dnet_dump_id(&cmd->id), __func__, dnet_flags_dump_ioflags(request->ioflags));
 
 	eblob_key key;
@@ -476,6 +1071,7 @@ int blob_del_new(eblob_backend_config *c, struct n2_request_info *req_info, stru
 	}
 
 	err = eblob_remove(b, &key);
+	blob_header_cache_forget(c->header_cache, &key);
 
 	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "{}: EBLOB: {} finished: {}",
 		 dnet_dump_id(&cmd->id), __func__, dnet_print_error(err));
@@ -487,26 +1083,38 @@ int blob_del_new(eblob_backend_config *c, struct n2_request_info *req_info, stru
 	return req_info->repliers.on_last_ack();
 }
 
-static int blob_read_new_impl(eblob_backend_config *c,
-                              void *state,
-                              dnet_cmd *cmd,
-                              dnet_cmd_stats *cmd_stats,
-                              const ioremap::elliptics::dnet_read_request &request,
-                              bool last_read,
-                              dnet_access_context *context) {
+/* record's location, headers and json read and verified by blob_read_new_prepare() */
+struct blob_read_new_record {
+	eblob_write_control wc;
+	dnet_ext_list_hdr ehdr;
+	dnet_json_header jhdr;
+	ioremap::elliptics::data_pointer json;
+	/* position of requested data in the blob */
+	uint64_t data_offset;
+	uint64_t data_size;
+	/* requested data if it is already in memory: decompressed or read along with headers */
+	ioremap::elliptics::data_pointer data;
+	bool in_memory;
+	/* size of record's uncompressed data */
+	uint64_t total_data_size;
+
+	uint64_t headers_csum_time;
+	uint64_t json_csum_time;
+	uint64_t data_csum_time;
+};
+
+static int blob_read_new_prepare(eblob_backend_config *c,
+                                 dnet_cmd *cmd,
+                                 const ioremap::elliptics::dnet_read_request &request,
+                                 blob_read_new_record &record) {
 	using namespace ioremap::elliptics;
 
 	eblob_backend *b = c->eblob;
 
-	DNET_LOG_NOTICE(c->blog, "{}: EBLOB: blob-read-new: {}: start: ioflags: {}, read_flags: {}, "
-	                         "data_offset: {}, data_size: {}",
-	                dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), dnet_flags_dump_ioflags(request.ioflags),
-	                dnet_dump_read_flags(request.read_flags), request.data_offset, request.data_size);
-
 	eblob_key key;
 	memcpy(key.id, cmd->id.id, EBLOB_ID_SIZE);
 
-	eblob_write_control wc;
+	auto &wc = record.wc;
 	int err = blob_read_and_check_flags_new(c, &key, &wc);
 	if (err) {
 		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: failed: {} [{}]", dnet_dump_id(&cmd->id),
@@ -514,25 +1122,42 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		return err;
 	}
 
+	const auto verified_ttl = std::chrono::seconds(c->verified_checksum_ttl);
+
 	auto verify_checksum = [&, wc] (uint64_t offset, uint64_t size, uint64_t &csum_time) mutable {
 		if (request.ioflags & DNET_IO_FLAGS_NOCSUM)
 			return 0;
-		wc.offset = offset;
+
+		if (c->verified_checksum_ttl && blob_header_cache_usable(c) &&
+		    c->header_cache->verified(key, wc.data_fd, wc.data_offset, offset, offset + size, verified_ttl)) {
+			atomic_inc(&c->verified_checksum_hits);
+			return 0;
+		}
+
+		wc.offset = offset;
 		wc.size = size;
 		util::steady_timer timer;
 		const auto ret = eblob_verify_checksum(b, &key, &wc);
 		csum_time = timer.get_us();
+
+		if (ret)
+			blob_header_cache_forget(c->header_cache, &key);
+		else if (c->verified_checksum_ttl)
+			c->header_cache->set_verified(key, wc.data_fd, wc.data_offset, offset, offset + size,
+			                              verified_ttl);
 		return ret;
 	};
 
-	dnet_ext_list_hdr ehdr;
-	memset(&ehdr, 0, sizeof(ehdr));
+	blob_record_head head;
+	memset(&head.ehdr, 0, sizeof(head.ehdr));
+	memset(&head.jhdr, 0, sizeof(head.jhdr));
 
-	dnet_json_header jhdr;
-	memset(&jhdr, 0, sizeof(jhdr));
+	auto &ehdr = head.ehdr;
+	auto &jhdr = head.jhdr;
 
 	uint64_t record_offset = 0;
-	uint64_t headers_csum_time = 0;
+	record.headers_csum_time = 0;
+	record.in_memory = false;
 
 	if (wc.flags & BLOB_DISK_CTL_EXTHDR) {
 		if (wc.total_data_size < sizeof(ehdr)) {
@@ -544,9 +1169,9 @@ static int blob_read_new_impl(eblob_backend_config *c,
 			return err;
 		}
 
-		err = dnet_ext_hdr_read(&ehdr, wc.data_fd, wc.data_offset);
+		err = blob_read_record_head(c, key, wc, head);
 		if (err) {
-			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read ext header : {} [{}]",
+			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read headers : {} [{}]",
 			               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), strerror(-err), err);
 			return err;
 		}
@@ -560,13 +1185,6 @@ static int blob_read_new_impl(eblob_backend_config *c,
 			return err;
 		}
 
-		err = dnet_read_json_header(wc.data_fd, wc.data_offset + sizeof(ehdr), ehdr.size, &jhdr);
-		if (err) {
-			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read json header : {} [{}]",
-			               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), strerror(-err), err);
-			return err;
-		}
-
 		if (wc.total_data_size < sizeof(ehdr) + ehdr.size + jhdr.capacity) {
 			err = -ERANGE;
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: invalid record: total_data_size({}) < "
@@ -581,7 +1199,7 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		 * it is too heavy operation.
 		 */
 		if (wc.flags & BLOB_DISK_CTL_CHUNKED_CSUM) {
-			err = verify_checksum(0, sizeof(ehdr) + ehdr.size, headers_csum_time);
+			err = verify_checksum(0, sizeof(ehdr) + ehdr.size, record.headers_csum_time);
 			if (err) {
 				DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to verify checksum for headers: "
 				                        "fd: {}, offset: {}, size: {}: {} [{}]",
@@ -607,11 +1225,11 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		return err;
 	}
 
-	data_pointer json;
-	uint64_t json_csum_time = 0;
+	auto &json = record.json;
+	record.json_csum_time = 0;
 
 	if (request.read_flags & DNET_READ_FLAGS_JSON && jhdr.size) {
-		err = verify_checksum(record_offset, jhdr.size, json_csum_time);
+		err = verify_checksum(record_offset, jhdr.size, record.json_csum_time);
 		if (err) {
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to verify checksum for "
 			                        "json: fd: {}, offset: {}, size: {}: {} [{}]",
@@ -620,8 +1238,12 @@ static int blob_read_new_impl(eblob_backend_config *c,
 			return err;
 		}
 
-		json = data_pointer::allocate(jhdr.size);
-		err = dnet_read_ll(wc.data_fd, (char*)json.data(), json.size(), wc.data_offset);
+		if (head.covers(record_offset, jhdr.size)) {
+			json = head.data.slice(record_offset, jhdr.size);
+		} else {
+			json = data_pointer::allocate(jhdr.size);
+			err = dnet_read_ll(wc.data_fd, (char*)json.data(), json.size(), wc.data_offset);
+		}
 		if (err) {
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read json: fd: {}, "
 			                        "offset: {}, size: {}: {} [{}]",
@@ -633,10 +1255,11 @@ static int blob_read_new_impl(eblob_backend_config *c,
 
 	data_size = 0;
 	data_offset = 0;
-	uint64_t data_csum_time = 0;
+	record.data_csum_time = 0;
+	record.total_data_size = ehdr.compression ? ehdr.data_size : wc.size - jhdr.capacity;
 
 	if (request.read_flags & DNET_READ_FLAGS_DATA) {
-		data_size = wc.size - jhdr.capacity;
+		data_size = record.total_data_size;
 		data_offset = wc.data_offset + jhdr.capacity;
 
 		if (request.data_offset && request.data_offset >= data_size) {
@@ -649,13 +1272,39 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		}
 
 		data_size -= request.data_offset;
-		data_offset += request.data_offset;
-		record_offset += request.data_offset;
 
 		if (request.data_size && request.data_size < data_size)
 			data_size = request.data_size;
 
-		err = verify_checksum(record_offset + jhdr.capacity, data_size, data_csum_time);
+		if (ehdr.compression) {
+			blob_compressed_range range;
+			err = blob_locate_compressed(wc.data_fd, data_offset, ehdr, request.data_offset, data_size, range);
+			if (!err && data_size) {
+				err = verify_checksum(record_offset + jhdr.capacity + range.stored_offset(),
+				                      range.stored_size(), record.data_csum_time);
+			}
+			if (!err)
+				err = blob_decompress_range(c, wc.data_fd, data_offset, ehdr, range, record.data);
+			if (err) {
+				DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read compressed data: "
+				                        "offset: {}, size: {}: {} [{}]",
+				               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), request.data_offset,
+				               data_size, strerror(-err), err);
+				return err;
+			}
+
+			record.ehdr = ehdr;
+			record.jhdr = jhdr;
+			record.data_offset = data_offset + range.stored_offset();
+			record.data_size = data_size;
+			record.in_memory = true;
+			return 0;
+		}
+
+		data_offset += request.data_offset;
+		record_offset += request.data_offset;
+
+		err = verify_checksum(record_offset + jhdr.capacity, data_size, record.data_csum_time);
 		if (err) {
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to verify checksum for "
 			                        "data: offset: {}, size: {}: {} [{}]",
@@ -663,8 +1312,113 @@ static int blob_read_new_impl(eblob_backend_config *c,
 			               request.data_size, strerror(-err), err);
 			return err;
 		}
+
+		/* data of small record is read along with its headers */
+		if (head.covers(record_offset + jhdr.capacity, data_size)) {
+			record.data = head.data.slice(record_offset + jhdr.capacity, data_size);
+			record.in_memory = true;
+		}
 	}
 
+	record.ehdr = ehdr;
+	record.jhdr = jhdr;
+	record.data_offset = data_offset;
+	record.data_size = data_size;
+	return 0;
+}
+
+/*
+ * Result of the first read of the last read flight (see dnet_current_read_flight()). Reads of the flight
+ * are processed one after another by the same io thread, so it is kept in thread-local storage
+ * until the thread serves next read.
+ */
+struct blob_read_new_flight {
+	uint64_t flight;
+	const eblob_backend_config *c;
+	dnet_raw_id id;
+	uint64_t ioflags;
+	uint64_t read_flags;
+	uint64_t data_offset;
+	uint64_t data_size;
+
+	int err;
+	blob_read_new_record record;
+};
+
+/*
+ * Identical reads of the same flight are served by the single lookup, headers read and checksum verification
+ * made for the first of them. Errors are shared too.
+ */
+static int blob_read_new_prepare_coalesced(eblob_backend_config *c,
+                                           dnet_cmd *cmd,
+                                           const ioremap::elliptics::dnet_read_request &request,
+                                           blob_read_new_record &record) {
+	static thread_local blob_read_new_flight current{};
+
+	const uint64_t flight = dnet_current_read_flight();
+	if (!flight)
+		return blob_read_new_prepare(c, cmd, request, record);
+
+	if (current.flight == flight &&
+	    current.c == c &&
+	    !memcmp(current.id.id, cmd->id.id, DNET_ID_SIZE) &&
+	    current.ioflags == request.ioflags &&
+	    current.read_flags == request.read_flags &&
+	    current.data_offset == request.data_offset &&
+	    current.data_size == request.data_size) {
+		record = current.record;
+		record.headers_csum_time = record.json_csum_time = record.data_csum_time = 0;
+
+		BLOB_LOG_NOTICE(c, "{}: EBLOB: blob-read-new: {}: served by coalesced read: flight: {}, err: {}",
+		                dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), flight, current.err);
+		return current.err;
+	}
+
+	current = blob_read_new_flight{};
+	current.flight = flight;
+	current.c = c;
+	memcpy(current.id.id, cmd->id.id, DNET_ID_SIZE);
+	current.ioflags = request.ioflags;
+	current.read_flags = request.read_flags;
+	current.data_offset = request.data_offset;
+	current.data_size = request.data_size;
+	current.err = blob_read_new_prepare(c, cmd, request, current.record);
+
+	record = current.record;
+	return current.err;
+}
+
+static int blob_read_new_impl(eblob_backend_config *c,
+                              void *state,
+                              dnet_cmd *cmd,
+                              dnet_cmd_stats *cmd_stats,
+                              const ioremap::elliptics::dnet_read_request &request,
+                              bool last_read,
+                              dnet_access_context *context,
+                              bool coalesce = false) {
+	using namespace ioremap::elliptics;
+
+	BLOB_LOG_NOTICE(c, "{}: EBLOB: blob-read-new: {}: start: ioflags: {}, read_flags: {}, "
+	                  "data_offset: {}, data_size: {}",
+	                dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), dnet_flags_dump_ioflags(request.ioflags),
+	                dnet_dump_read_flags(request.read_flags), request.data_offset, request.data_size);
+
+	blob_read_new_record record;
+	int err = coalesce ? blob_read_new_prepare_coalesced(c, cmd, request, record)
+	                   : blob_read_new_prepare(c, cmd, request, record);
+	if (err)
+		return err;
+
+	const auto &wc = record.wc;
+	const auto &ehdr = record.ehdr;
+	const auto &jhdr = record.jhdr;
+	const auto &json = record.json;
+	const uint64_t data_offset = record.data_offset;
+	const uint64_t data_size = record.data_size;
+	const uint64_t headers_csum_time = record.headers_csum_time;
+	const uint64_t json_csum_time = record.json_csum_time;
+	const uint64_t data_csum_time = record.data_csum_time;
+
 	cmd_stats->size = json.size() + data_size;
 
 	auto header = serialize(dnet_read_response{
@@ -677,7 +1431,7 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		json.size(),
 
 		ehdr.timestamp,
-		wc.size - jhdr.capacity,
+		record.total_data_size,
 		request.data_offset,
 		data_size,
 	});
@@ -693,8 +1447,13 @@ static int blob_read_new_impl(eblob_backend_config *c,
 	response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
 
 	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
-	err = dnet_send_fd((dnet_net_state *)state, response.data(), response.size(),
-	                   wc.data_fd, data_offset, data_size, 0, context);
+	if (record.in_memory) {
+		err = dnet_send_data((dnet_net_state *)state, response.data(), response.size(),
+		                     record.data.data(), record.data.size(), context);
+	} else {
+		err = dnet_send_fd((dnet_net_state *)state, response.data(), response.size(),
+		                   wc.data_fd, data_offset, data_size, 0, context);
+	}
 
 	if (err) {
 		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: dnet_send_reply: data {:p}, size: {}: {} [{}]",
@@ -711,8 +1470,8 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		            });
 	}
 
-	DNET_LOG_INFO(c->blog, "{}: EBLOB: blob-read-new: json_size: {}, data_size: {}, headers_csum_time: {} usecs, "
-	                       "json_csum_time: {} usecs, data_csum_time: {} usecs",
+	BLOB_LOG_INFO(c, "{}: EBLOB: blob-read-new: json_size: {}, data_size: {}, headers_csum_time: {} usecs, "
+	                "json_csum_time: {} usecs, data_csum_time: {} usecs",
 	              dnet_dump_id(&cmd->id), json.size(), data_size, headers_csum_time, json_csum_time,
 	              data_csum_time);
 
@@ -745,47 +1504,33 @@ int blob_read_new(eblob_backend_config *c,
 		}
 	}
 
-	return blob_read_new_impl(c, state, cmd, cmd_stats, request, true, context);
+	return blob_read_new_impl(c, state, cmd, cmd_stats, request, true, context, /*coalesce*/ true);
 }
 
-int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *data,
-                   dnet_cmd_stats *cmd_stats, struct dnet_access_context *context) {
+/*
+ * Writes json and data of @data_p to the record @cmd->id as described by @request. Serialized dnet_lookup_response
+ * of the written record is returned via @response, it stays empty if DNET_IO_FLAGS_WRITE_NO_FILE_INFO is set.
+ * Location of the written record is returned via @written if it isn't null, its descriptors are valid only
+ * while the caller holds the key's oplock, which should be held during the call.
+ */
+static int blob_write_new_impl(eblob_backend_config *c,
+                               const dnet_cmd *cmd,
+                               ioremap::elliptics::dnet_write_request request,
+                               const ioremap::elliptics::data_pointer &data_p,
+                               ioremap::elliptics::data_pointer &response,
+                               eblob_write_control *written = nullptr) {
 	using namespace ioremap::elliptics;
 
 	struct eblob_backend *b = c->eblob;
-	auto data_p = data_pointer::from_raw(data, cmd->size);
-
-	auto request = [&data_p] () {
-		size_t offset = 0;
-		dnet_write_request request;
-		deserialize(data_p, request, offset);
-		data_p = data_p.skip(offset);
-		return request;
-	} ();
-
-	if (context) {
-		context->add({{"id", std::string(dnet_dump_id(&cmd->id))},
-		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
-		              {"request_data_offset", request.data_offset},
-		              {"request_data_size", request.data_size},
-		              {"request_data_commit_size", request.data_commit_size},
-		              {"request_data_capacity", request.data_capacity},
-		              {"request_json_size", request.json_size},
-		              {"request_json_capacity", request.json_capacity},
-		              {"user_flags", to_hex_string(request.user_flags)},
-		             });
-	}
-
-	cmd_stats->size = request.json_size + request.data_size;
 
-	DNET_LOG_NOTICE(c->blog, "{}: EBLOB: blob-write-new: WRITE_NEW: start: ioflags: {}, json: {{size: {}, "
-	                         "capacity: {}}}, data: {{offset: {}, size: {}, capacity: {}, commit_size: {}}}",
+	BLOB_LOG_NOTICE(c, "{}: EBLOB: blob-write-new: WRITE_NEW: start: ioflags: {}, json: {{size: {}, "
+	                  "capacity: {}}}, data: {{offset: {}, size: {}, capacity: {}, commit_size: {}}}",
 	                dnet_dump_id(&cmd->id), dnet_flags_dump_ioflags(request.ioflags), request.json_size,
 	                request.json_capacity, request.data_offset, request.data_size, request.data_capacity,
 	                request.data_commit_size);
 
 	if (request.ioflags & DNET_IO_FLAGS_APPEND) {
-		DNET_LOG_NOTICE(c->blog, "{}: EBLOB: blob-write-new: WRITE_NEW: append is not supported",
+		BLOB_LOG_NOTICE(c, "{}: EBLOB: blob-write-new: WRITE_NEW: append is not supported",
 		                dnet_dump_id(&cmd->id));
 		return -ENOTSUP;
 	}
@@ -808,11 +1553,12 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 		if (!(wc.flags & BLOB_DISK_CTL_EXTHDR))
 			return;
 
-		if (dnet_ext_hdr_read(&ehdr, wc.data_fd, wc.data_offset))
+		blob_record_head head;
+		if (blob_read_record_head(c, key, wc, head))
 			return;
 
-		if (ehdr.size)
-			dnet_read_json_header(wc.data_fd, wc.data_offset + sizeof(ehdr), ehdr.size, &jhdr);
+		ehdr = head.ehdr;
+		jhdr = head.jhdr;
 	};
 
 	if (!(request.ioflags & DNET_IO_FLAGS_PREPARE) || (request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP)) {
@@ -852,6 +1598,25 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 	ehdr.timestamp = request.timestamp;
 	ehdr.flags = request.user_flags;
 
+	void *data_ptr = request.data_size ? data_p.skip(request.json_size).data() : nullptr;
+
+	/* only data written entirely by the single request can be compressed, chunked writes are stored as is */
+	std::string compressed;
+	if (c->compression != DNET_EXT_COMPRESSION_NONE &&
+	    (request.ioflags & (DNET_IO_FLAGS_PREPARE | DNET_IO_FLAGS_COMMIT)) ==
+	            (DNET_IO_FLAGS_PREPARE | DNET_IO_FLAGS_COMMIT) &&
+	    !(request.ioflags & DNET_IO_FLAGS_UPDATE_JSON) &&
+	    request.data_offset == 0 &&
+	    request.data_size == request.data_commit_size &&
+	    request.data_capacity <= request.data_size &&
+	    blob_compress_data(c, static_cast<const char *>(data_ptr), request.data_size, compressed)) {
+		ehdr.compression = c->compression;
+		ehdr.data_size = request.data_size;
+
+		data_ptr = &compressed[0];
+		request.data_size = request.data_commit_size = request.data_capacity = compressed.size();
+	}
+
 	dnet_json_header jhdr;
 	memset(&jhdr, 0, sizeof(jhdr));
 	if (request.json_capacity || request.json_size) {
@@ -884,6 +1649,10 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 			if (!record_exists)
 				return;
 
+			/* data is not rewritten here, so it keeps its codec */
+			ehdr.compression = disk_ehdr.compression;
+			ehdr.data_size = disk_ehdr.data_size;
+
 			if (request.ioflags & DNET_IO_FLAGS_UPDATE_JSON)
 				ehdr.timestamp = disk_ehdr.timestamp;
 
@@ -944,7 +1713,7 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 
 	if (request.data_size) {
 		const auto offset = sizeof(ehdr) + ehdr.size + jhdr.capacity + request.data_offset;
-		iov.emplace_back(eblob_iovec{data_p.skip(request.json_size).data(), request.data_size, offset});
+		iov.emplace_back(eblob_iovec{data_ptr, request.data_size, offset});
 	}
 
 	if (request.ioflags & DNET_IO_FLAGS_PLAIN_WRITE) {
@@ -957,6 +1726,7 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 	}
 
 	if (err) {
+		blob_header_cache_forget(c->header_cache, &key);
 		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: WRITE_NEW: writev failed {} [{}]",
 		               dnet_dump_id(&cmd->id), strerror(-err), err);
 		return err;
@@ -966,6 +1736,7 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 		const uint64_t commit_size = sizeof(ehdr) + ehdr.size + jhdr.capacity + request.data_commit_size;
 		err = eblob_write_commit(b, &key, commit_size, flags);
 		if (err) {
+			blob_header_cache_forget(c->header_cache, &key);
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: eblob_write_commit: size: {}: {} [{}]",
 			               dnet_dump_id(&cmd->id), commit_size, strerror(-err), err);
 			return err;
@@ -975,13 +1746,19 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 	memset(&wc, 0, sizeof(wc));
 	err = eblob_read_return(b, &key, EBLOB_READ_NOCSUM, &wc);
 	if (err) {
+		blob_header_cache_forget(c->header_cache, &key);
 		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: eblob_read failed: {} [{}]", dnet_dump_id(&cmd->id),
 		               strerror(-err), err);
 		return err;
 	}
 
+	/* the record could be rewritten in place, so its cached headers are replaced and its data is unverified */
+	c->header_cache->store(key, wc.data_fd, wc.data_offset, ehdr, jhdr, true);
+
+	if (written)
+		*written = wc;
+
 	if (request.ioflags & DNET_IO_FLAGS_WRITE_NO_FILE_INFO) {
-		cmd->flags |= DNET_FLAGS_NEED_ACK;
 		return 0;
 	}
 
@@ -1001,7 +1778,7 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 			return -EINVAL;
 	}
 
-	auto response = serialize(dnet_lookup_response{
+	response = serialize(dnet_lookup_response{
 		wc.flags,
 		ehdr.flags,
 		filename,
@@ -1014,10 +1791,56 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 
 		ehdr.timestamp,
 		wc.data_offset + jhdr.capacity,
-		wc.size ? (wc.size - jhdr.capacity) : 0,
+		ehdr.compression ? ehdr.data_size : (wc.size ? (wc.size - jhdr.capacity) : 0),
 		{},
 	});
 
+	BLOB_LOG_INFO(c, "{}: EBLOB: blob-write-new: ioflags: {}, json_size: {}, data_size: {}, compression: {}",
+	              dnet_dump_id(&cmd->id), dnet_flags_dump_ioflags(request.ioflags), jhdr.size,
+	              wc.size - jhdr.capacity, blob_compression_name(ehdr.compression));
+
+	return 0;
+}
+
+int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *data,
+                   dnet_cmd_stats *cmd_stats, struct dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	auto data_p = data_pointer::from_raw(data, cmd->size);
+
+	const auto request = [&data_p] () {
+		size_t offset = 0;
+		dnet_write_request request;
+		deserialize(data_p, request, offset);
+		data_p = data_p.skip(offset);
+		return request;
+	} ();
+
+	if (context) {
+		context->add({{"id", std::string(dnet_dump_id(&cmd->id))},
+		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
+		              {"request_data_offset", request.data_offset},
+		              {"request_data_size", request.data_size},
+		              {"request_data_commit_size", request.data_commit_size},
+		              {"request_data_capacity", request.data_capacity},
+		              {"request_json_size", request.json_size},
+		              {"request_json_capacity", request.json_capacity},
+		              {"user_flags", to_hex_string(request.user_flags)},
+		             });
+	}
+
+	cmd_stats->size = request.json_size + request.data_size;
+
+	data_pointer response;
+	int err = blob_write_new_impl(c, cmd, request, data_p, response);
+	if (err)
+		return err;
+
+	if (request.ioflags & DNET_IO_FLAGS_WRITE_NO_FILE_INFO) {
+		cmd->flags |= DNET_FLAGS_NEED_ACK;
+		return 0;
+	}
+
 	err = dnet_send_reply(state, cmd, response.data(), response.size(), 0, context);
 	if (err) {
 		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: dnet_send_reply: data: {:p}, size: {}: {} [{}]",
@@ -1025,10 +1848,6 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 		return err;
 	}
 
-	DNET_LOG_INFO(c->blog, "{}: EBLOB: blob-write-new: ioflags: {}, json_size: {}, data_size: {}",
-	              dnet_dump_id(&cmd->id), dnet_flags_dump_ioflags(request.ioflags), jhdr.size,
-	              wc.size - jhdr.capacity);
-
 	return 0;
 }
 
@@ -1073,7 +1892,7 @@ static bool check_key_ranges(eblob_backend_config *c, ioremap::elliptics::dnet_i
 	request.flags |= DNET_IFLAGS_KEY_RANGE;
 
 	for (const auto &range : request.key_ranges) {
-		DNET_LOG_NOTICE(c->blog, "EBLOB: iterator: using key range: {}...{}",
+		BLOB_LOG_NOTICE(c, "EBLOB: iterator: using key range: {}...{}",
 		                dnet_dump_id_len_raw(range.key_begin.id, DNET_ID_SIZE, k1),
 		                dnet_dump_id_len_raw(range.key_end.id, DNET_ID_SIZE, k2));
 	}
@@ -1091,7 +1910,7 @@ static bool check_ts_range(eblob_backend_config *c, ioremap::elliptics::dnet_ite
 	static const dnet_time empty_time{0, 0};
 	if ((memcmp(&empty_time, &std::get<0>(request.time_range), sizeof(empty_time)) == 0) &&
 	    (memcmp(&empty_time, &std::get<1>(request.time_range), sizeof(empty_time)) == 0)) {
-		DNET_LOG_NOTICE(c->blog, "EBLOB: iterator: both times are zero");
+		BLOB_LOG_NOTICE(c, "EBLOB: iterator: both times are zero");
 		return true;
 	}
 
@@ -1105,7 +1924,7 @@ static bool check_ts_range(eblob_backend_config *c, ioremap::elliptics::dnet_ite
 	const std::string time_begin = dnet_print_time(&std::get<0>(request.time_range));
 	const std::string time_end = dnet_print_time(&std::get<1>(request.time_range));
 
-	DNET_LOG_NOTICE(c->blog, "EBLOB: iterator: using ts range: {}...{}", time_begin, time_end);
+	BLOB_LOG_NOTICE(c, "EBLOB: iterator: using ts range: {}...{}", time_begin, time_end);
 	return true;
 }
 
@@ -1116,7 +1935,8 @@ struct iterated_key_info {
 	, fd{fd}
 	, json_offset{0}
 	, data_offset{0}
-	, data_size{0} {
+	, data_size{0}
+	, head_offset{0} {
 		memset(&jhdr, 0, sizeof(jhdr));
 		memset(&ehdr, 0, sizeof(ehdr));
 	}
@@ -1127,7 +1947,8 @@ struct iterated_key_info {
 	, fd{fd}
 	, json_offset{0}
 	, data_offset{0}
-	, data_size{0} {
+	, data_size{0}
+	, head_offset{0} {
 		memcpy(key.id, dc->key.id, DNET_ID_SIZE);
 
 		memset(&jhdr, 0, sizeof(jhdr));
@@ -1142,10 +1963,136 @@ struct iterated_key_info {
 	uint64_t data_size;
 	dnet_json_header jhdr;
 	dnet_ext_list_hdr ehdr;
+
+	/* beginning of the record read together with its headers, it may already contain json and small data */
+	ioremap::elliptics::data_pointer head;
+	uint64_t head_offset;
+
+	/* returns @size bytes at @offset of blob if they were read with the headers, otherwise empty pointer */
+	ioremap::elliptics::data_pointer from_head(uint64_t offset, uint64_t size) const {
+		if (head.empty() || offset < head_offset || offset - head_offset + size > head.size())
+			return ioremap::elliptics::data_pointer();
+		return head.slice(offset - head_offset, size);
+	}
 };
 
 typedef std::function<int (std::shared_ptr<iterated_key_info> info)> iterator_callback;
 
+static bool blob_json_equal(const rapidjson::Value &lhs, const rapidjson::Value &rhs) {
+	if (lhs.GetType() != rhs.GetType())
+		return false;
+
+	switch (lhs.GetType()) {
+	case rapidjson::kStringType:
+		return lhs.GetStringLength() == rhs.GetStringLength() &&
+		       !memcmp(lhs.GetString(), rhs.GetString(), lhs.GetStringLength());
+	case rapidjson::kNumberType:
+		if (lhs.IsInt64() && rhs.IsInt64())
+			return lhs.GetInt64() == rhs.GetInt64();
+		if (lhs.IsUint64() && rhs.IsUint64())
+			return lhs.GetUint64() == rhs.GetUint64();
+		return lhs.GetDouble() == rhs.GetDouble();
+	case rapidjson::kArrayType:
+		if (lhs.Size() != rhs.Size())
+			return false;
+		for (rapidjson::SizeType i = 0; i < lhs.Size(); ++i) {
+			if (!blob_json_equal(lhs[i], rhs[i]))
+				return false;
+		}
+		return true;
+	case rapidjson::kObjectType: {
+		size_t members = 0;
+		for (auto it = rhs.MemberBegin(); it != rhs.MemberEnd(); ++it)
+			++members;
+		for (auto it = lhs.MemberBegin(); it != lhs.MemberEnd(); ++it, --members) {
+			if (!members || !rhs.HasMember(it->name.GetString()) ||
+			    !blob_json_equal(it->value, rhs[it->name.GetString()]))
+				return false;
+		}
+		return !members;
+	}
+	default:
+		/* null, true and false are fully described by their types */
+		return true;
+	}
+}
+
+/*
+ * Filter of the iterator started with DNET_IFLAGS_FILTER. It is checked against record's headers
+ * before record's json and data are read, only json predicate reads json of the record.
+ */
+class blob_iterator_filter {
+public:
+	explicit blob_iterator_filter(const ioremap::elliptics::dnet_iterator_filter &filter)
+	: m_filter(filter)
+	, m_filtered{0} {
+	}
+
+	/* parses expected json value, returns false if it isn't valid json */
+	bool init() {
+		if (m_filter.json_key.empty())
+			return true;
+
+		/* the old rapidjson accepts only objects and arrays as the root, so the value is wrapped into array */
+		const std::string wrapped = "[" + m_filter.json_value + "]";
+		m_json_value.Parse<0>(wrapped.c_str());
+		return !m_json_value.HasParseError() && m_json_value.IsArray() && m_json_value.Size() == 1;
+	}
+
+	/* returns 1 if the record matches, 0 if it is filtered out or negative error */
+	int match(const iterated_key_info &info) {
+		const int ret = check(info);
+		if (ret == 0)
+			++m_filtered;
+		return ret;
+	}
+
+	uint64_t filtered() const {
+		return m_filtered;
+	}
+
+private:
+	int check(const iterated_key_info &info) const {
+		if ((info.ehdr.flags & m_filter.user_flags_mask) != m_filter.user_flags_value)
+			return 0;
+
+		if ((info.record_flags & m_filter.record_flags_mask) != m_filter.record_flags_value)
+			return 0;
+
+		if (info.data_size < m_filter.min_data_size ||
+		    (m_filter.max_data_size && info.data_size > m_filter.max_data_size))
+			return 0;
+
+		if (m_filter.json_key.empty())
+			return 1;
+
+		if (!info.jhdr.size)
+			return 0;
+
+		std::string json;
+		const auto cached = info.from_head(info.json_offset, info.jhdr.size);
+		if (!cached.empty()) {
+			json.assign(cached.data<char>(), cached.size());
+		} else {
+			json.resize(info.jhdr.size);
+			const int err = dnet_read_ll(info.fd, &json.front(), json.size(), info.json_offset);
+			if (err)
+				return err;
+		}
+
+		rapidjson::Document doc;
+		doc.Parse<0>(json.c_str());
+		if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember(m_filter.json_key.c_str()))
+			return 0;
+
+		return blob_json_equal(doc[m_filter.json_key.c_str()], m_json_value[0u]) ? 1 : 0;
+	}
+
+	const ioremap::elliptics::dnet_iterator_filter m_filter;
+	rapidjson::Document m_json_value;
+	std::atomic<uint64_t> m_filtered;
+};
+
 /*
  * \a congestion_control_monitor allows to limit amount of data sent to a remote backends simultaneously.
  */
@@ -1256,7 +2203,8 @@ public:
 	                   std::shared_ptr<iterated_key_info> info,
 	                   congestion_control_monitor &monitor,
 	                   std::atomic<uint64_t> &counter)
-	: log_{backend->blog}
+	: backend_{backend}
+	, log_{backend->blog}
 	, st_{st}
 	, iterator_id_{iterator_id}
 	, cmd_(cmd)
@@ -1346,8 +2294,14 @@ protected:
 
 		// read json only with first chunk of data (data_offset_ == 0)
 		if (info_->jhdr.size && !data_offset_) {
+			const auto json = info_->from_head(info_->json_offset, info_->jhdr.size);
 			json_.resize(info_->jhdr.size, 0);
-			const int err = dnet_read_ll(info_->fd, &json_.front(), json_.size(), info_->json_offset);
+
+			int err = 0;
+			if (!json.empty())
+				memcpy(&json_.front(), json.data(), json.size());
+			else
+				err = dnet_read_ll(info_->fd, &json_.front(), json_.size(), info_->json_offset);
 			if (err) {
 				DNET_LOG_ERROR(log_, "EBLOB: server_send: {}: failed to read json: {}",
 				               dnet_dump_id_str(info_->key.id), dnet_print_error(err));
@@ -1361,8 +2315,23 @@ protected:
 		data_.resize(chunk_size, 0);
 
 		if (!data_.empty()) {
-			const auto read_offset = info_->data_offset + data_offset_;
-			const int err = dnet_read_ll(info_->fd, &data_.front(), data_.size(), read_offset);
+			int err;
+			if (info_->ehdr.compression) {
+				ioremap::elliptics::data_pointer data;
+				err = blob_read_compressed(backend_, info_->fd, info_->data_offset, info_->ehdr, data_offset_,
+				                           data_.size(), data);
+				if (!err)
+					memcpy(&data_.front(), data.data(), data.size());
+			} else {
+				const auto read_offset = info_->data_offset + data_offset_;
+				const auto data = info_->from_head(read_offset, data_.size());
+				if (!data.empty()) {
+					memcpy(&data_.front(), data.data(), data.size());
+					err = 0;
+				} else {
+					err = dnet_read_ll(info_->fd, &data_.front(), data_.size(), read_offset);
+				}
+			}
 			if (err) {
 				DNET_LOG_ERROR(log_, "EBLOB: server_send: {}: failed to read data: {}",
 				               dnet_dump_id_str(info_->key.id), dnet_print_error(err));
@@ -1424,6 +2393,7 @@ protected:
 	}
 
 
+	eblob_backend_config *backend_;
 	dnet_logger *log_;
 	dnet_net_state *st_;
 
@@ -1450,18 +2420,72 @@ protected:
 	uint64_t data_offset_{0};
 };
 
+/*
+ * Sends object which fits into single chunk. The object is read by read_object() and then written to all groups
+ * by small_object_batch together with other small objects, groups failed by timeout are retried by the sender
+ * itself with separate writes.
+ */
 class small_object_sender : public base_object_sender, public std::enable_shared_from_this<small_object_sender> {
 public:
 	using base_object_sender::base_object_sender;
 
-	void send() {
+	/* reads the object, replies with error and returns false if it can't be read */
+	bool read_object() {
 		retry_count_ = request_.chunk_retry_count;
 
 		if (const int err = read()) {
 			send_response(err);
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t size() const {
+		return json_.size() + data_.size();
+	}
+
+	/* appends records which write the object to @groups, they refer to buffers of the sender */
+	void make_entries(const std::vector<int> &groups, const dnet_time &deadline,
+	                  std::vector<ioremap::elliptics::newapi::bulk_write_entry> &entries) {
+		ioremap::elliptics::dnet_write_request request;
+		memset(&request, 0, sizeof(request));
+		request.ioflags = DNET_IO_FLAGS_CAS_TIMESTAMP | DNET_IO_FLAGS_PREPARE | DNET_IO_FLAGS_COMMIT |
+		                  DNET_IO_FLAGS_PLAIN_WRITE;
+		request.user_flags = info_->ehdr.flags;
+		request.timestamp = info_->ehdr.timestamp;
+
+		request.json_size = json_.size();
+		request.json_capacity = info_->jhdr.capacity;
+		request.json_timestamp = info_->jhdr.timestamp;
+
+		request.data_size = request.data_commit_size = data_.size();
+		request.data_capacity = info_->data_size;
+		request.deadline = deadline;
+
+		for (const auto group : groups) {
+			dnet_id id;
+			dnet_setup_id(&id, group, info_->key.id);
+			entries.push_back({id, request, json(), data()});
+		}
+	}
+
+	/* handles (group_id, status) of the object's records written by the batch */
+	void on_batch_write(const std::vector<std::pair<int, int>> &statuses) {
+		// groups whose nodes don't support DNET_CMD_BULK_WRITE_NEW are written by separate write
+		std::vector<int> groups;
+		for (const auto &status : statuses) {
+			if (status.second == -ENOTSUP)
+				groups.emplace_back(status.first);
+			else
+				batch_statuses_.emplace_back(status);
+		}
+
+		if (groups.empty()) {
+			on_write_statuses(batch_statuses_);
 			return;
 		}
 
+		session_.set_groups(groups);
 		write();
 	}
 
@@ -1474,6 +2498,16 @@ private:
 
 	void on_write(const ioremap::elliptics::newapi::sync_write_result &results,
 	              const ioremap::elliptics::error_info &/*error*/) {
+		std::vector<std::pair<int, int>> statuses;
+		statuses.swap(batch_statuses_);
+		statuses.reserve(statuses.size() + results.size());
+		for (const auto &result: results) {
+			statuses.emplace_back(static_cast<int>(result.command()->id.group_id), result.status());
+		}
+		on_write_statuses(statuses);
+	}
+
+	void on_write_statuses(const std::vector<std::pair<int, int>> &statuses) {
 		if (st_->__need_exit) {
 			DNET_LOG_ERROR(log_, "EBLOB: Interrupting server_send: peer has been disconnected");
 			return;
@@ -1482,17 +2516,17 @@ private:
 		// collect groups with timeout
 		auto retry_groups = [&] {
 			std::vector<int> groups;
-			groups.reserve(results.size());
+			groups.reserve(statuses.size());
 
-			for (const auto &result: results) {
-				const auto group_id = result.command()->id.group_id;
-				switch (result.status()) {
+			for (const auto &status: statuses) {
+				const auto group_id = status.first;
+				switch (status.second) {
 					case 0: break; // skip successes
 					case -ETIMEDOUT: // collect timed-out groups
 						groups.emplace_back(group_id);
 						break;
 					default: // store one other error
-						last_error_ = result.status();
+						last_error_ = status.second;
 						break;
 				}
 			}
@@ -1519,6 +2553,7 @@ private:
 
 	uint8_t retry_count_{0};
 	int last_error_{0};
+	std::vector<std::pair<int, int>> batch_statuses_; // statuses of groups written by the batch
 };
 
 class large_object_sender : public base_object_sender {
@@ -1613,187 +2648,1169 @@ private:
 	int last_error_{0};
 };
 
-static iterator_callback make_iterator_server_send_callback(eblob_backend_config *c,
-                                                            dnet_net_state *st,
-                                                            dnet_cmd *cmd,
-                                                            const ioremap::elliptics::dnet_server_send_request &request,
-                                                            uint64_t iterator_id,
-                                                            congestion_control_monitor &monitor,
-                                                            std::atomic<uint64_t> &counter) {
-	using namespace ioremap::elliptics;
-	return [=, &request, &counter, &monitor] (std::shared_ptr<iterated_key_info> info) -> int {
-		if (st->__need_exit) {
-			DNET_LOG_ERROR(c->blog, "EBLOB: Interrupting server_send: peer has been disconnected");
-			return -EINTR;
-		}
+/* limits of the batch of small objects written by single send_bulk_write() */
+static const size_t server_send_batch_records = 128;
+/* batched objects hold their quota of congestion_control_monitor until the batch is flushed, so the batch
+ * should be smaller than minimal quota, otherwise reading of the next object would wait for the batch forever.
+ */
+static const uint64_t server_send_batch_size = 512 * 1024;
 
-		// use small key sender if data_size is less than chunk_size
-		if (info->data_size <= request.chunk_size) {
-			const auto sender = std::make_shared<small_object_sender>(c, st, iterator_id, cmd, request,
-			                                                          info, monitor, counter);
-			sender->send();
-		} else {
-			large_object_sender sender{c, st, iterator_id, cmd, request, info, monitor, counter};
-			sender.send();
+/*
+ * Collects small objects read by small_object_sender and writes them to all destination groups by
+ * DNET_CMD_BULK_WRITE_NEW: one request per destination node, which is split by the node between its backends.
+ * It is used only by the thread running blob_send_new(), results are handled by senders of the objects.
+ */
+class small_object_batch {
+public:
+	small_object_batch(eblob_backend_config *backend,
+	                   dnet_net_state *st,
+	                   dnet_cmd *cmd,
+	                   const ioremap::elliptics::dnet_server_send_request &request)
+	: log_{backend->blog}
+	, request_(request)
+	, session_{st->n} {
+		session_.set_exceptions_policy(ioremap::elliptics::session::no_exceptions);
+		session_.set_filter(ioremap::elliptics::filters::all_with_ack);
+		session_.set_trace_id(cmd->trace_id);
+		session_.set_trace_bit(!!(cmd->flags & DNET_FLAGS_TRACE_BIT));
+	}
+
+	void add(std::shared_ptr<small_object_sender> sender) {
+		size_ += sender->size();
+		senders_.emplace_back(std::move(sender));
+
+		if (senders_.size() >= server_send_batch_records || size_ >= server_send_batch_size)
+			flush();
+	}
+
+	void flush() {
+		using namespace ioremap::elliptics;
+
+		if (senders_.empty())
+			return;
+
+		// the batch is written as many chunks as it would take to write its objects by chunks
+		const auto number_of_chunks = size_ ? (size_ - 1) / request_.chunk_size + 1 : 1;
+		const auto timeout = std::max(1lu, (request_.chunk_write_timeout * number_of_chunks - 1) / 1000 + 1);
+		session_.set_timeout(timeout);
+
+		dnet_time deadline;
+		dnet_current_time(&deadline);
+		deadline.tsec += timeout;
+
+		std::vector<newapi::bulk_write_entry> entries;
+		entries.reserve(senders_.size() * request_.groups.size());
+		for (const auto &sender : senders_) {
+			sender->make_entries(request_.groups, deadline, entries);
 		}
 
-		return 0;
+		// entry's key -> index of its sender, sorted by keys of entries to match results
+		auto owners = std::make_shared<std::vector<owner>>();
+		owners->reserve(entries.size());
+		for (size_t i = 0; i < entries.size(); ++i) {
+			owners->emplace_back(entries[i].key, i / request_.groups.size());
+		}
+		std::sort(owners->begin(), owners->end(), owner_less);
+
+		DNET_LOG_INFO(log_, "EBLOB: server_send: small_object_batch: writing {} objects ({} bytes) to groups: {}",
+		              senders_.size(), size_, request_.groups);
+
+		auto senders = std::make_shared<std::vector<std::shared_ptr<small_object_sender>>>(std::move(senders_));
+		senders_.clear();
+		size_ = 0;
+
+		newapi::send_bulk_write(session_, entries).connect(
+			[senders, owners] (const newapi::sync_write_result &results, const error_info &/*error*/) {
+				std::vector<std::vector<std::pair<int, int>>> statuses(senders->size());
+				std::vector<bool> responded(owners->size(), false);
+
+				for (const auto &result : results) {
+					const auto &id = result.command()->id;
+					for (auto it = std::lower_bound(owners->begin(), owners->end(),
+					                                owner{id, 0}, owner_less);
+					     it != owners->end() && !dnet_id_cmp(&it->first, &id); ++it) {
+						const auto index = std::distance(owners->begin(), it);
+						if (responded[index])
+							continue;
+
+						responded[index] = true;
+						statuses[it->second].emplace_back(static_cast<int>(id.group_id),
+						                                  result.status());
+						break;
+					}
+				}
+
+				// records without result are retried by their senders
+				for (size_t i = 0; i < owners->size(); ++i) {
+					if (!responded[i]) {
+						const auto &owner = (*owners)[i];
+						statuses[owner.second].emplace_back(static_cast<int>(owner.first.group_id),
+						                                    -ETIMEDOUT);
+					}
+				}
+
+				for (size_t i = 0; i < senders->size(); ++i) {
+					(*senders)[i]->on_batch_write(statuses[i]);
+				}
+			});
+	}
+
+private:
+	typedef std::pair<dnet_id, size_t> owner;
+
+	static bool owner_less(const owner &lhs, const owner &rhs) {
+		return dnet_id_cmp(&lhs.first, &rhs.first) < 0;
+	}
+
+	dnet_logger *log_;
+	const ioremap::elliptics::dnet_server_send_request &request_;
+	ioremap::elliptics::newapi::session session_;
+
+	std::vector<std::shared_ptr<small_object_sender>> senders_;
+	uint64_t size_{0};
+};
+
+static iterator_callback make_iterator_server_send_callback(eblob_backend_config *c,
+                                                            dnet_net_state *st,
+                                                            dnet_cmd *cmd,
+                                                            const ioremap::elliptics::dnet_server_send_request &request,
+                                                            uint64_t iterator_id,
+                                                            congestion_control_monitor &monitor,
+                                                            small_object_batch &batch,
+                                                            std::atomic<uint64_t> &counter) {
+	using namespace ioremap::elliptics;
+	return [=, &request, &counter, &monitor, &batch] (std::shared_ptr<iterated_key_info> info) -> int {
+		if (st->__need_exit) {
+			DNET_LOG_ERROR(c->blog, "EBLOB: Interrupting server_send: peer has been disconnected");
+			return -EINTR;
+		}
+
+		// use small key sender if data_size is less than chunk_size, such keys are written by batches
+		if (info->data_size <= request.chunk_size) {
+			const auto sender = std::make_shared<small_object_sender>(c, st, iterator_id, cmd, request,
+			                                                          info, monitor, counter);
+			if (sender->read_object())
+				batch.add(sender);
+		} else {
+			large_object_sender sender{c, st, iterator_id, cmd, request, info, monitor, counter};
+			sender.send();
+		}
+
+		return 0;
 	};
 }
 
-static iterator_callback make_iterator_network_callback(eblob_backend_config *c, dnet_net_state *st,
-                                                        dnet_cmd *cmd,
-                                                        ioremap::elliptics::dnet_iterator_request &request,
-                                                        const dnet_iterator *it) {
-	using namespace ioremap::elliptics;
-	auto counter = std::make_shared<std::atomic<uint64_t>>(0);
-	const uint64_t total_keys = eblob_total_elements(c->eblob);
+/* limits of the batch used when they aren't set in the config */
+static const uint64_t blob_iterator_batch_records = 1000;
+static const uint64_t blob_iterator_batch_size = 1024 * 1024;
+static const uint64_t blob_iterator_batch_delay = 100; /* msecs */
+
+/*
+ * Replies of the iterator started with DNET_IFLAGS_BATCH and without DNET_IFLAGS_DATA. Replies of records
+ * are put one after another into the single packet, which is sent when it has enough records or bytes,
+ * or its first record has waited for too long. Every reply is self-described by its dnet_iterator_response,
+ * so the client splits the packet into the same entries it gets without batching.
+ */
+class blob_iterator_batch {
+public:
+	typedef std::chrono::steady_clock clock;
+
+	blob_iterator_batch(const eblob_backend_config *c, dnet_net_state *st, const dnet_cmd *cmd)
+	: m_st(st)
+	, m_max_records(c->iterator_batch_records ? c->iterator_batch_records : blob_iterator_batch_records)
+	, m_max_size(c->iterator_batch_size ? c->iterator_batch_size : blob_iterator_batch_size)
+	, m_max_delay(std::chrono::milliseconds(c->iterator_batch_delay ? c->iterator_batch_delay
+	                                                                 : blob_iterator_batch_delay))
+	, m_records(0) {
+		m_packet.reserve(sizeof(*cmd) + m_max_size);
+		m_packet.assign(reinterpret_cast<const char *>(cmd), reinterpret_cast<const char *>(cmd + 1));
+	}
+
+	int add(const ioremap::elliptics::data_pointer &header, const ioremap::elliptics::data_pointer &json) {
+		if (!m_records)
+			m_started = clock::now();
+
+		m_packet.insert(m_packet.end(), header.data<char>(), header.data<char>() + header.size());
+		if (!json.empty())
+			m_packet.insert(m_packet.end(), json.data<char>(), json.data<char>() + json.size());
+		++m_records;
+
+		if (m_records >= m_max_records || m_packet.size() - sizeof(dnet_cmd) >= m_max_size ||
+		    clock::now() - m_started >= m_max_delay)
+			return flush();
+		return 0;
+	}
+
+	int flush() {
+		if (!m_records)
+			return 0;
+
+		auto cmd = reinterpret_cast<dnet_cmd *>(m_packet.data());
+		cmd->size = m_packet.size() - sizeof(*cmd);
+		cmd->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+		cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+
+		const int err = dnet_send_fd_threshold(m_st, m_packet.data(), m_packet.size(), -1, 0, 0);
+
+		m_packet.resize(sizeof(*cmd));
+		m_records = 0;
+		return err;
+	}
+
+private:
+	dnet_net_state *m_st;
+	const uint64_t m_max_records;
+	const uint64_t m_max_size;
+	const clock::duration m_max_delay;
+
+	std::vector<char> m_packet;
+	uint64_t m_records;
+	clock::time_point m_started;
+};
+
+/* bytes of the sorted container sent in one reply, they are sent by sendfile straight from the file */
+static const uint64_t blob_iterator_container_chunk_size = 64 * 1024 * 1024;
+/* records buffered in memory before they are written to the container */
+static const size_t blob_iterator_container_buffer_items = 64 * 1024;
+
+/*
+ * Result of DNET_ITYPE_DISK iteration. Records are written as iterator_container_item into the local file,
+ * which is sorted like the client sorts its iterator_result_container when iteration is finished and is sent
+ * back by large chunks. The file is placed in chunks_dir of the backend if it is set or next to the blobs.
+ * It is unlinked right after sorting, queued chunks keep their own descriptors of it.
+ */
+class blob_iterator_container {
+public:
+	typedef ioremap::elliptics::newapi::iterator_container_item item_type;
+
+	blob_iterator_container(const eblob_backend_config *c, dnet_net_state *st, const dnet_cmd *cmd)
+	: m_c(c)
+	, m_st(st)
+	, m_cmd(*cmd)
+	, m_fd(-1)
+	, m_size(0) {
+		m_buffer.reserve(blob_iterator_container_buffer_items);
+	}
+
+	~blob_iterator_container() {
+		if (m_fd < 0)
+			return;
+
+		close(m_fd);
+		if (!m_path.empty())
+			unlink(m_path.c_str());
+	}
+
+	int open(uint64_t iterator_id) {
+		if (m_c->data.chunks_dir)
+			m_path = std::string(m_c->data.chunks_dir) + "/iterator." + std::to_string(iterator_id);
+		else
+			m_path = std::string(m_c->data.file) + ".iterator." + std::to_string(iterator_id);
+
+		m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (m_fd < 0) {
+			const int err = -errno;
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: failed to create container: {}: {} [{}]",
+			               m_path, strerror(-err), err);
+			m_path.clear();
+			return err;
+		}
+		return 0;
+	}
+
+	int add(const item_type &item) {
+		m_buffer.emplace_back(item);
+		if (m_buffer.size() >= blob_iterator_container_buffer_items)
+			return flush();
+		return 0;
+	}
+
+	/* sorts the container and queues it for sending, replies count items in @iterated_keys */
+	int send(uint64_t iterator_id, uint64_t filtered_keys) {
+		using namespace ioremap::elliptics;
+
+		int err = flush();
+		if (err)
+			return err;
+
+		try {
+			newapi::iterator_result_container container(m_fd, false, m_size);
+			container.sort();
+		} catch (const error &e) {
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: id: {}: failed to sort container: {}: {}",
+			               iterator_id, m_path, e.what());
+			return e.error_code();
+		}
+
+		unlink(m_path.c_str());
+		m_path.clear();
+
+		static const uint64_t chunk_size = blob_iterator_container_chunk_size / sizeof(item_type) *
+		                                   sizeof(item_type);
+		const uint64_t total_items = m_size / sizeof(item_type);
+
+		for (uint64_t offset = 0; offset < m_size;) {
+			const uint64_t size = std::min(chunk_size, m_size - offset);
+
+			const auto header = serialize(ioremap::elliptics::dnet_iterator_response{
+				iterator_id, // iterator_id
+				dnet_raw_id(), // key
+				0, // status
+
+				(offset + size) / sizeof(item_type), // iterated_keys
+				total_items, // total_keys
+
+				0, // record_flags
+				0, // user_flags
+
+				dnet_time(), // json_timestamp
+				0, // json_size
+				0, // json_capacity
+				0, // read_json_size
+
+				dnet_time(), // data timestamp
+				size, // data_size
+				size, // read_data_size
+				offset, // data_offset
+				0, // blob_id
+				filtered_keys // filtered_keys
+			});
+
+			auto packet = data_pointer::allocate(sizeof(m_cmd) + header.size());
+			memcpy(packet.data(), &m_cmd, sizeof(m_cmd));
+			memcpy(packet.skip<dnet_cmd>().data(), header.data(), header.size());
+
+			auto cmd = packet.data<dnet_cmd>();
+			cmd->size = header.size() + size;
+			cmd->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+			cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+
+			/* queued chunk is sent after the container is destroyed, so it gets its own descriptor */
+			const int fd = dup(m_fd);
+			if (fd < 0)
+				return -errno;
+
+			err = dnet_send_fd(m_st, packet.data(), packet.size(), fd, offset, size, DNET_IO_REQ_FLAGS_CLOSE,
+			                   /*context*/ nullptr);
+			if (err) {
+				close(fd);
+				return err;
+			}
+
+			offset += size;
+		}
+		return 0;
+	}
+
+private:
+	int flush() {
+		if (m_buffer.empty())
+			return 0;
+
+		const uint64_t size = m_buffer.size() * sizeof(item_type);
+		const int err = dnet_write_ll(m_fd, reinterpret_cast<const char *>(m_buffer.data()), size, m_size);
+		if (err) {
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: failed to write container: {}: {} [{}]",
+			               m_path, strerror(-err), err);
+			return err;
+		}
+
+		m_size += size;
+		m_buffer.clear();
+		return 0;
+	}
+
+	const eblob_backend_config *m_c;
+	dnet_net_state *m_st;
+	const dnet_cmd m_cmd;
+
+	std::string m_path;
+	int m_fd;
+	uint64_t m_size;
+	std::vector<item_type> m_buffer;
+};
+
+/*
+ * Iteration started by DNET_CMD_ITERATOR_NEW. It is checked by io thread which has received the command
+ * and is run by blob_iterator_pool, the command is acknowledged when the iteration is finished.
+ * Its progress is exported in backend's statistics.
+ */
+struct blob_iterator_task {
+	typedef std::chrono::steady_clock clock;
+
+	blob_iterator_task(dnet_net_state *st, const dnet_cmd *cmd,
+	                   const ioremap::elliptics::dnet_iterator_request &request)
+	: st(dnet_state_get(st))
+	, cmd(*cmd)
+	, request(request)
+	, it(nullptr)
+	, total_keys(0)
+	, iterated_keys(0)
+	, sent_bytes(0)
+	, running(false)
+	, queued_at(clock::now()) {
+	}
+
+	~blob_iterator_task() {
+		if (it)
+			dnet_iterator_destroy(st->n, it);
+		dnet_state_put(st);
+	}
+
+	dnet_net_state *st;
+	dnet_cmd cmd;
+	ioremap::elliptics::dnet_iterator_request request;
+	dnet_iterator *it;
+	std::shared_ptr<blob_iterator_filter> filter;
+	std::shared_ptr<blob_iterator_batch> batch;
+	std::shared_ptr<blob_iterator_container> container;
+
+	uint64_t total_keys;
+	std::atomic<uint64_t> iterated_keys;
+	std::atomic<uint64_t> sent_bytes;
+	/*
+	 * serializes replies of key range partitions iterated in parallel, so @iterated_keys grows
+	 * one by one in the reply stream and @batch is filled by one thread at a time
+	 */
+	std::mutex send_lock;
+	/* @started_at is set before @running */
+	std::atomic<bool> running;
+	clock::time_point queued_at;
+	clock::time_point started_at;
+};
+
+/* keys and bytes sent by one partition of the iteration, they are charged to rate limiters */
+struct blob_iterator_progress {
+	uint64_t keys;
+	uint64_t bytes;
+};
+
+static iterator_callback make_iterator_network_callback(eblob_backend_config *c, blob_iterator_task *task,
+                                                        blob_iterator_progress *progress) {
+	using namespace ioremap::elliptics;
+	dnet_net_state *st = task->st;
+	const dnet_cmd *cmd = &task->cmd;
+	const ioremap::elliptics::dnet_iterator_request &request = task->request;
+	const auto &filter = task->filter;
+	const auto &batch = task->batch;
+
+	return [=, &request, &filter, &batch] (std::shared_ptr<iterated_key_info> info) -> int {
+		if (st->__need_exit) {
+			DNET_LOG_ERROR(c->blog, "EBLOB: iterator: Interrupting iterator: peer has been disconnected");
+			return -EINTR;
+		}
+
+		data_pointer json;
+		if ((request.flags & DNET_IFLAGS_JSON) && info->jhdr.size)
+			json = info->from_head(info->json_offset, info->jhdr.size);
+		if (json.empty() && (request.flags & DNET_IFLAGS_JSON) && info->jhdr.size) {
+			json = data_pointer::allocate(info->jhdr.size);
+			const int err = dnet_read_ll(info->fd, json.data<char>(), json.size(), info->json_offset);
+			if (err) {
+				DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: failed to read json: {} [{}]",
+				               dnet_dump_id_str(info->key.id), strerror(-err), err);
+				return err;
+			}
+		}
+
+		const uint64_t read_data_size = (request.flags & DNET_IFLAGS_DATA) ? info->data_size : 0;
+
+		data_pointer data;
+		if (read_data_size && info->ehdr.compression) {
+			const int err = blob_read_compressed(c, info->fd, info->data_offset, info->ehdr, 0, read_data_size,
+			                                     data);
+			if (err) {
+				DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: failed to read compressed data: {} [{}]",
+				               dnet_dump_id_str(info->key.id), strerror(-err), err);
+				return err;
+			}
+		} else if (read_data_size) {
+			data = info->from_head(info->data_offset, read_data_size);
+		}
+
+		std::lock_guard<std::mutex> guard(task->send_lock);
+
+		auto header = serialize(ioremap::elliptics::dnet_iterator_response{
+			task->it->id, // iterator_id
+			info->key, // key
+			0, // status
+
+			++task->iterated_keys, // iterated_keys
+			task->total_keys, // total_keys
+
+			info->record_flags, // record_flags
+			info->ehdr.flags, // user_flags
+
+			info->jhdr.timestamp, // json_timestamp
+			info->jhdr.size, // json_size
+			info->jhdr.capacity, // json_capacity
+			json.size(), // read_json_size
+
+			info->ehdr.timestamp, // data timestamp
+			info->data_size, // data_size
+			read_data_size, // read_data_size
+			info->data_offset, // data_offset
+			static_cast<uint64_t>(info->fd), // blob_id
+			filter ? filter->filtered() : 0 // filtered_keys
+		});
+
+		if (st->__need_exit) {
+			DNET_LOG_ERROR(c->blog,
+			               "EBLOB: iterator: Interrupting iterator because peer has been disconnected");
+			return -EINTR;
+		}
+
+		const uint64_t sent_size = header.size() + json.size() + read_data_size;
+		task->sent_bytes += sent_size;
+		progress->bytes += sent_size;
+		++progress->keys;
+
+		if (batch)
+			return batch->add(header, json);
+
+		auto response = data_pointer::allocate(sizeof(*cmd) + header.size() + json.size() + data.size());
+
+		memcpy(response.data(), cmd, sizeof(*cmd));
+		memcpy(response.skip<dnet_cmd>().data(), header.data(), header.size());
+		if (!json.empty()) {
+			memcpy(response.skip(sizeof(*cmd) + header.size()).data(), json.data(), json.size());
+		}
+		if (!data.empty()) {
+			memcpy(response.skip(sizeof(*cmd) + header.size() + json.size()).data(), data.data(), data.size());
+		}
+
+		response.data<dnet_cmd>()->size = header.size() + json.size() + read_data_size;
+		response.data<dnet_cmd>()->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+		response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
+
+		return dnet_send_fd_threshold(st, response.data(), response.size(), info->fd, info->data_offset,
+		                              read_data_size - data.size());
+	};
+}
+
+/* writes records of DNET_ITYPE_DISK iteration into the task's container instead of sending them */
+static iterator_callback make_iterator_container_callback(blob_iterator_task *task,
+                                                          blob_iterator_progress *progress) {
+	return [=] (std::shared_ptr<iterated_key_info> info) -> int {
+		blob_iterator_container::item_type item;
+		memset(&item, 0, sizeof(item));
+
+		item.key = info->key;
+		item.record_flags = info->record_flags;
+		item.user_flags = info->ehdr.flags;
+		item.json_timestamp = info->jhdr.timestamp;
+		item.json_size = info->jhdr.size;
+		item.json_capacity = info->jhdr.capacity;
+		item.data_timestamp = info->ehdr.timestamp;
+		item.data_size = info->data_size;
+		item.data_offset = info->data_offset;
+		item.blob_id = info->fd;
+
+		std::lock_guard<std::mutex> guard(task->send_lock);
+
+		++task->iterated_keys;
+		progress->bytes += sizeof(item);
+		++progress->keys;
+
+		return task->container->add(item);
+	};
+}
+
+static int blob_iterate_callback_common(const eblob_backend_config *c,
+                                        const ioremap::elliptics::dnet_iterator_request &request,
+                                        dnet_iterator *it,
+                                        const eblob_disk_control *dc, int fd, uint64_t offset,
+                                        blob_iterator_filter *filter,
+                                        iterator_callback callback) {
+	assert(dc != nullptr);
+
+	auto info = std::make_shared<iterated_key_info>(dc, fd);
+
+	// dc->data_size for uncommitted records contains garbage and shouldn't be used
+	uint64_t size = (dc->flags & BLOB_DISK_CTL_UNCOMMITTED) ? 0 : dc->data_size;
+
+	int err = 0;
+	if (dc->flags & BLOB_DISK_CTL_EXTHDR) {
+		if (!(request.flags & DNET_IFLAGS_NO_META)) {
+			blob_record_head head;
+			err = blob_read_record_head(fd, offset, size, head);
+			if (err) {
+				DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: failed to read headers: {} [{}]",
+				               dnet_dump_id_str(info->key.id), strerror(-err), err);
+				return err;
+			}
+
+			info->ehdr = head.ehdr;
+			info->jhdr = head.jhdr;
+			info->head = head.data;
+			info->head_offset = offset;
+		}
+
+		offset += sizeof(info->ehdr) + info->ehdr.size;
+		if (size >= sizeof(info->ehdr) + info->ehdr.size) {
+			size -= sizeof(info->ehdr) + info->ehdr.size;
+		} else if (size) {
+			err = -EINVAL;
+			DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: has invalid size: {} < {} (sizeof(info.ehdr)) + "
+			                        "{} (info.ehdr.size): {} [{}]",
+			               dnet_dump_id_str(info->key.id), size, sizeof(info->ehdr), info->ehdr.size,
+			               strerror(-err), err);
+			return err;
+		}
+	}
+
+	if (request.flags & DNET_IFLAGS_TS_RANGE) {
+		if (dnet_time_cmp(&info->ehdr.timestamp, &std::get<0>(request.time_range)) < 0 ||
+		    dnet_time_cmp(&info->ehdr.timestamp, &std::get<1>(request.time_range)) > 0) {
+			/* skip key which timestamp is not in request.time_range */
+			return 0;
+		}
+	}
+
+	if (size >= info->jhdr.capacity) {
+		info->data_size = size - info->jhdr.capacity;
+	} else if (size) {
+		err = -EINVAL;
+		DNET_LOG_ERROR(c->blog, "EBLOB: iterator {}: has invalid size({}) < info.jhdr.capacity({}): {} [{}]",
+		               dnet_dump_id_str(info->key.id), size, info->jhdr.capacity, strerror(-err), err);
+		return err;
+	}
+
+	info->json_offset = offset;
+	info->data_offset = offset + info->jhdr.capacity;
+
+	/* compressed data is decompressed before sending, so its uncompressed size is reported */
+	if (info->ehdr.compression)
+		info->data_size = info->ehdr.data_size;
+
+	if (filter) {
+		err = filter->match(*info);
+		if (err < 0) {
+			DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: failed to apply filter: {} [{}]",
+			               dnet_dump_id_str(info->key.id), strerror(-err), err);
+			return err;
+		}
+		if (err == 0)
+			return dnet_iterator_flow_control(it);
+	}
+
+	/* time strings are built for every iterated key, so do it only if the message will be logged */
+	if (DNET_LOG_ENABLED(DNET_LOG_DEBUG, c->log_level)) {
+		const std::string data_ts = dnet_print_time(&info->ehdr.timestamp);
+		const std::string json_ts = dnet_print_time(&info->jhdr.timestamp);
+
+		DNET_LOG_DEBUG(c->blog, "EBLOB: iterated: key: {}, fd: {}, user_flags: {:#x}, json: {{offset: {}, "
+		                        "size: {}, capacity: {}, ts: {}}}, data: {{offset: {}, size: {}, ts: {}}}",
+		               dnet_dump_id_str(info->key.id), fd, info->ehdr.flags, offset, info->jhdr.size,
+		               info->jhdr.capacity, json_ts, info->data_offset, info->data_size, data_ts);
+	}
+
+	err = callback(info);
+	if (err) {
+		return err;
+	}
+
+	return dnet_iterator_flow_control(it);
+}
+
+/* ioprio_set(2) has no glibc wrapper */
+static const int blob_ioprio_who_process = 1;
+static const int blob_ioprio_class_shift = 13;
+
+/* number of threads of the iterator pool used when it isn't set in the config */
+static const unsigned int blob_iterator_threads = 2;
+
+/*
+ * Splits key ranges of @request into up to @parallelism partitions by the first 8 bytes of the key. Partitions
+ * are disjoint, so they are iterated in parallel without sending any key twice. Partitions which have no keys
+ * of the request are dropped. The only partition without ranges means the whole key space.
+ */
+static std::vector<std::vector<eblob_index_block>>
+blob_iterator_partitions(const ioremap::elliptics::dnet_iterator_request &request, unsigned int parallelism) {
+	std::vector<eblob_index_block> ranges;
+	if (request.flags & DNET_IFLAGS_KEY_RANGE) {
+		ranges.reserve(request.key_ranges.size());
+
+		for (const auto &range : request.key_ranges) {
+			eblob_key begin, end;
+			memcpy(begin.id, range.key_begin.id, EBLOB_ID_SIZE);
+			memcpy(end.id, range.key_end.id, EBLOB_ID_SIZE);
+
+			ranges.emplace_back(eblob_index_block{begin, end, 0, 0});
+		}
+	}
+
+	if (parallelism <= 1)
+		return std::vector<std::vector<eblob_index_block>>(1, ranges);
+
+	if (ranges.empty()) {
+		eblob_index_block all;
+		memset(&all, 0, sizeof(all));
+		memset(all.end_key.id, 0xff, EBLOB_ID_SIZE);
+		ranges.emplace_back(all);
+	}
+
+	auto set_prefix = [] (eblob_key &key, uint64_t prefix) {
+		for (size_t i = 0; i < sizeof(prefix); ++i)
+			key.id[i] = prefix >> (8 * (sizeof(prefix) - 1 - i));
+	};
+
+	const uint64_t step = std::numeric_limits<uint64_t>::max() / parallelism + 1;
+
+	std::vector<std::vector<eblob_index_block>> partitions;
+	for (unsigned int i = 0; i < parallelism; ++i) {
+		eblob_key begin, end;
+		memset(begin.id, 0, EBLOB_ID_SIZE);
+		memset(end.id, 0xff, EBLOB_ID_SIZE);
+		set_prefix(begin, i * step);
+		if (i + 1 < parallelism)
+			set_prefix(end, (i + 1) * step - 1);
+
+		std::vector<eblob_index_block> partition;
+		for (const auto &range : ranges) {
+			const eblob_key &first = memcmp(range.start_key.id, begin.id, EBLOB_ID_SIZE) > 0 ? range.start_key
+			                                                                                : begin;
+			const eblob_key &last = memcmp(range.end_key.id, end.id, EBLOB_ID_SIZE) < 0 ? range.end_key : end;
+			if (memcmp(first.id, last.id, EBLOB_ID_SIZE) <= 0)
+				partition.emplace_back(eblob_index_block{first, last, 0, 0});
+		}
+
+		if (!partition.empty())
+			partitions.emplace_back(std::move(partition));
+	}
+	return partitions;
+}
+
+/* longest sleep of the rate limiter between checks whether iteration is interrupted */
+static const uint64_t blob_rate_limiter_slice = 100; /* msecs */
+
+/*
+ * Token bucket shared by all iterations of the backend, it allows bursts of one second worth of @rate.
+ * Consumer which has exhausted the bucket sleeps until its debt is repaid, so the next consumers sleep
+ * longer and iterations get the rate in turns.
+ */
+class blob_rate_limiter {
+public:
+	typedef std::chrono::steady_clock clock;
+
+	explicit blob_rate_limiter(uint64_t rate)
+	: m_rate(rate)
+	, m_tokens(rate)
+	, m_updated(clock::now()) {
+	}
+
+	/*
+	 * Sleeps by slices, so low rate doesn't delay cancellation: @interrupted is called after each slice,
+	 * its non-zero result stops the sleep and is returned.
+	 */
+	int consume(uint64_t amount, const std::function<int ()> &interrupted) {
+		if (!m_rate || !amount)
+			return 0;
+
+		std::chrono::duration<double> debt;
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+
+			const auto now = clock::now();
+			const std::chrono::duration<double> elapsed = now - m_updated;
+			m_updated = now;
+
+			m_tokens = std::min<double>(m_rate, m_tokens + elapsed.count() * m_rate) - amount;
+			if (m_tokens >= 0)
+				return 0;
+
+			debt = std::chrono::duration<double>(-m_tokens / m_rate);
+		}
+
+		static const std::chrono::duration<double> slice = std::chrono::milliseconds(blob_rate_limiter_slice);
+		while (debt.count() > 0) {
+			std::this_thread::sleep_for(std::min(debt, slice));
+			debt -= slice;
+
+			const int err = interrupted();
+			if (err)
+				return err;
+		}
+		return 0;
+	}
+
+private:
+	const uint64_t m_rate;
+	std::mutex m_lock;
+	double m_tokens;
+	clock::time_point m_updated;
+};
+
+/*
+ * Threads of the backend which run iterations, so long iterations don't occupy io threads. Number of threads
+ * limits number of concurrently running iterations, the rest wait in the queue. Paused iteration keeps
+ * its thread. Iterations are paused, continued and canceled by dnet_iterator_set_state() like old iterators.
+ * It is referred by eblob_backend_config, so it lives in global namespace like other C-visible structures.
+ */
+struct blob_iterator_pool {
+public:
+	typedef std::chrono::steady_clock clock;
+
+	explicit blob_iterator_pool(eblob_backend_config *c)
+	: m_c(c)
+	, m_bytes_limiter(c->iterator_rate_bytes)
+	, m_keys_limiter(c->iterator_rate_keys)
+	, m_need_exit(false) {
+		const unsigned int threads = c->iterator_threads ? c->iterator_threads : blob_iterator_threads;
+
+		try {
+			for (unsigned int i = 0; i < threads; ++i)
+				m_threads.emplace_back(&blob_iterator_pool::process, this);
+		} catch (...) {
+			stop();
+			throw;
+		}
+	}
+
+	~blob_iterator_pool() {
+		stop();
+	}
+
+	/* queues @task, the pool acknowledges its command when the iteration is finished */
+	void push(const std::shared_ptr<blob_iterator_task> &task) {
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_queue.push_back(task);
+		}
+		m_wait.notify_one();
+	}
+
+	void stat(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) const {
+		std::lock_guard<std::mutex> guard(m_lock);
+
+		auto add = [&] (const blob_iterator_task &task) {
+			rapidjson::Value task_value(rapidjson::kObjectType);
+			task_stat(task, task_value, allocator);
+			value.PushBack(task_value, allocator);
+		};
+
+		for (const auto &task : m_running)
+			add(*task);
+		for (const auto &task : m_queue)
+			add(*task);
+	}
+
+private:
+	void stop() {
+		std::deque<std::shared_ptr<blob_iterator_task>> queue;
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_need_exit = true;
+			queue.swap(m_queue);
+
+			for (const auto &task : m_running)
+				dnet_iterator_set_state(task->st->n, DNET_ITERATOR_ACTION_CANCEL, task->it->id);
+		}
+		m_wait.notify_all();
+
+		for (const auto &task : queue)
+			finish(*task, -ECANCELED);
+
+		for (auto &thread : m_threads)
+			thread.join();
+		m_threads.clear();
+	}
+
+	/* ioprio_set(2) with zero pid changes priority of the calling thread only */
+	void set_ioprio() {
+		if (!m_c->iterator_ioprio_class)
+			return;
+
+		const int ioprio = (m_c->iterator_ioprio_class << blob_ioprio_class_shift) | m_c->iterator_ioprio_data;
+		if (syscall(SYS_ioprio_set, blob_ioprio_who_process, 0, ioprio) == -1) {
+			const int err = -errno;
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: failed to set ioprio: class: {}, data: {}: {} [{}]",
+			               m_c->iterator_ioprio_class, m_c->iterator_ioprio_data, strerror(-err), err);
+		}
+	}
+
+	void process() {
+		set_ioprio();
+
+		while (true) {
+			std::shared_ptr<blob_iterator_task> task;
+			{
+				std::unique_lock<std::mutex> guard(m_lock);
+				m_wait.wait(guard, [this] { return m_need_exit || !m_queue.empty(); });
+				if (m_need_exit)
+					return;
+
+				task = m_queue.front();
+				m_queue.pop_front();
+				m_running.push_back(task);
+			}
+
+			task->started_at = clock::now();
+			task->running = true;
+
+			finish(*task, run(*task));
+
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_running.remove(task);
+		}
+	}
+
+	/*
+	 * Iterates key range partitions of @task, the first one is iterated by the calling thread and the rest
+	 * by their own threads. Replies of partitions are interleaved, so records of the same blob are sent
+	 * in their order only within a partition. The first failed partition stops the others.
+	 */
+	int run(blob_iterator_task &task) {
+		/* iteration could be paused or canceled while it was queued */
+		int err = dnet_iterator_flow_control(task.it);
+		if (err)
+			return err;
+
+		const auto partitions = blob_iterator_partitions(task.request, m_c->iterator_parallelism);
+
+		std::atomic<int> first_error{0};
+		auto iterate_partition = [&] (const std::vector<eblob_index_block> &ranges) {
+			int expected = 0;
+			const int err = iterate(task, ranges, first_error);
+			if (err)
+				first_error.compare_exchange_strong(expected, err);
+		};
+
+		std::vector<std::thread> threads;
+		std::vector<const std::vector<eblob_index_block> *> inline_partitions{&partitions.front()};
+		for (size_t i = 1; i < partitions.size(); ++i) {
+			try {
+				threads.emplace_back([&, i] {
+					set_ioprio();
+					iterate_partition(partitions[i]);
+				});
+			} catch (const std::system_error &e) {
+				DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: id: {}: failed to start partition thread, "
+				                          "it will be iterated sequentially: {}", task.it->id, e.what());
+				inline_partitions.push_back(&partitions[i]);
+			}
+		}
+
+		for (const auto ranges : inline_partitions)
+			iterate_partition(*ranges);
+		for (auto &thread : threads)
+			thread.join();
+
+		err = first_error;
+		if (task.batch) {
+			/* the tail of replies is sent even if iteration has failed, they precede the final error */
+			const int flush_err = task.batch->flush();
+			if (!err)
+				err = flush_err;
+		}
+		if (task.container && !err) {
+			err = task.container->send(task.it->id, task.filter ? task.filter->filtered() : 0);
+			task.sent_bytes = task.iterated_keys * sizeof(blob_iterator_container::item_type);
+		}
+		return err;
+	}
+
+	/* iterates @ranges of the backend, iteration is interrupted when any partition of @task has failed */
+	int iterate(blob_iterator_task &task, const std::vector<eblob_index_block> &ranges,
+	            const std::atomic<int> &first_error) {
+		eblob_iterate_control control;
+		memset(&control, 0, sizeof(control));
+
+		control.b = m_c->eblob;
+		control.log = m_c->data.log;
+		control.flags = EBLOB_ITERATE_FLAGS_ALL | EBLOB_ITERATE_FLAGS_READONLY;
+
+		/* eblob doesn't modify ranges */
+		control.range = const_cast<eblob_index_block *>(ranges.data());
+		control.range_num = ranges.size();
+
+		blob_iterator_progress progress{0, 0};
+		const iterator_callback callback = task.container ? make_iterator_container_callback(&task, &progress)
+		                                                  : make_iterator_network_callback(m_c, &task, &progress);
 
-	return [=, &request] (std::shared_ptr<iterated_key_info> info) -> int {
-		if (st->__need_exit) {
-			DNET_LOG_ERROR(c->blog, "EBLOB: iterator: Interrupting iterator: peer has been disconnected");
-			return -EINTR;
-		}
+		auto common_callback = [&] (const eblob_disk_control *dc, int fd, uint64_t data_offset) -> int {
+			const int failed = first_error;
+			if (failed)
+				return failed;
 
-		data_pointer json;
-		if ((request.flags & DNET_IFLAGS_JSON) && info->jhdr.size) {
-			json = data_pointer::allocate(info->jhdr.size);
-			const int err = dnet_read_ll(info->fd, json.data<char>(), json.size(), info->json_offset);
-			if (err) {
-				DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: failed to read json: {} [{}]",
-				               dnet_dump_id_str(info->key.id), strerror(-err), err);
+			const uint64_t keys = progress.keys;
+			const uint64_t bytes = progress.bytes;
+
+			const int err = blob_iterate_callback_common(m_c, task.request, task.it, dc, fd, data_offset,
+			                                             task.filter.get(), callback);
+
+			if (err)
 				return err;
-			}
-		}
 
-		const uint64_t read_data_size = (request.flags & DNET_IFLAGS_DATA) ? info->data_size : 0;
+			const auto interrupted = [&] () {
+				return m_need_exit ? -ECANCELED : iterator_canceled(task);
+			};
+			const int limit_err = m_keys_limiter.consume(progress.keys - keys, interrupted);
+			if (limit_err)
+				return limit_err;
+			return m_bytes_limiter.consume(progress.bytes - bytes, interrupted);
+		};
 
-		auto header = serialize(ioremap::elliptics::dnet_iterator_response{
-			it->id, // iterator_id
-			info->key, // key
-			0, // status
+		control.priv = &common_callback;
 
-			++(*counter), // iterated_keys
-			total_keys, // total_keys
+		control.iterator_cb.iterator = [] (eblob_disk_control *dc, eblob_ram_control *,
+		                                   int fd, uint64_t data_offset, void *priv, void *) ->int {
+			auto callback = *static_cast<decltype(common_callback) *>(priv);
+			return callback(dc, fd, data_offset);
+		};
 
-			info->record_flags, // record_flags
-			info->ehdr.flags, // user_flags
+		return eblob_iterate(m_c->eblob, &control);
+	}
 
-			info->jhdr.timestamp, // json_timestamp
-			info->jhdr.size, // json_size
-			info->jhdr.capacity, // json_capacity
-			json.size(), // read_json_size
+	void finish(blob_iterator_task &task, int err) {
+		const auto run_time = task.running ? clock::now() - task.started_at : clock::duration::zero();
 
-			info->ehdr.timestamp, // data timestamp
-			info->data_size, // data_size
-			read_data_size, // read_data_size
-			info->data_offset, // data_offset
-			static_cast<uint64_t>(info->fd) // blob_id
-		});
+		DNET_LOG(m_c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO,
+		         "EBLOB: iterator: id: {}, client: {}: finished: iterated_keys: {}/{}, sent_bytes: {}, "
+		         "time: {} ms: {} [{}]",
+		         task.it->id, dnet_addr_string(&task.st->addr), task.iterated_keys.load(), task.total_keys,
+		         task.sent_bytes.load(),
+		         std::chrono::duration_cast<std::chrono::milliseconds>(run_time).count(), strerror(-err), err);
 
-		if (st->__need_exit) {
-			DNET_LOG_ERROR(c->blog,
-			               "EBLOB: iterator: Interrupting iterator because peer has been disconnected");
-			return -EINTR;
+		if (task.filter && (task.cmd.flags & DNET_FLAGS_NEED_ACK)) {
+			send_final_reply(task, err);
+			return;
 		}
 
-		auto response = data_pointer::allocate(sizeof(*cmd) + header.size() + json.size());
+		dnet_send_ack(task.st, &task.cmd, err, 0, /*context*/ nullptr);
+	}
 
-		memcpy(response.data(), cmd, sizeof(*cmd));
-		memcpy(response.skip<dnet_cmd>().data(), header.data(), header.size());
-		if (!json.empty()) {
-			memcpy(response.skip(sizeof(*cmd) + header.size()).data(), json.data(), json.size());
-		}
+	/*
+	 * Replaces the empty ack of filtered iteration: the final reply has no key, json and data, it carries
+	 * the number of keys skipped by the whole iteration, since replies of records report it only up to them.
+	 */
+	void send_final_reply(blob_iterator_task &task, int err) {
+		using namespace ioremap::elliptics;
 
-		response.data<dnet_cmd>()->size = header.size() + json.size() + read_data_size;
-		response.data<dnet_cmd>()->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
-		response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
+		const auto header = serialize(ioremap::elliptics::dnet_iterator_response{
+			task.it->id, // iterator_id
+			dnet_raw_id(), // key
+			err, // status
 
-		return dnet_send_fd_threshold(st, response.data(), response.size(), info->fd, info->data_offset, read_data_size);
-	};
-}
+			task.iterated_keys.load(), // iterated_keys
+			task.total_keys, // total_keys
 
+			0, // record_flags
+			0, // user_flags
 
-static int blob_iterate_callback_common(const eblob_backend_config *c,
-                                        const ioremap::elliptics::dnet_iterator_request &request,
-                                        dnet_iterator *it,
-                                        const eblob_disk_control *dc, int fd, uint64_t offset,
-                                        iterator_callback callback) {
-	assert(dc != nullptr);
+			dnet_time(), // json_timestamp
+			0, // json_size
+			0, // json_capacity
+			0, // read_json_size
 
-	auto info = std::make_shared<iterated_key_info>(dc, fd);
+			dnet_time(), // data timestamp
+			0, // data_size
+			0, // read_data_size
+			0, // data_offset
+			0, // blob_id
+			task.filter->filtered() // filtered_keys
+		});
 
-	// dc->data_size for uncommitted records contains garbage and shouldn't be used
-	uint64_t size = (dc->flags & BLOB_DISK_CTL_UNCOMMITTED) ? 0 : dc->data_size;
+		auto packet = data_pointer::allocate(sizeof(task.cmd) + header.size());
+		memcpy(packet.data(), &task.cmd, sizeof(task.cmd));
+		memcpy(packet.skip<dnet_cmd>().data(), header.data(), header.size());
 
-	int err = 0;
-	if (dc->flags & BLOB_DISK_CTL_EXTHDR) {
-		if (!(request.flags & DNET_IFLAGS_NO_META)) {
-			err = dnet_ext_hdr_read(&info->ehdr, fd, offset);
-			if (err) {
-				DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: dnet_ext_hdr_read failed: {} [{}]",
-				               dnet_dump_id_str(info->key.id), strerror(-err), err);
-				return err;
-			}
+		auto cmd = packet.data<dnet_cmd>();
+		cmd->size = header.size();
+		cmd->status = err;
+		cmd->flags |= DNET_FLAGS_REPLY;
+		cmd->flags &= ~(DNET_FLAGS_NEED_ACK | DNET_FLAGS_MORE);
 
-			if (info->ehdr.size) {
-				err = dnet_read_json_header(fd, offset + sizeof(info->ehdr), info->ehdr.size, &info->jhdr);
-				if (err) {
-					DNET_LOG_ERROR(c->blog,
-					               "EBLOB: iterator: {}: dnet_read_json_header failed: {} [{}]",
-					               dnet_dump_id_str(info->key.id), strerror(-err), err);
-					return err;
-				}
-			}
+		err = dnet_send(task.st, packet.data(), packet.size(), /*context*/ nullptr);
+		if (err) {
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: id: {}: failed to send final reply: {} [{}]",
+			               task.it->id, strerror(-err), err);
 		}
+	}
 
-		offset += sizeof(info->ehdr) + info->ehdr.size;
-		if (size >= sizeof(info->ehdr) + info->ehdr.size) {
-			size -= sizeof(info->ehdr) + info->ehdr.size;
-		} else if (size) {
-			err = -EINVAL;
-			DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: has invalid size: {} < {} (sizeof(info.ehdr)) + "
-			                        "{} (info.ehdr.size): {} [{}]",
-			               dnet_dump_id_str(info->key.id), size, sizeof(info->ehdr), info->ehdr.size,
-			               strerror(-err), err);
-			return err;
-		}
+	/* returns -ENOEXEC like dnet_iterator_flow_control() does if iteration of @task has been canceled */
+	static int iterator_canceled(const blob_iterator_task &task) {
+		pthread_mutex_lock(&task.it->lock);
+		const bool canceled = task.it->state == DNET_ITERATOR_ACTION_CANCEL;
+		pthread_mutex_unlock(&task.it->lock);
+
+		return canceled ? -ENOEXEC : 0;
 	}
 
-	if (request.flags & DNET_IFLAGS_TS_RANGE) {
-		if (dnet_time_cmp(&info->ehdr.timestamp, &std::get<0>(request.time_range)) < 0 ||
-		    dnet_time_cmp(&info->ehdr.timestamp, &std::get<1>(request.time_range)) > 0) {
-			/* skip key which timestamp is not in request.time_range */
-			return 0;
+	static const char *task_state(const blob_iterator_task &task) {
+		if (!task.running)
+			return "queued";
+
+		pthread_mutex_lock(&task.it->lock);
+		const auto state = task.it->state;
+		pthread_mutex_unlock(&task.it->lock);
+
+		switch (state) {
+		case DNET_ITERATOR_ACTION_PAUSE:
+			return "paused";
+		case DNET_ITERATOR_ACTION_CANCEL:
+			return "canceled";
+		default:
+			return "running";
 		}
 	}
 
-	if (size >= info->jhdr.capacity) {
-		info->data_size = size - info->jhdr.capacity;
-	} else if (size) {
-		err = -EINVAL;
-		DNET_LOG_ERROR(c->blog, "EBLOB: iterator {}: has invalid size({}) < info.jhdr.capacity({}): {} [{}]",
-		               dnet_dump_id_str(info->key.id), size, info->jhdr.capacity, strerror(-err), err);
-		return err;
+	static void task_stat(const blob_iterator_task &task, rapidjson::Value &value,
+	                      rapidjson::Document::AllocatorType &allocator) {
+		typedef std::chrono::milliseconds msecs;
+		const auto now = clock::now();
+
+		rapidjson::Value client(dnet_addr_string(&task.st->addr), allocator);
+
+		value.AddMember("id", task.it->id, allocator);
+		value.AddMember("state", task_state(task), allocator);
+		value.AddMember("client", client, allocator);
+		value.AddMember("flags", task.request.flags, allocator);
+		value.AddMember("key_ranges", static_cast<uint64_t>(task.request.key_ranges.size()), allocator);
+		value.AddMember("iterated_keys", task.iterated_keys.load(), allocator);
+		value.AddMember("total_keys", task.total_keys, allocator);
+		value.AddMember("sent_bytes", task.sent_bytes.load(), allocator);
+		if (task.running) {
+			value.AddMember("queue_time", std::chrono::duration_cast<msecs>(task.started_at -
+			                                                                task.queued_at).count(), allocator);
+			value.AddMember("run_time", std::chrono::duration_cast<msecs>(now - task.started_at).count(),
+			                allocator);
+		} else {
+			value.AddMember("queue_time", std::chrono::duration_cast<msecs>(now - task.queued_at).count(),
+			                allocator);
+			value.AddMember("run_time", 0, allocator);
+		}
 	}
 
-	info->json_offset = offset;
-	info->data_offset = offset + info->jhdr.capacity;
-
-	const std::string data_ts = dnet_print_time(&info->ehdr.timestamp);
-	const std::string json_ts = dnet_print_time(&info->jhdr.timestamp);
-
-	DNET_LOG_DEBUG(c->blog, "EBLOB: iterated: key: {}, fd: {}, user_flags: {:#x}, json: {{offset: {}, size: {}, "
-	                        "capacity: {}, ts: {}}}, data: {{offset: {}, size: {}, ts: {}}}",
-	               dnet_dump_id_str(info->key.id), fd, info->ehdr.flags, offset, info->jhdr.size,
-	               info->jhdr.capacity, json_ts, info->data_offset, info->data_size, data_ts);
+	eblob_backend_config *m_c;
+	blob_rate_limiter m_bytes_limiter;
+	blob_rate_limiter m_keys_limiter;
+
+	mutable std::mutex m_lock;
+	std::condition_variable m_wait;
+	/* it is read without @m_lock by rate limiters of running iterations */
+	std::atomic_bool m_need_exit;
+	std::deque<std::shared_ptr<blob_iterator_task>> m_queue;
+	std::list<std::shared_ptr<blob_iterator_task>> m_running;
+	std::vector<std::thread> m_threads;
+};
 
-	err = callback(info);
-	if (err) {
-		return err;
+struct blob_iterator_pool *blob_iterator_pool_create(struct eblob_backend_config *c) {
+	try {
+		return new blob_iterator_pool(c);
+	} catch (const std::exception &e) {
+		DNET_LOG_ERROR(c->blog, "EBLOB: failed to start iterator pool: {}", e.what());
+		return nullptr;
 	}
+}
 
-	return dnet_iterator_flow_control(it);
+void blob_iterator_pool_destroy(struct blob_iterator_pool *pool) {
+	delete pool;
+}
+
+static void blob_iterator_pool_stat(const blob_iterator_pool *pool, rapidjson::Value &value,
+                                    rapidjson::Document::AllocatorType &allocator) {
+	pool->stat(value, allocator);
 }
 
 static int blob_iterator_start(struct eblob_backend_config *c, dnet_net_state *st, dnet_cmd *cmd,
@@ -1819,45 +3836,16 @@ static int blob_iterator_start(struct eblob_backend_config *c, dnet_net_state *s
 		return -ERANGE;
 	}
 
-	eblob_iterate_control control;
-	memset(&control, 0, sizeof(control));
-
-	control.b = c->eblob;
-	control.log = c->data.log;
-	control.flags = EBLOB_ITERATE_FLAGS_ALL | EBLOB_ITERATE_FLAGS_READONLY;
-
-	std::vector<eblob_index_block> ranges;
-	ranges.reserve(request.key_ranges.size());
-
-	for (const auto &range : request.key_ranges) {
-		eblob_key begin, end;
-		memcpy(begin.id, range.key_begin.id, EBLOB_ID_SIZE);
-		memcpy(end.id, range.key_end.id, EBLOB_ID_SIZE);
-
-		ranges.emplace_back(eblob_index_block{begin, end, 0, 0});
-	}
-
-	control.range = ranges.data();
-	control.range_num = ranges.size();
-
-	auto deleter = [&st] (dnet_iterator *p) {
-		dnet_iterator_destroy(st->n, p);
-	};
-
-	std::unique_ptr<dnet_iterator, decltype(deleter)> it{dnet_iterator_create(st->n), deleter};
-	if (!it) {
-		return -ENOMEM;
-	}
-
-	iterator_callback callback;
-
 	switch (request.type) {
 		case DNET_ITYPE_DISK: {
-			DNET_LOG_ERROR(c->blog, "EBLOB: iteration failed: type: 'DNET_ITYPE_DISK' is not implemented");
-			return -ENOTSUP;
+			if (request.flags & (DNET_IFLAGS_JSON | DNET_IFLAGS_DATA | DNET_IFLAGS_BATCH)) {
+				DNET_LOG_ERROR(c->blog, "EBLOB: iteration failed: type: 'DNET_ITYPE_DISK' sends only "
+				                        "metadata, flags: {}", request.flags);
+				return -ENOTSUP;
+			}
+			break;
 		}
 		case DNET_ITYPE_NETWORK: {
-			callback = make_iterator_network_callback(c, st, cmd, request, it.get());
 			break;
 		}
 		default: {
@@ -1866,19 +3854,46 @@ static int blob_iterator_start(struct eblob_backend_config *c, dnet_net_state *s
 		}
 	}
 
-	auto common_callback = [&] (const eblob_disk_control *dc, int fd, uint64_t data_offset) -> int {
-		return blob_iterate_callback_common(c, request, it.get(), dc, fd, data_offset, callback);
-	};
+	auto task = std::make_shared<blob_iterator_task>(st, cmd, request);
 
-	control.priv = &common_callback;
+	if (request.flags & DNET_IFLAGS_FILTER) {
+		if (request.flags & DNET_IFLAGS_NO_META) {
+			DNET_LOG_ERROR(c->blog, "EBLOB: iteration failed: filter can't be applied without metadata");
+			return -EINVAL;
+		}
 
-	control.iterator_cb.iterator = [] (eblob_disk_control *dc, eblob_ram_control *,
-	                                   int fd, uint64_t data_offset, void *priv, void *) ->int {
-		auto callback = *static_cast<decltype(common_callback) *>(priv);
-		return callback(dc, fd, data_offset);
-	};
+		task->filter = std::make_shared<blob_iterator_filter>(request.filter);
+		if (!task->filter->init()) {
+			DNET_LOG_ERROR(c->blog, "EBLOB: iteration failed: invalid filter's json value: '{}'",
+			               request.filter.json_value);
+			return -EINVAL;
+		}
+	}
+
+	/* replies with data are sent by sendfile, so only metadata and json are batched */
+	if ((request.flags & DNET_IFLAGS_BATCH) && !(request.flags & DNET_IFLAGS_DATA))
+		task->batch = std::make_shared<blob_iterator_batch>(c, st, &task->cmd);
+
+	task->it = dnet_iterator_create(st->n);
+	if (!task->it) {
+		return -ENOMEM;
+	}
+
+	if (request.type == DNET_ITYPE_DISK) {
+		task->container = std::make_shared<blob_iterator_container>(c, st, &task->cmd);
+
+		const int err = task->container->open(task->it->id);
+		if (err)
+			return err;
+	}
+
+	task->total_keys = eblob_total_elements(c->eblob);
+
+	c->iterator_pool->push(task);
 
-	return eblob_iterate(c->eblob, &control);
+	/* the pool acknowledges the command when the iteration is finished */
+	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+	return 0;
 }
 
 int blob_iterate(struct eblob_backend_config *c,
@@ -1913,7 +3928,7 @@ int blob_iterate(struct eblob_backend_config *c,
 		             });
 	}
 
-	DNET_LOG_INFO(c->blog, "EBLOB: {} started: id: {}, flags: {}, action: {}, type: {}, key_ranges: {}, groups: {}",
+	BLOB_LOG_INFO(c, "EBLOB: {} started: id: {}, flags: {}, action: {}, type: {}, key_ranges: {}, groups: {}",
 	              __func__, request.iterator_id, request.flags, request.action, request.type,
 	              request.key_ranges.size(), request.groups.size());
 
@@ -1921,7 +3936,8 @@ int blob_iterate(struct eblob_backend_config *c,
 	 * Check iterator action start/pause/cont
 	 * On pause, find in list and mark as stopped
 	 * On continue, find in list and mark as running, broadcast condition variable.
-	 * On start, create and start iterator.
+	 * On start, create iterator and queue it to the backend's iterator pool.
+	 * On cancel, find in list and mark as canceled, iteration stops at the next key.
 	 */
 	int err = 0;
 	switch (request.action) {
@@ -1931,7 +3947,9 @@ int blob_iterate(struct eblob_backend_config *c,
 		case DNET_ITERATOR_ACTION_PAUSE:
 		case DNET_ITERATOR_ACTION_CONTINUE:
 		case DNET_ITERATOR_ACTION_CANCEL:
-			err = -ENOTSUP;
+			err = dnet_iterator_set_state(reinterpret_cast<dnet_net_state*>(state)->n,
+			                              static_cast<dnet_iterator_action>(request.action),
+			                              request.iterator_id);
 			break;
 		default:
 			err = -ENOTSUP;
@@ -1974,8 +3992,8 @@ int blob_send_new(struct eblob_backend_config *c,
 		             });
 	}
 
-	DNET_LOG_INFO(c->blog, "EBLOB: {} started: ids_num: {}, groups: {}, chunk_write_timeout: {}, "
-	                       "chunk_commit_timeout: {}, chunk_retry_count: {:d}",
+	BLOB_LOG_INFO(c, "EBLOB: {} started: ids_num: {}, groups: {}, chunk_write_timeout: {}, "
+	                "chunk_commit_timeout: {}, chunk_retry_count: {:d}",
 	              __func__, request.keys.size(), request.groups, request.chunk_write_timeout,
 	              request.chunk_commit_timeout, request.chunk_retry_count);
 
@@ -2014,9 +4032,10 @@ int blob_send_new(struct eblob_backend_config *c,
 	};
 
 	congestion_control_monitor monitor;
+	small_object_batch batch{c, reinterpret_cast<dnet_net_state*>(state), cmd, request};
 
 	auto callback = make_iterator_server_send_callback(c, reinterpret_cast<dnet_net_state*>(state),
-	                                                   cmd, request, cmd->backend_id, monitor, counter);
+	                                                   cmd, request, cmd->backend_id, monitor, batch, counter);
 
 	eblob_key ekey;
 	eblob_write_control wc;
@@ -2135,11 +4154,17 @@ int blob_send_new(struct eblob_backend_config *c,
 			continue;
 		}
 
+		/* compressed data is decompressed by sender, see base_object_sender::read() */
+		if (info->ehdr.compression)
+			info->data_size = info->ehdr.data_size;
+
 		if ((err = callback(info))) {
 			break;
 		}
 	}
 
+	// batched objects hold their quota, so they should be sent before waiting for completion
+	batch.flush();
 	monitor.wait_completion();
 
 	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "EBLOB: {} finished: {}", __func__,
@@ -2288,6 +4313,7 @@ int blob_bulk_remove_new(struct eblob_backend_config *config,
 			}
 			if (!err) {
 				err = eblob_remove(b, &key);
+				blob_header_cache_forget(config->header_cache, &key);
 			}
 		}
 
@@ -2298,6 +4324,203 @@ int blob_bulk_remove_new(struct eblob_backend_config *config,
 	return 0;
 }
 
+/*
+ * Blobs written by one DNET_CMD_BULK_WRITE_NEW with bulk_write_sync. Data and index descriptors of every written
+ * record are dup()-ed while the record's oplock is held, so defragmentation or close of the blob before the sync
+ * can't invalidate them or make them refer to another file. Each file is synced once by sync().
+ */
+class blob_bulk_write_sync {
+public:
+	blob_bulk_write_sync() = default;
+	blob_bulk_write_sync(const blob_bulk_write_sync &) = delete;
+	blob_bulk_write_sync &operator =(const blob_bulk_write_sync &) = delete;
+
+	~blob_bulk_write_sync() {
+		for (const auto &file : m_files)
+			close(file.fd);
+	}
+
+	/* pins blob and index files the record described by @wc was written to */
+	int add(const eblob_write_control &wc) {
+		int err = add(wc.data_fd);
+		if (!err)
+			err = add(wc.index_fd);
+		return err;
+	}
+
+	/* fdatasync-s all pinned files, returns the last error */
+	int sync(eblob_backend_config *c) {
+		int err = 0;
+		for (const auto &file : m_files) {
+			if (fdatasync(file.fd) == -1) {
+				err = -errno;
+				DNET_LOG_ERROR(c->blog, "EBLOB: BULK_WRITE_NEW: fdatasync: dev: {}, ino: {}: {} [{}]",
+				               file.dev, file.ino, strerror(-err), err);
+			}
+		}
+		return err;
+	}
+
+	size_t size() const {
+		return m_files.size();
+	}
+
+private:
+	int add(int fd) {
+		struct stat st;
+		if (fstat(fd, &st) == -1)
+			return -errno;
+
+		for (const auto &file : m_files) {
+			if (file.dev == st.st_dev && file.ino == st.st_ino)
+				return 0;
+		}
+
+		const int pinned = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+		if (pinned == -1)
+			return -errno;
+
+		m_files.emplace_back(pinned_file{st.st_dev, st.st_ino, pinned});
+		return 0;
+	}
+
+	struct pinned_file {
+		dev_t dev;
+		ino_t ino;
+		int fd;
+	};
+	std::vector<pinned_file> m_files;
+};
+
+int blob_bulk_write_new(struct eblob_backend_config *config,
+                        void *state,
+                        struct dnet_cmd *cmd,
+                        void *data,
+                        struct dnet_cmd_stats *cmd_stats,
+                        struct dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	if (config == nullptr || state == nullptr || cmd == nullptr || data == nullptr)
+		return -EINVAL;
+
+	const auto packet = data_pointer::from_raw(data, cmd->size);
+	size_t offset = 0;
+	dnet_bulk_write_request bulk_request;
+	deserialize(packet, bulk_request, offset);
+	if (!bulk_request.is_valid())
+		return -EINVAL;
+
+	const auto payload = packet.skip(offset);
+	uint64_t payload_size = 0;
+	for (const auto &request : bulk_request.requests)
+		payload_size += request.json_size + request.data_size;
+	if (payload_size != payload.size())
+		return -EINVAL;
+
+	auto st = reinterpret_cast<dnet_net_state *>(state);
+	const int backend_id = config->data.stat_id;
+	auto backend = st->n->io->backends_manager->get(backend_id);
+	if (!backend)
+		return -ENOTSUP;
+
+	if (context) {
+		context->add({{"keys", bulk_request.keys.size()},
+		              {"size", payload_size},
+		             });
+	}
+
+	auto pool = backend->io_pool();
+	if (!pool) {
+		DNET_LOG_ERROR(config->blog, "EBLOB: {}: couldn't find pool for backend_id: {}",
+		               __func__, backend_id);
+		return -EINVAL;
+	}
+
+	DNET_LOG_INFO(config->blog, "{}: EBLOB: {}: BULK_WRITE_NEW: start for backend_id: {}, keys: {}",
+	              dnet_dump_id(&cmd->id), __func__, backend_id, bulk_request.keys.size());
+
+	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+	cmd_stats->size = payload_size;
+
+	/*
+	 * Records are written one by one, each is an eblob write with its own index update. With bulk_write_sync
+	 * only their sync is batched: replies are held until blob and index files written by the batch are synced.
+	 */
+	const bool group_sync = config->bulk_write_sync;
+	std::vector<std::pair<dnet_cmd, data_pointer>> replies;
+	blob_bulk_write_sync pinned;
+	if (group_sync)
+		replies.reserve(bulk_request.keys.size());
+
+	const size_t num_keys = bulk_request.keys.size();
+	offset = 0;
+	for (size_t i = 0; i < num_keys; ++i) {
+		const auto &request = bulk_request.requests[i];
+		const auto record = payload.slice(offset, request.json_size + request.data_size);
+		offset += request.json_size + request.data_size;
+
+		struct dnet_cmd cmd_copy(*cmd);
+		cmd_copy.backend_id = backend_id;
+		cmd_copy.id = bulk_request.keys[i];
+
+		data_pointer response;
+		int err = 0;
+
+		dnet_time current_time;
+		dnet_current_time(&current_time);
+		if (dnet_time_cmp(&bulk_request.deadline, &current_time) < 0) {
+			err = -ETIMEDOUT;
+		} else {
+			eblob_write_control wc;
+			memset(&wc, 0, sizeof(wc));
+
+			dnet_oplock_guard oplock_guard{pool, &cmd_copy.id};
+			err = blob_write_new_impl(config, &cmd_copy, request, record, response, &wc);
+			if (!err && group_sync) {
+				err = pinned.add(wc);
+				if (err) {
+					response = data_pointer();
+					DNET_LOG_ERROR(config->blog, "{}: EBLOB: {}: BULK_WRITE_NEW: could not pin "
+					                             "written blob: {} [{}]",
+					               dnet_dump_id(&cmd_copy.id), __func__, strerror(-err), err);
+				}
+			}
+		}
+
+		cmd_copy.status = err;
+		if (group_sync) {
+			replies.emplace_back(cmd_copy, std::move(response));
+			continue;
+		}
+
+		const bool last_write = i >= (num_keys - 1);
+		dnet_send_reply(st, &cmd_copy, response.data(), response.size(), last_write ? 0 : 1,
+		                /*context*/ nullptr);
+	}
+
+	if (!group_sync)
+		return 0;
+
+	/* written records are acknowledged only if all files they were written to are synced */
+	const int sync_err = pinned.sync(config);
+
+	BLOB_LOG_INFO(config, "{}: EBLOB: {}: BULK_WRITE_NEW: synced files: {}, keys: {}, status: {}",
+	              dnet_dump_id(&cmd->id), __func__, pinned.size(), num_keys, sync_err);
+
+	for (size_t i = 0; i < replies.size(); ++i) {
+		auto &reply = replies[i];
+		if (sync_err && !reply.first.status) {
+			reply.first.status = sync_err;
+			reply.second = data_pointer();
+		}
+
+		const bool last_write = i >= (replies.size() - 1);
+		dnet_send_reply(st, &reply.first, reply.second.data(), reply.second.size(), last_write ? 0 : 1,
+		                /*context*/ nullptr);
+	}
+	return 0;
+}
+
 int n2_eblob_backend_command_handler(void *state,
                                      void *priv,
                                      struct n2_request_info *req_info,
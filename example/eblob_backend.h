@@ -26,12 +26,16 @@
 
 #include "elliptics/interface.h"
 
+#include "library/atomic.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct dnet_config_backend;
 struct dnet_cmd_stats;
+struct blob_header_cache;
+struct blob_iterator_pool;
 
 struct eblob_read_params {
 	int			fd;
@@ -39,20 +43,86 @@ struct eblob_read_params {
 	uint64_t		offset;
 };
 
+/* counters of records' compression exported in backend's statistics, times are in usecs */
+struct eblob_compression_stats {
+	atomic_t			compressed_records;
+	atomic_t			skipped_records;	/* compression didn't save compression_min_gain */
+	atomic_t			raw_bytes;		/* data of compressed records */
+	atomic_t			compressed_bytes;	/* the same data after compression */
+	atomic_t			compress_time;
+	atomic_t			decompressed_bytes;
+	atomic_t			decompress_time;
+};
+
 struct eblob_backend_config {
 	struct eblob_config		data;
 	struct eblob_backend		*eblob;
 	dnet_logger			*blog;
 	struct eblob_log		log;
+	/* backend's verbosity, messages below it are dropped before their arguments are evaluated */
+	enum dnet_log_level		log_level;
 
 	pthread_mutex_t			last_read_lock;
 	int64_t				vm_total;		/* squared in bytes */
 	int				random_access;
 	int				last_read_index;
 	struct eblob_read_params	last_reads[100];
+
+	/* codec of records written by a single request, see enum dnet_ext_compression */
+	int				compression;
+	/* percents of data size compression should save, otherwise data is written as is */
+	int				compression_min_gain;
+	struct eblob_compression_stats	compression_stats;
+
+	/* parsed headers of recently read records, see blob_header_cache_forget() */
+	struct blob_header_cache	*header_cache;
+
+	/*
+	 * seconds during which checksum verified by a read isn't verified again by next reads of the record,
+	 * 0 disables it. The cached state is dropped by rewrite, defragmentation and verification failure.
+	 */
+	unsigned int			verified_checksum_ttl;
+	atomic_t			verified_checksum_hits;	/* verifications skipped due to the cache */
+
+	/* limits of the reply packing records of the iterator with DNET_IFLAGS_BATCH, 0 means built-in default */
+	uint64_t			iterator_batch_records;
+	uint64_t			iterator_batch_size;	/* bytes */
+	uint64_t			iterator_batch_delay;	/* msecs of the first record in the reply */
+
+	/*
+	 * Iterations of DNET_CMD_ITERATOR_NEW are run by the backend's own threads instead of io threads,
+	 * see blob_iterator_pool_create(). 0 means built-in default of threads and no limit of rates.
+	 */
+	unsigned int			iterator_threads;
+	int				iterator_ioprio_class;	/* ioprio_set(2) class of the threads, 0 keeps it */
+	int				iterator_ioprio_data;
+	uint64_t			iterator_rate_bytes;	/* bytes per second sent by all iterations */
+	uint64_t			iterator_rate_keys;	/* keys per second sent by all iterations */
+	unsigned int			iterator_parallelism;	/* key range partitions iterated in parallel */
+	struct blob_iterator_pool	*iterator_pool;
+
+	/*
+	 * DNET_CMD_BULK_WRITE_NEW syncs blob and index files written by the request once after all its records
+	 * are written and replies only after that. Records are still written by an eblob write and index update
+	 * each, only their sync is batched. Useful with eblob's periodic or disabled @sync.
+	 */
+	int				bulk_write_sync;
 };
 
+/*
+ * Log into backend's logger, arguments are evaluated only if message passes backend's verbosity or trace bit.
+ * Should be used on the data path instead of DNET_LOG_{DEBUG,NOTICE,INFO}(c->blog, ...).
+ */
+#define BLOB_LOG_DEBUG(c, ...)		DNET_LOG_VERBOSITY((c)->blog, (c)->log_level, DNET_LOG_DEBUG, __VA_ARGS__)
+#define BLOB_LOG_NOTICE(c, ...)		DNET_LOG_VERBOSITY((c)->blog, (c)->log_level, DNET_LOG_NOTICE, __VA_ARGS__)
+#define BLOB_LOG_INFO(c, ...)		DNET_LOG_VERBOSITY((c)->blog, (c)->log_level, DNET_LOG_INFO, __VA_ARGS__)
+
 int dnet_blob_config_to_json(struct dnet_config_backend *b, char **json_stat, size_t *size);
+/*
+ * adds settings and counters of compression and verified checksum cache, and progress of iterations
+ * to eblob's statistics @json_stat
+ */
+int blob_backend_stat_json(struct eblob_backend_config *c, char **json_stat, size_t *size);
 
 int blob_file_info(struct eblob_backend_config *c, void *state, struct n2_request_info *req_info,
                    struct dnet_access_context *context);
@@ -82,6 +152,12 @@ int blob_bulk_remove_new(struct eblob_backend_config *c,
                          struct dnet_cmd *cmd,
                          void *data,
                          struct dnet_access_context *context);
+int blob_bulk_write_new(struct eblob_backend_config *c,
+                        void *state,
+                        struct dnet_cmd *cmd,
+                        void *data,
+                        struct dnet_cmd_stats *cmd_stats,
+                        struct dnet_access_context *context);
 
 int n2_eblob_backend_command_handler(void *state,
                                      void *priv,
@@ -91,6 +167,21 @@ int n2_eblob_backend_command_handler(void *state,
 
 int dnet_read_json_header(int fd, uint64_t offset, uint64_t size, struct dnet_json_header *jhdr);
 
+struct blob_header_cache *blob_header_cache_create(void);
+void blob_header_cache_destroy(struct blob_header_cache *cache);
+/*
+ * Drops cached headers of @key, it should be called for every change of the record made
+ * not by blob_write_new(), which updates the cache itself.
+ */
+void blob_header_cache_forget(struct blob_header_cache *cache, const struct eblob_key *key);
+/* drops all cached headers, positions of records are changed by defragmentation */
+void blob_header_cache_clear(struct blob_header_cache *cache);
+
+/* starts threads running iterations of the backend, it should be destroyed before eblob is cleaned up */
+struct blob_iterator_pool *blob_iterator_pool_create(struct eblob_backend_config *c);
+/* cancels queued and running iterations and joins the threads */
+void blob_iterator_pool_destroy(struct blob_iterator_pool *pool);
+
 // Checks for broken headers signature(s): ELL-817
 // Time when the bug was fixed.
 #define DNET_SERVER_SEND_BUGFIX_TIMESTAMP 1483228800ULL
@@ -36,6 +36,8 @@ class session;
  * Synchronous is provided by wait/get methods and iterator API.
  *
  * Asynchronous is provided by connect methods.
+ *
+ * Clients built with C++20 coroutines can co_await it, see elliptics/coroutine.hpp.
  */
 template <typename T>
 class async_result
@@ -267,8 +269,6 @@ class async_result
 		void wait(uint32_t policy);
 
 		static void aggregator_final_handler(const std::shared_ptr<data_keeper> &keeper, const result_array_function &handler);
-		static void handler_process(async_result_handler<T> handler, const T &result);
-		static void handler_complete(async_result_handler<T> handler, const error_info &error);
 
 		friend class iterator;
 		template <typename K> friend class async_result_handler;
@@ -96,6 +96,9 @@
 
 #define DNET_DEFAULT_SEND_LIMIT 1000
 
+/* Default node-wide limit of bytes queued for sending */
+#define DNET_DEFAULT_OUTPUT_MEMORY_LIMIT (2ULL * 1024 * 1024 * 1024) // 2 GiB
+
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
 #ifndef dnet_offsetof
@@ -0,0 +1,114 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IOREMAP_ELLIPTICS_COROUTINE_HPP
+#define IOREMAP_ELLIPTICS_COROUTINE_HPP
+
+#include "async_result.hpp"
+
+/*
+ * Library itself is built as C++11, awaitables are available only for clients built with C++20 coroutines.
+ */
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+
+#include <atomic>
+#include <coroutine>
+#include <utility>
+
+namespace ioremap { namespace elliptics {
+
+/*!
+ * Awaitable for async_result, it is returned by co_await on async_result and its result is
+ * the list of received entries like async_result::get() returns.
+ *
+ * \code
+ * newapi::sync_read_result result = co_await sess.read_data(key, 0, 0);
+ * \endcode
+ *
+ * If session::throw_at_get flag is activated and there were errors the exception is thrown by co_await.
+ *
+ * \note Coroutine is resumed in the thread which completes the request (usually elliptics io thread),
+ * so it must not block there, or it has to move itself to another executor.
+ */
+template <typename Result>
+class async_result_awaiter
+{
+	public:
+		typedef typename std::decay<Result>::type result_type;
+		typedef typename result_type::entry_type entry_type;
+
+		explicit async_result_awaiter(Result &&result)
+		: m_result(std::forward<Result>(result)), m_scheduled(false)
+		{}
+
+		bool await_ready() const
+		{
+			return m_result.ready();
+		}
+
+		/*
+		 * Final handler can be called right inside connect() if request has been completed after
+		 * await_ready(), so whoever is second (await_suspend or final handler) decides
+		 * whether coroutine should be resumed or not suspended at all.
+		 */
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			m_handle = handle;
+			m_result.connect(typename result_type::result_function(), [this] (const error_info &) {
+				if (m_scheduled.exchange(true, std::memory_order_acq_rel))
+					m_handle.resume();
+			});
+			return !m_scheduled.exchange(true, std::memory_order_acq_rel);
+		}
+
+		std::vector<entry_type> await_resume()
+		{
+			return m_result.get();
+		}
+
+	private:
+		Result m_result;
+		std::atomic_bool m_scheduled;
+		std::coroutine_handle<> m_handle;
+};
+
+/*!
+ * Makes async_result and therefore all session and newapi::session methods awaitable.
+ * Temporary async_result is kept by the awaiter until coroutine is resumed.
+ */
+template <typename T>
+async_result_awaiter<async_result<T>> operator co_await(async_result<T> &&result)
+{
+	return async_result_awaiter<async_result<T>>(std::move(result));
+}
+
+/*!
+ * Awaits named async_result, it must outlive the co_await expression.
+ */
+template <typename T>
+async_result_awaiter<async_result<T> &> operator co_await(async_result<T> &result)
+{
+	return async_result_awaiter<async_result<T> &>(result);
+}
+
+}} /* namespace ioremap::elliptics */
+
+#endif // __has_include(<coroutine>)
+#endif // __cpp_impl_coroutine
+
+#endif // IOREMAP_ELLIPTICS_COROUTINE_HPP
@@ -157,6 +157,7 @@ int dnet_search_range(struct dnet_node *n, struct dnet_id *id,
  */
 #define DNET_IO_REQ_FLAGS_CLOSE			(1<<0)	/* close fd */
 #define DNET_IO_REQ_FLAGS_CACHE_FORGET		(1<<1)	/* try to remove read data from page cache using fadvice */
+#define DNET_IO_REQ_FLAGS_SHARED		(1<<2)	/* request is reference-counted, see dnet_io_req_alloc_shared() */
 
 int __attribute__((weak)) dnet_send_read_data(void *state, struct dnet_cmd *cmd, struct dnet_io_attr *io,
 		void *data, int fd, uint64_t offset, int on_exit);
@@ -398,7 +399,10 @@ struct dnet_config
 
 	int			send_limit;
 
-	int			reserved_for_future_use_2[4];
+	/* Node-wide limit of bytes queued for sending to all connections, 0 means unlimited */
+	uint64_t		output_memory_limit;
+
+	int			reserved_for_future_use_2[2];
 
 	/* Config file name for handystats library */
 	const char 	*handystats_config;
@@ -798,6 +802,16 @@ int dnet_digest_auth_transform_raw(const void *src, uint64_t size, const void *k
 int dnet_lookup_addr(struct dnet_session *s, const void *remote, int len, const struct dnet_id *id, int group_id,
 		struct dnet_addr *addr, int *backend);
 
+/*
+ * Resolves address and backend of every key from @ids (each key is looked up in its own group_id)
+ * against single snapshot of the route table, route lock is taken once for the whole batch.
+ * @errors[i] is set to 0 if i-th key is resolved into @addrs[i] and @backend_ids[i] (it can be NULL),
+ * or to -ENXIO if its group is unknown.
+ * Returns negative error if batch could not be processed at all.
+ */
+int dnet_lookup_addr_batch(struct dnet_session *s, const struct dnet_id *ids, size_t count,
+		struct dnet_addr *addrs, int *backend_ids, int *errors);
+
 struct dnet_id_param {
 	unsigned int		group_id;
 	uint64_t		param;
@@ -0,0 +1,73 @@
+#ifndef ELLIPTICS_NEW_DC_RECOVERY_HPP
+#define ELLIPTICS_NEW_DC_RECOVERY_HPP
+
+#include "elliptics/session.hpp"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ioremap { namespace elliptics { namespace newapi {
+
+// Parameters of dc recovery, they have the same meaning as the options of dnet_recovery
+struct dc_recovery_config {
+	std::vector<int> groups;
+	std::set<int> ro_groups;
+
+	// Directory with files prepared by dnet_recovery's fill_buckets(): bucket_<group> with keys which
+	// newest replica lives in <group> and rest_keys with keys which can't be recovered by server_send.
+	// Keys are in msgpack format of recovery's dump_key_data(), see iterator_result_merger::merge().
+	std::string tmp_dir;
+	// Groups of bucket files from the biggest to the smallest, empty list disables server_send
+	std::vector<int> bucket_order;
+
+	size_t batch_size = 1024;		// keys in one server_send and keys recovered simultaneously
+	uint64_t chunk_size = 1024 * 1024;	// keys bigger than this are read and written by chunks
+	uint64_t data_flow_rate = 10 * 1024 * 1024;	// bytes per second used for calculating of timeouts
+	int attempts = 1;
+	uint64_t chunk_write_timeout = 1000;	// ms, see session::server_send()
+	uint64_t chunk_commit_timeout = 1000;	// ms, see session::server_send()
+	dnet_time prepare_timeout{0, 0};	// timestamp used for removing of corrupted keys
+	trace_id_t trace_id = 0;
+	bool safe = false;			// do not remove corrupted keys
+	bool dry_run = false;
+};
+
+// Counters of dc recovery named as counters of dnet_recovery's stats, so python recovery can apply them as is
+struct dc_recovery_stats {
+	std::map<std::string, int64_t> main;			// ctx.stats
+	std::map<std::string, int64_t> recover;			// ctx.stats['recover']
+	std::map<std::string, int64_t> commands;		// ctx.stats['commands']
+	std::map<std::string, int64_t> commands_by_groups;	// ctx.stats['commands_by_groups']
+	uint64_t processed_keys = 0;
+	uint64_t recovers_in_progress = 0;
+};
+
+class dc_recovery_data;
+
+/*
+ * Native replacement of dnet_recovery's dc_recovery.recover(). At first keys of bucket files are recovered by
+ * server_send from the newest replica, keys which can't be server-sent are moved to rest_keys. Then each key of
+ * rest_keys is read from the newest available replica and written to missed and stale groups, up to batch_size
+ * keys are recovered simultaneously. Corrupted replicas are removed unless safe mode is on.
+ * Corrupted keys are appended to corrupted_keys file of tmp_dir the same way as by python recovery.
+ */
+class dc_recovery {
+public:
+	dc_recovery(const node &node, const dc_recovery_config &config);
+	~dc_recovery();
+
+	// Returns false if some key wasn't recovered, throws error if input files can't be read
+	bool recover();
+
+	dc_recovery_stats stats() const;
+
+private:
+	std::unique_ptr<dc_recovery_data> m_data;
+};
+
+}}} /* namespace ioremap::elliptics::newapi */
+
+#endif // ELLIPTICS_NEW_DC_RECOVERY_HPP
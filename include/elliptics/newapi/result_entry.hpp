@@ -3,6 +3,9 @@
 
 #include "elliptics/result_entry.hpp"
 
+#include <set>
+#include <string>
+
 namespace ioremap { namespace elliptics { namespace newapi {
 
 class callback_result_entry : public ioremap::elliptics::callback_result_entry {
@@ -52,6 +55,8 @@ public:
 
 	uint64_t iterated_keys() const;
 	uint64_t total_keys() const;
+	/* number of records skipped by iterator's filter before this one was sent */
+	uint64_t filtered_keys() const;
 
 	dnet_raw_id key() const;
 	dnet_record_info record_info() const;
@@ -88,6 +93,9 @@ public:
 	// Appends one result to container
 	void append(const iterator_result_entry &result);
 	void append_old(const ioremap::elliptics::iterator_result_entry &result);
+	// Appends chunk of sorted items sent by session::start_disk_iterator(), container stays sorted,
+	// so it should be filled only by replies of the single iterator
+	void append_sorted_chunk(const iterator_result_entry &result);
 	// Sorts container
 	void sort();
 	iterator_container_item operator [](size_t n) const;
@@ -102,6 +110,43 @@ public:
 	uint64_t m_write_position;
 };
 
+// Sorted container of iterator results of one backend merged by iterator_result_merger
+struct iterator_merge_source {
+	iterator_result_container container;
+	std::string host;
+	int port;
+	int family;
+	uint32_t backend_id;
+	int group_id;
+};
+
+// Counters of iterator_result_merger::merge()
+struct iterator_merge_stats {
+	uint64_t total_keys = 0;	// keys met in any source
+	uint64_t written_keys = 0;	// keys which need recovery
+	std::map<int, uint64_t> missing_keys;	// written keys which are absent in the group
+	std::map<int, uint64_t> stale_keys;	// written keys whose replica in the group isn't the newest
+};
+
+// K-way merge of sorted containers of replicas' backends, used by dc recovery instead of merging in python
+class iterator_result_merger
+{
+public:
+	void add_source(const iterator_merge_source &source);
+
+	// Merges sources by keys and writes keys which need recovery to @filename. Key is skipped if it is
+	// committed in all @groups with the same timestamp, size and user_flags, or none of its replicas
+	// has user_flags from non-empty @user_flags_set. Corrupted keys are always written.
+	// Keys are written in msgpack format of recovery's dump_key_data(): (id, (key_info, ...)),
+	// where key_info is ((host, port, family), group_id, (tsec, tnsec), size, user_flags,
+	// record_flags, data_offset, blob_id) and replicas go from the newest to the oldest.
+	iterator_merge_stats merge(const std::string &filename, const std::vector<int> &groups,
+	                           const std::set<uint64_t> &user_flags_set) const;
+
+private:
+	std::vector<iterator_merge_source> m_sources;
+};
+
 typedef lookup_result_entry write_result_entry;
 
 typedef async_result<lookup_result_entry> async_lookup_result;
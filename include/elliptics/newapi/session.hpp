@@ -6,6 +6,46 @@
 
 namespace ioremap { namespace elliptics { namespace newapi {
 
+/*
+ * Filter applied by the backend to every iterated record before the record is read and sent,
+ * record is sent only if all conditions are true. See start_iterator().
+ */
+struct iterator_filter {
+	/* (user_flags & user_flags_mask) == user_flags_value */
+	uint64_t user_flags_mask = 0;
+	uint64_t user_flags_value = 0;
+
+	/* (record_flags & record_flags_mask) == record_flags_value, see DNET_RECORD_FLAGS_* */
+	uint64_t record_flags_mask = 0;
+	uint64_t record_flags_value = 0;
+
+	/* min_data_size <= data_size <= max_data_size, 0 max_data_size means no upper bound */
+	uint64_t min_data_size = 0;
+	uint64_t max_data_size = 0;
+
+	/* if \a json_key isn't empty, top-level member \a json_key of record's json should be equal to
+	 * the value represented by json text \a json_value, e.g. "\"value\"" or "42"
+	 */
+	std::string json_key;
+	std::string json_value;
+};
+
+/*
+ * Record written by session::bulk_write(). Empty \a timestamp and \a json_timestamp are replaced
+ * the same way as by session::write(): by session's timestamps or by current time.
+ */
+struct bulk_write_record {
+	dnet_id key;
+
+	data_pointer json;
+	uint64_t json_capacity = 0; /* 0 means json.size() */
+	dnet_time json_timestamp{0, 0};
+
+	data_pointer data;
+	uint64_t data_capacity = 0; /* 0 means data.size() */
+	dnet_time timestamp{0, 0};
+};
+
 class session: public elliptics::session {
 public:
 	explicit session(const node &);
@@ -117,6 +157,35 @@ public:
 	                                     const std::vector<dnet_iterator_range> &key_ranges,
 	                                     const std::tuple<dnet_time, dnet_time> &time_range);
 
+	/* Start iterator which sends only records matching \a filter, DNET_IFLAGS_FILTER is added to \a flags.
+	 * Number of skipped records is reported by iterator_result_entry::filtered_keys(), the final reply
+	 * has no key, json and data and reports the number of records skipped by the whole iteration.
+	 */
+	async_iterator_result start_iterator(const address &addr, uint32_t backend_id, uint64_t flags,
+	                                     const std::vector<dnet_iterator_range> &key_ranges,
+	                                     const std::tuple<dnet_time, dnet_time> &time_range,
+	                                     const iterator_filter &filter);
+
+	/* Start iterator of DNET_ITYPE_DISK type: records' metadata is collected into iterator_result_container
+	 * on the server side and is sorted there. Container is sent back by large chunks, each reply carries
+	 * sorted iterator_container_item-s in iterator_result_entry::data() and number of items sent so far in
+	 * iterator_result_entry::iterated_keys(). Replies are appended to the client's container by
+	 * iterator_result_container::append_sorted_chunk(). DNET_IFLAGS_JSON and DNET_IFLAGS_DATA aren't supported.
+	 */
+	async_iterator_result start_disk_iterator(const address &addr, uint32_t backend_id, uint64_t flags,
+	                                          const std::vector<dnet_iterator_range> &key_ranges,
+	                                          const std::tuple<dnet_time, dnet_time> &time_range);
+
+	/* Pause, continue or cancel iterator \a iterator_id started by start_iterator() on \a addr and \a backend_id.
+	 * Iterator's id is reported by iterator_result_entry::id() of its replies.
+	 */
+	using elliptics::session::pause_iterator;
+	using elliptics::session::continue_iterator;
+	using elliptics::session::cancel_iterator;
+	async_iterator_result pause_iterator(const address &addr, uint32_t backend_id, uint64_t iterator_id);
+	async_iterator_result continue_iterator(const address &addr, uint32_t backend_id, uint64_t iterator_id);
+	async_iterator_result cancel_iterator(const address &addr, uint32_t backend_id, uint64_t iterator_id);
+
 	async_iterator_result server_send(const std::vector<dnet_raw_id> &keys, uint64_t flags, uint64_t chunk_size,
 	                                  const int src_group, const std::vector<int> &dst_groups);
 
@@ -185,6 +254,15 @@ public:
 
 	async_remove_result bulk_remove(const std::vector<std::pair<dnet_id, dnet_time>> &keys);
 
+	/*
+	 * Write \a records by sending exactly one DNET_CMD_BULK_WRITE_NEW request to a node instead of
+	 * a request per record. Each record is written like session::write() does it into group of its key,
+	 * the backend writes records of the request one by one and replies by the key as soon as the record
+	 * is written, or after files written by the whole batch are synced once if the backend is configured so.
+	 * Result contains an entry per record.
+	 */
+	async_write_result bulk_write(const std::vector<bulk_write_record> &records);
+
 };
 
 }}} /* namespace ioremap::elliptics::newapi */
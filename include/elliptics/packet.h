@@ -85,6 +85,7 @@ enum dnet_commands {
 	DNET_CMD_DEL_NEW,
 	DNET_CMD_BULK_READ_NEW,
 	DNET_CMD_BULK_REMOVE_NEW,
+	DNET_CMD_BULK_WRITE_NEW,
 
 	DNET_CMD_UNKNOWN,			/* This slot is allocated for statistics gathered for unknown commands */
 	__DNET_CMD_MAX,
@@ -113,6 +114,12 @@ enum dnet_commands {
 #define DNET_MONITOR_TOP		(1<<7)				/* statistics of top keys ordered by generated traffic */
 #define DNET_MONITOR_ALL		(-1)				/* all available statistics */
 
+/*
+ * Encodings of monitor statistics report, both are zlib-compressed on the wire
+ */
+#define DNET_MONITOR_FORMAT_JSON	0				/* json document */
+#define DNET_MONITOR_FORMAT_MSGPACK	1				/* msgpack document with the same layout as json */
+
 enum dnet_backend_command {
 	DNET_BACKEND_ENABLE = 0,
 	DNET_BACKEND_DISABLE,
@@ -896,14 +903,25 @@ enum dnet_ext_versions {
 /*! In-memory extension header */
 struct dnet_ext;
 
+/*!
+ * Codecs of record's data, zero means data is stored as is
+ */
+enum dnet_ext_compression {
+	DNET_EXT_COMPRESSION_NONE,
+	DNET_EXT_COMPRESSION_ZLIB,
+	DNET_EXT_COMPRESSION_LAST,
+};
+
 /*! On-disk extension list header */
 struct dnet_ext_list_hdr {
 	uint8_t			version;	/* Extension header version */
-	uint8_t			__pad1[3];	/* For future use (should be NULLed) */
+	uint8_t			compression;	/* Codec of record's data, see enum dnet_ext_compression */
+	uint8_t			__pad1[2];	/* For future use (should be NULLed) */
 	uint32_t		size;		/* Size of all extensions */
 	struct dnet_time	timestamp;	/* Time stamp of record */
 	uint64_t		flags;		/* Custom flags for this record */
-	uint64_t		__pad2[2];	/* For future use (should be NULLed) */
+	uint64_t		data_size;	/* Size of uncompressed data if compression is set */
+	uint64_t		__pad2[1];	/* For future use (should be NULLed) */
 } __attribute__ ((packed));
 
 struct dnet_json_header {
@@ -958,6 +976,18 @@ enum {
 
 #define DNET_IFLAGS_JSON		(1<<6)
 
+/*
+ * When set, records which don't match the request's filter over their metadata
+ * (user_flags, record flags, data size and json field) are skipped by the backend before they are read and sent
+ */
+#define DNET_IFLAGS_FILTER		(1<<7)
+
+/*
+ * When set, replies of many records are packed into a single packet, limits of the packet are set
+ * by the backend's config. Clients split packets into the same per-record replies.
+ */
+#define DNET_IFLAGS_BATCH		(1<<8)
+
 /* Sanity */
 #define DNET_IFLAGS_ALL			(DNET_IFLAGS_DATA | \
 					 DNET_IFLAGS_KEY_RANGE | \
@@ -965,7 +995,9 @@ enum {
 					 DNET_IFLAGS_NO_META | \
 					 DNET_IFLAGS_MOVE | \
 					 DNET_IFLAGS_OVERWRITE | \
-					 DNET_IFLAGS_JSON)
+					 DNET_IFLAGS_JSON | \
+					 DNET_IFLAGS_FILTER | \
+					 DNET_IFLAGS_BATCH)
 
 /*
  * Defines how iterator should behave
@@ -1117,7 +1149,7 @@ struct dnet_monitor_stat_request {
 	int			reserved_int; // reserved for packing
 	uint32_t	backends_number; // size of array of backends ids.
 	                                 // This array is located behind this structure in binary packet
-	uint32_t        reserved_uint32t;
+	uint32_t        format; // DNET_MONITOR_FORMAT_* encoding of the report
 	uint64_t	reserved[3];
 } __attribute__ ((packed));
 
@@ -1125,6 +1157,7 @@ static inline void dnet_convert_monitor_stat_request(struct dnet_monitor_stat_re
 {
 	r->categories = dnet_bswap64(r->categories);
 	r->backends_number = dnet_bswap32(r->backends_number);
+	r->format = dnet_bswap32(r->format);
 }
 
 
@@ -151,6 +151,21 @@ inline bool operator ==(const address &first, const dnet_addr &second)
 class node_data;
 class session_data;
 
+/*!
+ * Counters of client-side read cache, see node::set_read_cache().
+ */
+struct read_cache_stats {
+	uint64_t hits;		// served from the cache within ttl
+	uint64_t revalidations;	// served from the cache after lookup has confirmed timestamps
+	uint64_t misses;	// absent or stale, stale ones are counted in revalidations if confirmed
+	uint64_t evictions;	// dropped to fit into the size limit
+	uint64_t invalidations;	// dropped by writes and removes made through the node
+
+	uint64_t entries;
+	uint64_t size;		// bytes occupied by cached replies
+	uint64_t max_size;
+};
+
 class node {
 public:
 	explicit node(std::unique_ptr<dnet_logger> logger);
@@ -174,6 +189,19 @@ public:
 	std::unique_ptr<dnet_logger> get_logger() const;
 	dnet_node *get_native() const;
 
+	/*!
+	 * Enables client-side cache of newapi::session read_json(), read_data() and read() replies
+	 * shared by all sessions of the node. Cache keeps up to \a max_size bytes with SLRU eviction.
+	 * Cached reply is returned without network round trip for \a ttl_ms milliseconds, after that
+	 * it is revalidated by lookup and returned only if json and data timestamps have not changed.
+	 * Writes and removes made through the node drop cached replies of their keys.
+	 *
+	 * Cache should be enabled before sessions are used, further calls only change its limits,
+	 * zero \a max_size disables it.
+	 */
+	void set_read_cache(uint64_t max_size, uint64_t ttl_ms);
+	read_cache_stats get_read_cache_stats() const;
+
 protected:
 	std::shared_ptr<node_data> m_data;
 
@@ -432,6 +460,13 @@ public:
 	 * Groups are generated automatically by session::mix_states().
 	 */
 	async_read_result read_data(const key &id, uint64_t offset, uint64_t size);
+	/*!
+	 * \overload read_data(const key &id, uint64_t offset, uint64_t size)
+	 * Reads data by chunks of \a chunk_size keeping up to \a window chunks in flight.
+	 * The first chunk chooses the group to read from and tells the size of the object if \a size is 0,
+	 * failed chunks are requested again one by one. Result is single entry with the whole data.
+	 */
+	async_read_result read_data(const key &id, uint64_t offset, uint64_t size, uint64_t chunk_size, size_t window);
 
 	/*!
 	 * Filters the list \a groups and leaves only ones with the latest
@@ -484,6 +519,16 @@ public:
 	 */
 	async_write_result
 	write_data(const key &id, const data_pointer &file, uint64_t remote_offset, uint64_t chunk_size);
+	/*!
+	 * \overload write_data(const key &id, const data_pointer &file, uint64_t remote_offset, uint64_t chunk_size)
+	 * Keeps up to \a window write_plain() chunks in flight after write_prepare() instead of waiting
+	 * for every chunk before sending the next one, write_commit() is sent when all chunks are acknowledged.
+	 * Chunk which failed in some groups is resent only to them, groups which could not write
+	 * a chunk are excluded from the rest of upload.
+	 */
+	async_write_result
+	write_data(const key &id, const data_pointer &file, uint64_t remote_offset, uint64_t chunk_size,
+	           size_t window);
 
 	/*!
 	 * Reads data by \a id and passes it through \a converter. If converter returns the same data
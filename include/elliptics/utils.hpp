@@ -251,6 +251,45 @@ class data_pointer_base
 			return from_raw(const_cast<char*>(str.c_str()), str.size());
 		}
 
+		/*
+		 * Gives up ownership of the buffer made by allocate() and returns its data,
+		 * so the buffer can be passed through C code. It has to be taken back by adopt() to be freed.
+		 */
+		typename fix_const<void>::type *release()
+		{
+			if (!m_counter || m_index != 0)
+				throw std::logic_error("data_pointer: only whole allocated buffer can be released");
+
+			typename fix_const<void>::type *data = m_data;
+			m_counter = NULL;
+			m_data = NULL;
+			m_size = 0;
+			return data;
+		}
+
+		/*
+		 * Takes back ownership of the buffer given up by release().
+		 */
+		static data_pointer_base adopt(typename fix_const<void>::type *data, size_t size)
+		{
+			data_pointer_base tmp;
+			tmp.m_counter = reinterpret_cast<atomic_type *>(
+				const_cast<char *>(reinterpret_cast<const char *>(data)) - sizeof(atomic_type));
+			tmp.m_data = data;
+			tmp.m_size = size;
+			return tmp;
+		}
+
+		/*
+		 * Makes one more reference to the buffer given up by release(), its current owner keeps its own one.
+		 */
+		static data_pointer_base share(typename fix_const<void>::type *data, size_t size)
+		{
+			data_pointer_base tmp = adopt(data, size);
+			++(*tmp.m_counter);
+			return tmp;
+		}
+
 		template <typename T>
 		data_pointer_base skip() const
 		{
@@ -20,11 +20,19 @@
 #include "access_context.h"
 
 #include "elliptics/interface.h"
+#include "elliptics.h"
 #include "logger.hpp"
 
 
 dnet_access_context::dnet_access_context(dnet_node *node)
-: node_(node) {}
+: node_(node)
+, binary_(node ? node->binary_access_log : nullptr) {
+	if (binary_) {
+		memset(&record_, 0, sizeof(record_));
+		record_.access = DNET_ACCESS_UNKNOWN;
+		dnet_current_time(&record_.start);
+	}
+}
 
 dnet_access_context::~dnet_access_context() {
 	print();
@@ -32,19 +40,119 @@ dnet_access_context::~dnet_access_context() {
 
 
 void dnet_access_context::add(blackhole::attribute_t attribute) {
+	if (binary_)
+		return;
+
 	std::lock_guard<std::mutex> guard(mutex_);
 	attributes_.emplace_back(std::move(attribute));
 }
 void dnet_access_context::add(std::initializer_list<blackhole::attribute_t> attributes) {
+	if (binary_)
+		return;
+
 	std::lock_guard<std::mutex> guard(mutex_);
 	attributes_.insert(attributes_.end(), attributes.begin(), attributes.end());
 }
 
+void dnet_access_context::add_request(dnet_net_state *st, dnet_io_req *r) {
+	const dnet_cmd *cmd = dnet_io_req_get_cmd(r);
+
+	if (!binary_) {
+		add({{"cmd", std::string(dnet_cmd_string(cmd->cmd))},
+		     {"trans", cmd->trans},
+		     {"st", std::string(dnet_state_dump_addr(st))},
+		     {"trace_id", ioremap::elliptics::to_hex_string(cmd->trace_id)},
+		     {"request_size", r->hsize + r->dsize + r->fsize},
+		     {"receive_time", r->recv_time},
+		     {"receive_queue_time", r->queue_time},
+		    });
+		return;
+	}
+
+	record_.id = cmd->id;
+	record_.st = st->addr;
+	record_.cmd = cmd->cmd;
+	record_.trans = cmd->trans;
+	record_.trace_id = cmd->trace_id;
+	record_.cflags = cmd->flags;
+	record_.backend_id = cmd->backend_id;
+	record_.request_size = r->hsize + r->dsize + r->fsize;
+	record_.receive_time = r->recv_time;
+	record_.receive_queue_time = r->queue_time;
+}
+
+void dnet_access_context::add_send_stats(uint64_t send_time, uint64_t send_queue_time, uint64_t response_size) {
+	if (!binary_) {
+		add({{"send_time", send_time},
+		     {"send_queue_time", send_queue_time},
+		     {"response_size", response_size},
+		    });
+		return;
+	}
+
+	send_time_ += send_time;
+	send_queue_time_ += send_queue_time;
+	response_size_ += response_size;
+}
+
+void dnet_access_context::add_int(const char *name, int64_t value) {
+	if (!binary_) {
+		add({name, value});
+		return;
+	}
+
+	if (!strcmp(name, "status"))
+		record_.status = value;
+	else if (!strcmp(name, "backend_id"))
+		record_.backend_id = value;
+}
+
+void dnet_access_context::add_uint(const char *name, uint64_t value) {
+	if (!binary_) {
+		add({name, value});
+		return;
+	}
+
+	if (!strcmp(name, "trans"))
+		record_.trans = value;
+	else if (!strcmp(name, "trace_id"))
+		record_.trace_id = value;
+	else if (!strcmp(name, "request_size"))
+		record_.request_size = value;
+}
+
+void dnet_access_context::add_string(const char *name, const char *value) {
+	if (!binary_) {
+		add({name, std::string(value)});
+		return;
+	}
+
+	if (!strcmp(name, "access")) {
+		if (!strcmp(value, "server"))
+			record_.access = DNET_ACCESS_SERVER;
+		else if (!strcmp(value, "server/control"))
+			record_.access = DNET_ACCESS_SERVER_CONTROL;
+		else if (!strcmp(value, "server/forward"))
+			record_.access = DNET_ACCESS_SERVER_FORWARD;
+		else if (!strcmp(value, "client"))
+			record_.access = DNET_ACCESS_CLIENT;
+	}
+}
+
 void dnet_access_context::increment_ref() {
 	++ref_counter_;
 }
 
 void dnet_access_context::print() {
+	if (binary_) {
+		record_.send_time = send_time_;
+		record_.send_queue_time = send_queue_time_;
+		record_.response_size = response_size_;
+		record_.total_time = timer_.get_us();
+		binary_->write(record_);
+		return;
+	}
+
 	add({"total_time", timer_.get_us()});
 	dnet_log_access(node_, blackhole::attribute_list{attributes_.begin(), attributes_.end()});
 }
@@ -81,26 +189,39 @@ void dnet_access_context_add_int(struct dnet_access_context *context, const char
 	if (!context)
 		return;
 
-	context->add({name, value});
+	context->add_int(name, value);
 }
 
 void dnet_access_context_add_uint(struct dnet_access_context *context, const char *name, uint64_t value) {
 	if (!context)
 		return;
 
-	context->add({name, value});
+	context->add_uint(name, value);
 }
 
 void dnet_access_context_add_string(struct dnet_access_context *context, const char *name, const char *value) {
 	if (!context)
 		return;
 
-	context->add({name, std::string(value)});
+	context->add_string(name, value);
 }
 
 void dnet_access_context_add_trace_id(struct dnet_access_context *context, uint64_t value) {
 	if (!context)
 		return;
 
+	if (context->binary()) {
+		context->add_uint("trace_id", value);
+		return;
+	}
+
 	context->add({"trace_id", ioremap::elliptics::to_hex_string(value)});
 }
+
+void dnet_access_context_add_request(struct dnet_access_context *context, struct dnet_net_state *st,
+                                     struct dnet_io_req *r) {
+	if (!context)
+		return;
+
+	context->add_request(st, r);
+}
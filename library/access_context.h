@@ -31,7 +31,11 @@
 
 #include "bindings/cpp/timer.hpp"
 
+#include "access_log.hpp"
+
 struct dnet_node;
+struct dnet_net_state;
+struct dnet_io_req;
 
 struct dnet_access_context {
 public:
@@ -39,10 +43,23 @@ public:
 	~dnet_access_context();
 
 	// attach @attribute to the final log
+	// binary access log has fixed layout, so arbitrary attributes are ignored by it
 	void add(blackhole::attribute_t attribute);
 	// attach batch of @attributes gto the final log
 	void add(std::initializer_list<blackhole::attribute_t> attributes);
 
+	// attach common attributes of request @r received from @st
+	void add_request(dnet_net_state *st, dnet_io_req *r);
+	// attach statistics of sent reply, could be called for each reply
+	void add_send_stats(uint64_t send_time, uint64_t send_queue_time, uint64_t response_size);
+	// attach attribute @name with integral @value, binary log keeps it if it has such field
+	void add_int(const char *name, int64_t value);
+	void add_uint(const char *name, uint64_t value);
+	void add_string(const char *name, const char *value);
+
+	// whether the request is written into binary access log
+	bool binary() const { return binary_ != nullptr; }
+
 	void increment_ref();
 	void decrement_ref();
 private:
@@ -58,6 +75,15 @@ private:
 	// Timer to measure total time spent on the request.
 	ioremap::elliptics::util::steady_timer timer_;
 
+	// binary log which the request is written to instead of text access log if it is configured
+	dnet_binary_access_log *binary_;
+	// record of binary log, its fields are filled without locks: each of them is set by a single stage
+	// of request processing and stages are ordered by queues between them
+	dnet_access_record record_;
+	std::atomic<uint64_t> send_time_{0};
+	std::atomic<uint64_t> send_queue_time_{0};
+	std::atomic<uint64_t> response_size_{0};
+
 	// mutex to synchronize adding attributes from various attributes
 	std::mutex mutex_{};
 	blackhole::attributes_t attributes_{};
@@ -66,6 +92,7 @@ private:
 extern "C" {
 #else
 struct dnet_node;
+struct dnet_net_state;
 struct dnet_io_req;
 struct dnet_access_context;
 #endif
@@ -84,6 +111,9 @@ void dnet_access_context_add_uint(struct dnet_access_context *context, const cha
 void dnet_access_context_add_string(struct dnet_access_context *context, const char *name, const char *value);
 // Add trace_id attribute with @value
 void dnet_access_context_add_trace_id(struct dnet_access_context *context, uint64_t value);
+// Add common attributes of request @r received from @st: cmd, trans, st, trace_id, sizes and times
+void dnet_access_context_add_request(struct dnet_access_context *context, struct dnet_net_state *st,
+                                     struct dnet_io_req *r);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,231 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "access_log.hpp"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <istream>
+#include <stdexcept>
+#include <unordered_map>
+
+static std::atomic<uint64_t> access_log_ids(0);
+
+dnet_binary_access_log::dnet_binary_access_log(const ioremap::elliptics::binary_access_log_config &config)
+: config_(config)
+, id_(++access_log_ids)
+, fd_(-1)
+, need_reopen_(false)
+, need_exit_(false)
+, orphan_dropped_(0) {
+	open();
+	thread_ = std::thread(&dnet_binary_access_log::drain_thread, this);
+}
+
+dnet_binary_access_log::~dnet_binary_access_log() {
+	{
+		std::lock_guard<std::mutex> guard(wait_mutex_);
+		need_exit_ = true;
+	}
+	wait_.notify_one();
+	thread_.join();
+
+	/* write everything put into rings before the log thread has been stopped */
+	drain();
+
+	if (fd_ >= 0)
+		::close(fd_);
+}
+
+dnet_binary_access_log::ring &dnet_binary_access_log::thread_ring() {
+	/*
+	 * Thread can write into several logs (e.g. several nodes within one process),
+	 * so rings are kept per log. Ring is shared with the log and outlives the thread
+	 * until all its records are drained.
+	 */
+	struct thread_rings {
+		/* tell logs that the thread has exited, so they can forget its rings once they are drained */
+		~thread_rings() {
+			for (const auto &it : rings) {
+				it.second->orphan();
+			}
+		}
+
+		std::unordered_map<uint64_t, std::shared_ptr<ring>> rings;
+	};
+
+	static thread_local thread_rings owned;
+	static thread_local uint64_t last_id = 0;
+	static thread_local ring *last_ring = nullptr;
+
+	if (last_id == id_)
+		return *last_ring;
+
+	auto &place = owned.rings[id_];
+	if (!place) {
+		place = std::make_shared<ring>(config_.ring_size);
+
+		std::lock_guard<std::mutex> guard(rings_mutex_);
+		rings_.push_back(place);
+	}
+
+	last_id = id_;
+	last_ring = place.get();
+	return *last_ring;
+}
+
+void dnet_binary_access_log::write(const dnet_access_record &record) {
+	auto &ring = thread_ring();
+
+	const bool slow = config_.slow_threshold_ms && record.total_time >= config_.slow_threshold_ms * 1000;
+	const bool sampled = config_.sample_every && (ring.next_counter() % config_.sample_every) == 0;
+	if (!slow && !sampled)
+		return;
+
+	ring.push(record);
+}
+
+void dnet_binary_access_log::reopen() {
+	need_reopen_ = true;
+	wait_.notify_one();
+}
+
+uint64_t dnet_binary_access_log::dropped() const {
+	uint64_t result = orphan_dropped_;
+	std::lock_guard<std::mutex> guard(rings_mutex_);
+	for (const auto &ring : rings_) {
+		result += ring->dropped();
+	}
+	return result;
+}
+
+void dnet_binary_access_log::open() {
+	int fd = ::open(config_.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		const int err = errno;
+		throw std::runtime_error("failed to open binary access log: " + config_.path + ": " + strerror(err));
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size == 0) {
+		dnet_access_log_header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, DNET_ACCESS_LOG_MAGIC, sizeof(header.magic));
+		header.version = DNET_ACCESS_LOG_VERSION;
+		header.record_size = sizeof(dnet_access_record);
+		if (::write(fd, &header, sizeof(header)) != sizeof(header)) {
+			const int err = errno;
+			::close(fd);
+			throw std::runtime_error("failed to write binary access log header: " + config_.path + ": " +
+			                         strerror(err));
+		}
+	}
+
+	if (fd_ >= 0)
+		::close(fd_);
+	fd_ = fd;
+}
+
+size_t dnet_binary_access_log::drain() {
+	std::vector<std::shared_ptr<ring>> rings;
+	{
+		std::lock_guard<std::mutex> guard(rings_mutex_);
+		rings = rings_;
+	}
+
+	std::vector<dnet_access_record> records;
+	for (const auto &ring : rings) {
+		ring->pop(records);
+	}
+
+	{
+		/* forget rings of exited threads, nobody will write into them anymore */
+		std::lock_guard<std::mutex> guard(rings_mutex_);
+		for (auto it = rings_.begin(); it != rings_.end();) {
+			if ((*it)->orphaned() && (*it)->empty()) {
+				orphan_dropped_ += (*it)->dropped();
+				it = rings_.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	const char *data = reinterpret_cast<const char *>(records.data());
+	size_t size = records.size() * sizeof(dnet_access_record);
+	while (size && fd_ >= 0) {
+		const ssize_t written = ::write(fd_, data, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		data += written;
+		size -= written;
+	}
+
+	return records.size();
+}
+
+void dnet_binary_access_log::drain_thread() {
+	while (!need_exit_) {
+		{
+			std::unique_lock<std::mutex> guard(wait_mutex_);
+			wait_.wait_for(guard, std::chrono::milliseconds(config_.flush_interval_ms), [this] () -> bool {
+				return need_exit_ || need_reopen_;
+			});
+		}
+
+		if (need_reopen_.exchange(false)) {
+			/* flush records of the old file before it is closed */
+			drain();
+			try {
+				open();
+			} catch (...) {
+				/* keep writing into the previous file */
+			}
+		}
+
+		drain();
+	}
+}
+
+void dnet_access_log_decode(std::istream &in, const std::function<void (const dnet_access_record &)> &handler) {
+	dnet_access_log_header header;
+	if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+		throw std::runtime_error("failed to read header");
+
+	if (memcmp(header.magic, DNET_ACCESS_LOG_MAGIC, sizeof(header.magic)) != 0)
+		throw std::runtime_error("is not a binary access log");
+
+	if (header.version != DNET_ACCESS_LOG_VERSION || header.record_size != sizeof(dnet_access_record)) {
+		throw std::runtime_error("unsupported version: " + std::to_string(header.version) +
+		                         ", record size: " + std::to_string(header.record_size));
+	}
+
+	dnet_access_record record;
+	while (in.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+		handler(record);
+	}
+
+	if (in.gcount() != 0)
+		throw std::runtime_error("truncated record at the end of file");
+}
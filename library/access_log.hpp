@@ -0,0 +1,209 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "elliptics/packet.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Binary access log file starts with dnet_access_log_header followed by fixed-size dnet_access_record's.
+ * All fields are stored in host byte order, dnet_access_log_decode turns the file into text access log.
+ */
+#define DNET_ACCESS_LOG_MAGIC		"DNETACL\0"
+#define DNET_ACCESS_LOG_VERSION		1
+
+struct dnet_access_log_header {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		record_size;
+} __attribute__ ((packed));
+
+enum dnet_access_type {
+	DNET_ACCESS_UNKNOWN = 0,
+	DNET_ACCESS_SERVER,
+	DNET_ACCESS_SERVER_CONTROL,
+	DNET_ACCESS_SERVER_FORWARD,
+	DNET_ACCESS_CLIENT,
+};
+
+struct dnet_access_record {
+	struct dnet_time	start;			/* wall-clock time when request was received */
+	struct dnet_id		id;
+	struct dnet_addr	st;			/* address of the peer */
+	uint64_t		trans;
+	uint64_t		trace_id;
+	uint64_t		cflags;
+	uint64_t		request_size;
+	uint64_t		response_size;
+	uint64_t		receive_time;		/* all times are in usecs */
+	uint64_t		receive_queue_time;
+	uint64_t		send_time;
+	uint64_t		send_queue_time;
+	uint64_t		total_time;
+	int32_t			cmd;
+	int32_t			status;
+	int32_t			backend_id;
+	uint32_t		access;			/* enum dnet_access_type */
+} __attribute__ ((packed));
+
+namespace ioremap { namespace elliptics {
+
+struct binary_access_log_config {
+	std::string	path;
+	/* every N-th request is written, 0 disables sampling by count */
+	uint64_t	sample_every;
+	/* requests slower than this are always written, 0 disables it */
+	uint64_t	slow_threshold_ms;
+	/* number of records buffered per thread before they are dropped */
+	size_t		ring_size;
+	uint64_t	flush_interval_ms;
+};
+
+}} /* namespace ioremap::elliptics */
+
+/*
+ * Reads binary access log from @in and calls @handler for each its record.
+ * Throws std::runtime_error if @in isn't binary access log of the supported version or it is truncated.
+ */
+void dnet_access_log_decode(std::istream &in, const std::function<void (const dnet_access_record &)> &handler);
+
+/*
+ * Binary access log: completed requests are put into per-thread lock-free rings by their threads
+ * and are drained into the file by the background thread.
+ */
+struct dnet_binary_access_log {
+public:
+	explicit dnet_binary_access_log(const ioremap::elliptics::binary_access_log_config &config);
+	~dnet_binary_access_log();
+
+	// write @record if it passes sampling, never blocks
+	void write(const dnet_access_record &record);
+
+	// reopen log file, used for log rotation
+	void reopen();
+
+	uint64_t dropped() const;
+
+	/*
+	 * Single-producer single-consumer ring of records.
+	 * It is filled only by the thread which owns it and is drained only by the log thread.
+	 */
+	class ring {
+	public:
+		explicit ring(size_t size)
+		: records_(round_up(size))
+		, mask_(records_.size() - 1)
+		, head_(0)
+		, tail_(0)
+		, dropped_(0)
+		, orphaned_(false)
+		, counter_(0) {}
+
+		bool push(const dnet_access_record &record) {
+			const uint64_t head = head_.load(std::memory_order_relaxed);
+			if (head - tail_.load(std::memory_order_acquire) >= records_.size()) {
+				dropped_.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			records_[head & mask_] = record;
+			head_.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// append all available records to @out, returns number of them
+		size_t pop(std::vector<dnet_access_record> &out) {
+			const uint64_t tail = tail_.load(std::memory_order_relaxed);
+			const uint64_t head = head_.load(std::memory_order_acquire);
+			for (uint64_t i = tail; i != head; ++i) {
+				out.push_back(records_[i & mask_]);
+			}
+			tail_.store(head, std::memory_order_release);
+			return head - tail;
+		}
+
+		bool empty() const {
+			return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed);
+		}
+
+		uint64_t dropped() const {
+			return dropped_.load(std::memory_order_relaxed);
+		}
+
+		// sampling counter, is accessed only by the owner thread
+		uint64_t next_counter() {
+			return counter_++;
+		}
+
+		// called by the owner thread when it exits, nobody will push into the ring after that
+		void orphan() {
+			orphaned_.store(true, std::memory_order_release);
+		}
+
+		bool orphaned() const {
+			return orphaned_.load(std::memory_order_acquire);
+		}
+
+	private:
+		static size_t round_up(size_t size) {
+			size_t result = 1;
+			while (result < size)
+				result <<= 1;
+			return result;
+		}
+
+		std::vector<dnet_access_record> records_;
+		const uint64_t mask_;
+		std::atomic<uint64_t> head_;
+		std::atomic<uint64_t> tail_;
+		std::atomic<uint64_t> dropped_;
+		std::atomic_bool orphaned_;
+		uint64_t counter_;
+	};
+
+private:
+	ring &thread_ring();
+	void drain_thread();
+	size_t drain();
+	void open();
+
+	const ioremap::elliptics::binary_access_log_config config_;
+	// unique id of the log, used as a key of thread-local rings, since address could be reused
+	const uint64_t id_;
+
+	int fd_;
+	std::atomic_bool need_reopen_;
+	std::atomic_bool need_exit_;
+
+	mutable std::mutex rings_mutex_;
+	std::vector<std::shared_ptr<ring>> rings_;
+	std::atomic<uint64_t> orphan_dropped_;
+
+	std::mutex wait_mutex_;
+	std::condition_variable wait_;
+	std::thread thread_;
+};
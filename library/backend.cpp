@@ -1039,6 +1039,190 @@ int dnet_cmd_bulk_remove_new(struct dnet_net_state *st, struct dnet_cmd *cmd,
 	return 0;
 }
 
+class bulk_write_handler : public std::enable_shared_from_this<bulk_write_handler> {
+public:
+	bulk_write_handler(struct dnet_net_state *st, const struct dnet_cmd *cmd)
+	: session_(st->n)
+	, node_(st->n)
+	, state_(dnet_state_get(st))
+	, orig_cmd_(*cmd)
+	, total_(0) {
+		using namespace ioremap::elliptics;
+		session_.set_exceptions_policy(session::no_exceptions);
+		session_.set_filter(filters::all_with_ack);
+		session_.set_trace_id(cmd->trace_id);
+		session_.set_trace_bit(!!(cmd->flags & DNET_FLAGS_TRACE_BIT));
+	}
+
+	/* @payload contains json and data of all records of @request, they are forwarded to backends as is */
+	void start(const ioremap::elliptics::dnet_bulk_write_request &request,
+	           const ioremap::elliptics::data_pointer &payload) {
+		using namespace ioremap::elliptics;
+		using namespace ioremap::elliptics::newapi;
+
+		total_ = request.keys.size();
+
+		dnet_time current_time;
+		dnet_current_time(&current_time);
+		if (request.deadline.tsec <= current_time.tsec) {
+			DNET_LOG_ERROR(node_, "{}: local: expired, skip sending keys to local backends: deadline: {}",
+			               dnet_cmd_string(DNET_CMD_BULK_WRITE_NEW), dnet_print_time(&request.deadline));
+			for (const auto &id : request.keys)
+				send_fail_reply(id, -1, -ETIMEDOUT);
+			return;
+		}
+		session_.set_timeout(request.deadline.tsec - current_time.tsec);
+
+		size_t offset = 0;
+		for (size_t i = 0; i < total_; ++i) {
+			const auto &write_request = request.requests[i];
+			const auto json = payload.slice(offset, write_request.json_size);
+			const auto data = payload.slice(offset + write_request.json_size, write_request.data_size);
+			offset += write_request.json_size + write_request.data_size;
+
+			auto backend_id = dnet_state_search_backend(node_, &request.keys[i]);
+			if (backend_id < 0) {
+				send_fail_reply(request.keys[i], backend_id, -ENXIO);
+				continue;
+			}
+			backend_entries_[backend_id].emplace_back(
+				bulk_write_entry{request.keys[i], write_request, json, data});
+		}
+
+		num_backend_responses_.reserve(backend_entries_.size());
+		for (const auto &pair : backend_entries_) {
+			auto &backend_id = pair.first;
+			num_backend_responses_.emplace(backend_id, 0);
+		}
+
+		address addr(node_->addrs[0]);
+		for (const auto &pair : backend_entries_) {
+			auto &backend_id = pair.first;
+			auto &entries = pair.second;
+
+			session_.set_direct_id(addr, backend_id);
+			auto async = send_bulk_write(session_, entries);
+			async.connect(
+				std::bind(&bulk_write_handler::process, shared_from_this(), backend_id,
+					std::placeholders::_1),
+				std::bind(&bulk_write_handler::complete, shared_from_this(), backend_id,
+					std::placeholders::_1)
+			);
+		}
+	}
+
+private:
+	void process(uint32_t backend_id, const ioremap::elliptics::callback_result_entry &entry) {
+		const auto entry_cmd = entry.command();
+		if (entry_cmd->status == 0) {
+			dnet_cmd cmd(orig_cmd_);
+			cmd.id = entry_cmd->id;
+			cmd.backend_id = backend_id;
+			send_reply(cmd, entry.data());
+		} else {
+			send_fail_reply(entry_cmd->id, backend_id, entry_cmd->status);
+		}
+		++num_backend_responses_[backend_id];
+
+		DNET_LOG_NOTICE(node_, "{}: {}: local: process: status: {}", dnet_dump_id(&entry_cmd->id),
+		                dnet_cmd_string(DNET_CMD_BULK_WRITE_NEW), entry_cmd->status);
+	}
+
+	void complete(uint32_t backend_id, const ioremap::elliptics::error_info &error) {
+		/* send_bulk_write() fabricates results for keys which weren't processed by backend,
+		 * so this is only a guard against lost replies.
+		 */
+		const auto &entries = backend_entries_[backend_id];
+		for (size_t i = num_backend_responses_[backend_id]; i < entries.size(); ++i) {
+			send_fail_reply(entries[i].key, backend_id, error ? error.code() : -ETIMEDOUT);
+		}
+		DNET_LOG_NOTICE(node_, "{}: local: complete for backend_id {}: status: {}",
+		                dnet_cmd_string(DNET_CMD_BULK_WRITE_NEW), backend_id, error.code());
+	}
+
+	void send_fail_reply(const dnet_id &id, uint32_t backend_id, int err) {
+		dnet_cmd cmd(orig_cmd_);
+		cmd.id = id;
+		cmd.status = err;
+		cmd.backend_id = backend_id;
+
+		send_reply(cmd, {});
+	}
+
+	void send_reply(struct dnet_cmd &cmd, const ioremap::elliptics::data_pointer &data) {
+		std::lock_guard<std::mutex> guard(mutex_);
+		const int more = --total_ ? 1 : 0;
+		dnet_send_reply(state_.get(), &cmd, data.data(), data.size(), more, /*context*/ nullptr);
+	}
+
+private:
+	ioremap::elliptics::newapi::session session_;
+	struct dnet_node *node_;
+	ioremap::elliptics::net_state_ptr state_;
+	const struct dnet_cmd orig_cmd_;
+	// backend_id -> [list of records]
+	std::unordered_map<uint32_t, std::vector<ioremap::elliptics::newapi::bulk_write_entry>> backend_entries_;
+	std::unordered_map<uint32_t, size_t> num_backend_responses_; // backend_id -> num_responses
+	size_t total_;
+	std::mutex mutex_;
+};
+
+int dnet_cmd_bulk_write_new(struct dnet_net_state *st, struct dnet_cmd *cmd,
+                            void *data, dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+	if (cmd->backend_id >= 0) {
+		return -ENOTSUP;
+	}
+
+	if (!st || !st->n || !st->n->addrs || !data) {
+		return -EINVAL;
+	}
+
+	const auto packet = data_pointer::from_raw(data, cmd->size);
+	size_t offset = 0;
+	dnet_bulk_write_request request;
+	deserialize(packet, request, offset);
+	if (!request.is_valid()) {
+		return -EINVAL;
+	}
+
+	/* handler replies per key, so request without keys would get no reply, it is acked with the error */
+	if (request.keys.empty()) {
+		DNET_LOG_ERROR(st->n, "{}: invalid packet: no keys", dnet_cmd_string(cmd->cmd));
+		return -EINVAL;
+	}
+
+	/* every size is checked against the rest of the payload, so their sum can't overflow */
+	const auto payload = packet.skip(offset);
+	uint64_t payload_size = 0;
+	for (const auto &write_request : request.requests) {
+		const uint64_t rest = payload.size() - payload_size;
+		if (write_request.json_size > rest || write_request.data_size > rest - write_request.json_size) {
+			DNET_LOG_ERROR(st->n, "{}: invalid packet: records exceed payload size: {}",
+			               dnet_cmd_string(cmd->cmd), payload.size());
+			return -EINVAL;
+		}
+		payload_size += write_request.json_size + write_request.data_size;
+	}
+	if (payload_size != payload.size()) {
+		DNET_LOG_ERROR(st->n, "{}: invalid packet: records size: {}, payload size: {}",
+		               dnet_cmd_string(cmd->cmd), payload_size, payload.size());
+		return -EINVAL;
+	}
+
+	if (context) {
+		context->add({{"keys", request.keys.size()},
+		              {"size", payload_size},
+		             });
+	}
+
+	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+	auto handler = std::make_shared<bulk_write_handler>(st, cmd);
+	handler->start(request, payload);
+
+	return 0;
+}
+
 
 int dnet_backend::change_state(dnet_backend_state state) {
 	auto set_activating = [this]() {
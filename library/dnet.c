@@ -270,12 +270,14 @@ int dnet_send_reply(void *state,
 static void dnet_queue_wait_threshold(struct dnet_net_state *st)
 {
 	/* If send succeeded then we should increase queue size */
-	while ((atomic_read(&st->send_queue_size) > DNET_SEND_WATERMARK_HIGH) && !st->__need_exit) {
+	while (((atomic_read(&st->send_queue_size) > DNET_SEND_WATERMARK_HIGH) ||
+	        (atomic_read(&st->send_queue_bytes) > DNET_SEND_WATERMARK_HIGH_BYTES)) && !st->__need_exit) {
 		/* If high watermark is reached we should sleep */
 		dnet_log(st->n, DNET_LOG_NOTICE,
-				"State high_watermark reached by iterator: %s: %ld, sleeping",
+				"State high_watermark reached by iterator: %s: %ld, bytes: %ld, sleeping",
 				dnet_addr_string(&st->addr),
-				atomic_read(&st->send_queue_size));
+				atomic_read(&st->send_queue_size),
+				atomic_read(&st->send_queue_bytes));
 
 		pthread_mutex_lock(&st->send_lock);
 		// after successful dnet_send_reply the state can be removed from another thread
@@ -288,10 +290,13 @@ static void dnet_queue_wait_threshold(struct dnet_net_state *st)
 				dnet_addr_string(&st->addr),
 				atomic_read(&st->send_queue_size));
 	}
+
+	dnet_output_budget_wait(st);
 }
 
 /*
- * Queue replies to send queue wrt high and low watermark limits.
+ * Queue replies to send queue wrt high and low watermark limits of the state
+ * (in requests and in bytes) and node-wide output memory budget.
  * This is useful to avoid memory bloat (and hence OOM) when data gets queued
  * into send queue faster than it could be send over wire.
  */
@@ -1479,6 +1484,8 @@ static int dnet_process_cmd_without_backend_raw(struct dnet_net_state *st,
 		return dnet_cmd_bulk_read_new(st, cmd, data, context);		
 	case DNET_CMD_BULK_REMOVE_NEW:
 		return dnet_cmd_bulk_remove_new(st, cmd, data, context);
+	case DNET_CMD_BULK_WRITE_NEW:
+		return dnet_cmd_bulk_write_new(st, cmd, data, context);
 	default:
 		return -ENOTSUP;
 	}
@@ -1605,7 +1612,8 @@ static int dnet_process_cmd_with_backend_raw(struct dnet_net_state *st,
 		if ((n->ro || dnet_backend_read_only(backend)) &&
 		    ((cmd->cmd == DNET_CMD_DEL_NEW) || 
 		     (cmd->cmd == DNET_CMD_WRITE_NEW) || 
-		     (cmd->cmd == DNET_CMD_BULK_REMOVE_NEW))) {
+		     (cmd->cmd == DNET_CMD_BULK_REMOVE_NEW) ||
+		     (cmd->cmd == DNET_CMD_BULK_WRITE_NEW))) {
 			err = -EROFS;
 			break;
 		}
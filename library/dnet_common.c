@@ -107,6 +107,7 @@ static char *dnet_cmd_strings[] = {
 	[DNET_CMD_DEL_NEW] = "REMOVE_NEW",
 	[DNET_CMD_BULK_READ_NEW] = "BULK_READ_NEW",
 	[DNET_CMD_BULK_REMOVE_NEW] = "BULK_REMOVE_NEW",
+	[DNET_CMD_BULK_WRITE_NEW] = "BULK_WRITE_NEW",
 
 	[DNET_CMD_UNKNOWN] = "UNKNOWN",
 };
@@ -544,6 +545,12 @@ err_out_exit:
 
 }
 
+int dnet_lookup_addr_batch(struct dnet_session *s, const struct dnet_id *ids, size_t count,
+		struct dnet_addr *addrs, int *backend_ids, int *errors)
+{
+	return dnet_state_search_batch(s->node, ids, count, addrs, backend_ids, errors);
+}
+
 struct dnet_weight {
 	double			weight;
 	int			group_id;
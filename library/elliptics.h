@@ -62,6 +62,7 @@ struct n2_recv_buffer;
 struct n2_request_info;
 struct n2_response_info;
 struct n2_serialized;
+struct dnet_read_cache;
 
 // Define which fields of dnet_io_req are used
 enum dnet_io_req_type {
@@ -88,6 +89,8 @@ struct dnet_io_req {
 
 	struct timespec		queue_start_ts;
 	uint64_t		queue_time;
+	/* memory pinned by the request while it waits in send queue of the state, fd-backed data is not counted */
+	size_t			queued_bytes;
 	uint64_t		recv_time;
 
 	struct dnet_access_context *context;
@@ -134,6 +137,10 @@ int dnet_io_req_set_request_backend_id(struct dnet_io_req *r, int backend_id);
 #define DNET_SEND_WATERMARK_HIGH	(1024 * 100)
 #define DNET_SEND_WATERMARK_LOW		(512 * 100)
 
+/* Watermarks of bytes queued to a single state, they bound memory pinned by large replies */
+#define DNET_SEND_WATERMARK_HIGH_BYTES	(100 * 1024 * 1024L)
+#define DNET_SEND_WATERMARK_LOW_BYTES	(50 * 1024 * 1024L)
+
 /* Internal flag to ignore cache */
 #define DNET_IO_FLAGS_NOCACHE		(1<<28)
 
@@ -168,6 +175,9 @@ struct dnet_net_state
 	int			stall;
 	struct timespec		stall_ts;
 
+	/* set under @send_lock when reading from client is stopped until its queued output is drained */
+	int			recv_suspended;
+
 	int			__join_state;
 	int			__ids_sent;
 
@@ -201,6 +211,8 @@ struct dnet_net_state
 	pthread_cond_t		send_wait;
 	/* Number of queued requests in send queue from iterator */
 	atomic_t		send_queue_size;
+	/* Number of bytes queued in send queue by all producers, see dnet_io_req::queued_bytes */
+	atomic_t		send_queue_bytes;
 
 	pthread_mutex_t		trans_lock;
 	struct rb_root		trans_root;
@@ -276,6 +288,11 @@ int dnet_get_backend_weight(struct dnet_net_state *st, int backend_id, uint32_t
 void dnet_set_backend_weight(struct dnet_net_state *st, int backend_id, uint32_t ioflags, double weight);
 void dnet_update_backend_weight(struct dnet_net_state *st, const struct dnet_cmd *, uint64_t ioflags, long time);
 struct dnet_net_state *dnet_state_search_nolock(struct dnet_node *n, const struct dnet_id *id, int *backend_id);
+/*
+ * Resolves @count keys under single state_lock, see dnet_lookup_addr_batch()
+ */
+int dnet_state_search_batch(struct dnet_node *n, const struct dnet_id *ids, size_t count,
+		struct dnet_addr *addrs, int *backend_ids, int *errors);
 struct dnet_net_state *dnet_node_state(struct dnet_node *n);
 
 /* Set need_exit flag, cancel iterators, stop and join node threads */
@@ -357,6 +374,12 @@ static inline void dnet_group_put(struct dnet_group *g)
 		dnet_group_destroy(g);
 }
 
+/*
+ * Returns position of route entry in sorted @g->ids which is responsible for @id,
+ * caller must hold node's state_lock.
+ */
+int __dnet_idc_search(struct dnet_group *g, const struct dnet_id *id);
+
 struct dnet_transform
 {
 	void			*priv;
@@ -422,8 +445,19 @@ struct dnet_work_pool {
 	struct dnet_work_io		*wio_list;
 
 	struct dnet_request_queue	*request_queue;
+
+	/* number of READ_NEW requests served together with identical read processed before them */
+	atomic_t			coalesced_reads;
 };
 
+/*
+ * Identical READ_NEW requests which have been waiting for the key lock while a read was processed are taken
+ * by the same io thread right after it and processed under its lock, so nothing can change the key between them.
+ * Returns id of such read flight shared by all its requests while they are processed by the current io thread,
+ * so backend may reuse result of the first read for the rest of them. Returns 0 outside of io threads.
+ */
+uint64_t dnet_current_read_flight(void);
+
 struct dnet_work_pool_place
 {
 	pthread_mutex_t		lock;
@@ -474,6 +508,22 @@ struct dnet_io {
 
 	struct list_stat	output_stats;
 
+	/*
+	 * Node-wide output memory budget: bytes queued to all states and its limit (0 means unlimited).
+	 * When the budget is exceeded, states which hold more than their share of it (the limit split between
+	 * @output_states having queued output) are throttled until they are drained below half of the share or
+	 * the node is drained below 3/4 of the limit: requests are not read from such clients and producers
+	 * streaming to such states sleep on @output_wait under @full_lock.
+	 * @output_suspended is the number of sleeping producers, @output_suspended_clients - of clients
+	 * which requests are not read.
+	 */
+	atomic_t		output_bytes;
+	atomic_t		output_states;
+	atomic_t		output_suspended_clients;
+	uint64_t		output_limit;
+	pthread_cond_t		output_wait;
+	int			output_suspended;
+
 	struct n2_native_protocol_io	*native_protocol;
 };
 
@@ -487,11 +537,30 @@ void dnet_io_cleanup(struct dnet_node *n);
 
 void dnet_io_req_free(struct dnet_io_req *r);
 
+/*
+ * Replies are received into reference-counted buffer (ioremap::elliptics::data_pointer), so result entries
+ * made by transaction completion callback can keep received header and data without copying them.
+ * Buffer layout is [struct dnet_io_req][struct dnet_addr][@size bytes of header and data],
+ * room for the address of reply's sender lets the entry to be the same as copied one.
+ */
+struct dnet_io_req *dnet_io_req_alloc_shared(size_t size);
+void dnet_io_req_put_shared(struct dnet_io_req *r);
+
+/*
+ * Returns shared request which holds reply @cmd if it is being processed by transaction completion callback
+ * in the current thread, NULL if @cmd is made locally (timeout, destruction of transaction etc).
+ */
+struct dnet_io_req *dnet_io_req_get_current_reply(const struct dnet_cmd *cmd);
+
+struct dnet_binary_access_log;
 struct dnet_config_data {
 	int cfg_addr_num;
 	struct dnet_addr *cfg_addrs;
 
 	struct dnet_config cfg_state;
+
+	/* binary access log, it is owned by config data and is NULL if it isn't configured */
+	struct dnet_binary_access_log *binary_access_log;
 };
 
 void dnet_config_data_destroy(struct dnet_config_data *config_data);
@@ -534,6 +603,8 @@ struct dnet_node {
 
 	dnet_logger		*log;
 	dnet_logger		*access_log;
+	/* if set, requests are written into the binary access log instead of @access_log */
+	struct dnet_binary_access_log *binary_access_log;
 
 	struct timespec		wait_ts;
 
@@ -612,6 +683,9 @@ struct dnet_node {
 	 * after which net thread will switch to next ready connection.
 	 */
 	uint32_t		send_limit;
+
+	/* client-side cache of newapi reads, it is owned by C++ node and is NULL if it isn't enabled */
+	struct dnet_read_cache	*read_cache;
 };
 
 
@@ -814,6 +888,10 @@ int n2_trans_forward(struct n2_request_info *request_info, struct dnet_net_state
 int n2_complete_trans_via_response_holder(struct dnet_trans *t, struct n2_response_info *response_info);
 
 void dnet_io_req_enqueue_net(struct dnet_net_state *st, struct dnet_io_req *r);
+/* drops @count sent or discarded requests of @bytes total size from send queue accounting of @st */
+void dnet_send_queue_release(struct dnet_net_state *st, uint64_t count, uint64_t bytes);
+/* suspends producer streaming to @st while @st is over its share of node-wide output memory budget */
+void dnet_output_budget_wait(struct dnet_net_state *st);
 
 int dnet_recv_list(struct dnet_node *n, struct dnet_net_state *st);
 
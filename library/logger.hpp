@@ -2,6 +2,24 @@
 
 #include "elliptics/logger.hpp"
 
+/*
+ * Messages with severity below DNET_LOG_MIN_LEVEL are compiled out entirely, even trace bit
+ * can't turn them on, e.g. build with -DDNET_LOG_MIN_LEVEL=1 drops all debug messages.
+ */
+#ifndef DNET_LOG_MIN_LEVEL
+#define DNET_LOG_MIN_LEVEL DNET_LOG_DEBUG
+#endif
+
+#define DNET_LOG_COMPILED(__severity__) ((int)(__severity__) >= (int)(DNET_LOG_MIN_LEVEL))
+
+/*
+ * Checks whether message with @__severity__ passes @__verbosity__ or should be logged due to trace bit.
+ * Log macros check it before evaluating any of their arguments.
+ */
+#define DNET_LOG_ENABLED(__severity__, __verbosity__)						\
+	(DNET_LOG_COMPILED(__severity__) &&							\
+	 ((int)(__severity__) >= (int)(__verbosity__) || dnet_logger_trace_bit))
+
 #ifdef __cplusplus
 #include <atomic>
 #include <unordered_map>
@@ -138,6 +156,11 @@ void dnet_logger_unset_backend_id();
 void dnet_logger_set_pool_id(const char *pool_id);
 void dnet_logger_unset_pool_id();
 
+/* Trace bit of the current thread's request, it is the same as dnet_logger_get_trace_bit() but cheap to check */
+extern __thread int dnet_logger_trace_bit;
+
+enum dnet_log_level dnet_node_get_verbosity(struct dnet_node *n);
+
 void dnet_log_raw(dnet_logger *logger, enum dnet_log_level level, const char *format, ...)
         __attribute__((format(printf, 3, 4)));
 
@@ -160,13 +183,32 @@ template <class T> inline blackhole::logger_facade<dnet_logger> make_facade(T &&
 	return blackhole::logger_facade<dnet_logger>(logger_ref(log));
 }
 
+/*
+ * Node's verbosity is known, so disabled messages are dropped before their arguments are evaluated.
+ * Bare loggers are filtered by blackhole itself.
+ */
+inline bool log_enabled(struct dnet_node *node, int severity) {
+	return DNET_LOG_ENABLED(severity, dnet_node_get_verbosity(node));
+}
+template <class T> inline bool log_enabled(T &&, int severity) { return DNET_LOG_COMPILED(severity); }
+
 }} /* namespace ioremap::elliptics */
 
 void dnet_log_access(dnet_node *node,
                      const blackhole::attribute_list &attributes);
 
-#define DNET_LOG(__log__, __severity__, ...) \
-	ioremap::elliptics::make_facade(__log__).log(__severity__, __VA_ARGS__)
+#define DNET_LOG(__log__, __severity__, ...)							\
+	do {												\
+		if (ioremap::elliptics::log_enabled(__log__, __severity__))				\
+			ioremap::elliptics::make_facade(__log__).log(__severity__, __VA_ARGS__);	\
+	} while (0)
+
+/* Logs into @__log__ only if @__severity__ passes @__verbosity__, e.g. backend's one */
+#define DNET_LOG_VERBOSITY(__log__, __verbosity__, __severity__, ...)				\
+	do {												\
+		if (DNET_LOG_ENABLED(__severity__, __verbosity__))					\
+			ioremap::elliptics::make_facade(__log__).log(__severity__, __VA_ARGS__);	\
+	} while (0)
 
 #define DNET_LOG_DEBUG(__log__, ...)	DNET_LOG(__log__, DNET_LOG_DEBUG, __VA_ARGS__)
 #define DNET_LOG_NOTICE(__log__, ...)	DNET_LOG(__log__, DNET_LOG_NOTICE, __VA_ARGS__)
@@ -179,17 +221,30 @@ void dnet_log_access(dnet_node *node,
 
 #define DNET_LOG(__node__, __severity__, ...)								\
 	do {												\
-		if (dnet_logger_get_trace_bit() ||							\
-		    (enum dnet_log_level)(__severity__) >= dnet_node_get_verbosity(__node__)) { 	\
+		if (DNET_LOG_ENABLED(__severity__, dnet_node_get_verbosity(__node__))) {		\
 			DNET_LOG_RAW(dnet_node_get_logger(__node__), __severity__, __VA_ARGS__);	\
 		}											\
 	} while (0)
 
+#define DNET_LOG_VERBOSITY(__log__, __verbosity__, __severity__, ...)				\
+	do {												\
+		if (DNET_LOG_ENABLED(__severity__, __verbosity__)) {					\
+			DNET_LOG_RAW(__log__, __severity__, __VA_ARGS__);				\
+		}											\
+	} while (0)
+
 #define dnet_log(...)			DNET_LOG(__VA_ARGS__)
 
-#define DNET_LOG_DEBUG(log, ...)	DNET_LOG_RAW(log, DNET_LOG_DEBUG, __VA_ARGS__)
-#define DNET_LOG_NOTICE(log, ...)	DNET_LOG_RAW(log, DNET_LOG_NOTICE, __VA_ARGS__)
-#define DNET_LOG_INFO(log, ...)		DNET_LOG_RAW(log, DNET_LOG_INFO, __VA_ARGS__)
+#define DNET_LOG_SEVERITY(log, severity, ...)							\
+	do {												\
+		if (DNET_LOG_COMPILED(severity)) {							\
+			DNET_LOG_RAW(log, severity, __VA_ARGS__);					\
+		}											\
+	} while (0)
+
+#define DNET_LOG_DEBUG(log, ...)	DNET_LOG_SEVERITY(log, DNET_LOG_DEBUG, __VA_ARGS__)
+#define DNET_LOG_NOTICE(log, ...)	DNET_LOG_SEVERITY(log, DNET_LOG_NOTICE, __VA_ARGS__)
+#define DNET_LOG_INFO(log, ...)		DNET_LOG_SEVERITY(log, DNET_LOG_INFO, __VA_ARGS__)
 #define DNET_LOG_WARNING(log, ...)	DNET_LOG_RAW(log, DNET_LOG_WARNING, __VA_ARGS__)
 #define DNET_LOG_ERROR(log, ...)	DNET_LOG_RAW(log, DNET_LOG_ERROR, __VA_ARGS__)
 
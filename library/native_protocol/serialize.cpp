@@ -61,6 +61,10 @@ int enqueue_net(dnet_net_state *st, std::unique_ptr<n2_serialized> serialized) {
 	if (!r)
 		return -ENOMEM;
 
+	r->queued_bytes = sizeof(serialized->cmd);
+	for (const auto &chunk : serialized->chunks)
+		r->queued_bytes += chunk.size();
+
 	r->serialized = serialized.release();
 	dnet_io_req_enqueue_net(st, r);
 	return 0;
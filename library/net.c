@@ -320,21 +320,166 @@ err_out_exit:
 	return err;
 }
 
+static inline uint64_t dnet_output_low_watermark(struct dnet_io *io)
+{
+	return io->output_limit / 4 * 3;
+}
+
+/* share of output memory budget of a single state: the limit is split between states having queued output */
+static inline uint64_t dnet_output_state_share(struct dnet_io *io)
+{
+	const long states = atomic_read(&io->output_states);
+	return io->output_limit / (states > 0 ? states : 1);
+}
+
+/* @st should be throttled: budget is exceeded and @st holds more than its share of it */
+static int dnet_output_state_over_budget(struct dnet_net_state *st)
+{
+	struct dnet_io *io = st->n->io;
+
+	return io->output_limit &&
+		(uint64_t)atomic_read(&io->output_bytes) > io->output_limit &&
+		(uint64_t)atomic_read(&st->send_queue_bytes) > dnet_output_state_share(io);
+}
+
+/* throttled @st can be resumed: it is drained below half of its share or the node is drained enough */
+static int dnet_output_state_drained(struct dnet_net_state *st)
+{
+	struct dnet_io *io = st->n->io;
+
+	return (uint64_t)atomic_read(&io->output_bytes) <= dnet_output_low_watermark(io) ||
+		(uint64_t)atomic_read(&st->send_queue_bytes) <= dnet_output_state_share(io) / 2;
+}
+
+/*
+ * Stops reading new requests from client which holds more than its share of exceeded output budget,
+ * so a client which doesn't read its replies can't occupy io threads and memory needed by others.
+ * Server peers (the listening state and states with known addresses) are never suspended,
+ * since they may wait for our replies to drain their own queues.
+ * Must be called under @st->send_lock.
+ */
+static void dnet_output_suspend_recv_nolock(struct dnet_net_state *st)
+{
+	if (st->recv_suspended || st->__need_exit || st->accept_s >= 0 || st->addr_num ||
+	    !dnet_output_state_over_budget(st))
+		return;
+
+	if (st->read_s >= 0)
+		epoll_ctl(st->epoll_fd, EPOLL_CTL_DEL, st->read_s, NULL);
+	st->recv_suspended = 1;
+	atomic_inc(&st->n->io->output_suspended_clients);
+
+	dnet_log(st->n, DNET_LOG_NOTICE, "Output memory budget is exceeded: %s: queued: %ld, share: %llu, "
+	                                 "node queued: %ld, limit: %llu, suspending receiving",
+	         dnet_addr_string(&st->addr), atomic_read(&st->send_queue_bytes),
+	         (unsigned long long)dnet_output_state_share(st->n->io), atomic_read(&st->n->io->output_bytes),
+	         (unsigned long long)st->n->io->output_limit);
+}
+
+static void dnet_output_resume_recv(struct dnet_net_state *st)
+{
+	if (!st->recv_suspended || !dnet_output_state_drained(st))
+		return;
+
+	pthread_mutex_lock(&st->send_lock);
+	if (st->recv_suspended) {
+		st->recv_suspended = 0;
+		atomic_dec(&st->n->io->output_suspended_clients);
+
+		if (!st->__need_exit) {
+			dnet_log(st->n, DNET_LOG_NOTICE, "%s: queued: %ld, node queued: %ld, resuming receiving",
+			         dnet_addr_string(&st->addr), atomic_read(&st->send_queue_bytes),
+			         atomic_read(&st->n->io->output_bytes));
+			dnet_schedule_recv(st);
+		}
+	}
+	pthread_mutex_unlock(&st->send_lock);
+}
+
 void dnet_io_req_enqueue_net(struct dnet_net_state *st, struct dnet_io_req *r)
 {
 	clock_gettime(CLOCK_MONOTONIC_RAW, &r->queue_start_ts);
 
+	/* serialized requests are accounted by their producer, data sent from fd is not kept in memory */
+	if (!r->serialized)
+		r->queued_bytes = r->hsize + r->dsize;
+	if (r->queued_bytes && atomic_add(&st->send_queue_bytes, r->queued_bytes) == (long)r->queued_bytes)
+		atomic_inc(&st->n->io->output_states);
+
+	pthread_mutex_lock(&st->n->io->full_lock);
+	list_stat_size_increase(&st->n->io->output_stats, 1);
+	atomic_add(&st->n->io->output_bytes, r->queued_bytes);
+	pthread_mutex_unlock(&st->n->io->full_lock);
+	HANDY_COUNTER_INCREMENT("io.output.queue.size", 1);
+
 	pthread_mutex_lock(&st->send_lock);
 	list_add_tail(&r->req_entry, &st->send_list);
 
-	if (!st->__need_exit)
+	if (!st->__need_exit) {
 		dnet_schedule_send(st);
+		dnet_output_suspend_recv_nolock(st);
+	}
 	pthread_mutex_unlock(&st->send_lock);
+}
 
-	pthread_mutex_lock(&st->n->io->full_lock);
-	list_stat_size_increase(&st->n->io->output_stats, 1);
-	pthread_mutex_unlock(&st->n->io->full_lock);
-	HANDY_COUNTER_INCREMENT("io.output.queue.size", 1);
+void dnet_send_queue_release(struct dnet_net_state *st, uint64_t count, uint64_t bytes)
+{
+	struct dnet_io *io = st->n->io;
+	long left, state_left;
+
+	state_left = atomic_sub(&st->send_queue_bytes, bytes);
+	if (bytes && !state_left)
+		atomic_dec(&io->output_states);
+	if (state_left <= DNET_SEND_WATERMARK_LOW_BYTES && state_left + (long)bytes > DNET_SEND_WATERMARK_LOW_BYTES) {
+		dnet_log(st->n, DNET_LOG_DEBUG, "State low_watermark of queued bytes reached: %s: %ld, waking up",
+		         dnet_addr_string(&st->addr), state_left);
+		pthread_cond_broadcast(&st->send_wait);
+	}
+
+	pthread_mutex_lock(&io->full_lock);
+	list_stat_size_decrease(&io->output_stats, count);
+	left = atomic_sub(&io->output_bytes, bytes);
+	if (io->output_suspended &&
+	    (left <= (long)dnet_output_low_watermark(io) ||
+	     (uint64_t)state_left <= dnet_output_state_share(io) / 2))
+		pthread_cond_broadcast(&io->output_wait);
+	pthread_mutex_unlock(&io->full_lock);
+	HANDY_COUNTER_DECREMENT("io.output.queue.size", count);
+
+	dnet_output_resume_recv(st);
+}
+
+/*
+ * Suspends producer streaming to @st while it is over its share of exceeded output budget.
+ * Producer is suspended only after its reply has been queued, so every producer woken up by
+ * dnet_send_queue_release() makes progress. Wait is periodically interrupted to recheck node and state exit.
+ */
+void dnet_output_budget_wait(struct dnet_net_state *st)
+{
+	struct dnet_node *n = st->n;
+	struct dnet_io *io = n->io;
+	struct timespec ts;
+
+	if (!dnet_output_state_over_budget(st))
+		return;
+
+	pthread_mutex_lock(&io->full_lock);
+	io->output_suspended++;
+
+	dnet_log(n, DNET_LOG_NOTICE, "Output memory budget is exceeded: %s: queued: %ld, share: %llu, "
+	                             "node queued: %ld, limit: %llu, suspended producers: %d, sleeping",
+	         dnet_addr_string(&st->addr), atomic_read(&st->send_queue_bytes),
+	         (unsigned long long)dnet_output_state_share(io), atomic_read(&io->output_bytes),
+	         (unsigned long long)io->output_limit, io->output_suspended);
+
+	while (!n->need_exit && !st->__need_exit && !dnet_output_state_drained(st)) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += 1;
+		pthread_cond_timedwait(&io->output_wait, &io->full_lock, &ts);
+	}
+
+	io->output_suspended--;
+	pthread_mutex_unlock(&io->full_lock);
 }
 
 void dnet_io_req_free(struct dnet_io_req *r)
@@ -364,7 +509,10 @@ void dnet_io_req_free(struct dnet_io_req *r)
 		n2_serialized_free(r->serialized);
 
 	dnet_access_access_put(r->context);
-	free(r);
+	if (r->on_exit & DNET_IO_REQ_FLAGS_SHARED)
+		dnet_io_req_put_shared(r);
+	else
+		free(r);
 }
 
 ssize_t dnet_send_nolock(struct dnet_net_state *st, void *data, uint64_t size)
@@ -622,6 +770,18 @@ static int dnet_process_control(struct dnet_net_state *st, struct dnet_cmd *cmd,
 	}
 }
 
+/* reply which is being processed by transaction completion callback in the current thread */
+static __thread struct dnet_io_req *dnet_current_reply;
+
+struct dnet_io_req *dnet_io_req_get_current_reply(const struct dnet_cmd *cmd)
+{
+	struct dnet_io_req *r = dnet_current_reply;
+
+	if (r && (r->on_exit & DNET_IO_REQ_FLAGS_SHARED) && r->header == cmd)
+		return r;
+	return NULL;
+}
+
 static int dnet_process_reply(struct dnet_net_state *st, struct dnet_io_req *r) {
 	int err = 0;
 	struct dnet_node *n = st->n;
@@ -699,7 +859,9 @@ static int dnet_process_reply(struct dnet_net_state *st, struct dnet_io_req *r)
 			}
 		}
 
+		dnet_current_reply = r;
 		t->complete(dnet_state_addr(t->st), cmd, t->priv);
+		dnet_current_reply = NULL;
 	}
 
 	if (t->repliers) {
@@ -744,13 +906,7 @@ int dnet_process_recv(struct dnet_net_state *st, struct dnet_io_req *r) {
 
 	// context is created only for requests, all replies should be handled within their request's context
 	context = dnet_access_context_create(n);
-	dnet_access_context_add_string(context, "cmd", dnet_cmd_string(cmd->cmd));
-	dnet_access_context_add_uint(context, "trans", cmd->trans);
-	dnet_access_context_add_string(context, "st", dnet_state_dump_addr(st));
-	dnet_access_context_add_trace_id(context, cmd->trace_id);
-	dnet_access_context_add_uint(context, "request_size", r->hsize + r->dsize + r->fsize);
-	dnet_access_context_add_uint(context, "receive_time", r->recv_time);
-	dnet_access_context_add_uint(context, "receive_queue_time", r->queue_time);
+	dnet_access_context_add_request(context, st, r);
 
 	err = dnet_process_control(st, cmd, r->data);
 	if (err != -ENOTSUP) {
@@ -1046,6 +1202,7 @@ int dnet_state_micro_init(struct dnet_net_state *st,
 	}
 
 	atomic_init(&st->send_queue_size, 0);
+	atomic_init(&st->send_queue_bytes, 0);
 	atomic_init(&st->refcnt, 1);
 
 	memcpy(&st->addr, addr, sizeof(struct dnet_addr));
@@ -1297,18 +1454,21 @@ int dnet_node_state_num(struct dnet_node *n)
 static void dnet_state_send_clean(struct dnet_net_state *st)
 {
 	struct dnet_io_req *r, *tmp;
-	uint64_t count = 0;
+	uint64_t count = 0, bytes = 0;
 
 	list_for_each_entry_safe(r, tmp, &st->send_list, req_entry) {
 		list_del(&r->req_entry);
+		bytes += r->queued_bytes;
 		dnet_io_req_free(r);
 		++count;
 	}
 
-	pthread_mutex_lock(&st->n->io->full_lock);
-	list_stat_size_decrease(&st->n->io->output_stats, count);
-	pthread_mutex_unlock(&st->n->io->full_lock);
-	HANDY_COUNTER_DECREMENT("io.output.queue.size", count);
+	/* sockets are closed already, state must not be scheduled again */
+	if (st->recv_suspended) {
+		st->recv_suspended = 0;
+		atomic_dec(&st->n->io->output_suspended_clients);
+	}
+	dnet_send_queue_release(st, count, bytes);
 }
 
 void dnet_state_destroy(struct dnet_net_state *st)
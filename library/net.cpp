@@ -43,6 +43,7 @@
 #include "elliptics.h"
 #include "elliptics/packet.h"
 #include "elliptics/interface.h"
+#include "elliptics/utils.hpp"
 #include "common.hpp"
 #include "protocol.hpp"
 #include "logger.hpp"
@@ -1335,6 +1336,26 @@ int dnet_add_state(dnet_node *node, const dnet_addr *addrs, int num, int flags)
 	return at_least_one_exist ? std::max(0, err) : err;
 }
 
+dnet_io_req *dnet_io_req_alloc_shared(size_t size) {
+	// request follows reference counter of the buffer, malloc() alignment is kept only if counter's size keeps it
+	static_assert(sizeof(ioremap::elliptics::data_pointer::atomic_type) % alignof(dnet_io_req) == 0,
+	              "reference counter of data_pointer misaligns dnet_io_req");
+	try {
+		auto buffer = ioremap::elliptics::data_pointer::allocate(sizeof(dnet_io_req) + sizeof(dnet_addr) + size);
+		auto r = static_cast<dnet_io_req *>(buffer.release());
+		memset(r, 0, sizeof(dnet_io_req) + sizeof(dnet_addr));
+		r->on_exit = DNET_IO_REQ_FLAGS_SHARED;
+		return r;
+	} catch (const std::bad_alloc &) {
+		return nullptr;
+	}
+}
+
+void dnet_io_req_put_shared(dnet_io_req *r) {
+	// drops reference of the request, buffer is freed by the last of it and result entries which share it
+	ioremap::elliptics::data_pointer::adopt(r, 0);
+}
+
 static int dnet_trans_complete_forward(struct dnet_addr * /*addr*/, struct dnet_cmd *cmd, void *priv) {
 	auto t = static_cast<dnet_trans *>(priv);
 	int err = -EINVAL;
@@ -1615,10 +1636,10 @@ static int n2_send_request_impl(dnet_net_state *st, dnet_io_req *r) {
 
 	dnet_logger_set_trace_id(cmd.trace_id, cmd.flags & DNET_FLAGS_TRACE_BIT);
 	enum dnet_log_level level = st->send_offset == 0 ? DNET_LOG_NOTICE : DNET_LOG_DEBUG;
-	DNET_LOG(st->n, level, "%s: %s: sending trans: %lld -> %s/%d: size: %llu, cflags: %s, start-sent: "
-			       "%zd/%zd, send-queue-time: %lu usecs",
-		 dnet_dump_id(&cmd.id), dnet_cmd_string(cmd.cmd), (unsigned long long)cmd.trans,
-		 dnet_addr_string(&st->addr), cmd.backend_id, (unsigned long long)cmd.size,
+	DNET_LOG(st->n, level, "{}: {}: sending trans: {} -> {}/{}: size: {}, cflags: {}, start-sent: "
+			       "{}/{}, send-queue-time: {} usecs",
+		 dnet_dump_id(&cmd.id), dnet_cmd_string(cmd.cmd), cmd.trans,
+		 dnet_addr_string(&st->addr), cmd.backend_id, cmd.size,
 		 dnet_flags_dump_cflags(cmd.flags), st->send_offset, total_size, r->queue_time);
 
 	dnet_cmd cmd_net = cmd;
@@ -1658,16 +1679,13 @@ static int n2_send_request_impl(dnet_net_state *st, dnet_io_req *r) {
 	if (!send_error) {
 		level = !(cmd.flags & DNET_FLAGS_MORE) ? DNET_LOG_INFO : DNET_LOG_NOTICE;
 		if (r->context) {
-			r->context->add({{"send_time", send_time},
-					 {"send_queue_time", r->queue_time},
-					 {"response_size", total_size},
-					});
+			r->context->add_send_stats(send_time, r->queue_time, total_size);
 		}
 	}
-	DNET_LOG(st->n, level, "%s: %s: sending trans: %lld -> %s/%d: size: %llu, cflags: %s, finish-sent: "
-			       "%zd/%zd, send-queue-time: %lu usecs, send-time: %lu usecs",
-		 dnet_dump_id(&cmd.id), dnet_cmd_string(cmd.cmd), (unsigned long long)cmd.trans,
-		 dnet_addr_string(&st->addr), cmd.backend_id, (unsigned long long)cmd.size,
+	DNET_LOG(st->n, level, "{}: {}: sending trans: {} -> {}/{}: size: {}, cflags: {}, finish-sent: "
+			       "{}/{}, send-queue-time: {} usecs, send-time: {} usecs",
+		 dnet_dump_id(&cmd.id), dnet_cmd_string(cmd.cmd), cmd.trans,
+		 dnet_addr_string(&st->addr), cmd.backend_id, cmd.size,
 		 dnet_flags_dump_cflags(cmd.flags), st->send_offset, total_size, r->queue_time, send_time);
 	dnet_logger_unset_trace_id();
 
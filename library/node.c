@@ -458,7 +458,7 @@ void dnet_idc_destroy_nolock(struct dnet_net_state *st)
 	dnet_idc_remove_all(st);
 }
 
-static int __dnet_idc_search(struct dnet_group *g, const struct dnet_id *id)
+int __dnet_idc_search(struct dnet_group *g, const struct dnet_id *id)
 {
 	int low, high, i, cmp;
 	struct dnet_state_id *sid;
@@ -718,6 +718,91 @@ void dnet_update_backend_weight(struct dnet_net_state *st, const struct dnet_cmd
 	}
 }
 
+static int dnet_id_group_compare(const void *v1, const void *v2)
+{
+	const struct dnet_id *id1 = *(const struct dnet_id **)v1;
+	const struct dnet_id *id2 = *(const struct dnet_id **)v2;
+
+	if (id1->group_id != id2->group_id)
+		return id1->group_id < id2->group_id ? -1 : 1;
+
+	return dnet_id_cmp_str(id1->id, id2->id);
+}
+
+int dnet_state_search_batch(struct dnet_node *n, const struct dnet_id *ids, size_t count,
+		struct dnet_addr *addrs, int *backend_ids, int *errors)
+{
+	const struct dnet_id **sorted;
+	struct dnet_group *g = NULL;
+	unsigned int group_id = 0;
+	int low, high, i, pos = -1;
+	size_t k;
+
+	if (!count)
+		return 0;
+
+	sorted = malloc(count * sizeof(*sorted));
+	if (!sorted)
+		return -ENOMEM;
+
+	for (k = 0; k < count; ++k)
+		sorted[k] = &ids[k];
+
+	/*
+	 * Keys are sorted by group and id outside of the lock,
+	 * so route entries of every group are walked once in the same direction.
+	 */
+	qsort(sorted, count, sizeof(*sorted), dnet_id_group_compare);
+
+	pthread_mutex_lock(&n->state_lock);
+	for (k = 0; k < count; ++k) {
+		const struct dnet_id *id = sorted[k];
+		const size_t index = id - ids;
+		struct dnet_state_id *sid;
+
+		if (k == 0 || id->group_id != group_id) {
+			dnet_group_put(g);
+			group_id = id->group_id;
+			g = dnet_group_search(n, group_id);
+			pos = -1;
+		}
+
+		if (!g || !g->id_num) {
+			errors[index] = -ENXIO;
+			continue;
+		}
+
+		/*
+		 * @pos is the last route entry not greater than previous key, it is still responsible for
+		 * the current key unless the next entry is passed too. In that case the rest of entries is searched,
+		 * so sparse keys do not walk through the whole group.
+		 */
+		if (pos + 1 < g->id_num && dnet_id_cmp_str(g->ids[pos + 1].raw.id, id->id) <= 0) {
+			for (low = pos + 1, high = g->id_num; high - low > 1; ) {
+				i = low + (high - low) / 2;
+				if (dnet_id_cmp_str(g->ids[i].raw.id, id->id) <= 0)
+					low = i;
+				else
+					high = i;
+			}
+			pos = low;
+		}
+
+		/* keys less than the first entry belong to the last one like in __dnet_idc_search() */
+		sid = &g->ids[pos == -1 ? g->id_num - 1 : pos];
+
+		addrs[index] = *dnet_state_addr(sid->idc->st);
+		if (backend_ids)
+			backend_ids[index] = sid->idc->backend_id;
+		errors[index] = 0;
+	}
+	dnet_group_put(g);
+	pthread_mutex_unlock(&n->state_lock);
+
+	free(sorted);
+	return 0;
+}
+
 struct dnet_net_state *dnet_state_get_first_with_backend(struct dnet_node *n,
                                                          const struct dnet_id *id,
                                                          int *backend_id) {
@@ -214,6 +214,8 @@ int dnet_work_pool_alloc(struct dnet_work_pool_place *place,
 
 	strncpy(pool->pool_id, pool_id, sizeof(pool->pool_id));
 
+	atomic_init(&pool->coalesced_reads, 0);
+
 	pool->request_queue = dnet_request_queue_create(mode, queue_limit);
 	if (!pool->request_queue) {
 		err = -ENOMEM;
@@ -252,6 +254,7 @@ static int dnet_cmd_needs_backend(int command)
 	case DNET_CMD_BACKEND_STATUS:
 	case DNET_CMD_BULK_READ_NEW:
 	case DNET_CMD_BULK_REMOVE_NEW:
+	case DNET_CMD_BULK_WRITE_NEW:
 		return 0;
 	}
 	return 1;
@@ -412,7 +415,7 @@ void dnet_schedule_command(struct dnet_net_state *st)
 						(unsigned long long)c->size, tid, tid != c->trans, st->rcv_data);
 #endif
 		if (!st->rcv_buffer_used)
-			free(st->rcv_data);
+			dnet_io_req_free(st->rcv_data);
 		st->rcv_data = NULL;
 	}
 
@@ -500,19 +503,33 @@ again:
 		if (err != -ENOTSUP)
 			goto out;
 
-		r = malloc(c->size + sizeof(struct dnet_cmd) + sizeof(struct dnet_io_req));
-		if (!r) {
-			err = -ENOMEM;
-			goto out;
+		/*
+		 * Replies are received into shared buffer, client's result entries keep it instead of copying.
+		 */
+		if (c->flags & DNET_FLAGS_REPLY) {
+			r = dnet_io_req_alloc_shared(c->size + sizeof(struct dnet_cmd));
+			if (!r) {
+				err = -ENOMEM;
+				goto out;
+			}
+
+			r->header = (void *)(r + 1) + sizeof(struct dnet_addr);
+		} else {
+			r = malloc(c->size + sizeof(struct dnet_cmd) + sizeof(struct dnet_io_req));
+			if (!r) {
+				err = -ENOMEM;
+				goto out;
+			}
+			memset(r, 0, sizeof(struct dnet_io_req));
+
+			r->header = r + 1;
 		}
-		memset(r, 0, sizeof(struct dnet_io_req));
 
-		r->header = r + 1;
 		r->hsize = sizeof(struct dnet_cmd);
 		memcpy(r->header, &st->rcv_cmd, sizeof(struct dnet_cmd));
 
 		st->rcv_data = r;
-		st->rcv_offset = sizeof(struct dnet_io_req) + sizeof(struct dnet_cmd);
+		st->rcv_offset = (r->header - (void *)r) + sizeof(struct dnet_cmd);
 		st->rcv_end = st->rcv_offset + c->size;
 
 		if (c->size) {
@@ -726,10 +743,7 @@ static int dnet_process_send_single(struct dnet_net_state *st)
 			list_del(&r->req_entry);
 			pthread_mutex_unlock(&st->send_lock);
 
-			pthread_mutex_lock(&st->n->io->full_lock);
-			list_stat_size_decrease(&st->n->io->output_stats, 1);
-			pthread_mutex_unlock(&st->n->io->full_lock);
-			HANDY_COUNTER_DECREMENT("io.output.queue.size", 1);
+			dnet_send_queue_release(st, 1, r->queued_bytes);
 
 			if (atomic_read(&st->send_queue_size) > 0)
 				if (atomic_dec(&st->send_queue_size) == DNET_SEND_WATERMARK_LOW) {
@@ -1062,6 +1076,46 @@ static void dnet_io_cleanup_states(struct dnet_node *n)
 	n->st = NULL;
 }
 
+/* backend keeps result of the flight's first read in thread-local storage too, so ids are unique per thread */
+static __thread uint64_t dnet_read_flight;
+static __thread uint64_t dnet_read_flight_seq;
+
+uint64_t dnet_current_read_flight(void)
+{
+	return dnet_read_flight;
+}
+
+/*
+ * Processes READ_NEW requests detached by dnet_take_coalesced_reads() right after their leader within its
+ * read flight, key is still locked by the leader, so they see the same record.
+ */
+static void dnet_process_coalesced_reads(struct dnet_work_io *wio, struct list_head *followers)
+{
+	struct dnet_node *n = wio->pool->n;
+	struct dnet_io_req *r, *tmp;
+	struct dnet_net_state *st;
+	struct dnet_cmd *cmd;
+
+	list_for_each_entry_safe(r, tmp, followers, req_entry) {
+		list_del_init(&r->req_entry);
+
+		st = r->st;
+		cmd = dnet_io_req_get_cmd(r);
+
+		dnet_logger_set_trace_id(cmd->trace_id, cmd->flags & DNET_FLAGS_TRACE_BIT);
+
+		dnet_log(n, DNET_LOG_DEBUG, "%s: %s: got coalesced IO event: %p: cmd: %s, queue_time: %lu usecs",
+		         dnet_state_dump_addr(st), dnet_dump_id(&cmd->id), r, dnet_cmd_string(cmd->cmd), r->queue_time);
+
+		dnet_process_recv(st, r);
+
+		dnet_io_req_free(r);
+		dnet_state_put(st);
+
+		dnet_logger_unset_trace_id();
+	}
+}
+
 void *dnet_io_process(void *data_) {
 	struct dnet_work_io *wio = data_;
 	struct dnet_work_pool *pool = wio->pool;
@@ -1072,6 +1126,8 @@ void *dnet_io_process(void *data_) {
 	const int lifo = (pool->mode == DNET_WORK_IO_MODE_LIFO);
 	const int nonblocking = (pool->mode == DNET_WORK_IO_MODE_NONBLOCKING || lifo);
 	char thread_stat_id[255];
+	LIST_HEAD(followers);
+	size_t coalesced;
 
 	dnet_set_name("dnet_%sio_%s", nonblocking ? "nb_" : "", pool->pool_id);
 
@@ -1102,11 +1158,20 @@ void *dnet_io_process(void *data_) {
 		         dnet_state_dump_addr(st), dnet_dump_id(&cmd->id), r, dnet_cmd_string(cmd->cmd), r->hsize,
 		         r->dsize, dnet_work_io_mode_str(pool->mode), cmd->backend_id, r->queue_time);
 
+		dnet_read_flight = ++dnet_read_flight_seq;
+
 		dnet_process_recv(st, r);
 
 		dnet_log(n, DNET_LOG_DEBUG, "%s: %s: processed IO event: %p, cmd: %s", dnet_state_dump_addr(st),
 		         dnet_dump_id(&cmd->id), r, dnet_cmd_string(cmd->cmd));
 
+		/* identical reads which have come while @r was processed wait for its key lock */
+		while ((coalesced = dnet_take_coalesced_reads(wio, r, &followers, thread_stat_id)) != 0) {
+			atomic_add(&pool->coalesced_reads, coalesced);
+			dnet_process_coalesced_reads(wio, &followers);
+		}
+		dnet_read_flight = 0;
+
 		dnet_release_request(wio, r);
 		dnet_io_req_free(r);
 		dnet_state_put(st);
@@ -1185,7 +1250,17 @@ int dnet_io_init(struct dnet_node *n, struct dnet_config *cfg)
 		goto err_out_free_mutex;
 	}
 
+	err = pthread_cond_init(&n->io->output_wait, NULL);
+	if (err) {
+		err = -err;
+		goto err_out_free_cond;
+	}
+
 	list_stat_init(&n->io->output_stats);
+	atomic_init(&n->io->output_bytes, 0);
+	atomic_init(&n->io->output_states, 0);
+	atomic_init(&n->io->output_suspended_clients, 0);
+	n->io->output_limit = cfg->output_memory_limit;
 
 	n->io->net_thread_num = cfg->net_thread_num;
 	n->io->net_thread_pos = 0;
@@ -1193,7 +1268,7 @@ int dnet_io_init(struct dnet_node *n, struct dnet_config *cfg)
 
 	err = dnet_work_pool_place_init(&n->io->pool.recv_pool);
 	if (err) {
-		goto err_out_free_cond;
+		goto err_out_free_output_cond;
 	}
 
 	err = dnet_work_pool_alloc(&n->io->pool.recv_pool, n, cfg->io_thread_num, DNET_WORK_IO_MODE_BLOCKING,
@@ -1255,6 +1330,8 @@ err_out_free_recv_pool:
 	dnet_work_pool_exit(&n->io->pool.recv_pool);
 err_out_cleanup_recv_place:
 	dnet_work_pool_place_cleanup(&n->io->pool.recv_pool);
+err_out_free_output_cond:
+	pthread_cond_destroy(&n->io->output_wait);
 err_out_free_cond:
 	pthread_cond_destroy(&n->io->full_wait);
 err_out_free_mutex:
@@ -320,6 +320,40 @@ inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o, const dn
 	return o;
 }
 
+inline ioremap::elliptics::dnet_iterator_filter &operator >>(msgpack::object o,
+                                                             ioremap::elliptics::dnet_iterator_filter &v) {
+	if (o.type != msgpack::type::ARRAY || o.via.array.size < 8)
+		throw msgpack::type_error();
+
+	object *p = o.via.array.ptr;
+	p[0].convert(&v.user_flags_mask);
+	p[1].convert(&v.user_flags_value);
+	p[2].convert(&v.record_flags_mask);
+	p[3].convert(&v.record_flags_value);
+	p[4].convert(&v.min_data_size);
+	p[5].convert(&v.max_data_size);
+	p[6].convert(&v.json_key);
+	p[7].convert(&v.json_value);
+
+	return v;
+}
+
+template <typename Stream>
+inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
+                                            const ioremap::elliptics::dnet_iterator_filter &v) {
+	o.pack_array(8);
+	o.pack(v.user_flags_mask);
+	o.pack(v.user_flags_value);
+	o.pack(v.record_flags_mask);
+	o.pack(v.record_flags_value);
+	o.pack(v.min_data_size);
+	o.pack(v.max_data_size);
+	o.pack(v.json_key);
+	o.pack(v.json_value);
+
+	return o;
+}
+
 inline ioremap::elliptics::dnet_iterator_request &operator >>(msgpack::object o,
                                                               ioremap::elliptics::dnet_iterator_request &v) {
 	if (o.type != msgpack::type::ARRAY || o.via.array.size < 8)
@@ -335,13 +369,19 @@ inline ioremap::elliptics::dnet_iterator_request &operator >>(msgpack::object o,
 	p[6].convert(&std::get<1>(v.time_range));
 	p[7].convert(&v.groups);
 
+	if (o.via.array.size > 8) {
+		p[8].convert(&v.filter);
+	} else {
+		v.filter = ioremap::elliptics::dnet_iterator_filter();
+	}
+
 	return v;
 }
 
 template <typename Stream>
 inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
                                             const ioremap::elliptics::dnet_iterator_request &v) {
-	o.pack_array(8);
+	o.pack_array(9);
 	o.pack(v.iterator_id);
 	o.pack(v.action);
 	o.pack(v.type);
@@ -350,6 +390,7 @@ inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
 	o.pack(std::get<0>(v.time_range));
 	o.pack(std::get<1>(v.time_range));
 	o.pack(v.groups);
+	o.pack(v.filter);
 
 	return o;
 }
@@ -384,13 +425,19 @@ inline ioremap::elliptics::dnet_iterator_response &operator >>(msgpack::object o
 		v.blob_id = 0;
 	}
 
+	if (o.via.array.size > 16) {
+		p[16].convert(&v.filtered_keys);
+	} else {
+		v.filtered_keys = 0;
+	}
+
 	return v;
 }
 
 template <typename Stream>
 inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
                                             const ioremap::elliptics::dnet_iterator_response &v) {
-	o.pack_array(16);
+	o.pack_array(17);
 	o.pack(v.iterator_id);
 	o.pack(v.key);
 	o.pack(v.status);
@@ -407,6 +454,7 @@ inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
 	o.pack(v.read_data_size);
 	o.pack(v.data_offset);
 	o.pack(v.blob_id);
+	o.pack(v.filtered_keys);
 
 	return o;
 }
@@ -511,6 +559,30 @@ inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
 	return o;
 }
 
+inline ioremap::elliptics::dnet_bulk_write_request &operator >>(msgpack::object o,
+                                                                ioremap::elliptics::dnet_bulk_write_request &v) {
+	if (o.type != msgpack::type::ARRAY || o.via.array.size < 3) {
+		throw msgpack::type_error();
+	}
+
+	const object *p = o.via.array.ptr;
+	p[0].convert(&v.keys);
+	p[1].convert(&v.requests);
+	p[2].convert(&v.deadline);
+
+	return v;
+}
+
+template <typename Stream>
+inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
+                                            const ioremap::elliptics::dnet_bulk_write_request &v) {
+	o.pack_array(3);
+	o.pack(v.keys);
+	o.pack(v.requests);
+	o.pack(v.deadline);
+	return o;
+}
+
 
 } // namespace msgpack
 
@@ -523,7 +595,8 @@ dnet_iterator_request::dnet_iterator_request()
 	, flags{0}
 	, key_ranges{}
 	, time_range{dnet_time{0, 0}, dnet_time{0, 0}}
-	, groups{} {
+	, groups{}
+	, filter{} {
 }
 
 dnet_iterator_request::dnet_iterator_request(uint32_t type, uint64_t flags,
@@ -535,7 +608,8 @@ dnet_iterator_request::dnet_iterator_request(uint32_t type, uint64_t flags,
 	, flags{flags}
 	, key_ranges{key_ranges}
 	, time_range(time_range)
-	, groups{} {
+	, groups{}
+	, filter{} {
 }
 
 dnet_bulk_remove_request::dnet_bulk_remove_request() {}
@@ -558,6 +632,10 @@ bool dnet_bulk_remove_request::is_valid() const {
 		(!(ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP) && (timestamps.size() == 0));
 }
 
+bool dnet_bulk_write_request::is_valid() const {
+	return keys.size() == requests.size();
+}
+
 template<typename T>
 data_pointer serialize(const T &value) {
 	msgpack::sbuffer buffer;
@@ -599,6 +677,7 @@ DEFINE_HEADER(dnet_write_request);
 DEFINE_HEADER(dnet_lookup_response);
 
 DEFINE_HEADER(dnet_bulk_remove_request)
+DEFINE_HEADER(dnet_bulk_write_request);
 DEFINE_HEADER(dnet_remove_request);
 
 DEFINE_HEADER(dnet_iterator_request);
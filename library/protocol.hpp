@@ -108,6 +108,40 @@ struct dnet_bulk_remove_request {
 	std::vector<dnet_time> timestamps;
 };
 
+/*
+ * Header of DNET_CMD_BULK_WRITE_NEW, it is followed by json and data of every record in order of @keys.
+ * Each record is written by its @requests item with the same semantics as single DNET_CMD_WRITE_NEW.
+ */
+struct dnet_bulk_write_request {
+	bool is_valid() const;
+
+	std::vector<dnet_id> keys;
+	std::vector<dnet_write_request> requests;
+
+	dnet_time deadline;
+};
+
+/*
+ * Predicate over record's metadata applied by the iterator with DNET_IFLAGS_FILTER,
+ * record matches if all conditions are true.
+ */
+struct dnet_iterator_filter {
+	/* (user_flags & user_flags_mask) == user_flags_value */
+	uint64_t user_flags_mask{0};
+	uint64_t user_flags_value{0};
+	/* (record_flags & record_flags_mask) == record_flags_value */
+	uint64_t record_flags_mask{0};
+	uint64_t record_flags_value{0};
+	/* min_data_size <= data_size <= max_data_size, 0 max_data_size means no upper bound */
+	uint64_t min_data_size{0};
+	uint64_t max_data_size{0};
+	/* if json_key is not empty, top-level member json_key of record's json should be equal to json_value,
+	 * which is json representation of expected value
+	 */
+	std::string json_key;
+	std::string json_value;
+};
+
 struct dnet_iterator_request {
 	dnet_iterator_request();
 	dnet_iterator_request(uint32_t type, uint64_t flags,
@@ -121,6 +155,7 @@ struct dnet_iterator_request {
 	std::vector<dnet_iterator_range> key_ranges;
 	std::tuple<dnet_time, dnet_time> time_range;
 	std::vector<uint32_t> groups;
+	dnet_iterator_filter filter;
 };
 
 struct dnet_iterator_response {
@@ -144,6 +179,9 @@ struct dnet_iterator_response {
 	uint64_t read_data_size;
 	uint64_t data_offset;
 	uint64_t blob_id;
+
+	/* number of records skipped by the filter so far */
+	uint64_t filtered_keys;
 };
 
 struct dnet_server_send_request {
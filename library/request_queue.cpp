@@ -9,6 +9,7 @@
 #include "example/config.hpp"
 #include "logger.hpp"
 #include "library/backend.h"
+#include "library/protocol.hpp"
 
 static size_t dnet_id_hash(const dnet_id &key) {
 	return MurmurHash64A(reinterpret_cast<const char *>(&key), sizeof(key.id) + sizeof(key.group_id), 0);
@@ -22,6 +23,64 @@ static const dnet_cmd *dnet_io_req_get_cmd(const dnet_io_req *r) {
 	return dnet_io_req_get_cmd(const_cast<dnet_io_req *>(r));
 }
 
+static uint64_t dnet_io_req_queue_timeout(const dnet_io_req *r) {
+	auto cmd = dnet_io_req_get_cmd(r);
+	auto node = r->st->n;
+
+	// ignore timeout for replies and commands with DNET_FLAGS_NO_QUEUE_TIMEOUT;
+	if (cmd->flags & (DNET_FLAGS_NO_QUEUE_TIMEOUT | DNET_FLAGS_REPLY))
+		return 0;
+
+	if (cmd->backend_id < 0)
+		return dnet_node_get_queue_timeout(node);
+
+	return dnet_backend_get_queue_timeout(node, cmd->backend_id);
+}
+
+static bool dnet_io_req_expired(const dnet_io_req *r, uint64_t timeout) {
+	if (!timeout)
+		return false;
+
+	if (r->st->__need_exit)
+		return true;
+
+	return r->queue_time > timeout;
+}
+
+/*
+ * Reads whose parameters affecting the reply are the same, they can be served by a single backend read.
+ * Deadline doesn't change the reply, so it isn't compared.
+ */
+static bool dnet_io_req_get_read_request(const dnet_io_req *r, ioremap::elliptics::dnet_read_request &request) {
+	auto cmd = dnet_io_req_get_cmd(r);
+	if (r->io_req_type != DNET_IO_REQ_OLD_PROTOCOL || cmd->cmd != DNET_CMD_READ_NEW ||
+	    (cmd->flags & (DNET_FLAGS_REPLY | DNET_FLAGS_NOLOCK)))
+		return false;
+
+	try {
+		ioremap::elliptics::deserialize(ioremap::elliptics::data_pointer::from_raw(r->data, cmd->size),
+		                                request);
+	} catch (const std::exception &) {
+		return false;
+	}
+	return true;
+}
+
+static bool dnet_io_req_same_read(const dnet_io_req *leader, const ioremap::elliptics::dnet_read_request &request,
+                                  const dnet_io_req *r) {
+	ioremap::elliptics::dnet_read_request other;
+	if (!dnet_io_req_get_read_request(r, other))
+		return false;
+
+	auto leader_cmd = dnet_io_req_get_cmd(leader);
+	auto cmd = dnet_io_req_get_cmd(r);
+	return cmd->backend_id == leader_cmd->backend_id &&
+	       other.ioflags == request.ioflags &&
+	       other.read_flags == request.read_flags &&
+	       other.data_offset == request.data_offset &&
+	       other.data_size == request.data_size;
+}
+
 dnet_request_queue::dnet_request_queue(bool lifo, size_t queue_limit)
 : m_queue_size(0)
 , m_queue_limit(queue_limit)
@@ -127,27 +186,9 @@ dnet_io_req *dnet_request_queue::pop_request(dnet_work_io *wio, const char *thre
 	auto cmd = dnet_io_req_get_cmd(r);
 	auto st = r->st;
 	auto node = st->n;
-	const auto timeout = [&]() -> uint64_t {
-		// ignore timeout for replies and commands with DNET_FLAGS_NO_QUEUE_TIMEOUT;
-		if (cmd->flags & (DNET_FLAGS_NO_QUEUE_TIMEOUT | DNET_FLAGS_REPLY))
-			return 0;
-
-		if (cmd->backend_id < 0)
-			return dnet_node_get_queue_timeout(node);
-
-		return dnet_backend_get_queue_timeout(node, cmd->backend_id);
-	}();
-	const auto expired = [&]() {
-		if (!timeout)
-			return false;
-
-		if (st->__need_exit)
-			return true;
-
-		return r->queue_time > timeout;
-	}();
+	const auto timeout = dnet_io_req_queue_timeout(r);
 
-	if (!expired)
+	if (!dnet_io_req_expired(r, timeout))
 		return r;
 
 	{
@@ -268,6 +309,55 @@ void dnet_request_queue::release_request(const dnet_io_req *req)
 	}
 }
 
+size_t dnet_request_queue::take_coalesced_reads(dnet_work_io *wio, const dnet_io_req *leader,
+                                                struct list_head *followers)
+{
+	ioremap::elliptics::dnet_read_request request;
+	if (!dnet_io_req_get_read_request(leader, request))
+		return 0;
+
+	const auto &id = dnet_io_req_get_cmd(leader)->id;
+	size_t count = 0;
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+
+	/*
+	 * Requests of the locked key are either moved to request_list of the thread which owns the lock or
+	 * still wait in the queue. Requests must be processed in the order they are received,
+	 * so coalescing stops at the first request of the key which can't be served by @leader's read.
+	 */
+	auto take = [&] (dnet_io_req *r) {
+		if (!dnet_io_req_same_read(leader, request, r))
+			return false;
+
+		r->queue_time = DIFF_TIMESPEC(r->queue_start_ts, ts);
+		if (dnet_io_req_expired(r, dnet_io_req_queue_timeout(r)))
+			return false;
+
+		list_move_tail(&r->req_entry, followers);
+		--m_queue_size;
+		++count;
+		return true;
+	};
+
+	std::unique_lock<std::mutex> lock(m_queue_mutex);
+
+	dnet_io_req *it, *tmp;
+	list_for_each_entry_safe(it, tmp, &wio->request_list, req_entry) {
+		if (!take(it))
+			return count;
+	}
+
+	list_for_each_entry_safe(it, tmp, &m_queue, req_entry) {
+		if (dnet_id_cmp(&dnet_io_req_get_cmd(it)->id, &id))
+			continue;
+		if (!take(it))
+			break;
+	}
+
+	return count;
+}
+
 void dnet_request_queue::lock_key(const dnet_id *id)
 {
 	std::unique_lock<std::mutex> lock(m_locks_mutex);
@@ -392,6 +482,22 @@ struct dnet_io_req *dnet_pop_request(struct dnet_work_io *wio, const char *threa
 	return wio->pool->request_queue->pop_request(wio, thread_stat_id);
 }
 
+size_t dnet_take_coalesced_reads(struct dnet_work_io *wio, const struct dnet_io_req *leader,
+                                 struct list_head *followers, const char *thread_stat_id) {
+	const size_t count = wio->pool->request_queue->take_coalesced_reads(wio, leader, followers);
+	if (!count)
+		return 0;
+
+	HANDY_COUNTER_DECREMENT("io.input.queue.size", count);
+	FORMATTED(HANDY_COUNTER_DECREMENT, ("pool.%s.queue.size", thread_stat_id), count);
+
+	struct dnet_io_req *r;
+	list_for_each_entry(r, followers, req_entry) {
+		FORMATTED(HANDY_TIMER_STOP, ("pool.%s.queue.wait_time", thread_stat_id), (uint64_t)r);
+	}
+	return count;
+}
+
 void dnet_release_request(struct dnet_work_io *wio, const struct dnet_io_req *req) {
 	wio->pool->request_queue->release_request(req);
 }
@@ -57,6 +57,13 @@ public:
 	 */
 	void unlock_key(const dnet_id *id);
 
+	/*!
+	 * Detaches READ_NEW requests identical to processed \a leader which wait for the key still locked by it
+	 * and moves them into \a followers, so they can be served by the \a leader's read under the same lock.
+	 * Returns number of detached requests.
+	 */
+	size_t take_coalesced_reads(dnet_work_io *wio, const dnet_io_req *leader, struct list_head *followers);
+
 	/*!
 	 * Returns size of the queue
 	 */
@@ -126,6 +133,8 @@ void dnet_request_queue_destroy(struct dnet_work_pool *pool);
 
 void dnet_push_request(struct dnet_work_pool *pool, struct dnet_io_req *req, const char *thread_stat_id);
 struct dnet_io_req *dnet_pop_request(struct dnet_work_io *wio, const char *thread_stat_id);
+size_t dnet_take_coalesced_reads(struct dnet_work_io *wio, const struct dnet_io_req *leader,
+                                 struct list_head *followers, const char *thread_stat_id);
 void dnet_release_request(struct dnet_work_io *wio, const struct dnet_io_req *req);
 
 size_t dnet_get_pool_queue_size(struct dnet_work_pool *pool);
@@ -102,6 +102,7 @@ struct dnet_node *dnet_server_node_create(struct dnet_config_data *cfg_data)
 		goto err_out_exit;
 
 	n->config_data = cfg_data;
+	n->binary_access_log = cfg_data->binary_access_log;
 
 	err = dnet_backends_init(n);
 	if (err)
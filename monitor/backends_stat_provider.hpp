@@ -37,6 +37,10 @@ public:
 	                rapidjson::Value &value,
 	                rapidjson::Document::AllocatorType &allocator) const override;
 
+	uint64_t categories() const override {
+		return DNET_MONITOR_IO | DNET_MONITOR_CACHE | DNET_MONITOR_BACKEND;
+	}
+
 private:
 	struct dnet_node *m_node;
 };
@@ -0,0 +1,140 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "encoding.hpp"
+
+#include <iterator>
+
+#include <msgpack.hpp>
+
+#include "elliptics/packet.h"
+
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+namespace ioremap { namespace monitor {
+
+template <typename Stream>
+static void pack_value(msgpack::packer<Stream> &packer, const rapidjson::Value &value) {
+	switch (value.GetType()) {
+	case rapidjson::kNullType:
+		packer.pack_nil();
+		break;
+	case rapidjson::kFalseType:
+		packer.pack_false();
+		break;
+	case rapidjson::kTrueType:
+		packer.pack_true();
+		break;
+	case rapidjson::kObjectType:
+		packer.pack_map(std::distance(value.MemberBegin(), value.MemberEnd()));
+		for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+			pack_value(packer, it->name);
+			pack_value(packer, it->value);
+		}
+		break;
+	case rapidjson::kArrayType:
+		packer.pack_array(value.Size());
+		for (auto it = value.Begin(); it != value.End(); ++it) {
+			pack_value(packer, *it);
+		}
+		break;
+	case rapidjson::kStringType:
+		packer.pack_raw(value.GetStringLength());
+		packer.pack_raw_body(value.GetString(), value.GetStringLength());
+		break;
+	case rapidjson::kNumberType:
+		if (value.IsInt())
+			packer.pack_int(value.GetInt());
+		else if (value.IsUint())
+			packer.pack_unsigned_int(value.GetUint());
+		else if (value.IsInt64())
+			packer.pack_int64(value.GetInt64());
+		else if (value.IsUint64())
+			packer.pack_uint64(value.GetUint64());
+		else
+			packer.pack_double(value.GetDouble());
+		break;
+	}
+}
+
+std::string encode(const rapidjson::Value &value, uint32_t format) {
+	if (format == DNET_MONITOR_FORMAT_MSGPACK) {
+		msgpack::sbuffer buffer;
+		msgpack::packer<msgpack::sbuffer> packer(buffer);
+		pack_value(packer, value);
+		return std::string(buffer.data(), buffer.size());
+	}
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	value.Accept(writer);
+	return std::string(buffer.GetString(), buffer.Size());
+}
+
+report_writer::report_writer(uint32_t format)
+: m_format(format) {}
+
+void report_writer::add(const std::string &name, const std::string &value) {
+	m_members.emplace_back(name, value);
+}
+
+std::string report_writer::finish() const {
+	size_t size = 2;
+	for (const auto &member : m_members) {
+		size += member.first.size() + member.second.size() + 8;
+	}
+
+	std::string result;
+	result.reserve(size);
+
+	if (m_format == DNET_MONITOR_FORMAT_MSGPACK) {
+		msgpack::sbuffer header;
+		msgpack::packer<msgpack::sbuffer> packer(header);
+		packer.pack_map(m_members.size());
+		result.append(header.data(), header.size());
+
+		for (const auto &member : m_members) {
+			msgpack::sbuffer name;
+			msgpack::packer<msgpack::sbuffer> name_packer(name);
+			name_packer.pack_raw(member.first.size());
+			name_packer.pack_raw_body(member.first.data(), member.first.size());
+			result.append(name.data(), name.size());
+			result.append(member.second);
+		}
+		return result;
+	}
+
+	result.push_back('{');
+	for (auto it = m_members.begin(); it != m_members.end(); ++it) {
+		if (it != m_members.begin())
+			result.push_back(',');
+
+		result.push_back('"');
+		for (const char c : it->first) {
+			if (c == '"' || c == '\\')
+				result.push_back('\\');
+			result.push_back(c);
+		}
+		result.append("\":");
+		result.append(it->second);
+	}
+	result.push_back('}');
+	return result;
+}
+
+}} /* namespace ioremap::monitor */
@@ -0,0 +1,63 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_ENCODING_HPP
+#define __DNET_MONITOR_ENCODING_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rapidjson/document.h"
+
+namespace ioremap { namespace monitor {
+
+/*!
+ * \internal
+ *
+ * Serializes \a value into DNET_MONITOR_FORMAT_* \a format
+ */
+std::string encode(const rapidjson::Value &value, uint32_t format);
+
+/*!
+ * \internal
+ *
+ * Assembles top-level statistics object from already serialized members,
+ * so cached parts of the report are concatenated instead of being rebuilt.
+ */
+class report_writer {
+public:
+	explicit report_writer(uint32_t format);
+
+	/*!
+	 * Adds member \a name with \a value serialized by encode() in the same format
+	 */
+	void add(const std::string &name, const std::string &value);
+
+	/*!
+	 * Returns serialized object with all added members
+	 */
+	std::string finish() const;
+
+private:
+	const uint32_t m_format;
+	std::vector<std::pair<std::string, std::string>> m_members;
+};
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_ENCODING_HPP */
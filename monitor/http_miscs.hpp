@@ -22,6 +22,8 @@
 
 #include <string>
 
+#include "elliptics/packet.h"
+
 namespace ioremap { namespace monitor {
 
 namespace status_strings {
@@ -40,18 +42,19 @@ const std::string list = R"(<html>
 		GET <a href='/stats'>/stats</a> - Retrieves in-process runtime statistics<br/>
 		GET <a href='/procfs'>/procfs</a> - Retrieves system statistics about process<br/>
 		GET <a href='/top'>/top</a> - Retrieves statistics of top keys ordered by generated traffic<br/>
+		Add ?format=msgpack to any of statistics requests to retrieve msgpack instead of json<br/>
 	</body>
 </html>)";
 }
 
 /*!
- * Generates HTTP response for @categories category with @content
+ * Generates HTTP response headers for @categories category with @content_size bytes of content
+ * encoded in @format
  */
-std::string make_reply(uint64_t categories, std::string content = "") {
+std::string make_reply_headers(uint64_t categories, uint32_t format, size_t content_size) {
 	std::ostringstream ret;
-	std::string content_type = "application/json";
+	std::string content_type = format == DNET_MONITOR_FORMAT_MSGPACK ? "application/x-msgpack" : "application/json";
 	if (categories == 0) {
-		content = content_strings::list;
 		content_type = "text/html";
 	}
 
@@ -59,8 +62,7 @@ std::string make_reply(uint64_t categories, std::string content = "") {
 	    << "Content-Type: " << content_type << "\r\n"
 	    << (categories != 0 ? "Content-Encoding: deflate\r\n" : "")
 	    << "Connection: close\r\n"
-	    << "Content-Length: " << content.size() << "\r\n\r\n"
-	    << content;
+	    << "Content-Length: " << content_size << "\r\n\r\n";
 
 	return ret.str();
 }
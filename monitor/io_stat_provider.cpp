@@ -34,6 +34,7 @@ static rapidjson::Value & fill_states_stats(struct dnet_node *n,
 	rb_for_each_entry(st, &n->empty_state_root, node_entry) {
 		rapidjson::Value state(rapidjson::kObjectType);
 		state.AddMember("send_queue_size", atomic_read(&st->send_queue_size), allocator);
+		state.AddMember("send_queue_bytes", atomic_read(&st->send_queue_bytes), allocator);
 		state.AddMember("la", st->la, allocator);
 		state.AddMember("free", (uint64_t)st->free, allocator);
 		state.AddMember("stall", st->stall, allocator);
@@ -56,6 +57,11 @@ void io_stat_provider::statistics(const request &request,
 
 	rapidjson::Value output(rapidjson::kObjectType);
 	output.AddMember("current_size", m_node->io->output_stats.list_size, allocator);
+	output.AddMember("current_bytes", atomic_read(&m_node->io->output_bytes), allocator);
+	output.AddMember("limit_bytes", m_node->io->output_limit, allocator);
+	output.AddMember("suspended_producers", m_node->io->output_suspended, allocator);
+	output.AddMember("queued_states", atomic_read(&m_node->io->output_states), allocator);
+	output.AddMember("suspended_clients", atomic_read(&m_node->io->output_suspended_clients), allocator);
 	value.AddMember("output", output, allocator);
 
 	rapidjson::Value states(rapidjson::kObjectType);
@@ -72,10 +78,13 @@ void dump_io_pool_stats(struct dnet_io_pool &io_pool,
                         rapidjson::Document::AllocatorType &allocator) {
 	rapidjson::Value blocking(rapidjson::kObjectType);
 	blocking.AddMember("current_size", dnet_get_pool_queue_size(io_pool.recv_pool.pool), allocator);
+	blocking.AddMember("coalesced_reads", atomic_read(&io_pool.recv_pool.pool->coalesced_reads), allocator);
 	value.AddMember("blocking", blocking, allocator);
 
 	rapidjson::Value nonblocking(rapidjson::kObjectType);
 	nonblocking.AddMember("current_size", dnet_get_pool_queue_size(io_pool.recv_pool_nb.pool), allocator);
+	nonblocking.AddMember("coalesced_reads", atomic_read(&io_pool.recv_pool_nb.pool->coalesced_reads),
+	                      allocator);
 	const auto mode = io_pool.recv_pool_nb.pool->mode == DNET_WORK_IO_MODE_LIFO ? "lifo" : "nonblocking";
 	value.AddMember(mode, nonblocking, allocator);
 }
@@ -35,6 +35,10 @@ public:
 	                rapidjson::Value &value,
 	                rapidjson::Document::AllocatorType &allocator) const override;
 
+	uint64_t categories() const override {
+		return DNET_MONITOR_IO;
+	}
+
 private:
 	dnet_node *m_node;
 };
@@ -59,6 +59,7 @@ std::unique_ptr<monitor_config> monitor_config::parse(const kora::config_t &moni
 	std::unique_ptr<monitor_config> cfg{new monitor_config()};
 
 	cfg->monitor_port = monitor.at<unsigned int>("port", 0);
+	cfg->snapshot_period_in_ms = monitor.at<unsigned int>("snapshot_period_in_ms", 0);
 
 	cfg->has_top = monitor.has("top");
 	if (cfg->has_top) {
@@ -244,6 +245,12 @@ int dnet_monitor_process_cmd(struct dnet_net_state *orig, struct dnet_cmd *cmd,
 	dnet_convert_monitor_stat_request(req);
 	static const std::string disabled_reply = ioremap::monitor::compress("{\"monitor_status\":\"disabled\"}");
 
+	if (req->format != DNET_MONITOR_FORMAT_JSON && req->format != DNET_MONITOR_FORMAT_MSGPACK) {
+		DNET_LOG_DEBUG(orig->n, "monitor: {}: {}: process MONITOR_STAT, invalid format: {}",
+		               dnet_state_dump_addr(orig), dnet_dump_id(&cmd->id), req->format);
+		return -EINVAL;
+	}
+
 	DNET_LOG_DEBUG(n, "monitor: {}: {}: process MONITOR_STAT, categories: {:x}, monitor: {:p}",
 	               dnet_state_dump_addr(orig), dnet_dump_id(&cmd->id), req->categories, (void *)n->monitor);
 
@@ -257,6 +264,7 @@ int dnet_monitor_process_cmd(struct dnet_net_state *orig, struct dnet_cmd *cmd,
 	}
 	
 	ioremap::monitor::request request(req->categories);
+	request.format = req->format;
 	uint32_t *backeds_ids_buff = static_cast<uint32_t *>(data + sizeof(struct dnet_monitor_stat_request));
 	for (size_t i = 0; i < req->backends_number; ++i) {
 		request.backends_ids.insert(dnet_bswap32(backeds_ids_buff[i]));
@@ -267,8 +275,8 @@ int dnet_monitor_process_cmd(struct dnet_net_state *orig, struct dnet_cmd *cmd,
 		return dnet_send_reply(orig, cmd, disabled_reply.c_str(), disabled_reply.size(), 0, /*context*/ NULL);
 
 	try {
-		auto json = real_monitor->get_statistics().report(request);
-		return dnet_send_reply(orig, cmd, &*json.begin(), json.size(), 0, /*context*/ nullptr);
+		auto report = real_monitor->get_statistics().report(request);
+		return dnet_send_reply(orig, cmd, report->data.data(), report->data.size(), 0, /*context*/ nullptr);
 	} catch(const std::exception &e) {
 		const std::string rep =
 		        ioremap::monitor::compress("{\"monitor_status\":\"failed: " + std::string(e.what()) + "\"}");
@@ -37,6 +37,7 @@ struct monitor_config {
 	size_t		top_length;
 	size_t		events_size;
 	int		period_in_seconds;
+	unsigned int	snapshot_period_in_ms;
 	std::string	handystats;
 
 	static std::unique_ptr<monitor_config> parse(const kora::config_t &monitor);
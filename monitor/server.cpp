@@ -70,7 +70,8 @@ private:
 
 	const std::string m_remote;
 	std::array<char, 1024> m_buffer;
-	std::string m_response;
+	std::string m_response_headers;
+	snapshot_ptr m_response;
 
 	std::chrono::time_point<std::chrono::system_clock> m_start_ts;
 	std::chrono::time_point<std::chrono::system_clock> m_recv_ts;
@@ -144,15 +145,21 @@ void handler::async_read() {
 		if (m_http_request.ready()) {
 			m_recv_ts = std::chrono::system_clock::now();
 			const auto request = parse_request();
-			m_response = make_reply(request.categories, [&]() {
-				if (request.categories == 0)
-					return std::string();
+			m_response = [&]() {
+				if (request.categories == 0) {
+					static const auto list = std::make_shared<snapshot>(
+						snapshot{0, std::chrono::steady_clock::time_point(), content_strings::list});
+					return snapshot_ptr(list);
+				}
 
 				DNET_LOG_DEBUG(m_monitor.node(), "monitor: http-server: "
-				                                 "got statistics request for categories: {:x} from: {}",
-				               request.categories, m_remote);
+				                                 "got statistics request for categories: {:x}, "
+				                                 "format: {} from: {}",
+				               request.categories, request.format, m_remote);
 				return m_monitor.get_statistics().report(request);
-			}());
+			}();
+			m_response_headers = make_reply_headers(request.categories, request.format,
+			                                        m_response->data.size());
 
 			m_collect_ts = std::chrono::system_clock::now();
 
@@ -165,11 +172,17 @@ void handler::async_read() {
 
 void handler::async_write() {
 	DNET_LOG_DEBUG(m_monitor.node(), "monitor: http-server: send requested statistics: started: {}, size: {}",
-	               m_remote, m_response.size());
+	               m_remote, m_response_headers.size() + m_response->data.size());
 
 	auto self(shared_from_this());
 
-	boost::asio::async_write(m_socket, boost::asio::buffer(m_response), [self,
+	/* cached report is shared with other requests, so it is sent as is without copying into response */
+	const std::array<boost::asio::const_buffer, 2> buffers = {{
+		boost::asio::buffer(m_response_headers),
+		boost::asio::buffer(m_response->data)
+	}};
+
+	boost::asio::async_write(m_socket, buffers, [self,
 	                                                                     this](const boost::system::error_code &err,
 	                                                                           const long unsigned int &size) {
 		const auto finish_ts = std::chrono::system_clock::now();
@@ -245,6 +258,17 @@ request handler::parse_request() {
 		return request();
 	}
 
+	const auto format_item = m_http_request.query().find("format");
+	if (format_item != m_http_request.query().end()) {
+		if (format_item->second == "msgpack") {
+			req.format = DNET_MONITOR_FORMAT_MSGPACK;
+		} else if (format_item->second != "json") {
+			DNET_LOG_ERROR(m_monitor.node(), "monitor: http-server: Unknown format: {}",
+			               format_item->second);
+			return request();
+		}
+	}
+
 	const auto backends_item = m_http_request.query().find("backends");
 	if (backends_item != m_http_request.query().end()) {
 		std::string id_list = backends_item->second;
@@ -0,0 +1,100 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "snapshot.hpp"
+
+namespace ioremap { namespace monitor {
+
+/*
+ * Number of cached snapshots after which expired ones are dropped.
+ * Keys depend on requested categories and backends, so the set of them is not bounded by itself.
+ */
+static const size_t max_snapshots_number = 1024;
+
+snapshot_cache::snapshot_cache(std::chrono::milliseconds period)
+: m_period(period)
+, m_version(0) {}
+
+snapshot_ptr snapshot_cache::get(const std::string &key, const builder_t &builder) {
+	std::unique_lock<std::mutex> guard(m_mutex);
+
+	auto it = m_entries.find(key);
+	if (it == m_entries.end()) {
+		if (m_entries.size() >= max_snapshots_number)
+			prune(std::chrono::steady_clock::now());
+		it = m_entries.emplace(key, std::make_shared<entry>()).first;
+	}
+	/* entry can be pruned from the map while we are waiting, so keep own reference */
+	auto item = it->second;
+
+	/*
+	 * Any build completed after this request has arrived is fresh enough for it,
+	 * even if the period is zero.
+	 */
+	const uint64_t completions = item->completions;
+	while (true) {
+		if (item->snapshot &&
+		    (item->completions != completions ||
+		     is_fresh(*item->snapshot, std::chrono::steady_clock::now()))) {
+			return item->snapshot;
+		}
+
+		if (!item->building)
+			break;
+
+		m_cond.wait(guard);
+	}
+
+	item->building = true;
+	const uint64_t version = ++m_version;
+	guard.unlock();
+
+	auto result = std::make_shared<snapshot>();
+	result->version = version;
+	result->created = std::chrono::steady_clock::now();
+	try {
+		result->data = builder(version);
+	} catch (...) {
+		guard.lock();
+		item->building = false;
+		m_cond.notify_all();
+		throw;
+	}
+
+	guard.lock();
+	item->snapshot = result;
+	item->building = false;
+	++item->completions;
+	m_cond.notify_all();
+	return result;
+}
+
+bool snapshot_cache::is_fresh(const snapshot &snapshot, const std::chrono::steady_clock::time_point &now) const {
+	return now - snapshot.created < m_period;
+}
+
+void snapshot_cache::prune(const std::chrono::steady_clock::time_point &now) {
+	for (auto it = m_entries.begin(); it != m_entries.end();) {
+		const auto &item = it->second;
+		if (!item->building && (!item->snapshot || !is_fresh(*item->snapshot, now)))
+			it = m_entries.erase(it);
+		else
+			++it;
+	}
+}
+
+}} /* namespace ioremap::monitor */
@@ -0,0 +1,91 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_SNAPSHOT_HPP
+#define __DNET_MONITOR_SNAPSHOT_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ioremap { namespace monitor {
+
+/*!
+ * \internal
+ *
+ * Serialized immutable piece of statistics
+ */
+struct snapshot {
+	uint64_t				version;
+	std::chrono::steady_clock::time_point	created;
+	std::string				data;
+};
+
+typedef std::shared_ptr<const snapshot> snapshot_ptr;
+
+/*!
+ * \internal
+ *
+ * Cache of serialized statistics snapshots.
+ * Snapshot is rebuilt on demand when it becomes older than the period. Concurrent requests
+ * of the same snapshot wait for the single build and share its result, so even with zero period
+ * simultaneous scrapes of the node are served by one statistics collection.
+ */
+class snapshot_cache {
+public:
+	typedef std::function<std::string (uint64_t version)> builder_t;
+
+	/*!
+	 * Constructor: \a period - maximum age of snapshot which is returned without rebuild
+	 */
+	explicit snapshot_cache(std::chrono::milliseconds period);
+
+	/*!
+	 * Returns snapshot stored by \a key. Builds it via \a builder if it is absent or expired.
+	 * Exceptions thrown by \a builder are propagated to the caller which has started the build.
+	 */
+	snapshot_ptr get(const std::string &key, const builder_t &builder);
+
+	std::chrono::milliseconds period() const { return m_period; }
+
+private:
+	struct entry {
+		snapshot_ptr	snapshot;
+		bool		building;
+		uint64_t	completions;
+
+		entry() : building(false), completions(0) {}
+	};
+
+	bool is_fresh(const snapshot &snapshot, const std::chrono::steady_clock::time_point &now) const;
+	void prune(const std::chrono::steady_clock::time_point &now);
+
+	const std::chrono::milliseconds m_period;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	uint64_t m_version;
+	std::unordered_map<std::string, std::shared_ptr<entry>> m_entries;
+};
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_SNAPSHOT_HPP */
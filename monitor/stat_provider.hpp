@@ -24,16 +24,20 @@
 
 #include "rapidjson/document.h"
 
+#include "elliptics/packet.h"
+
 namespace ioremap { namespace monitor {
 /*!
- * Struct that stores statistics categories and ids of requested backends
+ * Struct that stores statistics categories, ids of requested backends
+ * and encoding (DNET_MONITOR_FORMAT_*) of the report
  */
 struct request {
 	uint64_t categories;
 	std::unordered_set<uint32_t> backends_ids;
+	uint32_t format;
 
-	request(): categories(0) {}
-	request(uint64_t req_categories): categories(req_categories) {}
+	request(): categories(0), format(DNET_MONITOR_FORMAT_JSON) {}
+	request(uint64_t req_categories): categories(req_categories), format(DNET_MONITOR_FORMAT_JSON) {}
 };
 
 /*!
@@ -57,6 +61,17 @@ public:
 	                        rapidjson::Value &value,
 	                        rapidjson::Document::AllocatorType &allocator) const = 0;
 
+	/*!
+	 * \internal
+	 *
+	 * Returns mask of categories which affect the provider's statistics.
+	 * Statistics are not requested from the provider if none of them is requested, and
+	 * cached snapshot of the provider is shared between requests with equal masked categories
+	 */
+	virtual uint64_t categories() const {
+		return DNET_MONITOR_ALL;
+	}
+
 	/*!
 	 * \internal
 	 *
@@ -19,12 +19,15 @@
 
 #include "statistics.hpp"
 
+#include <algorithm>
+
 #include <blackhole/attribute.hpp>
 
 #include "monitor.hpp"
 #include "cache/cache.hpp"
 #include "elliptics/backends.h"
 #include "monitor/compress.hpp"
+#include "monitor/encoding.hpp"
 
 //FIXME: elliptics uses rather modified version of rapidjson
 // which is partially incompatible with a stock version used by
@@ -187,7 +190,14 @@ void statistics::command_counter(const int cmd,
 	m_command_stats.command_counter(cmd, trans, err, cache, size, time);
 }
 
-statistics::statistics(monitor& mon, struct dnet_config *cfg) : m_monitor(mon)
+static std::chrono::milliseconds snapshot_period(dnet_node *n) {
+	const auto monitor_cfg = get_monitor_config(n);
+	return std::chrono::milliseconds(monitor_cfg ? monitor_cfg->snapshot_period_in_ms : 0);
+}
+
+statistics::statistics(monitor& mon, struct dnet_config *cfg)
+: m_monitor(mon)
+, m_snapshots(snapshot_period(mon.node()))
 {
 	(void) cfg;
 	const auto monitor_cfg = get_monitor_config(mon.node());
@@ -202,20 +212,47 @@ void statistics::add_provider(stat_provider *stat, const std::string &name)
 	m_stat_providers.insert(make_pair(name, std::shared_ptr<stat_provider>(stat)));
 }
 
-inline std::string convert_report(const rapidjson::Document &report)
+/*
+ * Builds key of cached snapshot: snapshots are equal for equal categories, backends and format
+ */
+static std::string snapshot_key(const std::string &name, uint64_t categories, const request &request) {
+	std::vector<uint32_t> backends(request.backends_ids.begin(), request.backends_ids.end());
+	std::sort(backends.begin(), backends.end());
+
+	std::ostringstream key;
+	key << name << ':' << std::hex << categories << ':' << request.format << ':';
+	for (const auto &backend : backends) {
+		key << backend << ',';
+	}
+	return key.str();
+}
+
+snapshot_ptr statistics::report(const request &request)
+{
+	return m_snapshots.get(snapshot_key("report", request.categories, request),
+	                       [&](uint64_t version) { return build_report(request, version); });
+}
+
+snapshot_ptr statistics::section(const std::string &name, uint64_t categories, const request &request,
+                                 const std::function<void (rapidjson::Value &,
+                                                           rapidjson::Document::AllocatorType &)> &fill)
 {
-	rapidjson::StringBuffer buffer;
-	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-	report.Accept(writer);
-	return compress(buffer.GetString());
+	return m_snapshots.get(snapshot_key(name, categories, request), [&](uint64_t) {
+		rapidjson::Document document;
+		fill(document, document.GetAllocator());
+		return encode(document, request.format);
+	});
 }
 
-std::string statistics::report(const request &request)
+std::string statistics::build_report(const request &request, uint64_t version)
 {
-	rapidjson::Document report;
-	DNET_LOG_INFO(m_monitor.node(), "monitor: collecting statistics for categories: {:x}", request.categories);
-	report.SetObject();
-	auto &allocator = report.GetAllocator();
+	DNET_LOG_INFO(m_monitor.node(), "monitor: collecting statistics for categories: {:x}, format: {}, "
+	                                "snapshot: {}",
+	              request.categories, request.format, version);
+
+	rapidjson::Document header;
+	header.SetObject();
+	auto &allocator = header.GetAllocator();
 
 	dnet_time time;
 	dnet_current_time(&time);
@@ -223,46 +260,68 @@ std::string statistics::report(const request &request)
 	rapidjson::Value timestamp(rapidjson::kObjectType);
 	timestamp.AddMember("tv_sec", time.tsec, allocator);
 	timestamp.AddMember("tv_usec", time.tnsec / 1000, allocator);
-	report.AddMember("timestamp", timestamp, allocator);
-	report.AddMember("string_timestamp", dnet_print_time(&time), allocator);
 
-	report.AddMember("monitor_status", "enabled", allocator);
-	report.AddMember("categories", request.categories, allocator);
+	report_writer writer(request.format);
+	writer.add("timestamp", encode(timestamp, request.format));
+	writer.add("string_timestamp", encode(rapidjson::Value(dnet_print_time(&time), allocator), request.format));
+	writer.add("monitor_status", encode(rapidjson::Value("enabled"), request.format));
+	writer.add("categories", encode(rapidjson::Value(request.categories), request.format));
+	writer.add("snapshot_version", encode(rapidjson::Value(version), request.format));
 
 	if (request.categories & DNET_MONITOR_COMMANDS) {
-		rapidjson::Value commands_value(rapidjson::kObjectType);
-		m_command_stats.commands_report(m_monitor.node(), commands_value, allocator);
-
-		rapidjson::Value clients_stat(rapidjson::kObjectType);
-		clients_stat_json(m_monitor.node(), clients_stat, allocator);
-		commands_value.AddMember("clients", clients_stat, allocator);
-
-		report.AddMember("commands", commands_value, allocator);
+		auto commands = section("commands", DNET_MONITOR_COMMANDS, request,
+		                        [&](rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+			value.SetObject();
+			m_command_stats.commands_report(m_monitor.node(), value, allocator);
+
+			rapidjson::Value clients_stat(rapidjson::kObjectType);
+			clients_stat_json(m_monitor.node(), clients_stat, allocator);
+			value.AddMember("clients", clients_stat, allocator);
+		});
+		writer.add("commands", commands->data);
 	}
 
 	if (request.categories & DNET_MONITOR_STATS) {
 #if defined(HAVE_HANDYSTATS) && !defined(HANDYSTATS_DISABLE)
-		rapidjson::Document stats(&allocator);
-		stats.Parse<0>(HANDY_JSON_DUMP().c_str());
-		report.AddMember("stats", static_cast<rapidjson::Value &>(stats), allocator);
+		auto stats = section("stats", DNET_MONITOR_STATS, request,
+		                     [&](rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+			rapidjson::Document stats(&allocator);
+			stats.Parse<0>(HANDY_JSON_DUMP().c_str());
+			value = static_cast<rapidjson::Value &>(stats);
+		});
+		writer.add("stats", stats->data);
 #else
-		report.AddMember("__stats__", "stats subsystem disabled at compile time", allocator);
+		writer.add("__stats__", encode(rapidjson::Value("stats subsystem disabled at compile time"),
+		                               request.format));
 #endif
 	}
 
 	std::unique_lock<std::mutex> guard(m_provider_mutex);
-	for (auto &item : m_stat_providers) {
+	auto providers = m_stat_providers;
+	guard.unlock();
+
+	for (auto &item : providers) {
 		const auto &provider_name = item.first;
 		const auto &provider = item.second;
 
-		rapidjson::Value value;
-		provider->statistics(request, value, allocator);
-		report.AddMember(provider_name.c_str(), allocator, value, allocator);
+		const uint64_t categories = request.categories & provider->categories();
+		if (!categories) {
+			writer.add(provider_name, encode(rapidjson::Value(), request.format));
+			continue;
+		}
+
+		auto value = section("provider:" + provider_name, categories, request,
+		                     [&](rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+			ioremap::monitor::request provider_request(request);
+			provider_request.categories = categories;
+			provider->statistics(provider_request, value, allocator);
+		});
+		writer.add(provider_name, value->data);
 	}
 
-	DNET_LOG_DEBUG(m_monitor.node(), "monitor: finished generating json statistics for categories: {:x}",
+	DNET_LOG_DEBUG(m_monitor.node(), "monitor: finished generating statistics for categories: {:x}",
 	               request.categories);
-	return convert_report(report);
+	return compress(writer.finish());
 }
 
 }} /* namespace ioremap::monitor */
@@ -31,6 +31,7 @@
 #include "library/elliptics.h"
 
 #include "monitor.h"
+#include "snapshot.hpp"
 #include "stat_provider.hpp"
 #include "top.hpp"
 
@@ -155,11 +156,12 @@ public:
 	/*!
 	 * \internal
 	 *
-	 * Generates and returns json statistics for @request
+	 * Returns compressed statistics for @request encoded in @request.format
 	 * For that statistics will interview all external statistics provider
-	 * which supports this @request
+	 * which supports this @request. Report and each of its parts are cached
+	 * for the configured snapshot period and shared between concurrent requests.
 	 */
-	std::string report(const request &request);
+	snapshot_ptr report(const request &request);
 
 	/*!
 	 * \internal
@@ -186,6 +188,22 @@ public:
 	typedef std::shared_ptr<top_stats> top_stats_ptr;
 	top_stats_ptr get_top_stats() const { return m_top_stats; }
 private:
+	/*!
+	 * \internal
+	 *
+	 * Builds compressed report for @request from cached parts
+	 */
+	std::string build_report(const request &request, uint64_t version);
+
+	/*!
+	 * \internal
+	 *
+	 * Returns serialized part @name of the report which depends only on @categories of @request
+	 */
+	snapshot_ptr section(const std::string &name, uint64_t categories, const request &request,
+	                     const std::function<void (rapidjson::Value &,
+	                                               rapidjson::Document::AllocatorType &)> &fill);
+
 	/*!
 	 * \internal
 	 *
@@ -217,6 +235,13 @@ private:
 	std::map<std::string, std::shared_ptr<stat_provider>> m_stat_providers;
 
 	top_stats_ptr m_top_stats;
+
+	/*!
+	 * \internal
+	 *
+	 * Cached reports and their parts
+	 */
+	snapshot_cache m_snapshots;
 };
 
 }} /* namespace ioremap::monitor */
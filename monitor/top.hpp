@@ -134,6 +134,10 @@ public:
 	                rapidjson::Value &value,
 	                rapidjson::Document::AllocatorType &allocator) const override;
 
+	uint64_t categories() const override {
+		return DNET_MONITOR_TOP;
+	}
+
 private:
 	std::shared_ptr<top_stats> m_top_stats;
 };
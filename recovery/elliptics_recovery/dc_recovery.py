@@ -19,10 +19,12 @@ import logging.handlers
 import os
 import sys
 import threading
+import time
 import traceback
 import weakref
 
 from elliptics_recovery.dc_server_send import ServerSendRecovery
+from elliptics_recovery.etime import Time
 from elliptics_recovery.utils.misc import RecoverStat
 from elliptics_recovery.utils.misc import WindowedRecovery
 from elliptics_recovery.utils.misc import elliptics_create_node
@@ -465,6 +467,50 @@ def cleanup(ctx):
     del ctx.rest_file
 
 
+def native_recover(ctx, node):
+    '''
+    Recovers keys of bucket files and rest_keys by native dc recovery engine
+    (elliptics.core.newapi.dc_recover) which runs without GIL and applies its counters to ctx.stats.
+    '''
+    ctx.rest_file.flush()
+    for f in ctx.bucket_files.itervalues():
+        f.flush()
+    ctx.corrupted_keys.flush()
+
+    prepare_timeout = ctx.prepare_timeout
+    if isinstance(prepare_timeout, Time):
+        prepare_timeout = prepare_timeout.to_etime()
+
+    start_time = time.time()
+    result, stats = elliptics.core.newapi.dc_recover(node=node,
+                                                     groups=ctx.groups,
+                                                     ro_groups=list(ctx.ro_groups),
+                                                     tmp_dir=ctx.tmp_dir,
+                                                     bucket_order=[] if ctx.no_server_send else ctx.bucket_order,
+                                                     batch_size=ctx.batch_size,
+                                                     chunk_size=ctx.chunk_size,
+                                                     data_flow_rate=ctx.data_flow_rate,
+                                                     attempts=ctx.attempts,
+                                                     chunk_write_timeout=ctx.chunk_write_timeout,
+                                                     chunk_commit_timeout=ctx.chunk_commit_timeout,
+                                                     prepare_timeout=prepare_timeout,
+                                                     trace_id=ctx.trace_id,
+                                                     safe=ctx.safe,
+                                                     dry_run=ctx.dry_run)
+
+    for name, value in stats['main'].iteritems():
+        ctx.stats.counter(name, value)
+    for container in ('recover', 'commands', 'commands_by_groups'):
+        for name, value in stats[container].iteritems():
+            ctx.stats[container].counter(name, value)
+
+    elapsed = time.time() - start_time
+    if elapsed > 0:
+        ctx.stats['recover'].set_counter('recovery_speed', round(stats['processed_keys'] / elapsed, 2))
+    ctx.stats['recover'].set_counter('recovers_in_progress', 0)
+    return result
+
+
 def recover(ctx):
     stats = ctx.stats['recover']
 
@@ -476,8 +522,11 @@ def recover(ctx):
                                  net_thread_num=4,  # TODO(shaitan): why 4?
                                  io_thread_num=24,  # TODO(shaitan): why 24?
                                  remotes=ctx.remotes)
-    result = ServerSendRecovery(ctx, node).recover()
-    result &= WindowedDC(ctx, node).run()
+    if ctx.native_recover:
+        result = native_recover(ctx, node)
+    else:
+        result = ServerSendRecovery(ctx, node).recover()
+        result &= WindowedDC(ctx, node).run()
     cleanup(ctx)
     stats.timer('recover', 'finished')
 
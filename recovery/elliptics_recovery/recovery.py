@@ -96,6 +96,7 @@ def main(options, args):
     ctx.custom_recover = options.custom_recover
     ctx.no_meta = options.no_meta and (options.timestamp is None)
     ctx.no_server_send = options.no_server_send
+    ctx.native_recover = options.native_recover
     ctx.user_flags_set = frozenset(int(user_flags) for user_flags in options.user_flags_set)
 
     try:
@@ -438,6 +439,9 @@ def run(args=None):
     parser.add_option('-U', '--no-server-send', action="store_true", dest="no_server_send", default=False,
                       help=('Do not use server-send for recovery. Disabling recovery via server-send useful '
                             'if there is no network connection between groups'))
+    parser.add_option('--native-recover', action="store_true", dest="native_recover", default=False,
+                      help=('Recover keys by native dc recovery engine which recovers keys asynchronously '
+                            'without python overhead. Used only by dc recovery'))
     parser.add_option('--user-flags', action='append', dest='user_flags_set', default=[],
                       help='Recover key if at least one replica has user_flags from specified user_flags_set')
     parser.add_option('--data-flow-rate', action='store', dest='data_flow_rate', default=10,
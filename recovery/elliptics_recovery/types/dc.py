@@ -25,7 +25,7 @@ import elliptics
 
 from ..dc_recovery import recover
 from ..etime import Time
-from ..iterator import Iterator, MergeData, IteratorResult
+from ..iterator import Iterator, IteratorResult
 from ..range import IdRange
 from ..utils.misc import elliptics_create_node, dump_key_data, KeyInfo, load_key_data
 
@@ -138,8 +138,11 @@ def skip_key_data(ctx, key_data):
     return all(same_meta(info, first) for info in key_data[1])
 
 
-def merged_results(ctx, results):
-    import heapq
+def merged_results(ctx, range_id, results):
+    """
+    Merges sorted iterator results of all groups by native IteratorResultMerger
+    and yields only keys that need recovery
+    """
     results = [IteratorResult.load_filename(filename=r[0],
                                             address=r[1],
                                             backend_id=r[2],
@@ -148,31 +151,24 @@ def merged_results(ctx, results):
                                             tmp_dir=ctx.tmp_dir)
                for r in results]
 
-    heap = []
+    merger = elliptics.core.newapi.IteratorResultMerger()
     for r in results:
-        try:
-            heapq.heappush(heap, MergeData(r, None))
-        except StopIteration:
-            pass
-
-    while len(heap):
-        min_data = heapq.heappop(heap)
-        key_data = (min_data.key, [min_data.key_info])
-        same_datas = [min_data]
-        while len(heap) and min_data.key == heap[0].key:
-            key_data[1].append(heap[0].key_info)
-            same_datas.append(heapq.heappop(heap))
-
-        # skip keys that already exist and equal in all groups
-        if not skip_key_data(ctx, key_data):
-            yield key_data
+        if r:
+            merger.add_source(r.container, r.address.host, r.address.port, r.address.family,
+                              r.backend_id, r.group_id)
+
+    filename = os.path.join(ctx.tmp_dir, 'keys_%d' % (range_id))
+    stats = merger.merge(filename, ctx.groups, ctx.user_flags_set or ())
+    log.debug("Merged iteration results of range: {0}: total keys: {1}, keys to recover: {2}, "
+              "missing keys (group -> count): {3}, stale keys (group -> count): {4}"
+              .format(range_id, stats['total_keys'], stats['written_keys'],
+                      stats['missing_keys'], stats['stale_keys']))
 
-        for i in same_datas:
-            try:
-                i.next()
-                heapq.heappush(heap, i)
-            except StopIteration:
-                pass
+    try:
+        for key_data in load_key_data(filename):
+            yield key_data
+    finally:
+        os.remove(filename)
 
 
 class MergedKeys(object):
@@ -231,7 +227,7 @@ def merge_results(arg):
     counter = 0
     with open(filename, 'w') as merged_file, open(uncommitted_filename, 'w') as uncommitted_file, \
          open(dump_filename, 'w') as dump_file:
-        for key_data in merged_results(ctx, results):
+        for key_data in merged_results(ctx, range_id, results):
             counter += 1
             merged_keys.on_key_data(key_data, merged_file, uncommitted_file, dump_file)
 
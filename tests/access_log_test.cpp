@@ -0,0 +1,191 @@
+/*
+ * 2018+ Copyright (c) Elliptics contributors
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <future>
+#include <map>
+#include <sstream>
+
+#include "test_base.hpp"
+#include "library/access_log.hpp"
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_ALTERNATIVE_INIT_API
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost::unit_test;
+
+namespace tests {
+
+static dnet_access_record make_record(uint64_t trans) {
+	dnet_access_record record;
+	memset(&record, 0, sizeof(record));
+	record.trans = trans;
+	record.trace_id = trans * 7;
+	record.cmd = DNET_CMD_READ_NEW;
+	record.status = -ENOENT;
+	record.total_time = trans * 1000;
+	record.access = DNET_ACCESS_SERVER;
+	return record;
+}
+
+/* ring keeps order of records and drops new ones when it is full */
+static void test_ring()
+{
+	dnet_binary_access_log::ring ring(3);
+	std::vector<dnet_access_record> records;
+
+	BOOST_REQUIRE(ring.empty());
+	BOOST_REQUIRE_EQUAL(ring.pop(records), 0);
+
+	// size is rounded up to power of 2
+	for (uint64_t trans = 0; trans < 4; ++trans) {
+		BOOST_REQUIRE(ring.push(make_record(trans)));
+	}
+	BOOST_REQUIRE(!ring.push(make_record(4)));
+	BOOST_REQUIRE_EQUAL(ring.dropped(), 1);
+
+	BOOST_REQUIRE_EQUAL(ring.pop(records), 4);
+	BOOST_REQUIRE(ring.empty());
+
+	// records wrap around the end of the ring
+	BOOST_REQUIRE(ring.push(make_record(5)));
+	BOOST_REQUIRE(ring.push(make_record(6)));
+	BOOST_REQUIRE_EQUAL(ring.pop(records), 2);
+
+	BOOST_REQUIRE_EQUAL(records.size(), 6);
+	const uint64_t expected[] = {0, 1, 2, 3, 5, 6};
+	for (size_t i = 0; i < records.size(); ++i) {
+		BOOST_REQUIRE_EQUAL(records[i].trans, expected[i]);
+	}
+	BOOST_REQUIRE_EQUAL(ring.dropped(), 1);
+
+	BOOST_REQUIRE(!ring.orphaned());
+	ring.orphan();
+	BOOST_REQUIRE(ring.orphaned());
+}
+
+/*
+ * Records written by the exited thread, by the thread living across drains and by the thread which
+ * has registered its ring after the others were drained are all written into the file and are decoded back.
+ */
+static void test_write_drain_decode()
+{
+	char path[] = "/tmp/access_log_test.XXXXXX";
+	const int fd = mkstemp(path);
+	BOOST_REQUIRE(fd >= 0);
+	close(fd);
+
+	ioremap::elliptics::binary_access_log_config config;
+	config.path = path;
+	config.sample_every = 1;
+	config.slow_threshold_ms = 0;
+	config.ring_size = 1024;
+	config.flush_interval_ms = 10;
+	const auto drain_interval = std::chrono::milliseconds(5 * config.flush_interval_ms);
+
+	std::map<uint64_t, dnet_access_record> written;
+	auto write = [&] (dnet_binary_access_log &log, uint64_t trans) {
+		const auto record = make_record(trans);
+		log.write(record);
+		return record;
+	};
+
+	{
+		dnet_binary_access_log log(config);
+
+		std::thread([&] {
+			for (uint64_t trans = 0; trans < 10; ++trans) {
+				written.emplace(trans, write(log, trans));
+			}
+		}).join();
+		std::this_thread::sleep_for(drain_interval);
+
+		std::promise<void> drained;
+		std::thread live([&] {
+			written.emplace(10, write(log, 10));
+			drained.get_future().wait();
+			written.emplace(11, write(log, 11));
+		});
+
+		std::this_thread::sleep_for(drain_interval);
+		drained.set_value();
+		live.join();
+
+		written.emplace(12, write(log, 12));
+		BOOST_REQUIRE_EQUAL(log.dropped(), 0);
+	}
+
+	std::ifstream in(path, std::ios::binary);
+	std::vector<dnet_access_record> decoded;
+	dnet_access_log_decode(in, [&] (const dnet_access_record &record) {
+		decoded.push_back(record);
+	});
+	unlink(path);
+
+	BOOST_REQUIRE_EQUAL(decoded.size(), written.size());
+	for (const auto &record : decoded) {
+		const auto it = written.find(record.trans);
+		BOOST_REQUIRE(it != written.end());
+		BOOST_REQUIRE(!memcmp(&record, &it->second, sizeof(record)));
+		written.erase(it);
+	}
+}
+
+/* decoder rejects foreign files and truncated records */
+static void test_decode_errors()
+{
+	auto decode = [] (const std::string &data) {
+		std::istringstream in(data);
+		dnet_access_log_decode(in, [] (const dnet_access_record &) {});
+	};
+
+	BOOST_REQUIRE_THROW(decode(""), std::runtime_error);
+	BOOST_REQUIRE_THROW(decode(std::string(sizeof(dnet_access_log_header), 'x')), std::runtime_error);
+
+	dnet_access_log_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DNET_ACCESS_LOG_MAGIC, sizeof(header.magic));
+	header.version = DNET_ACCESS_LOG_VERSION;
+	header.record_size = sizeof(dnet_access_record);
+
+	const auto record = make_record(1);
+	std::string data(reinterpret_cast<const char *>(&header), sizeof(header));
+	data.append(reinterpret_cast<const char *>(&record), sizeof(record));
+	decode(data);
+
+	data.append(reinterpret_cast<const char *>(&record), sizeof(record) / 2);
+	BOOST_REQUIRE_THROW(decode(data), std::runtime_error);
+}
+
+bool register_tests()
+{
+	ELLIPTICS_TEST_CASE_NOARGS(test_ring);
+	ELLIPTICS_TEST_CASE_NOARGS(test_write_drain_decode);
+	ELLIPTICS_TEST_CASE_NOARGS(test_decode_errors);
+
+	return true;
+}
+
+} // namespace tests
+
+int main(int argc, char *argv[])
+{
+	return unit_test_main(tests::register_tests, argc, argv);
+}
@@ -0,0 +1,200 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "elliptics/session.hpp"
+#include "elliptics/coroutine.hpp"
+#include "elliptics/logger.hpp"
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_ALTERNATIVE_INIT_API
+#include <boost/test/included/unit_test.hpp>
+
+/*
+ * async_result is completed without lock, so these tests race its completion against connect(), wait()
+ * and co_await. Requests are not sent anywhere: results are completed by the test itself.
+ */
+
+using namespace ioremap::elliptics;
+using namespace boost::unit_test;
+
+namespace tests {
+
+static std::unique_ptr<node> client_node;
+
+static session create_session() {
+	session s(*client_node);
+	s.set_filter(filters::all_with_ack);
+	s.set_checker(checkers::no_check);
+	s.set_exceptions_policy(session::no_exceptions);
+	return s;
+}
+
+/* spins until all @count threads have come, so they start racing at the same time */
+static void rendezvous(std::atomic_size_t &counter, size_t count) {
+	++counter;
+	while (counter.load() < count)
+		std::this_thread::yield();
+}
+
+/*
+ * Final handler connected from one thread while the result is completed from another must be called exactly once
+ * with the completion error, and threads waiting for the result meanwhile must be woken up.
+ */
+static void test_connect_complete_race() {
+	static const size_t iterations = 5000;
+	static const size_t waiters = 2;
+
+	auto s = create_session();
+
+	for (size_t i = 0; i < iterations; ++i) {
+		async_generic_result result(s);
+		async_result_handler<callback_result_entry> handler(result);
+
+		std::atomic_size_t started{0};
+		std::atomic_int calls{0};
+		std::atomic_int error{0};
+		std::atomic_size_t woken{0};
+
+		std::vector<std::thread> threads;
+		threads.emplace_back([&] () {
+			rendezvous(started, waiters + 2);
+			result.connect(async_generic_result::result_function(), [&] (const error_info &e) {
+				error = e.code();
+				++calls;
+			});
+		});
+		threads.emplace_back([&] () {
+			rendezvous(started, waiters + 2);
+			handler.complete(create_error(-ENOENT, "test error %zu", i));
+		});
+		for (size_t j = 0; j < waiters; ++j) {
+			threads.emplace_back([&] () {
+				rendezvous(started, waiters + 2);
+				result.wait();
+				if (result.ready())
+					++woken;
+			});
+		}
+
+		for (auto &thread : threads)
+			thread.join();
+
+		BOOST_REQUIRE_EQUAL(calls.load(), 1);
+		BOOST_REQUIRE_EQUAL(woken.load(), waiters);
+		BOOST_REQUIRE_EQUAL(error.load(), -ENOENT);
+		BOOST_REQUIRE_EQUAL(result.error().code(), -ENOENT);
+	}
+}
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define ELLIPTICS_TEST_COROUTINES
+
+/* coroutine which starts immediately and whose frame is destroyed at its end */
+struct detached_task {
+	struct promise_type {
+		detached_task get_return_object() { return detached_task(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+/* the coroutine can be resumed in another thread, so it only publishes what it has got */
+static detached_task await_result(async_generic_result result, std::atomic_int &error,
+                                  std::atomic<std::thread::id> &resumed_in) {
+	const auto entries = co_await result;
+	resumed_in = std::this_thread::get_id();
+	error = entries.empty() ? result.error().code() : -EINVAL;
+}
+
+/*
+ * co_await of completed result doesn't suspend the coroutine, co_await of pending one resumes it in the thread
+ * which completes the result. Last part races suspension against completion.
+ */
+static void test_co_await() {
+	auto s = create_session();
+
+	{
+		async_generic_result result(s);
+		async_result_handler<callback_result_entry>(result).complete(create_error(-ENOENT, "completed"));
+
+		std::atomic_int error{0};
+		std::atomic<std::thread::id> resumed_in;
+		await_result(std::move(result), error, resumed_in);
+
+		BOOST_REQUIRE_EQUAL(error.load(), -ENOENT);
+		BOOST_REQUIRE(resumed_in.load() == std::this_thread::get_id());
+	}
+
+	{
+		async_generic_result result(s);
+		async_result_handler<callback_result_entry> handler(result);
+
+		std::atomic_int error{0};
+		std::atomic<std::thread::id> resumed_in;
+		await_result(std::move(result), error, resumed_in);
+		BOOST_REQUIRE_EQUAL(error.load(), 0);
+
+		std::thread completer([&] () {
+			handler.complete(create_error(-EIO, "pending"));
+		});
+		const auto completer_id = completer.get_id();
+		completer.join();
+
+		BOOST_REQUIRE_EQUAL(error.load(), -EIO);
+		BOOST_REQUIRE(resumed_in.load() == completer_id);
+	}
+
+	static const size_t iterations = 5000;
+	for (size_t i = 0; i < iterations; ++i) {
+		async_generic_result result(s);
+		async_result_handler<callback_result_entry> handler(result);
+
+		std::atomic_size_t started{0};
+		std::atomic_int error{0};
+		std::atomic<std::thread::id> resumed_in;
+
+		std::thread completer([&] () {
+			rendezvous(started, 2);
+			handler.complete(create_error(-ETIMEDOUT, "race %zu", i));
+		});
+		const auto completer_id = completer.get_id();
+
+		rendezvous(started, 2);
+		await_result(std::move(result), error, resumed_in);
+		completer.join();
+
+		BOOST_REQUIRE_EQUAL(error.load(), -ETIMEDOUT);
+		BOOST_REQUIRE(resumed_in.load() == std::this_thread::get_id() || resumed_in.load() == completer_id);
+	}
+}
+
+#endif // __has_include(<coroutine>)
+#endif // __cpp_impl_coroutine
+
+static bool register_tests() {
+	auto &suite = framework::master_test_suite();
+
+	suite.add(BOOST_TEST_CASE(&test_connect_complete_race));
+#ifdef ELLIPTICS_TEST_COROUTINES
+	suite.add(BOOST_TEST_CASE(&test_co_await));
+#endif
+
+	return true;
+}
+
+} /* namespace tests */
+
+int main(int argc, char *argv[])
+{
+	tests::client_node.reset(new node(make_file_logger("/dev/null", DNET_LOG_ERROR)));
+
+	int result = unit_test_main(tests::register_tests, argc, argv);
+
+	tests::client_node.reset();
+
+	return result;
+}
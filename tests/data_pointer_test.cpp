@@ -0,0 +1,136 @@
+/*
+ * 2018+ Copyright (c) Elliptics contributors
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "test_base.hpp"
+#include "library/elliptics.h"
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_ALTERNATIVE_INIT_API
+#include <boost/test/included/unit_test.hpp>
+
+using namespace ioremap::elliptics;
+using namespace boost::unit_test;
+
+namespace tests {
+
+/* reference counter which counts its live instances, so the test can check when the buffer is freed */
+struct counted_atomic : std::atomic_int_fast32_t {
+	counted_atomic(int value) : std::atomic_int_fast32_t(value) {
+		++alive;
+	}
+
+	~counted_atomic() {
+		--alive;
+	}
+
+	static int alive;
+};
+
+int counted_atomic::alive = 0;
+
+typedef data_pointer_base<counted_atomic, true> counted_pointer;
+
+/*
+ * Buffer given up by release() stays alive while there are references made by share() and adopt(),
+ * it is freed by the last of them regardless of the order they are dropped in.
+ */
+static void test_release_share_adopt()
+{
+	const std::string data = "release share adopt";
+
+	void *raw;
+	{
+		auto pointer = counted_pointer::copy(data);
+		raw = pointer.release();
+		BOOST_REQUIRE(pointer.empty());
+	}
+	BOOST_REQUIRE_EQUAL(counted_atomic::alive, 1);
+
+	// double share: both references outlive the owner which gives its own one back by adopt()
+	auto first = counted_pointer::share(raw, data.size());
+	auto second = counted_pointer::share(raw, data.size());
+	counted_pointer::adopt(raw, 0);
+	BOOST_REQUIRE_EQUAL(counted_atomic::alive, 1);
+	BOOST_REQUIRE_EQUAL(first.to_string(), data);
+
+	first = counted_pointer();
+	BOOST_REQUIRE_EQUAL(counted_atomic::alive, 1);
+	BOOST_REQUIRE_EQUAL(second.to_string(), data);
+
+	second = counted_pointer();
+	BOOST_REQUIRE_EQUAL(counted_atomic::alive, 0);
+
+	// only the whole allocated buffer can be given up
+	auto pointer = counted_pointer::copy(data);
+	auto slice = pointer.skip(1);
+	BOOST_REQUIRE_THROW(slice.release(), std::logic_error);
+	BOOST_REQUIRE_THROW(counted_pointer::from_raw(data).release(), std::logic_error);
+}
+
+/*
+ * Reply received into shared request is kept by result entries made by transaction completion callback
+ * (see callback_result_data) after the request has been freed by dnet_io_req_free().
+ */
+static void test_shared_reply_outlives_request()
+{
+	const std::string payload = "reply data";
+	const size_t size = sizeof(dnet_cmd) + payload.size();
+
+	dnet_io_req *r = dnet_io_req_alloc_shared(size);
+	BOOST_REQUIRE(r != nullptr);
+	BOOST_REQUIRE_EQUAL(reinterpret_cast<uintptr_t>(r) % alignof(dnet_io_req), 0);
+	BOOST_REQUIRE(r->on_exit & DNET_IO_REQ_FLAGS_SHARED);
+
+	r->header = reinterpret_cast<char *>(r + 1) + sizeof(dnet_addr);
+	r->hsize = sizeof(dnet_cmd);
+	r->data = reinterpret_cast<char *>(r->header) + sizeof(dnet_cmd);
+	r->dsize = payload.size();
+
+	auto cmd = static_cast<dnet_cmd *>(r->header);
+	memset(cmd, 0, sizeof(dnet_cmd));
+	cmd->size = payload.size();
+	memcpy(r->data, payload.data(), payload.size());
+
+	// entries of two handlers share the reply like callback_result_data does
+	const size_t entry_size = sizeof(dnet_io_req) + sizeof(dnet_addr) + size;
+	auto first = data_pointer::share(r, entry_size).skip<dnet_io_req>();
+	auto second = data_pointer::share(r, entry_size).skip<dnet_io_req>();
+
+	dnet_io_req_free(r);
+
+	for (auto entry : { first, second }) {
+		auto entry_cmd = entry.skip<dnet_addr>().data<dnet_cmd>();
+		BOOST_REQUIRE_EQUAL(entry_cmd->size, payload.size());
+		BOOST_REQUIRE_EQUAL(entry.skip<dnet_addr>().skip<dnet_cmd>().to_string(), payload);
+	}
+}
+
+bool register_tests()
+{
+	ELLIPTICS_TEST_CASE_NOARGS(test_release_share_adopt);
+	ELLIPTICS_TEST_CASE_NOARGS(test_shared_reply_outlives_request);
+
+	return true;
+}
+
+} // namespace tests
+
+int main(int argc, char *argv[])
+{
+	return unit_test_main(tests::register_tests, argc, argv);
+}
@@ -1,3 +1,10 @@
+#include <chrono>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <kora/dynamic.hpp>
+
 #include <boost/program_options.hpp>
 
 #define BOOST_TEST_NO_MAIN
@@ -23,9 +30,17 @@ nodes_data::ptr configure_test_setup(const std::string &path) {
 		return tests::server_config::default_value().apply_options(c);
 	};
 
+	/* iterations on the third node are throttled, so test_iterator_pause_and_cancel can catch them running */
+	auto throttled = server_config(tests::config_data()("group", 3));
+	throttled.backends.front()("iterator_rate_keys", 1);
+
+	/* the second node iterates key ranges in parallel, see test_iterator_parallel */
+	auto parallel = server_config(tests::config_data()("group", 2));
+	parallel.backends.front()("iterator_parallelism", 4);
+
 	auto configs = {server_config(tests::config_data()("group", 1)),
-	                server_config(tests::config_data()("group", 2)),
-	                server_config(tests::config_data()("group", 3))};
+	                parallel,
+	                throttled};
 
 	tests::start_nodes_config config(bu::results_reporter::get_stream(),
 	                                 configs,
@@ -520,6 +535,240 @@ void test_iterator_no_meta(const ioremap::elliptics::newapi::session &session) {
 }
 
 
+/* replies packed into batches are split by the client into the same stream of records */
+void test_iterator_batched(const ioremap::elliptics::newapi::session &session) {
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({constants::src_group});
+
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	uint64_t flags = DNET_IFLAGS_JSON | DNET_IFLAGS_BATCH;
+	auto async = s.start_iterator(get_setup()->nodes[0].remote(), 0, flags, {}, time_range);
+
+	size_t index = 0;
+	for (const auto &result: async) {
+		const record record{s, index};
+
+		BOOST_REQUIRE_EQUAL(result.key(), record.raw_key());
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+
+		const auto record_info = result.record_info();
+		BOOST_REQUIRE_BITWISE_EQUAL(record_info.user_flags, constants::user_flags);
+		BOOST_REQUIRE_BITWISE_EQUAL(record_info.record_flags, record.flags());
+		BOOST_REQUIRE_EQUAL(record_info.json_size, record.json().size());
+
+		BOOST_REQUIRE_EQUAL(result.json().to_string(), record.json());
+		BOOST_REQUIRE_EQUAL(result.data().size(), 0);
+
+		BOOST_REQUIRE_EQUAL(result.iterated_keys(), ++index);
+		BOOST_REQUIRE_EQUAL(result.total_keys(), constants::numberof::all);
+	}
+
+	BOOST_REQUIRE_EQUAL(index, constants::numberof::all);
+}
+
+/*
+ * iteration sending a key per second is paused and continued after its first record and then canceled,
+ * so it is finished by cancellation before all records are sent
+ */
+/* returns iterated_keys of iterator @id reported by monitor statistics of backend @backend_id */
+uint64_t iterator_progress(ioremap::elliptics::newapi::session &s, const ioremap::elliptics::address &remote,
+                           uint32_t backend_id, uint64_t id) {
+	ELLIPTICS_REQUIRE(async, s.monitor_stat(remote, DNET_MONITOR_BACKEND));
+	std::istringstream stream(async.get_one().statistics());
+	auto statistics = kora::dynamic::read_json(stream);
+	auto &backend = statistics.as_object()["backends"].as_object()[std::to_string(backend_id)];
+
+	for (auto &iterator : backend.as_object()["backend"].as_object()["iterators"].as_array()) {
+		if (iterator.as_object()["id"].as_uint() == id)
+			return iterator.as_object()["iterated_keys"].as_uint();
+	}
+
+	BOOST_FAIL("iterator " << id << " is not found in statistics");
+	return 0;
+}
+
+void test_iterator_pause_and_cancel(const ioremap::elliptics::newapi::session &session) {
+	static constexpr int throttled_group = 3;
+	static constexpr size_t records = 5;
+
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({throttled_group});
+
+	for (size_t index = 0; index < records; ++index) {
+		const record record{s, index};
+		ELLIPTICS_REQUIRE(res, s.write(record.key(),
+		                               record.json(), record.json_capacity(),
+		                               record.data(), record.data_capacity()));
+	}
+
+	const auto remote = get_setup()->nodes[2].remote();
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_iterator(remote, 0, 0, {}, time_range);
+
+	size_t count = 0;
+	for (const auto &result: async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+
+		if (count++ == 0) {
+			ELLIPTICS_REQUIRE(pause, s.pause_iterator(remote, 0, result.iterator_id()));
+
+			/* the record being sent while the iterator was paused is let to go, then progress stops */
+			static const auto settle_time = std::chrono::seconds(2);
+			std::this_thread::sleep_for(settle_time);
+			const auto paused_progress = iterator_progress(s, remote, 0, result.iterator_id());
+			std::this_thread::sleep_for(settle_time);
+			BOOST_REQUIRE_EQUAL(iterator_progress(s, remote, 0, result.iterator_id()), paused_progress);
+			BOOST_REQUIRE_LT(paused_progress, records);
+
+			ELLIPTICS_REQUIRE(resume, s.continue_iterator(remote, 0, result.iterator_id()));
+			ELLIPTICS_REQUIRE(cancel, s.cancel_iterator(remote, 0, result.iterator_id()));
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(async.error().code(), -ENOEXEC);
+	BOOST_REQUIRE_LT(count, records);
+}
+
+/*
+ * records come from partitions iterated in parallel in arbitrary order, but each of them is sent once
+ * and progress counters of the reply stream grow one by one
+ */
+void test_iterator_parallel(const ioremap::elliptics::newapi::session &session) {
+	static constexpr int parallel_group = 2;
+	static constexpr size_t records = 20;
+
+	auto raw_key_string = [] (const dnet_raw_id &key) {
+		return std::string(reinterpret_cast<const char *>(key.id), DNET_ID_SIZE);
+	};
+
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({parallel_group});
+
+	std::set<std::string> keys;
+	for (size_t index = 0; index < records; ++index) {
+		const record record{s, index};
+		ELLIPTICS_REQUIRE(res, s.write(record.key(),
+		                               record.json(), record.json_capacity(),
+		                               record.data(), record.data_capacity()));
+		keys.emplace(raw_key_string(record.raw_key()));
+	}
+
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_iterator(get_setup()->nodes[1].remote(), 0, 0, {}, time_range);
+
+	size_t index = 0;
+	for (const auto &result: async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		BOOST_REQUIRE_EQUAL(keys.erase(raw_key_string(result.key())), 1);
+
+		BOOST_REQUIRE_EQUAL(result.iterated_keys(), ++index);
+		BOOST_REQUIRE_EQUAL(result.total_keys(), records);
+	}
+
+	BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+	BOOST_REQUIRE(keys.empty());
+}
+
+/* records are collected into the container sorted by the server, it is fetched by chunks of items */
+void test_disk_iterator(const ioremap::elliptics::newapi::session &session) {
+	using ioremap::elliptics::newapi::iterator_result_container;
+
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({constants::src_group});
+
+	std::unique_ptr<FILE, int (*)(FILE *)> file(tmpfile(), fclose);
+	BOOST_REQUIRE(file);
+	iterator_result_container container(fileno(file.get()));
+
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_disk_iterator(get_setup()->nodes[0].remote(), 0, 0, {}, time_range);
+
+	for (const auto &result: async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		BOOST_REQUIRE_EQUAL(result.total_keys(), constants::numberof::all);
+
+		container.append_sorted_chunk(result);
+		BOOST_REQUIRE_EQUAL(result.iterated_keys(), container.m_count);
+	}
+
+	BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+	BOOST_REQUIRE(container.m_sorted);
+	BOOST_REQUIRE_EQUAL(container.m_count, constants::numberof::all);
+
+	std::set<std::string> keys;
+	for (size_t index = 0; index < constants::numberof::all; ++index) {
+		const auto key = record{s, index}.raw_key();
+		keys.emplace(reinterpret_cast<const char *>(key.id), DNET_ID_SIZE);
+	}
+
+	for (size_t index = 0; index < container.m_count; ++index) {
+		const auto item = container[index];
+		const std::string key(reinterpret_cast<const char *>(item.key.id), DNET_ID_SIZE);
+		BOOST_REQUIRE_EQUAL(keys.erase(key), 1);
+		BOOST_REQUIRE_BITWISE_EQUAL(item.user_flags, constants::user_flags);
+
+		if (index > 0) {
+			const auto previous = container[index - 1];
+			BOOST_REQUIRE_LT(dnet_id_cmp_str(previous.key.id, item.key.id), 0);
+		}
+	}
+
+	BOOST_REQUIRE(keys.empty());
+}
+
+/*
+ * filter keeps only committed record with data whose json has index 5, all preceding records are skipped
+ * by the moment of its reply, the final reply without key reports all skipped records
+ */
+void test_iterator_with_filter(const ioremap::elliptics::newapi::session &session) {
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({constants::src_group});
+
+	ioremap::elliptics::newapi::iterator_filter filter;
+	filter.user_flags_mask = ~0ULL;
+	filter.user_flags_value = constants::user_flags;
+	filter.record_flags_mask = DNET_RECORD_FLAGS_UNCOMMITTED;
+	filter.record_flags_value = 0;
+	filter.min_data_size = 1;
+	filter.json_key = "index";
+	filter.json_value = "\"5\"";
+
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_iterator(get_setup()->nodes[0].remote(), 0, DNET_IFLAGS_JSON, {}, time_range, filter);
+
+	size_t count = 0;
+	bool final_reply = false;
+	for (const auto &result: async) {
+		const record record{s, 5};
+
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		if (result.is_final()) {
+			BOOST_REQUIRE_EQUAL(result.key(), dnet_raw_id());
+			BOOST_REQUIRE_EQUAL(result.json().size(), 0);
+			BOOST_REQUIRE_EQUAL(result.data().size(), 0);
+			BOOST_REQUIRE_EQUAL(result.iterated_keys(), 1);
+			BOOST_REQUIRE_EQUAL(result.filtered_keys(), constants::numberof::all - 1);
+			final_reply = true;
+			continue;
+		}
+
+		BOOST_REQUIRE(!final_reply);
+		BOOST_REQUIRE_EQUAL(result.key(), record.raw_key());
+		BOOST_REQUIRE_EQUAL(result.json().to_string(), record.json());
+		BOOST_REQUIRE_EQUAL(result.iterated_keys(), 1);
+		BOOST_REQUIRE_EQUAL(result.filtered_keys(), 5);
+		++count;
+	}
+
+	BOOST_REQUIRE_EQUAL(count, 1);
+	BOOST_REQUIRE(final_reply);
+}
+
 bool register_tests(const tests::nodes_data *setup) {
 	using namespace tests;
 
@@ -547,6 +796,11 @@ bool register_tests(const tests::nodes_data *setup) {
 	}
 
 	ELLIPTICS_TEST_CASE(test_iterator_no_meta, use_session(n));
+	ELLIPTICS_TEST_CASE(test_iterator_with_filter, use_session(n));
+	ELLIPTICS_TEST_CASE(test_iterator_batched, use_session(n));
+	ELLIPTICS_TEST_CASE(test_iterator_pause_and_cancel, use_session(n));
+	ELLIPTICS_TEST_CASE(test_iterator_parallel, use_session(n));
+	ELLIPTICS_TEST_CASE(test_disk_iterator, use_session(n));
 
 	/* TODO:
 	 * * iterate with time range and json
@@ -1694,6 +1694,23 @@ bool register_tests(const nodes_data *setup) {
 
 	ELLIPTICS_TEST_CASE(test_make_groups_readonly, use_session(n), constants::dst_groups, false);
 
+	/* The same for many small keys, which are sent by batches of bulk writes.
+	   Number of keys exceeds the batch, so keys are sent by several batches.
+	 */
+	auto small_keys = generate_keys("newapi server send small id", "small data ", 1000);
+	ELLIPTICS_TEST_CASE(test_insert_keys, use_session(n), small_keys, std::vector<int>({constants::src_group}));
+	ELLIPTICS_TEST_CASE(test_read_keys_error, use_session(n), small_keys, constants::dst_groups, -ENOENT);
+
+	ELLIPTICS_TEST_CASE(test_chunked_server_send, use_session(n), small_keys, constants::src_group,
+	                    constants::dst_groups, DNET_DEFAULT_SERVER_SEND_CHUNK_SIZE, 0);
+	ELLIPTICS_TEST_CASE(test_read_keys, use_session(n), small_keys, all_groups);
+
+	ELLIPTICS_TEST_CASE(test_remove_keys, use_session(n), small_keys, constants::dst_groups);
+	ELLIPTICS_TEST_CASE(test_make_groups_readonly, use_session(n), constants::dst_groups, true);
+	ELLIPTICS_TEST_CASE(test_chunked_server_send, use_session(n), small_keys, constants::src_group,
+	                    constants::dst_groups, DNET_DEFAULT_SERVER_SEND_CHUNK_SIZE, -EROFS);
+	ELLIPTICS_TEST_CASE(test_make_groups_readonly, use_session(n), constants::dst_groups, false);
+
 	static const auto make_unique_key = [] {
 		static const std::string key_prefix = "newapi server_send failures";
 		static size_t key_idx = 0;
@@ -2,8 +2,11 @@
 #include <chrono>
 #include <fstream>
 #include <set>
+#include <sstream>
 #include <thread>
 
+#include <kora/dynamic.hpp>
+
 #include <boost/program_options.hpp>
 
 #define BOOST_TEST_NO_MAIN
@@ -25,6 +28,9 @@ namespace bu = boost::unit_test;
 
 const std::vector<int> groups{1,2,3};
 
+/* short enough for test_verified_checksum_cache_ttl to wait it out */
+static const int verified_checksum_ttl = 2;
+
 nodes_data::ptr configure_test_setup(const std::string &path) {
 	auto server_config = [](const std::vector<int> &groups) {
 		auto ret = server_config::default_value();
@@ -32,11 +38,17 @@ nodes_data::ptr configure_test_setup(const std::string &path) {
 		for (size_t i = 0; i < groups.size(); ++i) {
 			ret.backends[i]("group", groups[i]);
 		}
+		/* the second backend compresses records, caches verified checksums and syncs bulk writes,
+		 * see test_compression, test_verified_checksum_cache and test_bulk_write
+		 */
+		ret.backends.back()("compression", "zlib");
+		ret.backends.back()("verified_checksum_ttl", verified_checksum_ttl);
+		ret.backends.back()("bulk_write_sync", 1);
 		return ret;
 	};
 
 	/* Create 3 server nodes each containing two groups.
-	 * Groups 1, 2, 3 are used in all tests, while 4, 5, 6 are bulk_read-specific.
+	 * Groups 1, 2, 3 are used in all tests, while 4, 5, 6 are bulk_read-specific and compress records.
 	 */
 	auto configs = {server_config({1, 4}),
 	                server_config({2, 5}),
@@ -1841,6 +1853,294 @@ void test_bulk_remove_direct_backend(const ioremap::elliptics::newapi::session &
 	check_remove_result_all(async, 0, direct_ids.size());
 }
 
+/* batched route resolution must give the same result as per-key lookup */
+void test_lookup_addr_batch(const ioremap::elliptics::newapi::session &sess) {
+	auto s = sess.clone();
+	auto ids = generate_keys(bulk_remove_tests::good_groups, s);
+	const auto wrong_ids = generate_keys(bulk_remove_tests::wrong_groups, s);
+	ids.insert(ids.end(), wrong_ids.begin(), wrong_ids.end());
+
+	std::vector<dnet_addr> addresses(ids.size());
+	std::vector<int> backend_ids(ids.size());
+	std::vector<int> errors(ids.size());
+	const int err = dnet_lookup_addr_batch(s.get_native(), ids.data(), ids.size(),
+	                                       addresses.data(), backend_ids.data(), errors.data());
+	BOOST_REQUIRE_EQUAL(err, 0);
+
+	for (size_t i = 0; i < ids.size(); ++i) {
+		dnet_addr address;
+		int backend_id = -1;
+		memset(&address, 0, sizeof(address));
+		const int err_addr = dnet_lookup_addr(s.get_native(), nullptr, 0, &ids[i], ids[i].group_id,
+		                                      &address, &backend_id);
+
+		BOOST_REQUIRE_EQUAL(errors[i], err_addr);
+		if (!err_addr) {
+			BOOST_REQUIRE_EQUAL(dnet_addr_cmp(&addresses[i], &address), 0);
+			BOOST_REQUIRE_EQUAL(backend_ids[i], backend_id);
+		}
+	}
+}
+
+/* repeated reads are served by client cache until the key is overwritten through the same node */
+void test_read_cache(const ioremap::elliptics::newapi::session &sess, const nodes_data *setup) {
+	auto s = sess.clone();
+	s.set_groups({groups.front()});
+	const std::string key = "read_cache_key";
+
+	auto read_data = [&] () {
+		auto async = s.read_data(key, 0, 0);
+		std::string data;
+		for (const auto &result : async) {
+			BOOST_REQUIRE_EQUAL(result.status(), 0);
+			data = result.data().to_string();
+		}
+		BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+		return data;
+	};
+
+	ELLIPTICS_REQUIRE(first_write, s.write(key, "", 0, "first data", 0));
+
+	/* the cache is enabled on the node shared by all tests, so it is disabled even if the test fails */
+	struct read_cache_guard {
+		const nodes_data *setup;
+		~read_cache_guard() {
+			setup->node->set_read_cache(0, 0);
+		}
+	} guard{setup};
+	setup->node->set_read_cache(1 << 20, 60 * 1000);
+
+	BOOST_REQUIRE_EQUAL(read_data(), "first data");
+	BOOST_REQUIRE_EQUAL(read_data(), "first data");
+
+	auto stats = setup->node->get_read_cache_stats();
+	BOOST_REQUIRE_EQUAL(stats.misses, 1);
+	BOOST_REQUIRE_EQUAL(stats.hits, 1);
+	BOOST_REQUIRE_EQUAL(stats.entries, 1);
+
+	ELLIPTICS_REQUIRE(second_write, s.write(key, "", 0, "second data", 0));
+	BOOST_REQUIRE_EQUAL(read_data(), "second data");
+
+	stats = setup->node->get_read_cache_stats();
+	BOOST_REQUIRE_EQUAL(stats.invalidations, 1);
+	BOOST_REQUIRE_EQUAL(stats.misses, 2);
+
+	/* writes and removes of classic session invalidate the cache too */
+	ioremap::elliptics::session old_session(s.get_native_node());
+	old_session.set_groups({groups.front()});
+
+	ELLIPTICS_REQUIRE(third_write, old_session.write_data(key, std::string("third datum"), 0));
+	BOOST_REQUIRE_EQUAL(read_data(), "third datum");
+
+	stats = setup->node->get_read_cache_stats();
+	BOOST_REQUIRE_EQUAL(stats.invalidations, 2);
+	BOOST_REQUIRE_EQUAL(stats.misses, 3);
+
+	ELLIPTICS_REQUIRE(remove_result, old_session.remove(key));
+	BOOST_REQUIRE_EQUAL(setup->node->get_read_cache_stats().invalidations, 3);
+	BOOST_REQUIRE_EQUAL(setup->node->get_read_cache_stats().entries, 0);
+
+	/* stale entry is a miss, it is served only after lookup has confirmed it */
+	ELLIPTICS_REQUIRE(fourth_write, s.write(key, "", 0, "fourth data", 0));
+	setup->node->set_read_cache(1 << 20, 0);
+
+	BOOST_REQUIRE_EQUAL(read_data(), "fourth data");
+	BOOST_REQUIRE_EQUAL(read_data(), "fourth data");
+
+	const auto stale_stats = setup->node->get_read_cache_stats();
+	BOOST_REQUIRE_EQUAL(stale_stats.hits, stats.hits);
+	BOOST_REQUIRE_EQUAL(stale_stats.misses, stats.misses + 2);
+	BOOST_REQUIRE_EQUAL(stale_stats.revalidations, stats.revalidations + 1);
+
+	setup->node->set_read_cache(0, 0);
+	BOOST_REQUIRE_EQUAL(setup->node->get_read_cache_stats().entries, 0);
+}
+
+/* identical reads which wait for the key lock are served by the read which holds it */
+void test_coalesced_reads(const ioremap::elliptics::newapi::session &sess) {
+	auto s = sess.clone();
+	s.set_groups({groups.front()});
+	const std::string key = "coalesced_reads_key";
+	const std::string data = "coalesced reads data";
+
+	ELLIPTICS_REQUIRE(write_result, s.write(key, "", 0, data, 0));
+	const auto written = write_result.get_one();
+	const address remote(*written.address());
+	const auto backend_id = written.command()->backend_id;
+
+	auto coalesced_reads = [&] () {
+		ELLIPTICS_REQUIRE(async, s.monitor_stat(remote, DNET_MONITOR_IO));
+		std::istringstream stream(async.get_one().statistics());
+		auto statistics = kora::dynamic::read_json(stream);
+		const auto &backend = statistics.as_object()["backends"].as_object()[std::to_string(backend_id)];
+		const auto &io = backend.as_object()["io"];
+		return io.as_object()["blocking"].as_object()["coalesced_reads"].as_uint();
+	};
+
+	const auto coalesced_before = coalesced_reads();
+
+	// the first read holds the key lock while it is delayed, so the rest of reads have to wait for it
+	ELLIPTICS_REQUIRE(set_delay, s.set_delay(remote, backend_id, 200));
+
+	static const size_t reads_count = 8;
+	std::vector<ioremap::elliptics::newapi::async_read_result> reads;
+	for (size_t i = 0; i < reads_count; ++i) {
+		reads.emplace_back(s.read_data(key, 0, 0));
+	}
+
+	for (auto &async : reads) {
+		size_t count = 0;
+		for (const auto &result : async) {
+			BOOST_REQUIRE_EQUAL(result.status(), 0);
+			BOOST_REQUIRE_EQUAL(result.data().to_string(), data);
+			++count;
+		}
+		BOOST_REQUIRE_EQUAL(count, 1);
+	}
+
+	ELLIPTICS_REQUIRE(reset_delay, s.set_delay(remote, backend_id, 0));
+
+	BOOST_REQUIRE_GT(coalesced_reads(), coalesced_before);
+}
+
+/* compressed record is read entirely and by ranges crossing its chunks */
+void test_compression(const ioremap::elliptics::newapi::session &sess) {
+	auto s = sess.clone();
+	s.set_groups({4});
+	const std::string key = "compression_key";
+
+	std::string data;
+	while (data.size() < 300 * 1024) {
+		data += "compressible data " + std::to_string(data.size()) + "\n";
+	}
+
+	ELLIPTICS_REQUIRE(write_result, s.write(key, "{}", 0, data, 0));
+	const auto written = write_result.get_one();
+	BOOST_REQUIRE_EQUAL(written.record_info().data_size, data.size());
+	const address remote(*written.address());
+	const auto backend_id = written.command()->backend_id;
+
+	auto read_data = [&] (uint64_t offset, uint64_t size) {
+		ELLIPTICS_REQUIRE(async, s.read_data(key, offset, size));
+		const auto result = async.get_one();
+		BOOST_REQUIRE_EQUAL(result.record_info().data_size, data.size());
+		return result.data().to_string();
+	};
+
+	BOOST_REQUIRE(read_data(0, 0) == data);
+	BOOST_REQUIRE(read_data(60 * 1024, 10 * 1024) == data.substr(60 * 1024, 10 * 1024));
+	BOOST_REQUIRE(read_data(200 * 1024, 0) == data.substr(200 * 1024));
+
+	ELLIPTICS_REQUIRE(lookup_result, s.lookup(key));
+	BOOST_REQUIRE_EQUAL(lookup_result.get_one().record_info().data_size, data.size());
+
+	/* old api can't patch or append compressed record, which should stay intact */
+	{
+		ioremap::elliptics::session old_session(s.get_native_node());
+		old_session.set_groups({4});
+
+		ELLIPTICS_REQUIRE_ERROR(offset_result, old_session.write_data(key, std::string("patch"), 100),
+		                        -ENOTSUP);
+
+		old_session.set_ioflags(DNET_IO_FLAGS_APPEND);
+		ELLIPTICS_REQUIRE_ERROR(append_result, old_session.write_data(key, std::string("tail"), 0),
+		                        -ENOTSUP);
+	}
+	BOOST_REQUIRE(read_data(0, 0) == data);
+
+	ELLIPTICS_REQUIRE(async, s.monitor_stat(remote, DNET_MONITOR_BACKEND));
+	std::istringstream stream(async.get_one().statistics());
+	auto statistics = kora::dynamic::read_json(stream);
+	const auto &backend = statistics.as_object()["backends"].as_object()[std::to_string(backend_id)];
+	const auto &compression = backend.as_object()["backend"].as_object()["compression"].as_object();
+	BOOST_REQUIRE_GT(compression["compressed_records"].as_uint(), 0);
+	BOOST_REQUIRE_LT(compression["compressed_bytes"].as_uint(), compression["raw_bytes"].as_uint());
+}
+
+/* repeated reads skip checksum verification, while rewritten record is read and verified anew */
+/* returns the number of reads which skipped checksum verification of the backend which wrote @written */
+uint64_t verified_checksum_hits(ioremap::elliptics::newapi::session &s,
+                                const ioremap::elliptics::newapi::lookup_result_entry &written) {
+	const address remote(*written.address());
+	const auto backend_id = written.command()->backend_id;
+
+	ELLIPTICS_REQUIRE(async, s.monitor_stat(remote, DNET_MONITOR_BACKEND));
+	std::istringstream stream(async.get_one().statistics());
+	auto statistics = kora::dynamic::read_json(stream);
+	const auto &backend = statistics.as_object()["backends"].as_object()[std::to_string(backend_id)];
+	return backend.as_object()["backend"].as_object()["verified_checksum_hits"].as_uint();
+}
+
+void test_verified_checksum_cache(const ioremap::elliptics::newapi::session &sess) {
+	auto s = sess.clone();
+	s.set_groups({4});
+	const std::string key = "verified_checksum_cache_key";
+
+	ELLIPTICS_REQUIRE(write_result, s.write(key, "{\"first\":1}", 0, "first data", 0));
+	const auto written = write_result.get_one();
+
+	auto read = [&] () {
+		ELLIPTICS_REQUIRE(async, s.read(key, 0, 0));
+		const auto result = async.get_one();
+		return result.json().to_string() + result.data().to_string();
+	};
+
+	BOOST_REQUIRE_EQUAL(read(), "{\"first\":1}first data");
+	const auto hits_before = verified_checksum_hits(s, written);
+	BOOST_REQUIRE_EQUAL(read(), "{\"first\":1}first data");
+	BOOST_REQUIRE_GT(verified_checksum_hits(s, written), hits_before);
+
+	ELLIPTICS_REQUIRE(rewrite_result, s.write(key, "{\"second\":2}", 0, "second data", 0));
+	BOOST_REQUIRE_EQUAL(read(), "{\"second\":2}second data");
+
+	/* record rewritten in place under the very same headers must be verified anew */
+	dnet_time timestamp;
+	dnet_current_time(&timestamp);
+	s.set_timestamp(timestamp);
+	s.set_json_timestamp(timestamp);
+
+	ELLIPTICS_REQUIRE(same_write_result, s.write(key, "{\"third\":3}", 0, "third data", 0));
+	BOOST_REQUIRE_EQUAL(read(), "{\"third\":3}third data");
+	BOOST_REQUIRE_EQUAL(read(), "{\"third\":3}third data");
+
+	ELLIPTICS_REQUIRE(same_rewrite_result, s.write(key, "{\"third\":3}", 0, "fifth data", 0));
+	const auto rewritten = same_rewrite_result.get_one();
+	corrupt_record(rewritten.path(), rewritten.record_info().data_offset, "sixth");
+
+	ELLIPTICS_REQUIRE_ERROR(corrupted_read, s.read(key, 0, 0), -EILSEQ);
+}
+
+/* record verified again after ttl has passed is cached anew */
+void test_verified_checksum_cache_ttl(const ioremap::elliptics::newapi::session &sess) {
+	auto s = sess.clone();
+	s.set_groups({4});
+	const std::string key = "verified_checksum_cache_ttl_key";
+
+	ELLIPTICS_REQUIRE(write_result, s.write(key, "{\"ttl\":1}", 0, "ttl data", 0));
+	const auto written = write_result.get_one();
+
+	auto read = [&] () {
+		ELLIPTICS_REQUIRE(async, s.read(key, 0, 0));
+		const auto result = async.get_one();
+		BOOST_REQUIRE_EQUAL(result.json().to_string() + result.data().to_string(), "{\"ttl\":1}ttl data");
+	};
+
+	read();
+	auto hits = verified_checksum_hits(s, written);
+	read();
+	BOOST_REQUIRE_GT(verified_checksum_hits(s, written), hits);
+
+	std::this_thread::sleep_for(std::chrono::seconds(verified_checksum_ttl + 1));
+
+	/* verification is expired, so the record is verified again */
+	hits = verified_checksum_hits(s, written);
+	read();
+	BOOST_REQUIRE_EQUAL(verified_checksum_hits(s, written), hits);
+
+	read();
+	BOOST_REQUIRE_GT(verified_checksum_hits(s, written), hits);
+}
+
 void test_bulk_remove_timeout(const ioremap::elliptics::newapi::session &sess, const nodes_data *setup) {
 	auto s = sess.clone();
 	bulk_remove_tests::prepare_session(s);
@@ -1888,6 +2188,69 @@ void test_bulk_remove_timeout(const ioremap::elliptics::newapi::session &sess, c
 	check_remove_result_all(async, -ENOENT, delayed_ids.size());
 }
 
+/* records written by bulk_write are replied by key and are readable by bulk_read,
+ * groups 4, 5, 6 are served by backends syncing bulk writes, see configure_test_setup
+ */
+void test_bulk_write(const ioremap::elliptics::newapi::session &sess) {
+	auto s = sess.clone();
+	bulk_remove_tests::prepare_session(s);
+	const auto ids = generate_keys(bulk_remove_tests::good_groups, s);
+	dnet_time timestamp = bulk_remove_tests::rec_tmpl.timestamp;
+
+	std::map<dnet_id, std::pair<std::string, std::string>> records; // key -> (json, data)
+	std::vector<newapi::bulk_write_record> bulk_records;
+	bulk_records.reserve(ids.size());
+	for (size_t i = 0; i < ids.size(); ++i) {
+		const auto unique_suffix = std::to_string(i);
+		newapi::bulk_write_record record;
+		record.key = ids[i];
+		record.json = data_pointer::copy("{\"key\": \"bulk_write_json_" + unique_suffix + "\"}");
+		record.json_capacity = bulk_remove_tests::rec_tmpl.json_capacity;
+		record.data = data_pointer::copy("bulk_write_data_" + unique_suffix);
+		records.emplace(ids[i], std::make_pair(record.json.to_string(), record.data.to_string()));
+		bulk_records.emplace_back(std::move(record));
+	}
+
+	std::set<dnet_id> responses;
+	auto async = s.bulk_write(bulk_records);
+	for (const auto &result : async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		BOOST_REQUIRE_EQUAL(result.command()->cmd, DNET_CMD_BULK_WRITE_NEW);
+
+		auto record_info = result.record_info();
+		BOOST_REQUIRE_EQUAL(record_info.user_flags, bulk_remove_tests::rec_tmpl.user_flags);
+		BOOST_REQUIRE_EQUAL(dnet_time_cmp(&record_info.data_timestamp, &timestamp), 0);
+		BOOST_REQUIRE_EQUAL(record_info.json_capacity, bulk_remove_tests::rec_tmpl.json_capacity);
+		responses.emplace(result.command()->id);
+	}
+	BOOST_REQUIRE_EQUAL(responses.size(), ids.size());
+	check_all_ids_presents(ids, responses);
+
+	size_t count = 0;
+	auto read_async = s.bulk_read(ids);
+	for (const auto &result : read_async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		const auto &ref = records.at(result.command()->id);
+		BOOST_REQUIRE_EQUAL(result.json().to_string(), ref.first);
+		BOOST_REQUIRE_EQUAL(result.data().to_string(), ref.second);
+		++count;
+	}
+	BOOST_REQUIRE_EQUAL(count, ids.size());
+
+	/* cas_timestamp fails records older than the written ones by key */
+	for (auto &record : bulk_records) {
+		record.timestamp = dnet_time{1, 1};
+	}
+	s.set_ioflags(s.get_ioflags() | DNET_IO_FLAGS_CAS_TIMESTAMP);
+	async = s.bulk_write(bulk_records);
+	count = 0;
+	for (const auto &result : async) {
+		BOOST_REQUIRE_EQUAL(result.status(), -EBADFD);
+		++count;
+	}
+	BOOST_REQUIRE_EQUAL(count, ids.size());
+}
+
 // -----------------------------------------------------------------------------------------
 
 void test_bulk_read(const ioremap::elliptics::newapi::session &session) {
@@ -2314,6 +2677,13 @@ bool register_tests(const nodes_data *setup) {
 			ELLIPTICS_TEST_CASE(test_bulk_remove_readonly, use_session(n, {}, 0, ioflags), setup);
 			ELLIPTICS_TEST_CASE(test_bulk_remove_direct_backend, use_session(n, {}, 0, ioflags));
 			ELLIPTICS_TEST_CASE(test_bulk_remove_timeout, use_session(n, {}, 0, ioflags), setup);
+			ELLIPTICS_TEST_CASE(test_bulk_write, use_session(n, {}, 0, ioflags));
+			ELLIPTICS_TEST_CASE(test_lookup_addr_batch, use_session(n, {}, 0, ioflags));
+			ELLIPTICS_TEST_CASE(test_read_cache, use_session(n, {}, 0, ioflags), setup);
+			ELLIPTICS_TEST_CASE(test_coalesced_reads, use_session(n, {}, 0, ioflags));
+			ELLIPTICS_TEST_CASE(test_compression, use_session(n, {}, 0, ioflags));
+			ELLIPTICS_TEST_CASE(test_verified_checksum_cache, use_session(n, {}, 0, ioflags));
+			ELLIPTICS_TEST_CASE(test_verified_checksum_cache_ttl, use_session(n, {}, 0, ioflags));
 		}
 		record.json = R"json({
 			"record": {
@@ -0,0 +1,226 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include <kora/dynamic.hpp>
+
+#include "test_base.hpp"
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_ALTERNATIVE_INIT_API
+#include <boost/test/included/unit_test.hpp>
+
+#include <boost/program_options.hpp>
+
+using namespace ioremap::elliptics;
+using namespace boost::unit_test;
+
+namespace tests {
+
+constexpr int group = 1;
+constexpr uint64_t output_memory_limit = 8 << 20;
+
+static nodes_data::ptr configure_test_setup(const std::string &path) {
+	std::vector<server_config> servers {
+		[] () {
+			auto ret = server_config::default_value();
+			ret.options
+				("io_thread_num", 4)
+				("nonblocking_io_thread_num", 4)
+				("net_thread_num", 2)
+				("output_memory_limit", static_cast<int64_t>(output_memory_limit))
+			;
+
+			ret.backends[0]("enable", true)("group", group);
+			return ret;
+		} ()
+	};
+
+	start_nodes_config start_config(results_reporter::get_stream(), std::move(servers), path);
+	start_config.fork = true;
+
+	return start_nodes(start_config);
+}
+
+/* returns io.output statistics of the node */
+static kora::dynamic_t output_statistics(session &s, const address &remote) {
+	ELLIPTICS_REQUIRE(async, s.monitor_stat(remote, DNET_MONITOR_IO));
+	std::istringstream stream(async.get_one().statistics());
+	auto statistics = kora::dynamic::read_json(stream);
+	return statistics.as_object()["io"].as_object()["output"];
+}
+
+/* Stalled client: it sends old-style cache reads of the whole @id and never reads replies */
+class stalled_client {
+public:
+	stalled_client(const address &remote, const dnet_cmd &written) {
+		const dnet_addr &addr = remote.to_raw();
+
+		m_socket = socket(addr.family, SOCK_STREAM, 0);
+		BOOST_REQUIRE_GE(m_socket, 0);
+
+		// keep kernel buffers small, so replies are queued by the server
+		int rcvbuf = 4096;
+		setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+		BOOST_REQUIRE_EQUAL(connect(m_socket, (const struct sockaddr *)addr.addr, addr.addr_len), 0);
+
+		m_request.cmd.id = written.id;
+		m_request.cmd.cmd = DNET_CMD_READ;
+		m_request.cmd.backend_id = written.backend_id;
+		m_request.cmd.flags = DNET_FLAGS_NEED_ACK | DNET_FLAGS_DIRECT;
+		m_request.cmd.size = sizeof(m_request.io);
+
+		memcpy(m_request.io.id, written.id.id, DNET_ID_SIZE);
+		memcpy(m_request.io.parent, written.id.id, DNET_ID_SIZE);
+		m_request.io.flags = DNET_IO_FLAGS_CACHE | DNET_IO_FLAGS_CACHE_ONLY;
+	}
+
+	~stalled_client() {
+		close(m_socket);
+	}
+
+	void send_reads(size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			request r = m_request;
+			r.cmd.trans = i + 1;
+			dnet_convert_cmd(&r.cmd);
+			dnet_convert_io_attr(&r.io);
+
+			BOOST_REQUIRE_EQUAL(send(m_socket, &r, sizeof(r), MSG_NOSIGNAL), sizeof(r));
+		}
+	}
+
+private:
+	struct request {
+		dnet_cmd cmd;
+		dnet_io_attr io;
+	} __attribute__ ((packed));
+
+	int m_socket;
+	request m_request = {};
+};
+
+/* The test checks that a client which doesn't read its replies can't block other clients:
+ * * write 1 MB key into the cache
+ * * stalled client sends 64 reads of the key (64 MB of replies against 8 MB output budget) and never reads them
+ * * check that the node has stopped reading requests from the stalled client while it is over the budget
+ * * check that reads of the regular client are served by the same io threads meanwhile
+ * * check that the budget is released and the node is not throttled after the stalled client has gone.
+ */
+static void test_stalled_client(session &s) {
+	const std::string key = "stalled client test key";
+	const std::string data(1 << 20, 'x');
+
+	s.set_ioflags(DNET_IO_FLAGS_CACHE);
+	ELLIPTICS_REQUIRE(write_result, s.write_data(key, data, 0));
+	const auto written = write_result.get_one();
+	const address remote(*written.address());
+
+	auto wait_for = [&] (const std::function<bool (kora::dynamic_t)> &predicate) {
+		for (size_t i = 0; i < 100; ++i) {
+			if (predicate(output_statistics(s, remote)))
+				return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		return false;
+	};
+
+	{
+		stalled_client client(remote, *written.command());
+		client.send_reads(64);
+
+		BOOST_REQUIRE(wait_for([] (kora::dynamic_t output) {
+			return output.as_object()["suspended_clients"].as_uint() > 0;
+		}));
+
+		s.set_timeout(5);
+		for (size_t i = 0; i < 16; ++i) {
+			ELLIPTICS_COMPARE_REQUIRE(read_result, s.read_data(key, 0, 0), data);
+		}
+
+		auto output = output_statistics(s, remote);
+		BOOST_REQUIRE_GT(output.as_object()["current_bytes"].as_uint(), output_memory_limit);
+		BOOST_REQUIRE_EQUAL(output.as_object()["suspended_producers"].as_uint(), 0);
+	}
+
+	BOOST_REQUIRE(wait_for([] (kora::dynamic_t output) {
+		return output.as_object()["current_bytes"].as_uint() < output_memory_limit &&
+		       output.as_object()["suspended_clients"].as_uint() == 0;
+	}));
+}
+
+static bool register_tests(const nodes_data *setup) {
+	auto n = setup->node->get_native();
+
+	ELLIPTICS_TEST_CASE(test_stalled_client, use_session(n, { group }, 0, 0));
+
+	return true;
+}
+
+nodes_data::ptr configure_test_setup_from_args(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	bpo::variables_map vm;
+	bpo::options_description generic("Test options");
+
+	std::string path;
+
+	generic.add_options()
+		("help", "This help message")
+		("path", bpo::value(&path), "Path where to store everything")
+		;
+
+	bpo::store(bpo::parse_command_line(argc, argv, generic), vm);
+	bpo::notify(vm);
+
+	if (vm.count("help")) {
+		std::cerr << generic;
+		return nullptr;
+	}
+
+	return configure_test_setup(path);
+}
+
+} /* namespace tests */
+
+
+/*
+ * Common test initialization routine.
+ */
+using namespace tests;
+using namespace boost::unit_test;
+
+/*FIXME: forced to use global variable and plain function wrapper
+ * because of the way how init_test_main works in boost.test,
+ * introducing a global fixture would be a proper way to handle
+ * global test setup
+ */
+namespace {
+
+std::shared_ptr<nodes_data> setup;
+
+bool init_func()
+{
+	return register_tests(setup.get());
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	srand(time(nullptr));
+
+	// we own our test setup
+	setup = configure_test_setup_from_args(argc, argv);
+
+	int result = unit_test_main(init_func, argc, argv);
+
+	// disassemble setup explicitly, to be sure about where its lifetime ends
+	setup.reset();
+
+	return result;
+}
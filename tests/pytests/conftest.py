@@ -268,6 +268,71 @@ def mock_iterator_result_container(mocker):
 
     mocker.patch('elliptics.core.newapi.IteratorResultContainer',
                  mocker.MagicMock(side_effect=container_side_effect()))
+    mocker.patch('elliptics.core.newapi.IteratorResultMerger', MockedIteratorResultMerger)
+
+
+class MockedIteratorResultMerger(object):
+    """Pure python IteratorResultMerger which merges mocked containers by heap of MergeData
+
+    Original IteratorResultMerger reads containers' files, so it can't merge mocked containers.
+    It is also used as a reference for the original one by test_iterator_merger.py.
+    """
+    def __init__(self):
+        self.results = []
+
+    def add_source(self, container, host, port, family, backend_id, group_id):
+        from elliptics_recovery.iterator import IteratorResult
+        self.results.append(IteratorResult(address=elliptics.Address(host, port, family),
+                                           backend_id=backend_id,
+                                           group_id=group_id,
+                                           container=container,
+                                           leave_file=True))
+
+    def merge(self, filename, groups, user_flags_set):
+        import heapq
+        from elliptics_recovery.iterator import MergeData
+        from elliptics_recovery.types.dc import skip_key_data
+        from elliptics_recovery.utils.misc import dump_key_data
+
+        ctx = collections.namedtuple('Context', 'groups user_flags_set')(groups, frozenset(user_flags_set))
+        stats = {'total_keys': 0, 'written_keys': 0,
+                 'missing_keys': collections.Counter(), 'stale_keys': collections.Counter()}
+
+        heap = []
+        for result in self.results:
+            try:
+                heapq.heappush(heap, MergeData(result, None))
+            except StopIteration:
+                pass
+
+        with open(filename, 'wb') as output:
+            while heap:
+                min_data = heapq.heappop(heap)
+                same_datas = [min_data]
+                while heap and min_data.key == heap[0].key:
+                    same_datas.append(heapq.heappop(heap))
+
+                key_data = (min_data.key, [data.key_info for data in same_datas])
+                stats['total_keys'] += 1
+                if not skip_key_data(ctx, key_data):
+                    stats['written_keys'] += 1
+                    key_groups = set(info.group_id for info in key_data[1])
+                    stats['missing_keys'].update(group for group in groups if group not in key_groups)
+                    newest = key_data[1][0]
+                    stats['stale_keys'].update(info.group_id for info in key_data[1]
+                                               if not info.same_meta(newest))
+                    dump_key_data(key_data, output)
+
+                for data in same_datas:
+                    try:
+                        data.next()
+                        heapq.heappush(heap, data)
+                    except StopIteration:
+                        pass
+
+        stats['missing_keys'] = dict(stats['missing_keys'])
+        stats['stale_keys'] = dict(stats['stale_keys'])
+        return stats
 
 
 class MockedRecordInfo(object):
@@ -137,11 +137,17 @@ class MonitorStatsChecker:
         else:
             assert False  # either nonblocking or lifo should be presented in io
         check_queue(io['output'])
+        assert io['output']['current_bytes'] >= 0
+        assert io['output']['limit_bytes'] >= 0
+        assert io['output']['suspended_producers'] >= 0
+        assert io['output']['queued_states'] >= 0
+        assert io['output']['suspended_clients'] >= 0
         assert io['blocked'] == False
 
         for state in io['states']:
             state_io = io['states'][state]
             assert state_io['send_queue_size'] >= 0
+            assert state_io['send_queue_bytes'] >= 0
             assert state_io['la'] >= 0
             assert state_io['free'] >= 0
             assert state_io['stall'] >= 0
@@ -0,0 +1,161 @@
+"""Tests of native IteratorResultMerger used by dc recovery
+
+Containers are written into real files in the format of iterator_container_item and merged by both
+native IteratorResultMerger and pure python MockedIteratorResultMerger which merges them by MergeData,
+skip_key_data() and dump_key_data() like dc recovery did. Results of both merges should be the same.
+"""
+import hashlib
+import os
+import socket
+import struct
+
+import msgpack
+import pytest
+
+import elliptics
+
+from conftest import MockedIteratorResultMerger
+
+# iterator_container_item: key, status, record_flags, user_flags, json_timestamp, json_size, json_capacity,
+# data_timestamp, data_size, data_offset, blob_id
+ITEM_FORMAT = '<64si4x11Q'
+ITEM_SIZE = struct.calcsize(ITEM_FORMAT)
+
+# number of items read by native merger from each container at once
+MERGE_SOURCE_BUFFER_ITEMS = 64 * 1024
+
+GROUPS = [1, 2, 3]
+
+
+def make_key(index):
+    return hashlib.sha512('test_iterator_merger key {0}'.format(index)).digest()
+
+
+class Item(object):
+    def __init__(self, key, data_timestamp=(100, 0), data_size=10, user_flags=0, record_flags=0):
+        self.key = key
+        self.data_timestamp = data_timestamp
+        self.data_size = data_size
+        self.user_flags = user_flags
+        self.record_flags = record_flags
+
+    def pack(self, data_offset, blob_id):
+        return struct.pack(ITEM_FORMAT, self.key, 0, self.record_flags, self.user_flags,
+                           self.data_timestamp[0], self.data_timestamp[1], 0, 0,
+                           self.data_timestamp[0], self.data_timestamp[1], self.data_size,
+                           data_offset, blob_id)
+
+
+def make_sources(num_keys):
+    """Generates items of all groups, every group is a list sorted by key
+    which can contain several items of the same key
+    """
+    sources = dict((group, []) for group in GROUPS)
+    for index in xrange(num_keys):
+        key = make_key(index)
+
+        # group 1 has all keys, some of them several times: the newest one should be used
+        sources[1].append(Item(key))
+        if index % 1000 == 0 or abs(index - MERGE_SOURCE_BUFFER_ITEMS) < 8:
+            sources[1].append(Item(key, data_timestamp=(50, index)))
+        if index % 5000 == 0:
+            sources[1][-1].data_timestamp = (100, 0)
+            sources[1][-2].data_timestamp = (10, 0)
+
+        # group 2 misses some keys and has stale, uncommitted and differently flagged replicas of others
+        if index % 7 != 0:
+            item = Item(key)
+            if index % 11 == 0:
+                item.data_timestamp = (90, index)
+            if index % 13 == 0:
+                item.record_flags |= elliptics.record_flags.uncommitted
+            if index % 17 == 0:
+                item.user_flags = 1
+            if index % 19 == 0:
+                item.data_size = 20
+            sources[2].append(item)
+
+        # group 3 has every third key, some of them are corrupted
+        if index % 3 == 0:
+            item = Item(key)
+            if index % 23 == 0:
+                item.record_flags |= elliptics.record_flags.corrupted
+            if index % 29 == 0:
+                item.user_flags = 2
+            sources[3].append(item)
+
+    # keys which are presented only in group 3
+    for index in xrange(num_keys, num_keys + 100):
+        sources[3].append(Item(make_key(index), data_timestamp=(100, index)))
+
+    for group in GROUPS:
+        sources[group].sort(key=lambda item: item.key)
+    return sources
+
+
+def write_container(path, items):
+    with open(path, 'wb') as f:
+        for offset, item in enumerate(items):
+            f.write(item.pack(data_offset=offset, blob_id=offset % 3))
+    return len(items) * ITEM_SIZE
+
+
+def load_merged(path):
+    """Loads output of merge, replicas of each key are ordered by their meta and then by group,
+    because python's heap doesn't keep the order of replicas with the same meta
+    """
+    with open(path, 'rb') as f:
+        ret = list(msgpack.Unpacker(f))
+    for _, replicas in ret:
+        replicas.sort(key=lambda r: (-r[2][0], -r[2][1], r[3], -r[4], r[1]))
+    return ret
+
+
+@pytest.yield_fixture(scope='module')
+def containers(tmpdir_factory):
+    """Writes containers of all groups, group 1 exceeds the buffer of native merger"""
+    tmpdir = tmpdir_factory.mktemp('test_iterator_merger')
+    sources = make_sources(MERGE_SOURCE_BUFFER_ITEMS + 5000)
+    assert len(sources[1]) > MERGE_SOURCE_BUFFER_ITEMS
+
+    ret = []
+    for group in GROUPS:
+        path = str(tmpdir.join('container_{0}'.format(group)))
+        size = write_container(path, sources[group])
+        fd = os.open(path, os.O_RDONLY)
+        ret.append((group, fd, elliptics.core.newapi.IteratorResultContainer(fd, True, size)))
+
+    yield tmpdir, ret
+
+    for _, fd, _ in ret:
+        os.close(fd)
+
+
+@pytest.mark.parametrize('user_flags_set', [(), (1, 2)])
+def test_merge(containers, user_flags_set):
+    """Merge the same containers by native and python mergers and compare written keys and statistics"""
+    tmpdir, sources = containers
+
+    native, reference = elliptics.core.newapi.IteratorResultMerger(), MockedIteratorResultMerger()
+    for group, _, container in sources:
+        for merger in (native, reference):
+            merger.add_source(container, '127.0.0.1', 1025 + group, socket.AF_INET, 0, group)
+
+    native_path = str(tmpdir.join('native_merged'))
+    reference_path = str(tmpdir.join('reference_merged'))
+    native_stats = native.merge(native_path, GROUPS, user_flags_set)
+    reference_stats = reference.merge(reference_path, GROUPS, user_flags_set)
+
+    native_merged = load_merged(native_path)
+    assert native_merged == load_merged(reference_path)
+    # native merger writes replicas ordered, so normalization of the order shouldn't change its output
+    with open(native_path, 'rb') as f:
+        assert list(msgpack.Unpacker(f)) == native_merged
+
+    assert native_stats == reference_stats
+    assert native_stats['total_keys'] == MERGE_SOURCE_BUFFER_ITEMS + 5000 + 100
+    assert native_stats['written_keys'] == len(native_merged)
+    assert 0 < native_stats['written_keys'] < native_stats['total_keys']
+    if not user_flags_set:
+        assert native_stats['missing_keys'][2] > 0
+        assert native_stats['stale_keys'][2] > 0
@@ -3,6 +3,7 @@ import elliptics
 import errno
 import hashlib
 import json
+import threading
 
 import pytest
 
@@ -276,3 +277,105 @@ def test_session_bulk_remove(simple_node):
     assert count == len(keys_ts)
 
 
+@pytest.mark.usefixtures('servers')
+def test_session_bulk_write(simple_node):
+    """Test bulk_write: records are written and replied by key, then read back by bulk_read."""
+    session = elliptics.newapi.Session(simple_node)
+    session.trace_id = make_trace_id('test_session_bulk_write')
+    session.groups = session.routes.groups()
+
+    timestamp = elliptics.Time(1000, 1)
+    records = []
+    datas = {}
+    for group_id in session.groups:
+        for i in range(100):
+            eid = session.transform('k_bw{}'.format(i))
+            eid.group_id = group_id
+            data = "data{}_{}".format(group_id, i)
+            json_string = json.dumps({'some': "json{}_{}".format(group_id, i)})
+            records.append((eid, json_string, data, timestamp))
+            datas[repr(eid)] = (json_string, data)
+
+    count = 0
+    for result in session.bulk_write(records):
+        assert result.status == 0
+        assert repr(result.id) in datas
+        assert result.record_info.data_timestamp == timestamp
+        assert result.record_info.json_timestamp == timestamp
+        count += 1
+    assert count == len(records)
+
+    count = 0
+    for result in session.bulk_read([record[0] for record in records]):
+        assert result.status == 0
+        assert (result.json, result.data) == datas[repr(result.id)]
+        count += 1
+    assert count == len(records)
+
+    # records with timestamp older than written one are rejected by key
+    older = [(eid, json_string, data, elliptics.Time(1, 1)) for eid, json_string, data, _ in records[:10]]
+    session.ioflags = elliptics.io_flags.cas_timestamp
+    for result in session.bulk_write(older):
+        assert result.status == -errno.EBADFD
+    session.ioflags = 0
+
+    # invalid json fails the whole request
+    with pytest.raises(Exception):
+        session.bulk_write([(records[0][0], '{', '', timestamp)]).wait()
+
+
+@pytest.mark.usefixtures('servers')
+def test_read_data_view(simple_node):
+    """Read a key and check that json_view and data_view share result's memory without copying."""
+    session = elliptics.newapi.Session(simple_node)
+    session.trace_id = make_trace_id('test_read_data_view')
+    session.groups = session.routes.groups()[:1]
+
+    key = 'test_read_data_view'
+    json_string = json.dumps({'some': 'field'})
+    data = 'some data' * 1024
+    session.write(key, json_string, len(json_string), data, len(data)).wait()
+
+    result = session.read(key).get()[0]
+    assert result.status == 0
+    data_view = result.data_view
+    assert isinstance(data_view, memoryview)
+    assert data_view.readonly
+    assert data_view.tobytes() == data
+    assert result.json_view.tobytes() == json_string
+    # memoryview holds memory of the result even if the result is gone
+    del result
+    assert data_view[:9].tobytes() == 'some data'
+
+
+@pytest.mark.usefixtures('servers')
+def test_connect_batch(simple_node):
+    """Write keys, read them by bulk_read and receive results by batches via connect_batch."""
+    session = elliptics.newapi.Session(simple_node)
+    session.trace_id = make_trace_id('test_connect_batch')
+    session.groups = session.routes.groups()[:1]
+
+    keys = ['test_connect_batch_{}'.format(i) for i in range(25)]
+    for r in [session.write(key, '', 0, key, len(key)) for key in keys]:
+        assert r.get()[0].status == 0
+
+    ids = [session.transform(key) for key in keys]
+    for eid in ids:
+        eid.group_id = session.groups[0]
+
+    batches = []
+    errors = []
+    completed = threading.Event()
+
+    def final_handler(error):
+        errors.append(error)
+        completed.set()
+
+    async = session.bulk_read_data(ids)
+    async.connect_batch(lambda results: batches.append(results), final_handler, 10)
+    assert completed.wait(60)
+
+    assert len(errors) == 1
+    assert errors[0].code == 0
+    assert all(len(batch) <= 10 for batch in batches)
+    assert sorted(r.data_view.tobytes() for batch in batches for r in batch) == sorted(keys)
@@ -172,7 +172,8 @@ def corrupt_key(session, key):
 
 def recovery(one_node, remotes, backend_id, address, groups,
              rtype, log_file, tmp_dir, no_server_send=False, dump_file=None, no_meta=False,
-             user_flags_set=(), expected_ret_code=0, chunk_size=1024, ro_groups=set(), safe=False):
+             user_flags_set=(), expected_ret_code=0, chunk_size=1024, ro_groups=set(), safe=False,
+             native_recover=False):
     '''
     Imports dnet_recovery tools and executes merge recovery. Checks result of merge.
     '''
@@ -215,6 +216,8 @@ def recovery(one_node, remotes, backend_id, address, groups,
         args += ['--ro-groups', ','.join(map(str, ro_groups))]
     if safe:
         args += ['-S']
+    if native_recover:
+        args += ['--native-recover']
 
     assert elliptics_recovery.recovery.run(args) == expected_ret_code
 
@@ -347,6 +350,8 @@ class TestRecovery:
     datas2 = map('{0}.{0}'.format, keys)
     # this timestamp will be used for writing data to the third group
     timestamp2 = elliptics.Time(timestamp.tsec + 3600, timestamp.tnsec)
+    # keys which will be written only to the first group and recovered by native dc recovery
+    native_keys = map('native_{0}'.format, range(count))
     corrupted_key = 'corrupted_test.key'
     corrupted_key2 = 'corrupted_test.key2'
     corrupted_data = 'corrupted_test.data'
@@ -676,6 +681,44 @@ class TestRecovery:
             session.groups = [group]
             check_data(scope, session, self.keys, self.datas2, self.timestamp2)
 
+    @pytest.mark.usefixtures("servers")
+    def test_write_native_keys(self, simple_node):
+        '''
+        Writes self.native_keys to the first group only
+        '''
+        session = make_session(node=simple_node,
+                               test_name='TestRecovery.test_write_native_keys',
+                               test_namespace=self.namespace)
+        session.groups = [scope.test_group]
+        session.timestamp = self.timestamp2
+
+        write_data(scope, session, self.native_keys, self.native_keys)
+        check_data(scope, session, self.native_keys, self.native_keys, self.timestamp2)
+
+    def test_native_dc_three_groups(self, servers, simple_node, use_server_send):
+        '''
+        Runs dc recovery with --native-recover against all three groups.
+        Checks that self.native_keys are recovered from the first group to the second and third ones.
+        '''
+        session = make_session(node=simple_node,
+                               test_name='TestRecovery.test_native_dc_three_groups',
+                               test_namespace=self.namespace)
+
+        recovery(one_node=False,
+                 remotes=map(elliptics.Address.from_host_port_family, servers.remotes),
+                 backend_id=None,
+                 address=scope.test_address2,
+                 groups=(scope.test_group, scope.test_group2, scope.test_group3),
+                 rtype=RECOVERY.DC,
+                 log_file='native_dc_three_groups.log',
+                 tmp_dir='native_dc_three_groups_{}'.format(use_server_send[0]),
+                 no_server_send=use_server_send[1],
+                 native_recover=True)
+
+        for group in (scope.test_group, scope.test_group2, scope.test_group3):
+            session.groups = [group]
+            check_data(scope, session, self.native_keys, self.native_keys, self.timestamp2)
+
     @pytest.mark.usefixtures("servers")
     def test_write_and_corrupt_data(self, simple_node):
         '''
@@ -1554,9 +1597,10 @@ class TestDCRecoveryReadOnlyGroup:
         scope.ro_group = scope.session.routes.groups()[0]
         scope.rw_group = scope.session.routes.groups()[1]
 
+    @pytest.mark.parametrize('native_recover', [False, True], ids=['python_recover', 'native_recover'])
+    def test_recovery(self, use_server_send, native_recover):
         self.prepare_data()
 
-    def test_recovery(self, use_server_send):
         recovery(one_node=False,
                  remotes=scope.session.routes.addresses(),
                  backend_id=None,
@@ -1565,9 +1609,10 @@ class TestDCRecoveryReadOnlyGroup:
                  ro_groups={scope.ro_group},
                  rtype=RECOVERY.DC,
                  log_file='dc_recovery_ro_group.log',
-                 tmp_dir='dc_recovery_ro_group_{}'.format(use_server_send[0]),
+                 tmp_dir='dc_recovery_ro_group_{}_{}'.format(use_server_send[0], native_recover),
                  no_server_send=use_server_send[1],
-                 expected_ret_code=1)  # expect that recovery will fail because one corrupted key won't be recovered
+                 expected_ret_code=1,  # expect that recovery will fail because one corrupted key won't be recovered
+                 native_recover=native_recover)
 
         session = scope.session.clone()
         session.exceptions_policy = elliptics.core.exceptions_policy.no_exceptions
@@ -1676,6 +1721,166 @@ class TestRecoveryDCWithFailedGroup:
         self.cleanup()
 
 
+@pytest.mark.usefixtures('use_server_send')
+@pytest.mark.usefixtures("servers")
+@pytest.mark.incremental
+class TestNativeDCRecovery:
+    """Checks dc recovery with --native-recover beyond the happy path of TestRecovery.test_native_dc_three_groups:
+    * chunked recovery of keys larger than chunk_size
+    * corrupted replicas with and without -S
+    * fallback of keys failed by server_send with -ENXIO into rest_keys
+    Native recovery with read-only groups is checked by TestDCRecoveryReadOnlyGroup.
+    """
+
+    timestamp = elliptics.Time.now()
+    timestamp2 = elliptics.Time(timestamp.tsec + 3600, timestamp.tnsec)
+    timestamp3 = elliptics.Time(timestamp.tsec + 7200, timestamp.tnsec)
+    count = 16
+
+    def recovery(self, use_server_send, name, expected_ret_code=0, chunk_size=1024, safe=False):
+        recovery(one_node=False,
+                 remotes=scope.session.routes.addresses(),
+                 backend_id=None,
+                 address=scope.session.routes.addresses(),
+                 groups=scope.groups,
+                 rtype=RECOVERY.DC,
+                 log_file='native_{}.log'.format(name),
+                 tmp_dir='TestNativeDCRecovery_{}_{}'.format(name, use_server_send[0]),
+                 no_server_send=use_server_send[1],
+                 expected_ret_code=expected_ret_code,
+                 chunk_size=chunk_size,
+                 safe=safe,
+                 native_recover=True)
+
+    def cleanup(self):
+        cleanup_backends(scope.session, scope.session.routes.addresses_with_backends(),
+                         scope.session.routes.addresses_with_backends())
+
+    def test_setup(self, simple_node):
+        scope.session = make_session(node=simple_node, test_name='TestNativeDCRecovery')
+        scope.groups = scope.session.routes.groups()[:3]
+
+        self.cleanup()
+
+    def test_chunked_recovery(self, use_server_send):
+        '''
+        Writes keys larger than chunk_size to the first group and recovers them by chunks to other groups.
+        '''
+        keys = ['native_large_key_{}_{}'.format(use_server_send[0], i) for i in xrange(self.count)]
+        datas = [str(i) * 32 for i in xrange(self.count)]
+
+        session = scope.session.clone()
+        session.groups = scope.groups[:1]
+        session.timestamp = self.timestamp
+        write_data(scope, session, keys, datas)
+
+        self.recovery(use_server_send, 'chunked', chunk_size=13)
+
+        for group in scope.groups:
+            session.groups = [group]
+            check_data(scope, session, keys, datas, self.timestamp)
+
+    @pytest.mark.parametrize('safe', [False, True])
+    def test_corrupted_newest_replica(self, use_server_send, safe):
+        '''
+        Writes the key with incremental timestamps to all groups and corrupts the newest replica.
+        Checks that the second replica is recovered to all groups including the corrupted one in both modes.
+        '''
+        key = 'native_corrupted_key_{}_{}'.format(use_server_send[0], safe)
+
+        session = scope.session.clone()
+        for i, (group, timestamp) in enumerate(zip(scope.groups, (self.timestamp, self.timestamp2, self.timestamp3))):
+            session.groups = [group]
+            session.timestamp = timestamp
+            write_data(scope, session, [key], ['{}.{}'.format(key, i)])
+        corrupt_key(session, key)
+
+        self.recovery(use_server_send, 'corrupted_newest_{}'.format(safe), safe=safe)
+
+        for group in scope.groups:
+            session.groups = [group]
+            check_data(scope, session, [key], [key + '.1'], self.timestamp2)
+
+    @pytest.mark.parametrize('safe', [False, True])
+    def test_corrupted_single_replica(self, use_server_send, safe):
+        '''
+        Writes the key to the first group only and corrupts it, so the key can't be recovered.
+        Checks that the corrupted replica is removed, but it is kept in safe mode.
+        '''
+        key = 'native_corrupted_single_key_{}_{}'.format(use_server_send[0], safe)
+
+        session = scope.session.clone()
+        session.groups = scope.groups[:1]
+        session.timestamp = self.timestamp
+        write_data(scope, session, [key], [key])
+        corrupt_key(session, key)
+
+        self.recovery(use_server_send, 'corrupted_single_{}'.format(safe), expected_ret_code=1, safe=safe)
+
+        session.exceptions_policy = elliptics.exceptions_policy.no_exceptions
+        session.set_filter(elliptics.filters.all)
+        if safe:
+            assert session.read_data(key).get()[0].status == -errno.EILSEQ
+            session.groups = scope.groups[1:]
+        else:
+            session.groups = scope.groups
+        check_keys_absence_in_all_groups(scope, session, [key])
+
+    def test_server_send_fallback_to_rest_keys(self, simple_node, use_server_send):
+        '''
+        Prepares bucket of the first group with the key which should be recovered to the second group and
+        to the group without routes. Server-send fails with -ENXIO and moves the key into rest_keys, where it is
+        recovered by reading and writing it. Checks that the key is written to the second group, while the result
+        of recovery is negative because write to the group without routes fails.
+        '''
+        from elliptics_recovery.utils.misc import KeyInfo, dump_key_data
+
+        key = 'native_fallback_key_{}'.format(use_server_send[0])
+        source_group, dest_group = scope.groups[:2]
+        unrouted_group = max(scope.session.routes.groups()) + 1
+
+        session = scope.session.clone()
+        session.groups = [source_group]
+        session.timestamp = self.timestamp
+        write_data(scope, session, [key], [key])
+        lookup = session.lookup(key).get()[0]
+
+        tmp_dir = os.path.join(os.getcwd(), 'TestNativeDCRecovery_fallback_{}'.format(use_server_send[0]))
+        try:
+            os.makedirs(tmp_dir, 0755)
+        except:
+            pass
+        with open(os.path.join(tmp_dir, 'bucket_{}'.format(source_group)), 'wb') as bucket:
+            key_info = KeyInfo(lookup.address, source_group, lookup.timestamp, lookup.size, 0,
+                               lookup.record_flags, lookup.offset, 0)
+            dump_key_data((session.transform(key), (key_info,)), bucket)
+
+        result, stats = elliptics.core.newapi.dc_recover(node=simple_node,
+                                                         groups=[source_group, dest_group, unrouted_group],
+                                                         ro_groups=[],
+                                                         tmp_dir=tmp_dir,
+                                                         bucket_order=[source_group],
+                                                         batch_size=100,
+                                                         chunk_size=1024,
+                                                         data_flow_rate=10 * 1024 * 1024,
+                                                         attempts=1,
+                                                         chunk_write_timeout=1000,
+                                                         chunk_commit_timeout=1000,
+                                                         prepare_timeout=elliptics.Time(0, 0),
+                                                         trace_id=0,
+                                                         safe=False,
+                                                         dry_run=False)
+        assert not result
+        assert stats['commands']['server_send.{}'.format(-errno.ENXIO)] == 1
+        assert stats['processed_keys'] == 1
+
+        session.groups = [dest_group]
+        check_data(scope, session, [key], [key], self.timestamp)
+
+    def test_teardown(self):
+        self.cleanup()
+
+
 @pytest.mark.usefixtures("servers")
 @pytest.mark.incremental
 class TestRecoveryDCWithUncommitted:
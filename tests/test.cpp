@@ -445,6 +445,25 @@ static void test_prepare_commit(session &sess, const std::string &remote, int ps
 	BOOST_REQUIRE_EQUAL(read_entry.file().to_string(), written);
 }
 
+/* upload with several chunks in flight and download of the same object by chunks */
+static void test_parallel_chunked_write_read(session &sess, const std::string &remote, size_t chunk_size,
+		size_t window)
+{
+	std::string data;
+	for (size_t i = 0; data.size() < chunk_size * 10 + chunk_size / 2; ++i)
+		data += "parallel chunk data " + std::to_string(i) + "|";
+
+	ELLIPTICS_REQUIRE(write_result, sess.write_data(remote, data_pointer::copy(data), 0, chunk_size, window));
+
+	ELLIPTICS_REQUIRE(read_result, sess.read_data(remote, 0, 0, chunk_size, window));
+	read_result_entry read_entry = read_result.get_one();
+	BOOST_REQUIRE_EQUAL(read_entry.io_attribute()->size, data.size());
+	BOOST_REQUIRE_EQUAL(read_entry.file().to_string(), data);
+
+	ELLIPTICS_REQUIRE(range_result, sess.read_data(remote, chunk_size / 2, chunk_size * 3, chunk_size, window));
+	BOOST_REQUIRE_EQUAL(range_result.get_one().file().to_string(), data.substr(chunk_size / 2, chunk_size * 3));
+}
+
 static void test_bulk_write(session &sess, size_t test_count)
 {
 	std::vector<struct dnet_io_attr> ios;
@@ -1040,6 +1059,8 @@ bool register_tests(const nodes_data *setup)
 	ELLIPTICS_TEST_CASE(test_prepare_commit, use_session(n, {1, 2}, 0, 0), "prepare-commit-test-2", 0, 1);
 	ELLIPTICS_TEST_CASE(test_prepare_commit, use_session(n, {1, 2}, 0, 0), "prepare-commit-test-3", 1, 0);
 	ELLIPTICS_TEST_CASE(test_prepare_commit, use_session(n, {1, 2}, 0, 0), "prepare-commit-test-4", 1, 1);
+	ELLIPTICS_TEST_CASE(test_parallel_chunked_write_read, use_session(n, {1, 2}, 0, 0), "parallel-chunked-test-1", 1024, 1);
+	ELLIPTICS_TEST_CASE(test_parallel_chunked_write_read, use_session(n, {1, 2}, 0, 0), "parallel-chunked-test-2", 1024, 4);
 	ELLIPTICS_TEST_CASE(test_prepare_commit_simultaneously, use_session(n, {1, 2}, 0, 0));
 	ELLIPTICS_TEST_CASE(test_bulk_write, use_session(n, {1, 2}, 0, 0), 1000);
 	ELLIPTICS_TEST_CASE(test_bulk_read, use_session(n, {1, 2}, 0, 0), 1000);
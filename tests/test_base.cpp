@@ -399,7 +399,9 @@ void server_config::write(const std::string &path) const {
 
 	rapidjson::Value logger;
 	logger.SetObject();
-	logger.AddMember("level", "debug", allocator);
+	const std::string level_name = log_level.empty() ? "debug" : log_level;
+	rapidjson::Value level(level_name.c_str(), level_name.size(), allocator);
+	logger.AddMember("level", level, allocator);
 	add_core_logger(logger, allocator, log_path);
 	add_access_logger(logger, allocator, access_path);
 
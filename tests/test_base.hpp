@@ -230,6 +230,8 @@ public:
 
 	std::string log_path;
 	std::string access_path;
+	// verbosity of server's log, debug if it is empty
+	std::string log_level;
 };
 
 class server_node